@@ -0,0 +1,90 @@
+# CHAP - The Channel Annotation Package
+# 
+# Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+# Stephen J. Tucker
+# 
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+
+# Embed Data Files
+#------------------------------------------------------------------------------
+#
+# Generates a C++ source file that contains all JSON files in DATA_DIR as 
+# string literals, so that the built-in databases are available without any
+# file I/O at run time. Files are identified by their path relative to 
+# DATA_DIR. Invoke as:
+#
+#   cmake -DDATA_DIR=<dir> -DOUTPUT_FILE=<file> -P EmbedDataFiles.cmake
+#
+
+# sanity checks:
+if(NOT DATA_DIR OR NOT OUTPUT_FILE)
+    message(FATAL_ERROR "EmbedDataFiles requires DATA_DIR and OUTPUT_FILE.")
+endif()
+
+# long string literals are split into chunks of this many characters:
+set(CHUNK_SIZE 4096)
+
+# raw string literal delimiters:
+set(LITERAL_BEGIN "R\"CHAPDATA(")
+set(LITERAL_END ")CHAPDATA\"")
+
+# file header:
+set(CONTENT "// generated by EmbedDataFiles.cmake, do not edit\n\n")
+string(APPEND CONTENT "#include \"config/builtin_data.hpp\"\n\n")
+string(APPEND CONTENT "const BuiltinDataFile g_BUILTIN_DATA_FILES[] = {\n")
+
+# one table entry per data file:
+file(GLOB_RECURSE DATA_FILES RELATIVE ${DATA_DIR} ${DATA_DIR}/*.json)
+list(SORT DATA_FILES)
+list(LENGTH DATA_FILES NUM_DATA_FILES)
+foreach(DATA_FILE ${DATA_FILES})
+
+    # read file and check that it can be embedded in a raw string literal:
+    file(READ ${DATA_DIR}/${DATA_FILE} DATA)
+    string(FIND "${DATA}" "${LITERAL_END}" DELIM_POS)
+    if(NOT DELIM_POS EQUAL -1)
+        message(FATAL_ERROR "Can not embed ${DATA_FILE}.")
+    endif()
+
+    # file name and content as concatenated string literals:
+    string(LENGTH "${DATA}" DATA_LENGTH)
+    string(APPEND CONTENT "    {\"${DATA_FILE}\",\n")
+    set(OFFSET 0)
+    while(OFFSET LESS DATA_LENGTH)
+        string(SUBSTRING "${DATA}" ${OFFSET} ${CHUNK_SIZE} CHUNK)
+        string(APPEND CONTENT "     ${LITERAL_BEGIN}${CHUNK}${LITERAL_END}\n")
+        math(EXPR OFFSET "${OFFSET} + ${CHUNK_SIZE}")
+    endwhile()
+    string(APPEND CONTENT "     , ${DATA_LENGTH}},\n")
+
+endforeach()
+
+# terminating entry ensures table is never empty:
+string(APPEND CONTENT "    {nullptr, nullptr, 0}};\n\n")
+
+# number of table entries (excluding terminating entry):
+string(APPEND CONTENT "const size_t g_NUM_BUILTIN_DATA_FILES = ")
+string(APPEND CONTENT "${NUM_DATA_FILES};\n")
+
+# only touch output file if content has changed:
+file(WRITE ${OUTPUT_FILE}.tmp "${CONTENT}")
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different 
+                ${OUTPUT_FILE}.tmp ${OUTPUT_FILE})
+file(REMOVE ${OUTPUT_FILE}.tmp)
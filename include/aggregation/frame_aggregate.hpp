@@ -0,0 +1,181 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef FRAME_AGGREGATE_HPP
+#define FRAME_AGGREGATE_HPP
+
+#include <string>
+#include <vector>
+
+#include "gromacs/utility/real.h"
+
+#include "external/rapidjson/document.h"
+
+#include "analysis-setup/residue_information_provider.hpp"
+#include "io/frame_stream_reader.hpp"
+#include "io/results_json_stream_writer.hpp"
+#include "path-finding/molecular_path.hpp"
+#include "statistics/histogram_density_estimator.hpp"
+#include "statistics/profile_summary_statistics.hpp"
+#include "statistics/summary_statistics.hpp"
+
+
+/*!
+ * \brief Profiles sampled at the support points from a single frame of the 
+ * stream file.
+ */
+struct FrameProfileSample
+{
+    std::vector<real> radius_;
+    std::vector<real> plHydrophobicity_;
+    std::vector<real> pfHydrophobicity_;
+    std::vector<real> solventDensity_;
+    std::vector<real> energy_;
+    real energyAnchorLo_;
+    real energyAnchorHi_;
+};
+
+
+/*!
+ * \brief Time-averaged results of a contiguous sequence of frames read from
+ * the stream file.
+ *
+ * All profiles are sampled on a set of support points that is fixed when the
+ * object is created, so that aggregates over different parts of a trajectory
+ * (e.g. analysed by separate jobs) can be combined with merge(). The state 
+ * consists of SummaryStatistics for all scalar, profile, and residue 
+ * properties, which are combined exactly with the pairwise update formula,
+ * and of the complete scalar and profile time series, which are concatenated.
+ * Quantiles and correlation-aware error estimates depend on the order of the
+ * frames and can not be merged, so they are computed from the time series 
+ * only once all frames have been added in writeResults(). As a consequence,
+ * partial aggregates must be merged in the order of their time stamps.
+ *
+ * Aggregates of independent replicas of a simulation are combined with 
+ * merge() to obtain ensemble averages, while ensembleProfile() summarises 
+ * the time-averaged profiles of each replica to quantify the variance 
+ * between replicas.
+ *
+ * By default, the time-averaged solvent density is the mean of the per-frame
+ * densities. If setSolventHistogram() is called before adding frames, the 
+ * solvent positions of all frames are instead collected in a single 
+ * trajectory-wide histogram, from which the mean density profile is 
+ * calculated using the time-averaged radius profile. This histogram is 
+ * combined exactly by merge().
+ *
+ * The first frame added defines the pathway used to visualise the time 
+ * averaged profiles. All state can be converted to and from JSON to pass
+ * partial aggregates between jobs.
+ */
+class FrameAggregate
+{
+    public:
+
+        // constructor:
+        FrameAggregate(
+                const std::vector<real> &supportPoints,
+                real anchorPointLo,
+                real anchorPointHi);
+
+        // trajectory-wide solvent histogram:
+        void setSolventHistogram(
+                real binWidth);
+
+        // adding frames:
+        void sample(
+                const FrameStreamData &frame,
+                FrameProfileSample &sample) const;
+        void update(
+                const FrameStreamData &frame,
+                const FrameProfileSample &sample);
+
+        // combining partial aggregates:
+        void merge(
+                const FrameAggregate &other);
+        static std::vector<SummaryStatistics> ensembleProfile(
+                const std::vector<FrameAggregate> &replicas,
+                const std::string &profile);
+
+        // conversion to and from JSON:
+        rapidjson::Value toJson(
+                rapidjson::Document::AllocatorType &alloc) const;
+        static FrameAggregate fromJson(
+                const rapidjson::Value &json);
+
+        // getter methods:
+        size_t numFrames() const;
+        std::vector<real> supportPoints() const;
+        std::vector<real> timeStamps() const;
+        std::vector<int> poreResIds() const;
+        std::vector<SummaryStatistics> residuePoreLining() const;
+        std::vector<SummaryStatistics> residuePoreFacing() const;
+
+        // output:
+        void writeResults(
+                ResultsJsonStreamWriter &results,
+                const ResidueInformationProvider &resInfo) const;
+        MolecularPath averagePath() const;
+
+        // create pathway from stream data:
+        static MolecularPath molecularPath(
+                const FrameStreamData &frame);
+
+    private:
+
+        // support points and points at which energy is zero:
+        std::vector<real> supportPoints_;
+        real anchorPointLo_;
+        real anchorPointHi_;
+
+        // first frame defining the pathway:
+        FrameStreamData firstFrame_;
+
+        // aggregate scalar properties and their time series:
+        std::vector<real> timeStamps_;
+        std::vector<SummaryStatistics> scalarSummary_;
+        std::vector<std::vector<real>> scalarTimeSeries_;
+
+        // aggregate profiles and their time series (one row per frame):
+        std::vector<ProfileSummaryStatistics> profileSummary_;
+        std::vector<std::vector<real>> profileTimeSeries_;
+        SummaryStatistics anchorEnergyLo_;
+        SummaryStatistics anchorEnergyHi_;
+
+        // aggregate residue properties:
+        std::vector<int> poreResIds_;
+        std::vector<std::vector<SummaryStatistics>> residueSummary_;
+
+        // trajectory-wide histogram of solvent positions:
+        bool hasSolventHistogram_;
+        HistogramDensityEstimator solventHistogram_;
+
+        // internal auxiliary functions:
+        ProfileSummaryStatistics densityProfile() const;
+        std::vector<real> profileRow(
+                size_t profile,
+                size_t frame) const;
+        real energyShift() const;
+};
+
+#endif
@@ -68,6 +68,11 @@ class ResidueInformationProvider
         void chainFromTopology(const gmx::TopologyInformation &top);
         void hydrophobicityFromJson(const rapidjson::Document &doc);
         void setDefaultHydrophobicity(const real hydrophobicity);
+        void setName(const int id, const std::string &name);
+        void setChain(const int id, const std::string &chain);
+        void setHydrophobicity(
+                const std::string &name, 
+                const real hydrophobicity);
         
         // getter methods:
         std::vector<int> ids() const;
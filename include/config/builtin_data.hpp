@@ -0,0 +1,71 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef BUILTIN_DATA_HPP
+#define BUILTIN_DATA_HPP
+
+#include <cstddef>
+#include <string>
+
+
+/*!
+ * \brief Content of a data file that has been compiled into the binary.
+ *
+ * The table of built-in data files is generated from the JSON files in 
+ * share/data at build time (see cmake/Scripts/EmbedDataFiles.cmake). Files 
+ * are identified by their path relative to share/data, e.g. 
+ * vdwradii/hole_simple.json.
+ */
+struct BuiltinDataFile
+{
+    const char *name_;
+    const char *data_;
+    size_t size_;
+};
+
+extern const BuiltinDataFile g_BUILTIN_DATA_FILES[];
+extern const size_t g_NUM_BUILTIN_DATA_FILES;
+
+
+/*!
+ * \brief Returns the built-in data file of the given name or a null pointer 
+ * if no such file has been compiled in.
+ */
+inline const BuiltinDataFile*
+builtinDataFile(const std::string &name)
+{
+    for(size_t i = 0; i < g_NUM_BUILTIN_DATA_FILES; i++)
+    {
+        if( name == g_BUILTIN_DATA_FILES[i].name_ )
+        {
+            return &g_BUILTIN_DATA_FILES[i];
+        }
+    }
+
+    return nullptr;
+}
+
+#endif
+
@@ -0,0 +1,42 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef FRIEND_TEST_HPP
+#define FRIEND_TEST_HPP
+
+/*
+ * Unit tests access private members of some classes through FRIEND_TEST. The
+ * Google Test header providing it is only used when building the tests 
+ * (CHAP_UNIT_TESTS is defined for the test target only), so that the 
+ * installed headers do not depend on Google Test. Otherwise the macro expands
+ * to nothing, unless Google Test has already been included.
+ */
+#ifdef CHAP_UNIT_TESTS
+#include <gtest/gtest_prod.h>
+#elif !defined(FRIEND_TEST)
+#define FRIEND_TEST(test_case_name, test_name)
+#endif
+
+#endif
+
@@ -25,14 +25,15 @@
 #ifndef BSPLINE_BASIS_SET_HPP
 #define BSPLINE_BASIS_SET_HPP
 
+#include <cstddef>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
 
-#include <gtest/gtest.h>
-
 #include <gromacs/utility/real.h> 
 
+#include "config/friend_test.hpp"
+
 
 /*!
  * Shorthand notation for a sparse basis vector given as map of indeces to 
@@ -28,10 +28,10 @@
 #include <utility>
 #include <vector>
 
-#include <gtest/gtest_prod.h>   
-
 #include <gromacs/math/vec.h>
 
+#include "config/friend_test.hpp"
+
 #include "geometry/abstract_spline_curve.hpp"
 
 
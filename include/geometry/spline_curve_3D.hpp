@@ -27,11 +27,11 @@
 
 #include <vector>
 
-#include <gtest/gtest_prod.h>   
-
 #include <gromacs/utility/real.h> 
 #include <gromacs/math/vec.h>
 
+#include "config/friend_test.hpp"
+
 #include "geometry/abstract_spline_curve.hpp"
 
 
@@ -25,13 +25,16 @@
 #ifndef ANALYSIS_DATA_JSON_FRAME_EXPORTER
 #define ANALYSIS_DATA_JSON_FRAME_EXPORTER
 
-#include <fstream>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "gromacs/analysisdata/datamodule.h"
 
-#include "external/rapidjson/document.h"
+#include "external/rapidjson/stringbuffer.h"
+#include "external/rapidjson/writer.h"
+
+#include "io/async_file_writer.hpp"
 
 
 /*!
@@ -63,8 +66,12 @@
  *   need to keep the entire file in memory (or implement a much more 
  *   complicated parser for extracting features of interest).
  *
- * The repeated opening and closing of files may not be very efficient, but 
- * will likely not be the bottleneck of the analysis tool.
+ * No JSON document is built in memory. Instead, the values of each frame are
+ * collected in reusable per-column arrays and serialised directly with a 
+ * rapidjson::Writer into the buffer of an AsyncFileWriter, which keeps the 
+ * file open for the entire analysis and writes full buffers on a background
+ * thread. The file is therefore only guaranteed to be complete after 
+ * dataFinished() has been called.
  */
 class AnalysisDataJsonFrameExporter : public gmx::AnalysisDataModuleSerial
 {
@@ -101,10 +108,15 @@ class AnalysisDataJsonFrameExporter : public gmx::AnalysisDataModuleSerial
         std::vector<std::string> dataSetNames_;
         std::vector<std::vector<std::string>> columnNames_;
 
+        // values of current frame for each data set and column:
+        int frameIndex_ = 0;
+        real frameTime_ = 0.0;
+        std::vector<std::vector<std::vector<real>>> values_;
+
         // internal variables:
-        rapidjson::Document json_;
         std::string fileName_ = "stream.json";
-        std::fstream file_;
+        AsyncFileWriter file_;
+        rapidjson::Writer<rapidjson::StringBuffer> writer_;
 };
 
 
@@ -0,0 +1,109 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef ASYNC_FILE_WRITER_HPP
+#define ASYNC_FILE_WRITER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "external/rapidjson/stringbuffer.h"
+
+
+/*!
+ * \brief Writes text to a file on a background thread.
+ *
+ * Text is written into a reusable buffer obtained from buffer(). Once that 
+ * buffer exceeds a given size, commit() hands it over to a dedicated writer
+ * thread via a bounded queue and provides a fresh (recycled) buffer, so that
+ * serialisation on the calling thread overlaps with file I/O. If the writer
+ * thread falls behind and the queue is full, commit() blocks until a buffer
+ * has been written.
+ *
+ * The file is kept open from open() to close() and is never flushed 
+ * explicitly in between. Errors on the writer thread are reported as a 
+ * std::runtime_error the next time commit() or close() is called.
+ */
+class AsyncFileWriter
+{
+    public:
+
+        // constructor and destructor:
+        AsyncFileWriter(
+                size_t bufferSize = 1 << 20,
+                size_t maxQueueLength = 4);
+        ~AsyncFileWriter();
+
+        // file handling:
+        void open(
+                const std::string &fileName);
+        void close();
+        bool isOpen() const;
+
+        // buffer handling:
+        rapidjson::StringBuffer& buffer();
+        void commit();
+        void flush();
+
+    private:
+
+        // parameters:
+        size_t bufferSize_;
+        size_t maxQueueLength_;
+
+        // output file:
+        std::string fileName_;
+        std::ofstream file_;
+
+        // buffer currently written to by the calling thread:
+        std::unique_ptr<rapidjson::StringBuffer> buffer_;
+
+        // buffers waiting to be written and buffers available for reuse:
+        std::deque<std::unique_ptr<rapidjson::StringBuffer>> filledBuffers_;
+        std::deque<std::unique_ptr<rapidjson::StringBuffer>> freeBuffers_;
+
+        // synchronisation between calling and writer thread:
+        std::thread writerThread_;
+        std::mutex mutex_;
+        std::condition_variable bufferFilled_;
+        std::condition_variable bufferWritten_;
+        bool finished_;
+        bool writeFailed_;
+
+        // auxiliary functions:
+        void writeLoop();
+        void handOverBuffer();
+        void stopWriterThread();
+        void checkWriteErrors();
+};
+
+#endif
+
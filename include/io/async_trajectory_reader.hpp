@@ -0,0 +1,156 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#ifndef ASYNC_TRAJECTORY_READER_HPP
+#define ASYNC_TRAJECTORY_READER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gromacs/fileio/oenv.h>
+#include <gromacs/fileio/trxio.h>
+#include <gromacs/math/vectypes.h>
+#include <gromacs/trajectory/trajectoryframe.h>
+
+#include "io/xtc_reader.hpp"
+
+
+/*!
+ * \brief Reads trajectory frames ahead of their analysis on a background 
+ * thread.
+ *
+ * Frames are decoded with the Gromacs trajectory I/O on a dedicated reader
+ * thread and copied into a ring of frame buffers, whose coordinate arrays 
+ * are allocated once when the trajectory is opened. The calling thread 
+ * obtains frames in their original order from nextFrame(), so that decoding
+ * (e.g. XTC decompression) of the following frames overlaps with the 
+ * analysis of the current one. A frame remains valid until the next call to
+ * nextFrame(), after which its buffer is handed back to the reader thread. 
+ * If the reader thread is ahead by as many frames as there are buffers, it
+ * waits until the calling thread releases a buffer.
+ *
+ * Only coordinates, box, time, and step of each frame are kept. Errors on the
+ * reader thread are rethrown by nextFrame() once all frames read before the
+ * error have been returned.
+ *
+ * XTC files are read with an XtcReader instead of the Gromacs trajectory 
+ * I/O. Frames are then selected by their time stamp from the frame index 
+ * built on opening the file, so that frames outside the range set with 
+ * setTimeRange() are skipped without being decompressed, and if a maximum 
+ * number of atoms is set with setMaxAtoms(), only the coordinates of these
+ * atoms are decoded directly into the frame buffers. Frames of other 
+ * formats are selected by the Gromacs time control (i.e. the -b, -e, and 
+ * -dt options of the trajectory analysis framework) instead.
+ */
+class AsyncTrajectoryReader
+{
+    public:
+
+        // constructor and destructor:
+        AsyncTrajectoryReader(
+                size_t numBuffers = 4);
+        ~AsyncTrajectoryReader();
+
+        // setup:
+        void setMaxAtoms(
+                int numAtoms);
+        void setTimeRange(
+                real begin,
+                real end,
+                real dt);
+
+        // file handling:
+        void open(
+                const std::string &fileName);
+        void close();
+
+        // access to frames:
+        const t_trxframe* nextFrame();
+
+
+    private:
+
+        /*!
+         * \brief Frame in the ring together with storage for coordinates.
+         */
+        struct FrameBuffer
+        {
+            t_trxframe frame_;
+            std::vector<gmx::RVec> x_;
+        };
+
+        // input file:
+        std::string fileName_;
+        bool isOpen_;
+        gmx_output_env_t *oenv_;
+        t_trxstatus *status_;
+        t_trxframe decodedFrame_;
+
+        // indexed reading of XTC files:
+        XtcReader xtcReader_;
+        bool useXtcReader_;
+        std::vector<size_t> xtcFrames_;
+        size_t nextXtcFrame_;
+        int maxAtoms_;
+        real beginTime_;
+        real endTime_;
+        real deltaTime_;
+
+        // ring of frame buffers:
+        std::vector<FrameBuffer> buffers_;
+        size_t firstFilled_;
+        size_t numFilled_;
+        bool holdsFrame_;
+
+        // synchronisation between calling and reader thread:
+        std::thread readerThread_;
+        std::mutex mutex_;
+        std::condition_variable frameRead_;
+        std::condition_variable frameReleased_;
+        bool endOfFile_;
+        bool stopped_;
+        std::exception_ptr readError_;
+
+        // auxiliary functions:
+        void openTrajectory();
+        void openXtcFile();
+        void selectXtcFrames();
+        void readXtcFrame(
+                size_t frame,
+                FrameBuffer &target);
+        void readLoop();
+        void copyFrame(
+                const t_trxframe &source,
+                FrameBuffer &target);
+        void stopReaderThread();
+};
+
+#endif
@@ -0,0 +1,71 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef BINARY_BUFFER_HPP
+#define BINARY_BUFFER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/*!
+ * \brief Byte buffer for assembling little endian binary files.
+ *
+ * Integers and floating point numbers are always appended in little endian
+ * byte order, irrespective of the byte order of the machine. This is used by 
+ * the binary mesh exporters, which assemble a complete file in memory before 
+ * writing it to disk in a single call.
+ */
+class BinaryBuffer
+{
+    public:
+
+        // functions for appending data:
+        void reserve(size_t size);
+        void appendUint8(uint8_t value);
+        void appendUint32(uint32_t value);
+        void appendFloat(float value);
+        void appendString(const std::string &str);
+        void pad(size_t alignment, char fill);
+
+        // access to data:
+        const std::string& data() const;
+        size_t size() const;
+
+        // writing to file:
+        void write(const std::string &fileName) const;
+        static void write(
+                const std::string &fileName,
+                const std::vector<const BinaryBuffer*> &buffers);
+
+    private:
+
+        // byte storage:
+        std::string data_;
+};
+
+#endif
+
@@ -0,0 +1,187 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef FRAME_STREAM_READER_HPP
+#define FRAME_STREAM_READER_HPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/utility/real.h>
+
+#include "external/rapidjson/reader.h"
+
+
+/*!
+ * \brief Knots and control points of a one-dimensional spline curve as stored
+ * in the per-frame stream file.
+ */
+struct FrameStreamSpline
+{
+    std::vector<real> knots_;
+    std::vector<real> ctrl_;
+};
+
+
+/*!
+ * \brief Typed container for the per-frame data that is read back from the
+ * stream file to form time averages.
+ *
+ * Member names follow the data set and column names used when writing the 
+ * stream file in ChapTrajectoryAnalysis::initAnalysis(). Of the solvent 
+ * positions, only the arc length coordinate and the inside flags are 
+ * included and only if requested from FrameStreamReader, as they are not 
+ * needed for aggregation unless the solvent density is re-estimated.
+ * All arrays keep their capacity between frames, so that reusing the same
+ * object for every frame avoids repeated memory allocation.
+ */
+struct FrameStreamData
+{
+    // frame number and time stamp:
+    int frameIndex_ = 0;
+    real frameTime_ = 0.0;
+
+    // path summary:
+    real timeStamp_ = 0.0;
+    real argMinRadius_ = 0.0;
+    real minRadius_ = 0.0;
+    real length_ = 0.0;
+    real volume_ = 0.0;
+    real numPath_ = 0.0;
+    real numSample_ = 0.0;
+    real solventRangeLo_ = 0.0;
+    real solventRangeHi_ = 0.0;
+    real argMinSolventDensity_ = 0.0;
+    real minSolventDensity_ = 0.0;
+    real arcLengthLo_ = 0.0;
+    real arcLengthHi_ = 0.0;
+    real bandWidth_ = 0.0;
+
+    // original path points and radii:
+    std::vector<real> origPointsX_;
+    std::vector<real> origPointsY_;
+    std::vector<real> origPointsZ_;
+    std::vector<real> origPointsR_;
+
+    // molecular path splines:
+    FrameStreamSpline radiusSpline_;
+    std::vector<real> centreLineKnots_;
+    std::vector<real> centreLineCtrlX_;
+    std::vector<real> centreLineCtrlY_;
+    std::vector<real> centreLineCtrlZ_;
+
+    // residue positions:
+    std::vector<real> resId_;
+    std::vector<real> resS_;
+    std::vector<real> resRho_;
+    std::vector<real> resPhi_;
+    std::vector<real> resPoreLining_;
+    std::vector<real> resPoreFacing_;
+    std::vector<real> resPoreRadius_;
+    std::vector<real> resSolventDensity_;
+    std::vector<real> resX_;
+    std::vector<real> resY_;
+    std::vector<real> resZ_;
+
+    // solvent positions (optional):
+    std::vector<real> solventS_;
+    std::vector<real> solventInPore_;
+    std::vector<real> solventInSample_;
+
+    // profile splines:
+    FrameStreamSpline solventDensitySpline_;
+    FrameStreamSpline plHydrophobicitySpline_;
+    FrameStreamSpline pfHydrophobicitySpline_;
+
+    // convenience functions for creating a MolecularPath:
+    std::vector<gmx::RVec> origPoints() const;
+    std::vector<gmx::RVec> centreLineCtrlPoints() const;
+
+    // reset all arrays without releasing memory:
+    void clear();
+};
+
+
+/*!
+ * \brief Reads the newline delimited JSON stream file written by 
+ * AnalysisDataJsonFrameExporter one frame at a time.
+ *
+ * Rather than building a rapidjson::Document for each line, this class uses
+ * the SAX interface of rapidjson to copy only those values needed for forming
+ * time averages straight into a FrameStreamData object. Values in all other
+ * data sets (most notably the large solventPositions arrays, unless 
+ * setReadSolventPositions() has been called) are parsed but immediately 
+ * discarded. Each line is read into the same string buffer and 
+ * parsed in-situ, and the parser and its stack are reused across lines, so 
+ * that reading a frame does not allocate any memory once the buffers have 
+ * grown to their final size.
+ */
+class FrameStreamReader
+{
+    public:
+
+        // constructor:
+        FrameStreamReader();
+
+        // file handling:
+        void open(
+                const std::string &fileName);
+        void close();
+
+        // also read solvent positions:
+        void setReadSolventPositions(
+                bool readSolventPositions);
+
+        // read results of a parameter sweep:
+        void setDataSetSuffix(
+                const std::string &dataSetSuffix);
+
+        // read next frame:
+        bool readFrame(
+                FrameStreamData &frame);
+        int numFramesRead() const;
+
+    private:
+
+        // file and line buffer:
+        std::string fileName_;
+        std::ifstream file_;
+        std::string line_;
+
+        // reusable SAX parser:
+        rapidjson::Reader reader_;
+
+        // read optional data?
+        bool readSolventPositions_;
+        std::string dataSetSuffix_;
+
+        // number of frames read so far:
+        int numFramesRead_;
+};
+
+#endif
+
@@ -0,0 +1,118 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef GLTF_IO_HPP
+#define GLTF_IO_HPP
+
+#include <string>
+#include <vector>
+
+#include <gromacs/utility/real.h>
+
+#include "io/binary_buffer.hpp"
+#include "io/surface_mesh.hpp"
+
+
+/*!
+ * \brief Serialiser for writing a SurfaceMesh to a binary glTF 2.0 (.glb) 
+ * file.
+ *
+ * The mesh is written as a single indexed triangle primitive. Positions and
+ * normals are stored in the POSITION and NORMAL attributes, each scalar 
+ * property is stored as an application specific float attribute named after
+ * the property in upper case with a leading underscore (e.g. _AVG_RADIUS for
+ * avg_radius). All attributes share one index buffer. Each attribute and the 
+ * indices occupy a separate, tightly packed view of the binary buffer.
+ */
+class GltfExporter
+{
+    public:
+
+        // interface for export:
+        void write(
+                const std::string &fileName,
+                const SurfaceMesh &mesh);
+
+        // name of attribute for a scalar property:
+        static std::string attributeName(const std::string &propertyName);
+};
+
+
+/*!
+ * \brief Serialiser for writing a time series of SurfaceMesh frames to a
+ * binary glTF 2.0 (.glb) file.
+ *
+ * All frames must share the same connectivity and the same set of scalar
+ * properties, as is the case for surfaces generated on a fixed grid. The 
+ * triangle indices are therefore stored only once and referenced by the 
+ * primitive of every frame, while the vertex attributes of each frame are 
+ * kept in a compact single precision block in memory until the file is 
+ * written. 
+ *
+ * Each frame becomes a separate node with its own mesh. The simulation time 
+ * of a frame is stored in the extras of its node. An animation with one 
+ * channel per node toggles the node scale so that frames are shown one after
+ * the other, with each frame lasting for the given frame duration in 
+ * seconds. Only the first frame is visible in viewers that do not play the
+ * animation.
+ */
+class GltfSequenceExporter
+{
+    public:
+
+        // constructor:
+        GltfSequenceExporter();
+
+        // setter functions:
+        void setFrameDuration(real frameDuration);
+
+        // interface for adding frames:
+        void addFrame(
+                const SurfaceMesh &mesh,
+                real time);
+        size_t numFrames() const;
+
+        // interface for export:
+        void write(const std::string &fileName);
+
+    private:
+
+        // parameters:
+        real frameDuration_;
+
+        // connectivity and properties shared by all frames:
+        std::string name_;
+        std::vector<std::string> propertyNames_;
+        std::vector<unsigned int> indices_;
+        size_t numVertices_;
+
+        // per-frame data:
+        std::vector<real> times_;
+        std::vector<float> bounds_;
+        BinaryBuffer frameData_;
+};
+
+#endif
+
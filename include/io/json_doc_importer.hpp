@@ -32,6 +32,11 @@
 
 /*!
  * \brief Imports JSON files and returns them as rapidjson objects.
+ *
+ * Files on disk are memory mapped and parsed directly from the mapping, so 
+ * that no intermediate copy of the file content is made. The default 
+ * databases shipped in share/data are also compiled into the binary and can 
+ * be loaded by name through fromBuiltin() without any file system access.
  */
 class JsonDocImporter
 {
@@ -43,6 +48,14 @@ class JsonDocImporter
 
         // define operator for file reading:
         rapidjson::Document operator()(std::string fileName);
+
+        // read a data file compiled into the binary:
+        rapidjson::Document fromBuiltin(std::string name);
+
+    private:
+
+        // parse a buffer into a JSON document:
+        rapidjson::Document parse(const char *data, size_t size);
 };
 
 #endif
@@ -27,17 +27,23 @@
 
 #include <map>
 #include <string>
-#include <tuple>
-#include <unordered_set>
+#include <vector>
 
-#include <gtest/gtest.h>
+#include "config/friend_test.hpp"
 
 #include "path-finding/molecular_path.hpp"
 #include "io/colour.hpp"
+#include "io/surface_mesh.hpp"
 #include "io/wavefront_mtl_io.hpp"
 #include "io/wavefront_obj_io.hpp"
 
 
+/*!
+ * Enum for file formats in which the pathway surface can be written.
+ */
+enum eMeshFormat {eMeshFormatObj, eMeshFormatPly, eMeshFormatGlb};
+
+
 /*!
  * \brief Representation of a regular grid on a cylinder surface.
  *
@@ -47,6 +53,14 @@
  * which can be exploited to generate triangular faces. These faces can be used
  * to subsequently generate vertex normals. 
  *
+ * The geometry of the grid is shared by all scalar properties mapped onto 
+ * the surface, so that vertices and normals are stored only once while each
+ * property contributes one weight per vertex. All arrays are contiguous and
+ * of size \f$ N_s \times N_\phi \f$ and are linearly indexed as 
+ * \f$ i N_\phi + j \f$, so that neighbouring vertices and the triangles 
+ * between them are found by index arithmetic. Properties are kept in the 
+ * order in which they were added.
+ *
  * This is all used by MolcularPathObjExporter.
  */
 class RegularVertexGrid
@@ -60,13 +74,12 @@ class RegularVertexGrid
                 std::vector<real> s,
                 std::vector<real> phi);
 
-        // interface for adding vertices to the grid:
-        void addVertex(
-                size_t i, 
-                size_t j,
+        // interface for adding vertices and properties to the grid:
+        void setVertices(
+                std::vector<gmx::RVec> vertices);
+        void setWeights(
                 std::string p,
-                gmx::RVec vertex, 
-                real weight);
+                std::vector<real> weights);
 
 
         void addColourScale(
@@ -82,16 +95,15 @@ class RegularVertexGrid
         void normalsFromFaces();
     
         // getter methods:
-        std::vector<gmx::RVec> vertices(
-                std::string p);
+        const std::vector<gmx::RVec>& vertices() const;
         std::vector<std::pair<gmx::RVec, real>> weightedVertices(
-                std::string p);
-        std::vector<gmx::RVec> normals(
-                std::string p);
+                std::string p) const;
+        const std::vector<gmx::RVec>& normals() const;
         std::vector<WavefrontObjFace> faces(
-                std::string p);
+                std::string p) const;
+        std::vector<unsigned int> triangleIndices() const;
         ColourScale colourScale(
-                std::string p);
+                std::string p) const;
 
     private:
 
@@ -100,20 +112,19 @@ class RegularVertexGrid
 
         const std::vector<real> phi_;
         const std::vector<real> s_;
-        std::unordered_set<std::string> p_;
-
-        std::map<std::string, ColourScale> colourScales_;
+        std::vector<std::string> p_;
 
-        std::map<std::tuple<size_t, size_t, std::string>, gmx::RVec> vertices_;
-        std::map<std::tuple<size_t, size_t, std::string>, real> weights_;
-        std::map<std::tuple<size_t, size_t, std::string>, gmx::RVec> normals_;
+        // shared geometry, linearly indexed by grid point:
+        std::vector<gmx::RVec> vertices_;
+        std::vector<gmx::RVec> normals_;
 
+        // per-property weights, linearly indexed by grid point:
+        std::vector<std::vector<real>> weights_;
 
-
-        void addTriangleNorm(
-                const gmx::RVec &sideA, 
-                const gmx::RVec &sideB, 
-                gmx::RVec &norm);
+        // indexing:
+        size_t propertyIndex(
+                const std::string &p) const;
+        bool isComplete() const;
 };
 
 
@@ -124,6 +135,12 @@ class RegularVertexGrid
  * a different scalar property mapped to the pathway surface. The colour 
  * associated with this property is written to an MTL file, which is referenced
  * at the beginning of the OBJ file.
+ *
+ * Alternatively, the surface can be written to a binary PLY or glTF file (see
+ * setMeshFormat()). In this case each vertex is stored only once and all 
+ * scalar properties are attached to it as per-vertex attributes with their
+ * physical (i.e. not rescaled) values, so that the colour mapping can be 
+ * chosen in the visualisation software.
  */
 class MolecularPathObjExporter
 {
@@ -146,6 +163,8 @@ class MolecularPathObjExporter
         void setGridSampleDist(real gridSampleDist);
         void setCorrectionThreshold(real correctionThreshold);
         void setPermitClashes(bool permitClashes);
+        void setPrecision(int decimalPlaces);
+        void setMeshFormat(eMeshFormat meshFormat);
 
         // interface for exporting:
         void operator()(
@@ -153,6 +172,9 @@ class MolecularPathObjExporter
                 std::string objectName,
                 MolecularPath &molPath,
                 std::map<std::string, ColourPalette> palettes);
+        SurfaceMesh surfaceMesh(
+                std::string objectName,
+                MolecularPath &molPath);
 
 
     private:
@@ -161,20 +183,31 @@ class MolecularPathObjExporter
         real extrapDist_;
         real gridSampleDist_;
         real correctionThreshold_;
+        int decimalPlaces_;
+        eMeshFormat meshFormat_;
 
         // functions for generating the pathway surface grid:
         std::vector<gmx::RVec> generateNormals(
                 const std::vector<gmx::RVec> &tangents);
+        RegularVertexGrid generatePathwayGrid(
+                MolecularPath &molPath,
+                std::map<std::string, std::pair<SplineCurve1D, bool>> &properties);
         RegularVertexGrid generateGrid(
                 SplineCurve3D &centreLine,
                 SplineCurve1D &radius,
                 std::map<std::string, std::pair<SplineCurve1D, bool>> &properties,
                 std::pair<size_t, size_t> resolution,
                 std::pair<real, real> range);
-        void generatePropertyGrid(
+        SurfaceMesh generateSurfaceMesh(
+                std::string objectName,
+                RegularVertexGrid &grid,
+                std::map<std::string, std::pair<SplineCurve1D, bool>> &properties);
+        void generateGeometry(
                 SplineCurve3D &centreLine,
                 SplineCurve1D &radius,
-                std::pair<std::string, std::pair<SplineCurve1D, bool>> property,
+                RegularVertexGrid &grid);
+        void generatePropertyWeights(
+                std::pair<const std::string, std::pair<SplineCurve1D, bool>> &property,
                 RegularVertexGrid &grid);
 
         // auxiliary geometric functions: 
@@ -0,0 +1,61 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef NPY_WRITER_HPP
+#define NPY_WRITER_HPP
+
+#include <string>
+#include <vector>
+
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Writes arrays of reals to files in the NumPy .npy format.
+ *
+ * Files are written in version 1.0 of the format with a header padded to a 
+ * multiple of 64 bytes, followed by the raw data in C (row-major) order. The
+ * data type is the native byte order and precision of real, so that the data
+ * can be written directly from memory without conversion. Files can be read
+ * (and memory mapped) with numpy.load().
+ */
+class NpyWriter
+{
+    public:
+
+        // write array to file:
+        static void write(
+                const std::string &fileName,
+                const std::vector<real> &data,
+                const std::vector<size_t> &shape);
+
+        // header generation:
+        static std::string header(
+                const std::vector<size_t> &shape);
+        static std::string descr();
+};
+
+#endif
+
@@ -0,0 +1,66 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef NUMBER_FORMATTER_HPP
+#define NUMBER_FORMATTER_HPP
+
+#include <string>
+
+#include <gromacs/utility/real.h>
+
+#include "external/rapidjson/stringbuffer.h"
+
+
+/*!
+ * \brief Appends numbers in text form to a character buffer.
+ *
+ * Floating point numbers are formatted with the Grisu2 algorithm and integers
+ * with the digit lookup table used by rapidjson, which avoids the locale 
+ * handling of iostreams and is considerably faster for large text files such
+ * as Wavefront OBJ meshes. Floating point numbers are written in the shortest
+ * representation that round trips, truncated to a given number of decimal 
+ * places (with at least one decimal place, e.g. "1.0"). Numbers of very large 
+ * magnitude are written in exponential notation. NaN and infinite values are
+ * written as "nan" and "inf" respectively.
+ */
+class NumberFormatter
+{
+    public:
+
+        // formatting functions:
+        static void appendReal(
+                rapidjson::StringBuffer &buffer,
+                real value,
+                int decimalPlaces);
+        static void appendInt(
+                rapidjson::StringBuffer &buffer,
+                int value);
+        static void appendString(
+                rapidjson::StringBuffer &buffer,
+                const std::string &str);
+};
+
+#endif
+
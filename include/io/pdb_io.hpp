@@ -48,6 +48,9 @@ class PdbStructure
         // create PDB file from topology:
         void fromTopology(const gmx::TopologyInformation &top);
 
+        // create PDB file from structure file:
+        void fromFile(const std::string &fileName);
+
         // 
         void setPoreFacing(
                 const std::vector<SummaryStatistics> &poreLining,
@@ -0,0 +1,54 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef PLY_IO_HPP
+#define PLY_IO_HPP
+
+#include <string>
+
+#include "io/surface_mesh.hpp"
+
+
+/*!
+ * \brief Serialiser for writing a SurfaceMesh to a binary PLY file.
+ *
+ * The file is written in the binary little endian variant of the PLY format.
+ * Each vertex element carries its position (x, y, z), its normal (nx, ny, 
+ * nz), and one single precision float property per scalar property of the 
+ * mesh, named as the property. Faces are triangles given as lists of vertex
+ * indices.
+ */
+class PlyExporter
+{
+    public:
+
+        // interface for export:
+        void write(
+                const std::string &fileName,
+                const SurfaceMesh &mesh);
+};
+
+#endif
+
@@ -30,6 +30,10 @@
 #include "external/rapidjson/document.h"
 
 #include "analysis-setup/residue_information_provider.hpp"
+#include "statistics/autocorrelation_statistics.hpp"
+#include "statistics/block_average_statistics.hpp"
+#include "statistics/profile_quantile_statistics.hpp"
+#include "statistics/profile_summary_statistics.hpp"
 #include "statistics/summary_statistics.hpp"
 
 
@@ -47,11 +51,27 @@ class ResultsJsonExporter
         void addPathwaySummary(
                 std::string name,
                 const SummaryStatistics &summary);
+        void addPathwaySummary(
+                std::string name,
+                const SummaryStatistics &summary,
+                const BlockAverageStatistics &blockAvg,
+                const AutocorrelationStatistics &autocorr);
         void addSupportPoints(
                 const std::vector<real> &supportPoints);
         void addPathwayProfile(
                 std::string name,
                 const std::vector<SummaryStatistics> &profile);
+        void addPathwayProfile(
+                std::string name,
+                const ProfileSummaryStatistics &profile);
+        void addPathwayProfile(
+                std::string name,
+                const ProfileSummaryStatistics &profile,
+                const ProfileQuantileStatistics &quantiles);
+        void addPathwayProfileErrors(
+                std::string name,
+                const std::vector<BlockAverageStatistics> &blockAvg,
+                const std::vector<AutocorrelationStatistics> &autocorr);
         void addTimeStamps(
                 const std::vector<real> &timeStamps);
         void addPathwayScalarTimeSeries(
@@ -69,18 +89,31 @@ class ResultsJsonExporter
         void addResidueSummary(
                 std::string name,
                 const std::vector<SummaryStatistics> &resSummary);
+        void addConvergenceInformation(
+                bool converged,
+                int frame,
+                real time);
+        void addEnsembleInformation(
+                const std::vector<std::string> &replicas);
+        void addEnsembleProfile(
+                std::string name,
+                const std::vector<SummaryStatistics> &profile);
 
         // interface for writing to file:
         void write(std::string filename);
 
+        // helper function to create name suffix for a quantile:
+        static std::string quantileSuffix(real p);
+
+        // function for populating the reproducibility info with values:
+        static rapidjson::Value reproducibilityInformation(
+                rapidjson::Document::AllocatorType &alloc);
+
     private:
 
         // helper function to convert a string to a rapidjson value:
         inline rapidjson::Value toVal(const std::string &str);
 
-        // function for populating the reproducibility info with values:
-        rapidjson::Value reproducibilityInformation();
-
         // overall output document:
         rapidjson::Document doc_;
 };
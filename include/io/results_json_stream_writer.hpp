@@ -0,0 +1,220 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef RESULTS_JSON_STREAM_WRITER_HPP
+#define RESULTS_JSON_STREAM_WRITER_HPP
+
+#include <string>
+#include <vector>
+
+#include "external/rapidjson/document.h"
+#include "external/rapidjson/stringbuffer.h"
+#include "external/rapidjson/writer.h"
+
+#include "analysis-setup/residue_information_provider.hpp"
+#include "io/async_file_writer.hpp"
+#include "statistics/autocorrelation_statistics.hpp"
+#include "statistics/block_average_statistics.hpp"
+#include "statistics/profile_quantile_statistics.hpp"
+#include "statistics/profile_summary_statistics.hpp"
+#include "statistics/summary_statistics.hpp"
+
+
+/*!
+ * Enum for format in which time series are written.
+ */
+enum eTimeSeriesFormat {eTimeSeriesFormatJson, eTimeSeriesFormatNpy};
+
+
+/*!
+ * \brief Writes the results JSON file incrementally without building the 
+ * output document in memory.
+ *
+ * This class offers the same interface as ResultsJsonExporter and produces 
+ * byte-identical output, but serialises each piece of data directly to a 
+ * buffered file as soon as it is added. Large arrays such as the long-format
+ * profile time series are written one time step at a time, so that memory
+ * consumption does not grow with the size of the output file.
+ *
+ * As the output is streamed, data must be added in the order in which the 
+ * top level objects appear in the file, i.e. pathway summary, pathway 
+ * profile, scalar time series, profile time series, residue summary, 
+ * convergence information, and finally ensemble information. Objects to 
+ * which no data is added are written as empty objects, except for the 
+ * optional convergence and ensemble objects. Adding data to an object that has already been 
+ * completed results in a std::logic_error.
+ *
+ * If the time series format is set to eTimeSeriesFormatNpy, the scalar and 
+ * profile time series are not written to the JSON file, but to individual 
+ * NumPy .npy files next to it, which can be memory mapped when loading them.
+ * In this case, the JSON file only contains an object for each array with
+ * the file name relative to the JSON file, data type, and shape. Profile 
+ * time series are stored as matrices with one row per time step, with the
+ * time stamps and support points as separate one dimensional arrays.
+ */
+class ResultsJsonStreamWriter
+{
+    public:
+       
+        // constructor:
+        ResultsJsonStreamWriter();
+
+        // file handling:
+        void open(
+                const std::string &fileName,
+                eTimeSeriesFormat tsFormat = eTimeSeriesFormatJson);
+        void close();
+
+        // interface for adding to output:
+        void addPathwaySummary(
+                std::string name,
+                const SummaryStatistics &summary);
+        void addPathwaySummary(
+                std::string name,
+                const SummaryStatistics &summary,
+                const BlockAverageStatistics &blockAvg,
+                const AutocorrelationStatistics &autocorr);
+        void addSupportPoints(
+                const std::vector<real> &supportPoints);
+        void addPathwayProfile(
+                std::string name,
+                const std::vector<SummaryStatistics> &profile);
+        void addPathwayProfile(
+                std::string name,
+                const ProfileSummaryStatistics &profile);
+        void addPathwayProfile(
+                std::string name,
+                const ProfileSummaryStatistics &profile,
+                const ProfileQuantileStatistics &quantiles);
+        void addPathwayProfileErrors(
+                std::string name,
+                const std::vector<BlockAverageStatistics> &blockAvg,
+                const std::vector<AutocorrelationStatistics> &autocorr);
+        void addTimeStamps(
+                const std::vector<real> &timeStamps);
+        void addPathwayScalarTimeSeries(
+                std::string name,
+                const std::vector<real> &timeSeries);
+        void addPathwayGridPoints(
+                const std::vector<real> &timeStamps,
+                const std::vector<real> &supportPoints);
+        void addPathwayProfileTimeSeries(
+                std::string name,
+                const std::vector<std::vector<real>> &timeSeries);
+        void addPathwayProfileTimeSeries(
+                std::string name,
+                const std::vector<real> &timeSeries);
+        void addResidueInformation(
+                const std::vector<int> &resId,
+                const ResidueInformationProvider &resInf);
+        void addResidueSummary(
+                std::string name,
+                const std::vector<SummaryStatistics> &resSummary);
+        void addConvergenceInformation(
+                bool converged,
+                int frame,
+                real time);
+        void addEnsembleInformation(
+                const std::vector<std::string> &replicas);
+        void addEnsembleProfile(
+                std::string name,
+                const std::vector<SummaryStatistics> &profile);
+
+    private:
+
+        // top level objects in order of appearance in output:
+        enum Section
+        {
+            eSectionNone,
+            eSectionReproducibilityInformation,
+            eSectionPathwaySummary,
+            eSectionPathwayProfile,
+            eSectionPathwayScalarTimeSeries,
+            eSectionPathwayProfileTimeSeries,
+            eSectionResidueSummary,
+            eSectionConvergence,
+            eSectionEnsemble,
+            eSectionEnd
+        };
+
+        // output stream adaptor writing into the current file buffer:
+        class BufferStream
+        {
+            public:
+
+                typedef char Ch;
+
+                BufferStream() : buffer_(nullptr) {};
+                void reset(rapidjson::StringBuffer &buffer){buffer_ = &buffer;};
+                void Put(Ch c){buffer_->Put(c);};
+                void Flush(){};
+
+            private:
+
+                rapidjson::StringBuffer *buffer_;
+        };
+
+        // output file and serialisation:
+        AsyncFileWriter file_;
+        BufferStream stream_;
+        rapidjson::Writer<BufferStream> writer_;
+        Section section_;
+
+        // location of time series arrays:
+        eTimeSeriesFormat tsFormat_;
+        std::string arrayDirectory_;
+        std::string arrayBaseName_;
+
+        // sizes of previously written data used for sanity checks:
+        bool hasSupportPoints_;
+        size_t numSupportPoints_;
+        bool hasTimeStamps_;
+        size_t numTimeStamps_;
+        bool hasGridPoints_;
+        size_t numGridPoints_;
+        size_t numGridTimeStamps_;
+        size_t numGridSupportPoints_;
+        bool hasResidueInformation_;
+        size_t numResidues_;
+        bool hasEnsembleInformation_;
+
+        // auxiliary functions:
+        void enterSection(Section section);
+        void writeKey(const std::string &key);
+        void writeValue(const rapidjson::Value &value);
+        void writeReal(real value);
+        void writeRealArray(const std::vector<real> &values);
+        void writeArrayFile(
+                const std::string &name,
+                const std::vector<real> &values,
+                const std::vector<size_t> &shape);
+        void commit();
+        void checkWriter(bool success);
+        void checkProfileSize(size_t size);
+        static const char* sectionName(Section section);
+};
+
+#endif
+
@@ -42,6 +42,10 @@ class SplineCurve1DJsonConverter
         static SplineCurve1D fromJson(
                 rapidjson::Value &val,
                 unsigned int degree);
+        static SplineCurve1D fromUniqueKnots(
+                std::vector<real> knots,
+                const std::vector<real> &ctrlPoints,
+                unsigned int degree);
 
     private:
 
@@ -0,0 +1,81 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#ifndef SURFACE_MESH_HPP
+#define SURFACE_MESH_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Indexed triangle mesh with per-vertex scalar properties.
+ *
+ * All vertex attributes (position, normal, and any number of named scalar
+ * properties) share a single vertex index, so that each vertex is stored 
+ * exactly once irrespective of the number of properties mapped onto the 
+ * surface. Triangles are given as consecutive triples of zero-based vertex
+ * indices. This is the common input to the binary mesh exporters 
+ * (PlyExporter and GltfExporter).
+ */
+class SurfaceMesh
+{
+    public:
+
+        // constructor:
+        SurfaceMesh(std::string name);
+
+        // functions to add data:
+        void setVertices(
+                const std::vector<gmx::RVec> &positions,
+                const std::vector<gmx::RVec> &normals);
+        void setTriangles(
+                const std::vector<unsigned int> &indices);
+        void addProperty(
+                std::string name,
+                const std::vector<real> &values);
+
+        // functions to manipulate data:
+        void scale(real fac);
+
+        // functions to query data:
+        size_t numVertices() const;
+        size_t numTriangles() const;
+        bool valid() const;
+
+        // data:
+        std::string name_;
+        std::vector<gmx::RVec> positions_;
+        std::vector<gmx::RVec> normals_;
+        std::vector<unsigned int> indices_;
+        std::vector<std::pair<std::string, std::vector<real>>> properties_;
+};
+
+#endif
+
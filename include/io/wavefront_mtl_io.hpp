@@ -32,6 +32,8 @@
 #include <gromacs/math/vec.h>
 #include <gromacs/utility/real.h>
 
+#include "io/async_file_writer.hpp"
+
 
 /*!
  * \brief Representation of material in MTL format.
@@ -92,25 +94,33 @@ class WavefrontMtlObject
  * \brief Serialiser for material specification in Wavefront MTL format.
  *
  * This class serves to write the material specifications contained in a
- * WavefrontMtlObject to file.
+ * WavefrontMtlObject to file. As for WavefrontObjExporter, lines are 
+ * assembled in a buffer and numbers are formatted by NumberFormatter.
  */
 class WavefrontMtlExporter
 {
     public:
 
+        // constructor:
+        WavefrontMtlExporter();
+
+        // set number of decimal places for colour values:
+        void setPrecision(int decimalPlaces);
+
         // public interfacr for writing material definitions to file:
-        void write(std::string fileName, WavefrontMtlObject object);
+        void write(std::string fileName, const WavefrontMtlObject &object);
 
     private:
 
-        // file handle:
-        std::fstream file_;
+        // output parameters:
+        int decimalPlaces_;
+
+        // buffered file output:
+        AsyncFileWriter file_;
     
         // utilities for writing individual lines:
-        void writeMaterialName(std::string name);
-        void writeAmbientColour(const gmx::RVec &col);
-        void writeDiffuseColour(const gmx::RVec &col);
-        void writeSpecularColour(const gmx::RVec &col);
+        void writeMaterialName(const std::string &name);
+        void writeColour(const char *keyword, const gmx::RVec &col);
 };
 
 #endif
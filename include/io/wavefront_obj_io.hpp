@@ -35,6 +35,8 @@
 #include <gromacs/math/vec.h>
 #include <gromacs/utility/real.h>   
 
+#include "io/async_file_writer.hpp"
+
 
 /*!
  * \brief Abstract data type for faces in Wavefront OBJ objects.
@@ -142,18 +144,28 @@ class WavefrontObjObject
  *
  * Currently, only writing of comments, vertices and faces is supported. Faces
  * may be grouped together. Does not perform error checking.
+ *
+ * Lines are assembled in a large character buffer which is written to file in
+ * blocks by an AsyncFileWriter. Numbers are formatted by NumberFormatter with
+ * a configurable number of decimal places.
  */
 class WavefrontObjExporter
 {
     public:
 
+        // constructor:
+        WavefrontObjExporter();
+
+        // set number of decimal places for vertex coordinates:
+        void setPrecision(int decimalPlaces);
+
         // interface for export:
         void write(std::string fileName,
                    std::vector<gmx::RVec> vertices,
                    std::vector<std::vector<int>> faces);
 
         void write(std::string fileName,
-                   WavefrontObjObject object);
+                   const WavefrontObjObject &object);
 
 
     private:
@@ -161,17 +173,21 @@ class WavefrontObjExporter
         // internal temporaries:
         std::string crntMtlName_ = "";
 
-        // file handle:
-        std::fstream obj_;
+        // output parameters:
+        int decimalPlaces_;
+
+        // buffered file output:
+        AsyncFileWriter file_;
 
         // utilities for writing individual lines:
-        inline void writeComment(std::string comment);
-        inline void writeMaterialLibrary(std::string mtl);
-        inline void writeGroup(std::string group);
-        inline void writeObject(std::string object);
-        inline void writeVertex(std::pair<gmx::RVec, real> vertex);
-        inline void writeVertexNormal(gmx::RVec norm);
+        inline void writeComment(const std::string &comment);
+        inline void writeMaterialLibrary(const std::string &mtl);
+        inline void writeGroup(const std::string &group);
+        inline void writeObject(const std::string &object);
+        inline void writeVertex(const std::pair<gmx::RVec, real> &vertex);
+        inline void writeVertexNormal(const gmx::RVec &norm);
         inline void writeFace(const WavefrontObjFace &face);
+        inline void writeEmptyLine();
 };
 
 #endif
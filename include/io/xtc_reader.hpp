@@ -0,0 +1,106 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#ifndef XTC_READER_HPP
+#define XTC_READER_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gromacs/math/vectypes.h>
+#include <gromacs/utility/real.h>
+
+
+/*!
+ * \brief Reads frames of an XTC trajectory by index, optionally decoding 
+ * only the first atoms of each frame.
+ *
+ * On open(), the header of every frame is read to build an index of frame 
+ * offsets and time stamps, which allows seeking to arbitrary frames (e.g. 
+ * to the first frame after a given time) without decoding any coordinates.
+ *
+ * The compressed coordinates of an XTC frame can only be decoded 
+ * sequentially, but decoding can stop once the required number of atoms has
+ * been reached. readFrame() therefore accepts a maximum number of atoms, so 
+ * that an analysis that only needs e.g. the protein atoms at the start of a 
+ * large membrane system does not pay for decompressing lipids and solvent. 
+ * As atoms are encoded in runs, a few atoms beyond this limit may be 
+ * decoded as well, coordinates of all further atoms are left untouched.
+ *
+ * The decoder follows the reference implementation of the XTC compression 
+ * algorithm in the xdrfile library.
+ */
+class XtcReader
+{
+    public:
+
+        // file handling:
+        void open(
+                const std::string &fileName);
+        void close();
+
+        // frame index:
+        size_t numFrames() const;
+        int numAtoms() const;
+        real time(
+                size_t frame) const;
+
+        // decode a frame:
+        int readFrame(
+                size_t frame,
+                int maxAtoms,
+                std::int64_t &step,
+                real &time,
+                matrix box,
+                rvec *x);
+
+        // check file type:
+        static bool isXtcFile(
+                const std::string &fileName);
+
+
+    private:
+
+        // input file and frame index:
+        std::string fileName_;
+        std::ifstream file_;
+        int numAtoms_ = 0;
+        std::vector<std::streamoff> offsets_;
+        std::vector<real> times_;
+
+        // buffers reused between frames:
+        std::vector<unsigned char> header_;
+        std::vector<unsigned char> compressed_;
+
+        // auxiliary functions:
+        bool readBytes(
+                std::vector<unsigned char> &buffer,
+                size_t numBytes);
+};
+
+#endif
@@ -28,10 +28,10 @@
 #include <map>
 #include <string>
 
-#include <gtest/gtest.h>
-
 #include <gromacs/utility/real.h>
 
+#include "config/friend_test.hpp"
+
 #include "optim/optimisation.hpp"
 
 
@@ -28,12 +28,12 @@
 #include <map>
 #include <string>
 
-#include <gtest/gtest_prod.h>
-
 #include <gromacs/utility/real.h>
 #include <gromacs/random/threefry.h>
 #include <gromacs/random/uniformrealdistribution.h>
 
+#include "config/friend_test.hpp"
+
 #include "optim/optimisation.hpp"
 
 
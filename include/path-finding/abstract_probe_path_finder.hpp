@@ -25,6 +25,7 @@
 #ifndef ABSTRACT_PROBE_PATH_FINDER
 #define ABSTRACT_PROBE_PATH_FINDER
 
+#include <memory>
 #include <vector>
 
 #include <gromacs/trajectoryanalysis.h>
@@ -43,9 +44,10 @@ class AbstractProbePathFinder : public AbstractPathFinder
     public:
 
         // constructor:
-        AbstractProbePathFinder(std::map<std::string, real> params,
-                                gmx::RVec initProbePos,
-                                std::vector<real> vdwRadii);
+        AbstractProbePathFinder(
+                std::map<std::string, real> params,
+                gmx::RVec initProbePos,
+                std::shared_ptr<const std::vector<real>> vdwRadii);
 
 
     protected:
@@ -63,7 +65,8 @@ class AbstractProbePathFinder : public AbstractPathFinder
         real maxProbeRadius_;
         real nbhCutoff_;
 
-        std::vector<real> vdwRadii_;
+        // radii of pore atoms in order of selection positions:
+        std::shared_ptr<const std::vector<real>> vdwRadii_;
         real maxVdwRadius_;
 
         gmx::RVec initProbePos_;
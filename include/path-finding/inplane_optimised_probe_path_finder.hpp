@@ -26,6 +26,7 @@
 #define INPLANE_OPTIMISED_PROBE_PATH_FINDER_HPP
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -42,12 +43,13 @@ class InplaneOptimisedProbePathFinder : public AbstractProbePathFinder
     public:
 
         // constructor
-        InplaneOptimisedProbePathFinder(std::map<std::string, real> params,
-                                        gmx::RVec initProbePos,
-                                        gmx::RVec chanDirVec,
-                                        t_pbc *pbc,
-                                        gmx::AnalysisNeighborhoodPositions porePos,
-                                        std::vector<real> vdwRadii);
+        InplaneOptimisedProbePathFinder(
+                std::map<std::string, real> params,
+                gmx::RVec initProbePos,
+                gmx::RVec chanDirVec,
+                t_pbc *pbc,
+                gmx::AnalysisNeighborhoodPositions porePos,
+                std::shared_ptr<const std::vector<real>> vdwRadii);
 
         // interface for setting parameters:
         void setParameters(const PathFindingParameters &params);
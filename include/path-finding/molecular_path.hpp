@@ -91,12 +91,13 @@ class MolecularPath
                 std::vector<real> &poreRadii);
         MolecularPath(
                 const rapidjson::Document &doc);
-                /*
         MolecularPath(
-                std::vector<real> poreRadiusKnots,
-                std::vector<real> poreRadiusCtrlPoints,
-                std::vector<real> centreLineKnots,
-                std::vector<gmx::RVec> centreLineCtrlPoints);*/
+                const std::vector<gmx::RVec> &pathPoints,
+                const std::vector<real> &pathRadii,
+                const std::vector<real> &poreRadiusKnots,
+                const std::vector<real> &poreRadiusCtrlPoints,
+                const std::vector<real> &centreLineKnots,
+                const std::vector<gmx::RVec> &centreLineCtrlPoints);
         ~MolecularPath();
 
         // interface for mapping particles onto pathway:
@@ -184,6 +185,13 @@ class MolecularPath
         // mathematical constants:
         const real PI_ = std::acos(-1.0);
 
+        // utilities for constructors:
+        void initSplines(
+                std::vector<real> poreRadiusKnots,
+                const std::vector<real> &poreRadiusCtrlPoints,
+                std::vector<real> centreLineKnots,
+                const std::vector<gmx::RVec> &centreLineCtrlPoints);
+
         // utilities for sampling functions:
         inline real sampleArcLenStep(
                 size_t nPoints, 
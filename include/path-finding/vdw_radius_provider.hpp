@@ -25,13 +25,15 @@
 #ifndef VDW_RADIUS_PROVIDER_HPP
 #define VDW_RADIUS_PROVIDER_HPP
 
+#include <string>
 #include <unordered_map>
-
-#include <gtest/gtest.h>
+#include <vector>
 
 #include <gromacs/trajectoryanalysis/analysissettings.h>
 #include <gromacs/utility/arrayref.h>
 
+#include "config/friend_test.hpp"
+
 #include "external/rapidjson/document.h"
 
 
@@ -153,12 +155,20 @@ enum eVdwRadiusDatabase {eVdwRadiusDatabaseHoleAmberuni,
  * resort is to use default radius that can be set with setDefaultVdwRadius()
  * prior to calling vdwRadiiForTopology(). If not default radius has been set,
  * the lookup will throw an exception.
+ *
+ * To keep startup times low for large selections, exact atom name matches are
+ * looked up in a hash index keyed on atom and residue name, wildcard atom name
+ * candidates are computed once per distinct atom name, and the final radius is
+ * cached per distinct combination of atom name, residue name, and element. 
+ * The cost of vdwRadiiForTopology() thus scales with the number of distinct 
+ * atom types rather than with the number of atoms.
  */
 class VdwRadiusProvider
 {
     friend class VdwRadiusProviderTest;
     FRIEND_TEST(VdwRadiusProviderTest, VdwRadiusProviderJsonTest);
     FRIEND_TEST(VdwRadiusProviderTest, VdwRadiusProviderLookupTest);
+    FRIEND_TEST(VdwRadiusProviderTest, VdwRadiusProviderCacheTest);
 
     public:
 
@@ -175,7 +185,7 @@ class VdwRadiusProvider
         // public interface for obtaining vdwRadii for given topology:
         std::unordered_map<int, real> vdwRadiiForTopology(
             const gmx::TopologyInformation &top,
-            std::vector<int> mappedIds);
+            const std::vector<int> &mappedIds);
 
     private:
 
@@ -185,18 +195,36 @@ class VdwRadiusProvider
         // lookup table for vdW radii:
         std::vector<VdwRadiusRecord> vdwRadiusLookupTable_;
 
+        // index of lookup table by atom name and residue name:
+        std::unordered_map<std::string, 
+                           std::unordered_map<std::string, size_t>> 
+                atmNameIndex_;
+
+        // records partially matching a given atom name in table order:
+        std::unordered_map<std::string, std::vector<size_t>> 
+                partAtmNameIndex_;
+
+        // radii of previously looked up atom, residue, and element names:
+        std::unordered_map<std::string, real> vdwRadiusCache_;
+
         // function to perform sanity checks on lookup table:
         void validateLookupTable();
 
         // function for associating a vdW radius with an atom and residue name:
-        real vdwRadiusForAtom(std::string atmName, 
-                              std::string resName,
-                              std::string elemSym);
-        std::vector<VdwRadiusRecord> matchAtmName(std::string atmName);
-        std::vector<VdwRadiusRecord> matchPartAtmName(std::string atmName);
-        std::vector<VdwRadiusRecord>::const_iterator matchResName(
-            std::string resName,
-            const std::vector<VdwRadiusRecord> &records);
+        real vdwRadiusForAtom(const std::string &atmName, 
+                              const std::string &resName,
+                              const std::string &elemSym);
+        real lookupVdwRadius(const std::string &atmName, 
+                             const std::string &resName,
+                             std::string elemSym);
+        const VdwRadiusRecord* matchAtmName(
+            const std::string &atmName,
+            const std::string &resName);
+        const VdwRadiusRecord* matchPartAtmName(
+            const std::string &atmName,
+            const std::string &resName);
+        const std::vector<size_t>& partAtmNameMatches(
+            const std::string &atmName);
 
         // function to validate and return default radius:
         inline real returnDefaultRadius(std::string atmName, std::string resName);
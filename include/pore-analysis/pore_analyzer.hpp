@@ -0,0 +1,201 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#ifndef PORE_ANALYZER_HPP
+#define PORE_ANALYZER_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gromacs/math/vectypes.h>
+#include <gromacs/utility/real.h>
+
+#include "analysis-setup/residue_information_provider.hpp"
+#include "path-finding/abstract_path_finder.hpp"
+#include "path-finding/molecular_path.hpp"
+#include "statistics/abstract_density_estimator.hpp"
+#include "trajectory-analysis/frame_analysis_context.hpp"
+#include "trajectory-analysis/frame_analysis_stages.hpp"
+
+
+/*!
+ * \brief Results of analysing a single set of coordinates with a 
+ * PoreAnalyzer.
+ *
+ * Residue and solvent maps are keyed by the IDs under which residues and 
+ * solvent particles were passed to the PoreAnalyzer. Mapped coordinates are
+ * given as \f$ (s, \rho, \phi) \f$ relative to the centre line of the 
+ * pathway. Profiles that were not requested keep their default values.
+ */
+struct PoreAnalysisResult
+{
+    // permeation pathway:
+    gmx::RVec initProbePos_ = gmx::RVec(0.0, 0.0, 0.0);
+    std::unique_ptr<MolecularPath> molPath_;
+
+    // pore forming residues:
+    std::map<int, gmx::RVec> poreCogMappedCoords_;
+    std::map<int, gmx::RVec> poreCalMappedCoords_;
+    std::map<int, bool> poreLining_;
+    std::map<int, bool> poreFacing_;
+    HydrophobicityProfiles hydrophobicity_;
+
+    // solvent particles:
+    std::map<int, gmx::RVec> solventMappedCoords_;
+    std::map<int, bool> solvInsideSample_;
+    std::map<int, bool> solvInsidePore_;
+    int numSolvInsideSample_ = 0;
+    int numSolvInsidePore_ = 0;
+    SolventDensityProfile solventDensity_;
+};
+
+
+/*!
+ * \brief Runs the per-frame CHAP analysis on raw coordinate arrays.
+ *
+ * This is the entry point for using CHAP as a library, e.g. from other 
+ * analysis tools or from within an MD engine, without going through the 
+ * Gromacs trajectory analysis framework. Instead of selections, atoms are 
+ * identified by their index in the coordinate array passed to analyse():
+ *
+ *  - the pathway-lining atoms together with their van der Waals radii, 
+ *  - optionally the atoms whose centre of geometry is used as initial probe
+ *    position (defaults to the pathway-lining atoms),
+ *  - optionally the pore-forming residues, each given by its atoms and its
+ *    C-alpha atom, which are mapped onto the pathway to decide whether they
+ *    are pore-lining and pore-facing and from which the hydrophobicity 
+ *    profiles are estimated, and
+ *  - optionally solvent particles, each given by its atoms, which are mapped
+ *    onto the pathway and from which the solvent density is estimated.
+ *
+ * Positions of residues and solvent particles are the centre of geometry of
+ * their atoms, as with the res_cog position type used by the chap 
+ * executable. Parameters default to those of the chap executable and can be
+ * changed with the setter methods. The same analyser can be applied to any 
+ * number of coordinate sets with the same atom indices; only the density 
+ * estimator persists between calls.
+ */
+class PoreAnalyzer
+{
+    public:
+
+        // constructor:
+        PoreAnalyzer();
+
+        // atom indices:
+        void setPathwayAtoms(
+                const std::vector<int> &atomIndices,
+                const std::vector<real> &vdwRadii);
+        void setInitProbePosAtoms(
+                const std::vector<int> &atomIndices);
+        void setPoreResidues(
+                const std::map<int, std::vector<int>> &residueAtoms,
+                const std::map<int, int> &calphaAtoms);
+        void setSolventParticles(
+                const std::map<int, std::vector<int>> &particleAtoms);
+
+        // path finding parameters:
+        void setPathFindingMethod(
+                ePathFindingMethod method,
+                const std::map<std::string, real> &par,
+                const PathFindingParameters &params);
+        void setInitProbePos(
+                const gmx::RVec &initProbePos);
+        void setChanDirVec(
+                const gmx::RVec &chanDirVec);
+        void setPathAlignmentMethod(
+                ePathAlignmentMethod method);
+
+        // residue mapping and profile parameters:
+        void setPoreLiningMargin(
+                real margin);
+        void setHydrophobicity(
+                const ResidueInformationProvider &resInfo,
+                const DensityEstimationParameters &params,
+                real bandWidth);
+        void setDensityEstimation(
+                eDensityEstimator method,
+                const DensityEstimationParameters &params,
+                real bandWidth);
+
+        // analysis of a set of coordinates:
+        PoreAnalysisResult analyse(
+                const rvec *x,
+                int numAtoms,
+                const matrix box = nullptr);
+
+
+    private:
+
+        // atom indices:
+        std::vector<int> pathwayAtoms_;
+        std::shared_ptr<const std::vector<real>> vdwRadii_;
+        std::vector<int> ippAtoms_;
+        std::map<int, std::vector<int>> residueAtoms_;
+        std::map<int, int> calphaAtoms_;
+        std::map<int, std::vector<int>> solventAtoms_;
+
+        // path finding parameters:
+        ePathFindingMethod method_;
+        std::map<std::string, real> par_;
+        PathFindingParameters params_;
+        bool initProbePosIsSet_;
+        gmx::RVec initProbePos_;
+        gmx::RVec chanDirVec_;
+        ePathAlignmentMethod pathAlignmentMethod_;
+
+        // residue mapping and profiles:
+        real poreLiningMargin_;
+        ResidueInformationProvider resInfo_;
+        std::unique_ptr<HydrophobicityProfileStage> hydrophobicity_;
+        std::unique_ptr<SolventDensityStage> density_;
+
+        // auxiliary functions:
+        void findPath(
+                const rvec *x,
+                t_pbc *pbc,
+                FrameAnalysisContext &ctx) const;
+        void mapPoreResidues(
+                const rvec *x,
+                FrameAnalysisContext &ctx) const;
+        void mapSolvent(
+                const rvec *x,
+                FrameAnalysisContext &ctx) const;
+        static gmx::RVec centreOfGeometry(
+                const rvec *x,
+                const std::vector<int> &atomIndices);
+        static void checkAtomIndices(
+                const std::vector<int> &atomIndices,
+                int numAtoms);
+
+        // stages hold a reference to the residue information:
+        PoreAnalyzer(const PoreAnalyzer&) = delete;
+        PoreAnalyzer& operator=(const PoreAnalyzer&) = delete;
+};
+
+#endif
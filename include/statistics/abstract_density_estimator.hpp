@@ -115,6 +115,9 @@ class AbstractDensityEstimator
 {
     public:
 
+        // destructor:
+        virtual ~AbstractDensityEstimator() {}
+
         // density estimation interface:
         virtual SplineCurve1D estimate(
                 std::vector<real> &samples) = 0;
@@ -29,10 +29,10 @@
 #include <functional>
 #include <vector>
 
-#include <gtest/gtest.h>
-
 #include "gromacs/utility/real.h"
 
+#include "config/friend_test.hpp"
+
 #include "statistics/gaussian_density_derivative.hpp"
 
 
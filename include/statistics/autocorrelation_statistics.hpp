@@ -0,0 +1,113 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef AUTOCORRELATION_STATISTICS_HPP
+#define AUTOCORRELATION_STATISTICS_HPP
+
+#include <vector>
+
+#include "gromacs/utility/real.h"
+
+
+/*!
+ * \brief Estimates the autocorrelation function and integrated 
+ * autocorrelation time of a time series in an online fashion.
+ *
+ * This class keeps a ring buffer of the most recent maxLag() values and 
+ * accumulates the lagged products \f$ \sum_t x_t x_{t+l} \f$ for all lags 
+ * \f$ 1 \leq l \leq L \f$ together with the sums needed to subtract the 
+ * mean. Memory use is therefore proportional to the maximum lag and 
+ * independent of the length of the time series. To limit cancellation 
+ * errors, all values are shifted by the first value of the series and 
+ * accumulated in double precision.
+ *
+ * The integrated autocorrelation time is estimated as
+ *
+ * \f[
+ *      \tau = \frac{1}{2} + \sum_{l=1}^{W} \rho(l)
+ * \f]
+ *
+ * where the summation window \f$ W \f$ is chosen with the automatic 
+ * windowing procedure of Sokal (1997), i.e. as the smallest \f$ W \f$ for 
+ * which \f$ W \geq c \, \tau(W) \f$ with \f$ c = 5 \f$, and is otherwise 
+ * truncated at the first non-positive autocorrelation or at maxLag(). The 
+ * statistical inefficiency is \f$ g = 2 \tau \f$ and the standard error of 
+ * the mean is \f$ \sqrt{g \sigma^2 / N} \f$.
+ *
+ * Non-finite values are skipped.
+ */
+class AutocorrelationStatistics
+{
+    public:
+
+        // constructor:
+        explicit AutocorrelationStatistics(
+                const size_t maxLag = 100);
+
+        // updating method:
+        void update(
+                const real newValue);
+        static void updateMultiple(
+                std::vector<AutocorrelationStatistics> &stat,
+                const std::vector<real> &newValues);
+
+        // getter methods:
+        int num() const;
+        size_t maxLag() const;
+        real mean() const;
+        real autocorrelation(
+                const size_t lag) const;
+        real integratedAutocorrelationTime() const;
+        real statisticalInefficiency() const;
+        real standardError() const;
+
+    private:
+
+        // maximum lag:
+        size_t maxLag_;
+
+        // shift applied to all values:
+        double offset_;
+
+        // number of values and their sums:
+        size_t num_;
+        double sum_;
+        double sumSq_;
+
+        // lagged products and leading/trailing partial sums:
+        std::vector<double> lagProdSum_;
+        std::vector<double> headSum_;
+        std::vector<double> tailSum_;
+
+        // ring buffer of most recent values:
+        std::vector<double> recent_;
+        size_t recentPos_;
+
+        // internal auxiliary functions:
+        double autocovariance(
+                const size_t lag) const;
+};
+
+#endif
+
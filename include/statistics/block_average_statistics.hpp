@@ -0,0 +1,102 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef BLOCK_AVERAGE_STATISTICS_HPP
+#define BLOCK_AVERAGE_STATISTICS_HPP
+
+#include <vector>
+
+#include "gromacs/utility/real.h"
+
+#include "statistics/summary_statistics.hpp"
+
+
+/*!
+ * \brief Estimates the standard error of the mean of a correlated time 
+ * series by block averaging without having to store the time series.
+ *
+ * Successive frames of a molecular dynamics trajectory are generally not 
+ * independent, so the naive standard error \f$ \sigma / \sqrt{N} \f$ 
+ * underestimates the true uncertainty of the mean. This class implements the
+ * blocking method of Flyvbjerg and Petersen (1989) in an online fashion. On 
+ * level \f$ k \f$ the time series is divided into blocks of \f$ 2^k \f$ 
+ * consecutive values and a SummaryStatistics object accumulates the block 
+ * means. Each level only needs to hold the mean of its currently incomplete
+ * block, so memory use grows with \f$ \log_2 N \f$ only.
+ *
+ * Once the block size exceeds the correlation time, the block means become
+ * independent and the standard error estimated from them reaches a plateau.
+ * The standardError() is taken as the largest estimate over all levels with
+ * at least minNumBlocks() complete blocks, which is a conservative estimate 
+ * of the plateau value. The statistical inefficiency is the ratio of the 
+ * variance of the mean to the naive estimate \f$ \sigma^2 / N \f$, i.e. the
+ * number of frames per effectively independent sample.
+ *
+ * Non-finite values are skipped.
+ */
+class BlockAverageStatistics
+{
+    public:
+
+        // constructor:
+        BlockAverageStatistics();
+
+        // updating method:
+        void update(
+                const real newValue);
+        static void updateMultiple(
+                std::vector<BlockAverageStatistics> &stat,
+                const std::vector<real> &newValues);
+
+        // setter methods:
+        void setMinNumBlocks(
+                const int minNumBlocks);
+
+        // getter methods:
+        int num() const;
+        real mean() const;
+        real standardError() const;
+        real statisticalInefficiency() const;
+        int minNumBlocks() const;
+        size_t numLevels() const;
+        int blockSize(
+                const size_t level) const;
+        real blockStandardError(
+                const size_t level) const;
+
+    private:
+
+        // minimum number of blocks for a level to be considered reliable:
+        int minNumBlocks_;
+
+        // statistics of block means on each level:
+        std::vector<SummaryStatistics> levels_;
+
+        // mean of incomplete block on each level:
+        std::vector<real> pending_;
+        std::vector<bool> hasPending_;
+};
+
+#endif
+
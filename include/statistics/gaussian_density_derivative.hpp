@@ -27,10 +27,10 @@
 
 #include <vector>
 
-#include <gtest/gtest.h>
-
 #include <gromacs/utility/real.h>
 
+#include "config/friend_test.hpp"
+
 
 /*!
  * \brief Calculates derivative of Gaussian kernel density for a given sample.
@@ -25,12 +25,13 @@
 #ifndef HISTOGRAM_DENSITY_ESTIMATOR_HPP
 #define HISTOGRAM_DENSITY_ESTIMATOR_HPP
 
+#include <cstddef>
 #include <vector>
 
-#include <gtest/gtest.h>
-
 #include "gromacs/utility/real.h"
 
+#include "config/friend_test.hpp"
+
 #include "statistics/abstract_density_estimator.hpp"
 
 
@@ -45,6 +46,24 @@
  * LinearSplineInterp1D and the result is returned as a SplineCurve1D object.
  * Linear rather than higher order interpolation is used to avoid artifacts
  * where the interpolation method introduces locally negative densities.
+ *
+ * Because all bins have the same width, the bin index of each sample is 
+ * computed directly rather than by searching the sorted sample, so that the
+ * input data does not need to be sorted. Break points and midpoints are 
+ * cached and reused across calls to estimate() as long as the data range
+ * does not require a different set of breaks. The lowest break point is a 
+ * multiple of the bin width, so that samples with similar ranges share the 
+ * same breaks. For large samples, binning can
+ * be distributed over several threads (see setNumThreads()), each of which
+ * fills a private array of counts that are summed up afterwards.
+ *
+ * In addition, accumulate() can be used to build up a single histogram over
+ * many frames of a trajectory. The accumulated histogram lives on a grid of
+ * break points at integer multiples of the bin width, which grows as needed 
+ * to cover the data, and can be converted into a density with 
+ * accumulatedDensity(). Histograms accumulated by different estimators 
+ * (e.g. over different parts of a trajectory) can be combined exactly with 
+ * mergeAccumulated() or addAccumulated().
  */
 class HistogramDensityEstimator : public AbstractDensityEstimator
 {
@@ -57,6 +76,14 @@ class HistogramDensityEstimator : public AbstractDensityEstimator
                 HistogramDensityEstimatorDensityTest);
     FRIEND_TEST(HistogramDensityEstimatorTest,
                 HistogramDensityEstimatorEstimateTest);
+    FRIEND_TEST(HistogramDensityEstimatorTest,
+                HistogramDensityEstimatorParallelTest);
+    FRIEND_TEST(HistogramDensityEstimatorTest,
+                HistogramDensityEstimatorBreaksReuseTest);
+    FRIEND_TEST(HistogramDensityEstimatorTest,
+                HistogramDensityEstimatorAccumulateTest);
+    FRIEND_TEST(HistogramDensityEstimatorTest,
+                HistogramDensityEstimatorBreaksSnapTest);
 
     public:
        
@@ -71,20 +98,75 @@ class HistogramDensityEstimator : public AbstractDensityEstimator
         virtual void setParameters(
                 const DensityEstimationParameters &params);
         void setBinWidth(real binWidth);
+        void setNumThreads(size_t numThreads);
+
+        // getter methods for parameters:
+        real binWidth() const;
+
+        // trajectory-wide histogram:
+        void accumulate(
+                const std::vector<real> &samples);
+        void addAccumulated(
+                long firstBreak,
+                const std::vector<size_t> &counts);
+        void mergeAccumulated(
+                const HistogramDensityEstimator &other);
+        SplineCurve1D accumulatedDensity() const;
+        std::vector<real> accumulatedBreaks() const;
+        long accumulatedFirstBreak() const;
+        std::vector<size_t> accumulatedCounts() const;
+        size_t numAccumulatedSamples() const;
+        void resetAccumulated();
 
     private:
 
         // internal parameters:
         real binWidth_;
+        size_t numThreads_;
+        size_t minSamplesPerThread_;
+
+        // breaks and midpoints cached between calls to estimate():
+        std::vector<real> breaks_;
+        std::vector<real> midpoints_;
+
+        // trajectory-wide histogram:
+        long accumFirstBreak_;
+        std::vector<real> accumBreaks_;
+        std::vector<size_t> accumCounts_;
+        size_t accumNumSamples_;
 
         // auxiliary functions:
+        void extendAccumulated(
+                long firstBreak,
+                long lastBreak);
         std::vector<real> createBreaks(
-                const std::vector<real> &samples);
+                const std::vector<real> &samples) const;
+        std::vector<real> createBreaks(
+                real rangeLo,
+                real rangeHi) const;
+        real lowestBreak(
+                real rangeLo) const;
+        bool breaksCoverRange(
+                real rangeLo,
+                real rangeHi) const;
         std::vector<real> createMidpoints(
-                const std::vector<real> &breaks);
+                const std::vector<real> &breaks) const;
         std::vector<real> calculateDensity(
                 const std::vector<real> &samples,
                 const std::vector<real> &breaks);
+        std::vector<size_t> countSamples(
+                const std::vector<real> &samples,
+                const std::vector<real> &breaks) const;
+        void countSamplesRange(
+                const std::vector<real> &samples,
+                const std::vector<real> &breaks,
+                size_t begin,
+                size_t end,
+                std::vector<size_t> &counts) const;
+        void sampleRange(
+                const std::vector<real> &samples,
+                real &rangeLo,
+                real &rangeHi) const;
     
 };
 
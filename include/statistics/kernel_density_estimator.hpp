@@ -27,10 +27,10 @@
 
 #include <vector>
 
-#include <gtest/gtest.h>
-
 #include "gromacs/utility/real.h"
 
+#include "config/friend_test.hpp"
+
 #include "geometry/spline_curve_1D.hpp"
 #include "statistics/abstract_density_estimator.hpp"
 #include "statistics/kernel_function.hpp"
@@ -0,0 +1,102 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef P2_QUANTILE_ESTIMATOR_HPP
+#define P2_QUANTILE_ESTIMATOR_HPP
+
+#include <array>
+
+#include "gromacs/utility/real.h"
+
+
+/*!
+ * \brief Estimates a quantile of a scalar variable without having to hold an
+ * entire dataset in memory.
+ *
+ * This class implements the \f$ P^2 \f$ algorithm of Jain and Chlamtac (1985),
+ * which tracks five markers whose heights approximate the minimum, the 
+ * \f$ p/2 \f$, \f$ p \f$, and \f$ (1+p)/2 \f$ quantiles, and the maximum of
+ * all values passed to update(). Marker heights are adjusted with a piecewise
+ * parabolic prediction whenever a marker's position deviates from its desired
+ * position by more than one. Memory use and the cost of each update are 
+ * therefore constant and independent of the number of samples.
+ *
+ * For less than five samples the exact sample quantile (linear interpolation
+ * between order statistics) is returned. Beyond that the estimate is 
+ * approximate. There is no strict worst case bound on the error, but for 
+ * smooth, unimodal distributions as typically encountered for fluctuations of
+ * pore radius or solvent density, the error is of the same order as the 
+ * sampling error of the exact sample quantile and falls well below one 
+ * percent of the interquantile range after a few hundred samples. Strongly
+ * multimodal distributions may yield larger errors.
+ *
+ * As in SummaryStatistics, infinite values (and NaN) are skipped. Note that 
+ * unlike SummaryStatistics, partial estimates can not be merged exactly.
+ */
+class P2QuantileEstimator
+{
+    public:
+
+        // constructor:
+        explicit P2QuantileEstimator(
+                const real p);
+
+        // updating method:
+        void update(
+                const real newValue);
+
+        // manipulation methods:
+        void shift(
+                const real shift);
+
+        // getter methods:
+        real quantile() const;
+        real p() const;
+        int num() const;
+
+    private:
+
+        // probability of quantile to estimate:
+        real p_;
+
+        // number of samples so far:
+        int num_;
+
+        // marker heights, actual positions, desired positions and increments:
+        std::array<real, 5> height_;
+        std::array<int, 5> pos_;
+        std::array<real, 5> desiredPos_;
+        std::array<real, 5> desiredPosIncrement_;
+
+        // internal auxiliary functions:
+        inline real parabolic(
+                const int i, 
+                const int d) const;
+        inline real linear(
+                const int i, 
+                const int d) const;
+};
+
+#endif
+
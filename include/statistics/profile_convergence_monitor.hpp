@@ -0,0 +1,100 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef PROFILE_CONVERGENCE_MONITOR_HPP
+#define PROFILE_CONVERGENCE_MONITOR_HPP
+
+#include <vector>
+
+#include "gromacs/utility/real.h"
+
+#include "statistics/block_average_statistics.hpp"
+#include "statistics/profile_summary_statistics.hpp"
+
+
+/*!
+ * \brief Monitors the convergence of the running mean of a profile over 
+ * successive trajectory frames.
+ *
+ * Each call to update() adds a profile sampled at a fixed set of support 
+ * points to a ProfileSummaryStatistics object and to one 
+ * BlockAverageStatistics object per support point. Every checkInterval() 
+ * profiles, the running mean is compared to the running mean at the previous
+ * check. The profile is considered converged once, at every support point 
+ * with at least two samples, both the change of the mean since the last check
+ * and the block averaging estimate of its standard error are below the given
+ * tolerance. Because the standard error accounts for the statistical 
+ * inefficiency of the time series, correlated frames do not lead to premature
+ * convergence.
+ *
+ * Values whose magnitude is at least the largest representable real number
+ * (as produced e.g. by BoltzmannEnergyCalculator for zero density) are 
+ * treated as infinite and skipped.
+ */
+class ProfileConvergenceMonitor
+{
+    public:
+
+        // constructors:
+        ProfileConvergenceMonitor();
+        ProfileConvergenceMonitor(
+                const size_t numPoints,
+                const real tolerance,
+                const int checkInterval);
+
+        // updating method:
+        bool update(
+                const std::vector<real> &profile);
+
+        // getter methods:
+        bool converged() const;
+        int num() const;
+        int checkInterval() const;
+        real tolerance() const;
+        real maxMeanChange() const;
+        real maxStandardError() const;
+
+    private:
+
+        // parameters:
+        real tolerance_;
+        int checkInterval_;
+
+        // number of profiles seen and convergence state:
+        int num_;
+        bool converged_;
+        real maxMeanChange_;
+        real maxStandardError_;
+
+        // accumulators:
+        ProfileSummaryStatistics summary_;
+        std::vector<BlockAverageStatistics> blockAvg_;
+        std::vector<real> prevMean_;
+
+        // internal auxiliary functions:
+        void check();
+};
+
+#endif
+
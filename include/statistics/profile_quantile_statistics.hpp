@@ -0,0 +1,81 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef PROFILE_QUANTILE_STATISTICS_HPP
+#define PROFILE_QUANTILE_STATISTICS_HPP
+
+#include <vector>
+
+#include "gromacs/utility/real.h"
+
+#include "statistics/p2_quantile_estimator.hpp"
+
+
+/*!
+ * \brief Streaming estimates of several quantiles of a profile at each of a 
+ * fixed set of support points.
+ *
+ * This class complements ProfileSummaryStatistics and maintains one 
+ * P2QuantileEstimator per support point and requested probability. Memory
+ * use is proportional to the number of support points times the number of
+ * probabilities and independent of the number of profiles passed to 
+ * update(). See P2QuantileEstimator for a discussion of the accuracy of the
+ * estimates.
+ */
+class ProfileQuantileStatistics
+{
+    public:
+
+        // constructors:
+        ProfileQuantileStatistics();
+        ProfileQuantileStatistics(
+                const size_t numPoints,
+                const std::vector<real> &probs);
+
+        // updating method:
+        void update(
+                const std::vector<real> &newValues);
+
+        // manipulation methods:
+        void shift(
+                const real shift);
+
+        // getter methods:
+        size_t size() const;
+        std::vector<real> probs() const;
+        std::vector<real> quantile(
+                const size_t probIdx) const;
+
+    private:
+
+        // probabilities of quantiles to estimate:
+        std::vector<real> probs_;
+
+        // estimators laid out with support points as inner index:
+        size_t numPoints_;
+        std::vector<P2QuantileEstimator> estimators_;
+};
+
+#endif
+
@@ -0,0 +1,104 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef PROFILE_SUMMARY_STATISTICS_HPP
+#define PROFILE_SUMMARY_STATISTICS_HPP
+
+#include <vector>
+
+#include "gromacs/utility/real.h"
+
+#include "statistics/summary_statistics.hpp"
+
+
+/*!
+ * \brief Collects summary statistics of a profile, i.e. of a vector-valued 
+ * variable sampled at a fixed set of support points.
+ *
+ * This class is the structure-of-arrays counterpart to a 
+ * std::vector<SummaryStatistics>. Minimum, maximum, mean, sum of squared 
+ * differences from the mean, and number of samples are each stored in a 
+ * contiguous array with one element per support point. The update() method 
+ * processes an entire profile in a single loop over these arrays, which avoids
+ * the per-point function call overhead of SummaryStatistics::updateMultiple()
+ * and allows the compiler to vectorise the update.
+ *
+ * Semantics are identical to SummaryStatistics, i.e. infinite values are 
+ * skipped and the getter functions never return infinity. Individual support
+ * points can be extracted as SummaryStatistics objects using at() and a 
+ * profile can be reconstructed from these. Two profiles accumulated over 
+ * disjoint sets of frames can be combined exactly with merge().
+ */
+class ProfileSummaryStatistics
+{
+    public:
+
+        // constructors:
+        ProfileSummaryStatistics();
+        explicit ProfileSummaryStatistics(
+                const size_t numPoints);
+        explicit ProfileSummaryStatistics(
+                const std::vector<SummaryStatistics> &stats);
+
+        // updating method:
+        void update(
+                const std::vector<real> &newValues);
+
+        // combining partial statistics:
+        void merge(
+                const ProfileSummaryStatistics &other);
+
+        // manipulation methods:
+        void shift(
+                const real shift);
+
+        // getter methods for individual support points:
+        size_t size() const;
+        SummaryStatistics at(
+                const size_t idx) const;
+        real min(const size_t idx) const;
+        real max(const size_t idx) const;
+        real mean(const size_t idx) const;
+        real var(const size_t idx) const;
+        real sd(const size_t idx) const;
+        int num(const size_t idx) const;
+
+        // getter methods for entire profile:
+        std::vector<real> min() const;
+        std::vector<real> max() const;
+        std::vector<real> mean() const;
+        std::vector<real> sd() const;
+
+    private:
+
+        // summary statistics at each support point:
+        std::vector<real> min_;
+        std::vector<real> max_;
+        std::vector<real> mean_;
+        std::vector<real> sumSquaredMeanDiff_;
+        std::vector<int> num_;
+};
+
+#endif
+
@@ -53,6 +53,12 @@
  * the update() method, all returned statistics are capped at the minimum and 
  * maximum real number, i.e. no infinity is ever returned to allow 
  * compatibility with JSON.
+ *
+ * Two SummaryStatistics objects that have been updated with disjoint parts of
+ * a dataset can be combined with merge(), which yields the same result as if
+ * all values had been passed to a single object. This uses the pairwise
+ * update formula of Chan et al. (1979) and allows e.g. partial statistics 
+ * computed by different threads or jobs to be aggregated exactly.
  */
 class SummaryStatistics
 {
@@ -60,6 +66,12 @@ class SummaryStatistics
 
         // constructor and destructor:
         SummaryStatistics();        
+        SummaryStatistics(
+                const real min,
+                const real max,
+                const real mean,
+                const real sumSquaredMeanDiff,
+                const int num);
 
         // getter methods:
         real min() const;
@@ -68,6 +80,7 @@ class SummaryStatistics
         real var() const;
         real sd() const;
         int num() const;
+        real sumSquaredMeanDiff() const;
 
         // updating method:
         void update(
@@ -76,6 +89,10 @@ class SummaryStatistics
                 std::vector<SummaryStatistics> &stat,
                 const std::vector<real> &newValues);
 
+        // combining partial statistics:
+        void merge(
+                const SummaryStatistics &other);
+
         // manipulation methods:
         void shift(
                 const real shift);
@@ -0,0 +1,90 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#ifndef ABSTRACT_FRAME_ANALYSIS_STAGE_HPP
+#define ABSTRACT_FRAME_ANALYSIS_STAGE_HPP
+
+#include <string>
+
+#include "trajectory-analysis/frame_analysis_context.hpp"
+
+
+/*!
+ * \brief Abstract base class for a single step of the per-frame analysis.
+ *
+ * A stage declares which groups of data in the FrameAnalysisContext it reads
+ * (inputs) and which it fills in (outputs), so that a FrameAnalysisPipeline 
+ * can order stages and run independent stages concurrently. Each frame, the
+ * pipeline calls the following hooks:
+ *
+ *  - prepare() is always called serially and should be used for anything 
+ *    that is not safe to do concurrently with other stages (such as 
+ *    evaluating selections).
+ *  - evaluate() does the actual work and may run concurrently with other 
+ *    stages that do not depend on this stage's outputs. It may only modify 
+ *    the context members belonging to the declared outputs.
+ *  - skip() is called instead of evaluate() if the stage has been disabled. It
+ *    should fill the outputs with cheap neutral values so that downstream 
+ *    stages and the output file keep their structure.
+ *  - write() is always called serially after evaluate() or skip() and is used
+ *    to add results to the analysis data handle.
+ */
+class AbstractFrameAnalysisStage
+{
+    public:
+
+        // constructor and destructor:
+        AbstractFrameAnalysisStage(
+                std::string name, 
+                unsigned int inputs, 
+                unsigned int outputs);
+        virtual ~AbstractFrameAnalysisStage(){};
+
+        // stage properties:
+        std::string name() const;
+        unsigned int inputs() const;
+        unsigned int outputs() const;
+
+        // enable or disable stage:
+        void setEnabled(bool enabled);
+        bool isEnabled() const;
+
+        // hooks called by pipeline:
+        virtual void prepare(FrameAnalysisContext &ctx);
+        virtual void evaluate(FrameAnalysisContext &ctx) = 0;
+        virtual void skip(FrameAnalysisContext &ctx);
+        virtual void write(FrameAnalysisContext &ctx);
+
+    private:
+
+        std::string name_;
+        unsigned int inputs_;
+        unsigned int outputs_;
+        bool enabled_;
+};
+
+#endif
+
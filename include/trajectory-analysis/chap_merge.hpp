@@ -0,0 +1,82 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef CHAP_MERGE_HPP
+#define CHAP_MERGE_HPP
+
+#include <string>
+#include <vector>
+
+#include <gromacs/commandline/cmdlineoptionsmodule.h>
+#include <gromacs/options/ioptionscontainer.h>
+
+
+/*!
+ * \brief Command line module implementing 'chap merge'.
+ *
+ * Combines shard files written by runs over consecutive time windows of a 
+ * trajectory with -out-shard into the same JSON, PDB, and OBJ output that a 
+ * single run over the whole trajectory would produce. Shards may be given in
+ * any order, but their time windows must not overlap. All shards must sample
+ * profiles at the same support points, i.e. they must have been created with
+ * the same -out-profile-range, -out-extrap-dist, and -out-num-points.
+ *
+ * Files referenced by a shard, such as the PDB file written alongside it, 
+ * are stored relative to the directory of the shard file, so that shards can
+ * be merged from any working directory.
+ */
+class ChapMerge : public gmx::ICommandLineOptionsModule
+{
+    public:
+
+        // factory method for use with runAsMain():
+        static gmx::ICommandLineOptionsModulePointer create();
+
+        // methods from libgromacs base class:
+        virtual void init(gmx::CommandLineModuleSettings *settings);
+        virtual void initOptions(
+                gmx::IOptionsContainer *options,
+                gmx::ICommandLineOptionsModuleSettings *settings);
+        virtual void optionsFinished();
+        virtual int run();
+
+        // file names stored in shard files:
+        static std::string shardRelativePath(
+                const std::string &path);
+        static std::string resolveShardPath(
+                const std::string &shardFileName,
+                const std::string &path);
+
+
+    private:
+
+        // input and output files:
+        std::vector<std::string> shardFileNames_;
+        std::string outputBaseFileName_;
+        std::string pdbFileName_;
+        bool pdbFileNameIsSet_;
+};
+
+#endif
+
@@ -25,16 +25,23 @@
 #ifndef TRAJECTORYANALYSIS_HPP
 #define TRAJECTORYANALYSIS_HPP
 
+#include <future>
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include <gromacs/trajectoryanalysis.h>
 
+#include "aggregation/frame_aggregate.hpp"
+
 #include "analysis-setup/residue_information_provider.hpp"
 
+#include "io/gltf_io.hpp"
+#include "io/molecular_path_obj_exporter.hpp"
 #include "io/pdb_io.hpp"
+#include "io/results_json_stream_writer.hpp"
 
 #include "path-finding/abstract_path_finder.hpp"
 #include "path-finding/molecular_path.hpp"
@@ -42,6 +49,10 @@
 
 #include "statistics/abstract_density_estimator.hpp"
 
+#include "trajectory-analysis/frame_analysis_pipeline.hpp"
+#include "trajectory-analysis/frame_analysis_stages.hpp"
+#include "trajectory-analysis/replica_trajectory_analysis.hpp"
+
 using namespace gmx;
 
 
@@ -76,19 +87,78 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
 
     private:
 
-        // find file path for index files:
+        // find file path for index and trajectory files:
         virtual void obtainNdxFilePathInfo();   
+        void obtainTrajectoryFilePathInfo();
         std::string customNdxFileName_;
 
         
         // check input parameter validity:
         virtual void checkParameters();
 
+        // assemble per-frame analysis stages:
+        void initFramePipeline(
+                FrameAnalysisPipeline &pipeline,
+                const FrameSelections &selections,
+                bool primary);
+
+        // parameters for density and hydrophobicity estimation:
+        DensityEstimationParameters densityEstimationParameters(
+                eDensityEstimator method,
+                real bandWidth) const;
+        DensityEstimationParameters hydrophobicityKernelParameters(
+                real bandWidth) const;
+
+        // aggregate stream files into time-averaged results:
+        void aggregateFrameStream(
+                const std::vector<std::string> &inFileNames,
+                const std::vector<int> &numFrames,
+                const std::string &dataSetSuffix,
+                bool reestimateDensity);
+        FrameAggregate readFrameStream(
+                const std::string &inFileName,
+                const std::string &dataSetSuffix,
+                const std::vector<real> &supportPoints,
+                real anchorPointLo,
+                real anchorPointHi,
+                bool reestimateDensity,
+                int numFrames);
+        void writeAggregate(
+                const std::string &outBaseFileName,
+                const FrameAggregate &aggregate,
+                const std::vector<FrameAggregate> &replicas,
+                const std::vector<std::string> &replicaFileNames);
+        void writeShard(
+                const std::string &fileName,
+                const FrameAggregate &aggregate) const;
+
         
         // names of output files:
         std::string outputBaseFileName_;
         std::string outputJsonFileName_;
         std::string outputPdbFileName_;
+        std::string inputStreamFileName_;
+        bool inputStreamFileNameIsSet_;
+
+
+        // main trajectory, optionally analysed outside the runner:
+        std::string trajectoryFileName_;
+        bool readTrajectoryDirectly_;
+        std::unique_ptr<ReplicaTrajectoryAnalysis> mainTrajectory_;
+        std::future<int> mainTrajectoryRun_;
+
+        // replica trajectories analysed alongside the main trajectory:
+        std::vector<std::string> replicaFileNames_;
+        int readAhead_;
+        bool readAheadIsSet_;
+        std::vector<std::unique_ptr<ReplicaTrajectoryAnalysis>> replicas_;
+        std::vector<std::future<int>> replicaRuns_;
+
+        // time range set with -b, -e, and -dt:
+        real beginTime_;
+        real endTime_;
+        bool endTimeIsSet_;
+        real deltaTime_;
 
         
         // user specified selections:
@@ -126,10 +196,18 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
         // output parameters:
         int outputNumPoints_;        
         real outputExtrapDist_;
+        std::vector<real> outputProfileRange_;
+        bool outputProfileRangeIsSet_;
+        bool outputShard_;
         real outputGridSampleDist_;
         real outputCorrectionThreshold_;
+        int outputObjPrecision_;
+        eMeshFormat outputMeshFormat_;
+        int outputMeshStride_;
         bool outputDetailed_;
+        eTimeSeriesFormat outputTsFormat_;
         PdbStructure outputStructure_;
+        GltfSequenceExporter meshSequence_;
 
 
         // path finding:
@@ -173,11 +251,17 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
         
         // density estimation parameters:
         eDensityEstimator deMethod_;
+        bool deMethodIsSet_;
         DensityEstimationParameters deParams_;
         real deResolution_;
+        bool deResolutionIsSet_;
         real deBandWidth_;
+        bool deBandWidthIsSet_;
         real deBandWidthScale_;
+        bool deBandWidthScaleIsSet_;
         real deEvalRangeCutoff_;
+        bool deEvalRangeCutoffIsSet_;
+        bool deAccumulate_;
 
 
         // hydrophobicity profile parameters:
@@ -185,6 +269,27 @@ class ChapTrajectoryAnalysis : public TrajectoryAnalysisModule
         real hpEvalRangeCutoff_;
         real hpResolution_;
         DensityEstimationParameters hydrophobKernelParams_;
+
+
+        // parameter sweep:
+        std::vector<eDensityEstimator> sweepDeMethod_;
+        std::vector<real> sweepDeBandWidth_;
+        std::vector<real> sweepHpBandWidth_;
+        size_t numSweepSets_;
+
+
+        // convergence monitoring:
+        int convCheckInterval_;
+        real convTolRadius_;
+        real convTolEnergy_;
+        int convergedFrame_;
+        real convergedTime_;
+
+
+        // per-frame analysis stages:
+        std::vector<eFrameAnalysisSkip> skipStages_;
+        bool concurrentStages_;
+        FrameAnalysisPipeline framePipeline_;
         
         
         // molecular pathway for first frame:
@@ -0,0 +1,132 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#ifndef FRAME_ANALYSIS_CONTEXT_HPP
+#define FRAME_ANALYSIS_CONTEXT_HPP
+
+#include <map>
+#include <memory>
+#include <utility>
+
+#include <gromacs/trajectoryanalysis.h>
+
+#include "geometry/spline_curve_1D.hpp"
+#include "path-finding/molecular_path.hpp"
+
+
+/*!
+ * \brief Flags identifying the data produced and consumed by the stages of a
+ * FrameAnalysisPipeline.
+ *
+ * Each flag refers to a group of members of FrameAnalysisContext. Stages 
+ * declare the groups they read and write as a bitwise or of these flags.
+ */
+enum eFrameData {eFrameDataPath = 1 << 0,
+                 eFrameDataPoreResidues = 1 << 1,
+                 eFrameDataHydrophobicity = 1 << 2,
+                 eFrameDataSolvent = 1 << 3,
+                 eFrameDataSolventDensity = 1 << 4};
+
+
+/*!
+ * \brief Hydrophobicity profiles due to pore-lining and pore-facing residues.
+ */
+struct HydrophobicityProfiles
+{
+    SplineCurve1D poreLining_;
+    SplineCurve1D poreFacing_;
+};
+
+
+/*!
+ * \brief Solvent density along the pathway together with the quantities
+ * derived from it.
+ */
+struct SolventDensityProfile
+{
+    SplineCurve1D density_;
+    SplineCurve1D numberDensity_;
+    std::pair<real, real> minimum_ = {0.0, 0.0};
+    real bandWidth_ = 0.0;
+};
+
+
+/*!
+ * \brief Data shared between the stages analysing a single trajectory frame.
+ *
+ * The first block of members describes the frame itself and is set before
+ * the pipeline is run. All other members are filled in by the stage that 
+ * declares the corresponding eFrameData flag as an output. Members keep their
+ * default values if the producing stage is skipped and no neutral value is 
+ * set by the stage.
+ */
+struct FrameAnalysisContext
+{
+    // frame to be analysed:
+    int frnr_ = 0;
+    const t_trxframe *fr_ = nullptr;
+    t_pbc *pbc_ = nullptr;
+    gmx::TrajectoryAnalysisModuleData *pdata_ = nullptr;
+    gmx::AnalysisDataHandle *dataHandle_ = nullptr;
+
+    // permeation pathway (eFrameDataPath):
+    gmx::RVec initProbePos_ = gmx::RVec(0.0, 0.0, 0.0);
+    std::unique_ptr<MolecularPath> molPath_;
+
+    // pore forming residues (eFrameDataPoreResidues):
+    gmx::Selection poreMappingSelCog_;
+    std::map<int, gmx::RVec> poreCogMappedCoords_;
+    std::map<int, gmx::RVec> poreCalMappedCoords_;
+    std::map<int, bool> poreLining_;
+    std::map<int, bool> poreFacing_;
+
+    // hydrophobicity profiles (eFrameDataHydrophobicity):
+    HydrophobicityProfiles hydrophobicity_;
+
+    // solvent particles (eFrameDataSolvent):
+    std::map<int, gmx::RVec> solventMappedCoords_;
+    std::map<int, bool> solvInsideSample_;
+    std::map<int, bool> solvInsidePore_;
+    int numSolvInsideSample_ = 0;
+    int numSolvInsidePore_ = 0;
+
+    // solvent density (eFrameDataSolventDensity):
+    SolventDensityProfile solventDensity_;
+
+    /*!
+     * Returns the data of a selection in this frame. Frames read by the 
+     * Gromacs runner use its thread-local copy of the selection, frames read
+     * directly from a trajectory (pdata_ not set) use the selection itself,
+     * which must have been evaluated by the caller.
+     */
+    gmx::Selection selection(const gmx::Selection &sel) const
+    {
+        return pdata_ ? pdata_ -> parallelSelection(sel) : sel;
+    }
+};
+
+#endif
+
@@ -0,0 +1,91 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#ifndef FRAME_ANALYSIS_PIPELINE_HPP
+#define FRAME_ANALYSIS_PIPELINE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "trajectory-analysis/abstract_frame_analysis_stage.hpp"
+
+
+/*!
+ * \brief Runs a sequence of AbstractFrameAnalysisStage objects on each 
+ * trajectory frame.
+ *
+ * Stages are added in an order in which their inputs are available, i.e. 
+ * each input of a stage must be an output of a previously added stage. From
+ * these declarations, the pipeline assigns each stage to a level, which is 
+ * one higher than the highest level of any stage producing one of its inputs.
+ * Stages on the same level do not depend on each other and are run 
+ * concurrently if setConcurrent() has been called with true. Levels 
+ * themselves are run in order.
+ *
+ * Individual stages can be disabled by name with setStageEnabled(), in which
+ * case their skip() hook is called instead of evaluate().
+ */
+class FrameAnalysisPipeline
+{
+    public:
+
+        // constructor:
+        FrameAnalysisPipeline();
+
+        // setup:
+        void addStage(std::unique_ptr<AbstractFrameAnalysisStage> stage);
+        void setStageEnabled(const std::string &name, bool enabled);
+        void setConcurrent(bool concurrent);
+
+        // access to pipeline layout:
+        size_t numStages() const;
+        std::vector<std::vector<std::string>> schedule() const;
+
+        // run all stages on a frame:
+        void run(FrameAnalysisContext &ctx);
+
+    private:
+
+        // stages and their levels in order of addition:
+        std::vector<std::unique_ptr<AbstractFrameAnalysisStage>> stages_;
+        std::vector<int> levels_;
+        int numLevels_;
+
+        // data produced so far and the level of its producer:
+        unsigned int available_;
+        std::vector<int> producerLevel_;
+
+        // run independent stages concurrently?
+        bool concurrent_;
+
+        // evaluate or skip a single stage:
+        void runStage(AbstractFrameAnalysisStage &stage, 
+                      FrameAnalysisContext &ctx);
+};
+
+#endif
+
@@ -0,0 +1,427 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#ifndef FRAME_ANALYSIS_STAGES_HPP
+#define FRAME_ANALYSIS_STAGES_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <gromacs/trajectoryanalysis.h>
+
+#include "analysis-setup/residue_information_provider.hpp"
+#include "io/gltf_io.hpp"
+#include "path-finding/abstract_path_finder.hpp"
+#include "statistics/abstract_density_estimator.hpp"
+#include "statistics/profile_convergence_monitor.hpp"
+#include "trajectory-analysis/abstract_frame_analysis_stage.hpp"
+
+
+/*!
+ * Enum for optional stages that can be skipped by the user.
+ */
+enum eFrameAnalysisSkip {eFrameAnalysisSkipHydrophobicity,
+                         eFrameAnalysisSkipSolvent};
+
+
+/*!
+ * \brief Finds the permeation pathway in a frame.
+ *
+ * Updates the initial probe position (unless a fixed position has been set),
+ * runs the selected path finder, and aligns the resulting MolecularPath. 
+ * Writes the original path points and the radius and centre line splines to
+ * data sets 1, 2, and 3. The van der Waals radii of the pathway selection are
+ * kept in an array shared with the path finders, which is only rebuilt if a
+ * dynamic selection changes.
+ */
+class PathFindingStage : public AbstractFrameAnalysisStage
+{
+    public:
+
+        // constructor:
+        PathFindingStage(
+                const gmx::Selection &pathwaySel,
+                const gmx::Selection &ippSel,
+                const std::unordered_map<int, real> &vdwRadii);
+
+        // setters:
+        void setPathFindingMethod(
+                ePathFindingMethod method,
+                const std::map<std::string, real> &par,
+                const PathFindingParameters &params);
+        void setInitProbePos(const std::vector<real> &initProbePos);
+        void setChanDirVec(const std::vector<real> &chanDirVec);
+        void setPathAlignmentMethod(ePathAlignmentMethod method);
+
+        // stage hooks:
+        void evaluate(FrameAnalysisContext &ctx);
+        void write(FrameAnalysisContext &ctx);
+
+    private:
+
+        // selections:
+        gmx::Selection pathwaySel_;
+        gmx::Selection ippSel_;
+
+        // path finding parameters:
+        ePathFindingMethod method_;
+        std::map<std::string, real> par_;
+        PathFindingParameters params_;
+        bool initProbePosIsSet_;
+        gmx::RVec initProbePos_;
+        gmx::RVec chanDirVec_;
+        ePathAlignmentMethod pathAlignmentMethod_;
+
+        // van der Waals radii by mapped ID and by selection position:
+        std::unordered_map<int, real> vdwRadii_;
+        std::shared_ptr<const std::vector<real>> selVdwRadii_;
+        std::vector<int> selVdwRadiiIds_;
+
+        // align van der Waals radii with positions in pathway selection:
+        void updateSelectionVdwRadii(const gmx::Selection &sel);
+};
+
+
+/*!
+ * \brief Maps pore-forming residues onto the pathway and decides which of 
+ * them are pore-lining and pore-facing.
+ */
+class PoreResidueMappingStage : public AbstractFrameAnalysisStage
+{
+    public:
+
+        // constructor:
+        PoreResidueMappingStage(
+                gmx::SelectionCollection *selCol,
+                const gmx::Selection &calSel,
+                const gmx::Selection &cogSel,
+                real margin,
+                bool findPfResidues);
+
+        // stage hooks:
+        void prepare(FrameAnalysisContext &ctx);
+        void evaluate(FrameAnalysisContext &ctx);
+
+        // classify residues already mapped onto the pathway:
+        static void classifyResidues(
+                FrameAnalysisContext &ctx,
+                real margin,
+                bool findPfResidues);
+
+    private:
+
+        gmx::SelectionCollection *selCol_;
+        gmx::Selection calSel_;
+        gmx::Selection cogSel_;
+        real margin_;
+        bool findPfResidues_;
+};
+
+
+/*!
+ * \brief Estimates hydrophobicity profiles due to pore-lining and pore-facing
+ * residues and writes them to data sets 7 and 8.
+ *
+ * If skipped, both profiles are zero along the entire pathway.
+ */
+class HydrophobicityProfileStage : public AbstractFrameAnalysisStage
+{
+    public:
+
+        // constructor:
+        HydrophobicityProfileStage(
+                const ResidueInformationProvider &resInfo,
+                const DensityEstimationParameters &params,
+                real bandWidth);
+
+        // stage hooks:
+        void evaluate(FrameAnalysisContext &ctx);
+        void skip(FrameAnalysisContext &ctx);
+        void write(FrameAnalysisContext &ctx);
+
+        // estimate profiles without storing them in context:
+        void estimate(
+                const FrameAnalysisContext &ctx, 
+                HydrophobicityProfiles &profiles) const;
+        void zero(
+                const FrameAnalysisContext &ctx, 
+                HydrophobicityProfiles &profiles) const;
+
+    private:
+
+        const ResidueInformationProvider &resInfo_;
+        DensityEstimationParameters params_;
+        real bandWidth_;
+};
+
+
+/*!
+ * \brief Maps solvent particles onto the pathway, decides which of them lie
+ * inside the pore and the sample region, and writes them to data set 5.
+ *
+ * Does nothing if no solvent selection is given or if the stage is skipped.
+ */
+class SolventMappingStage : public AbstractFrameAnalysisStage
+{
+    public:
+
+        // constructor:
+        SolventMappingStage(
+                gmx::SelectionCollection *selCol,
+                const gmx::Selection &cogSel,
+                bool hasSolvent);
+
+        // stage hooks:
+        void prepare(FrameAnalysisContext &ctx);
+        void evaluate(FrameAnalysisContext &ctx);
+        void write(FrameAnalysisContext &ctx);
+
+        // classify particles already mapped onto the pathway:
+        static void classifySolvent(FrameAnalysisContext &ctx);
+
+    private:
+
+        gmx::SelectionCollection *selCol_;
+        gmx::Selection cogSel_;
+        gmx::Selection frameSel_;
+        bool hasSolvent_;
+};
+
+
+/*!
+ * \brief Estimates the solvent density along the pathway and writes its 
+ * spline parameters to data set 6.
+ *
+ * The density estimator persists across frames so that histogram breaks are
+ * reused. If skipped, the density is zero along the entire pathway.
+ */
+class SolventDensityStage : public AbstractFrameAnalysisStage
+{
+    public:
+
+        // constructor:
+        SolventDensityStage(
+                eDensityEstimator method,
+                const DensityEstimationParameters &params,
+                real bandWidth);
+
+        // stage hooks:
+        void evaluate(FrameAnalysisContext &ctx);
+        void skip(FrameAnalysisContext &ctx);
+        void write(FrameAnalysisContext &ctx);
+
+        // estimate density without storing it in context:
+        void estimate(
+                const FrameAnalysisContext &ctx, 
+                SolventDensityProfile &density);
+        void zero(
+                const FrameAnalysisContext &ctx, 
+                SolventDensityProfile &density) const;
+
+    private:
+
+        eDensityEstimator method_;
+        DensityEstimationParameters params_;
+        real bandWidth_;
+        std::unique_ptr<AbstractDensityEstimator> densityEstimator_;
+};
+
+
+/*!
+ * \brief Repeats density and hydrophobicity estimation for several sets of 
+ * parameters using the pathway, residues, and solvent mapped once per frame.
+ *
+ * Each parameter set k = 1, 2, ... is written to five data sets following 
+ * the primary ones, starting at 9 + 5*(k - 1): the parameter dependent 
+ * columns of the path summary (solventRangeLo, solventRangeHi, 
+ * argMinSolventDensity, minSolventDensity, bandWidth), the solvent density 
+ * at each pore residue, and the solvent density and pore-lining and 
+ * pore-facing hydrophobicity splines. Density and hydrophobicity are zero 
+ * for all parameter sets if the corresponding primary stage is skipped.
+ */
+class ParameterSweepStage : public AbstractFrameAnalysisStage
+{
+    public:
+
+        // constructor:
+        ParameterSweepStage(
+                const ResidueInformationProvider &resInfo,
+                bool estimateHydrophobicity,
+                bool estimateDensity);
+
+        // setters and getters:
+        void addParameterSet(
+                eDensityEstimator deMethod,
+                const DensityEstimationParameters &deParams,
+                real deBandWidth,
+                const DensityEstimationParameters &hpParams,
+                real hpBandWidth);
+        size_t numParameterSets() const;
+
+        // stage hooks:
+        void evaluate(FrameAnalysisContext &ctx);
+        void write(FrameAnalysisContext &ctx);
+
+    private:
+
+        const ResidueInformationProvider &resInfo_;
+        bool estimateHydrophobicity_;
+        bool estimateDensity_;
+
+        // one density and hydrophobicity estimator per parameter set:
+        std::vector<std::unique_ptr<SolventDensityStage>> densityStages_;
+        std::vector<std::unique_ptr<HydrophobicityProfileStage>> 
+                hydrophobicityStages_;
+
+        // results for each parameter set:
+        std::vector<SolventDensityProfile> densities_;
+        std::vector<HydrophobicityProfiles> hydrophobicities_;
+        std::vector<std::map<int, real>> solventDensityAtResidue_;
+};
+
+
+/*!
+ * \brief Checks whether the running averages of the radius and energy 
+ * profiles have converged.
+ *
+ * The frame number and time at which convergence was reached are written to
+ * the variables passed to the constructor. The frame number remains 
+ * negative until then, so that the code driving the pipeline can stop 
+ * reading the trajectory once it is set. The stage itself does not touch
+ * any global state.
+ */
+class ConvergenceMonitoringStage : public AbstractFrameAnalysisStage
+{
+    public:
+
+        // constructor:
+        ConvergenceMonitoringStage(
+                int numPoints,
+                real extrapDist,
+                int checkInterval,
+                real tolRadius,
+                real tolEnergy,
+                bool monitorEnergy,
+                int &convergedFrame,
+                real &convergedTime);
+
+        // stage hooks:
+        void evaluate(FrameAnalysisContext &ctx);
+
+    private:
+
+        int numPoints_;
+        real extrapDist_;
+        int checkInterval_;
+        real tolRadius_;
+        real tolEnergy_;
+        bool monitorEnergy_;
+        int &convergedFrame_;
+        real &convergedTime_;
+
+        std::vector<real> supportPoints_;
+        ProfileConvergenceMonitor radiusConvergence_;
+        ProfileConvergenceMonitor energyConvergence_;
+};
+
+
+/*!
+ * \brief Writes aggregate properties of the pathway and solvent to data 
+ * set 0.
+ */
+class PathSummaryStage : public AbstractFrameAnalysisStage
+{
+    public:
+
+        // constructor:
+        PathSummaryStage();
+
+        // stage hooks:
+        void evaluate(FrameAnalysisContext &ctx);
+        void write(FrameAnalysisContext &ctx);
+
+    private:
+
+        std::pair<real, real> minRadius_;
+        real volume_;
+};
+
+
+/*!
+ * \brief Writes the mapped positions of pore-forming residues together with
+ * the local pore radius and solvent density to data set 4.
+ */
+class PoreResidueOutputStage : public AbstractFrameAnalysisStage
+{
+    public:
+
+        // constructor:
+        PoreResidueOutputStage();
+
+        // stage hooks:
+        void evaluate(FrameAnalysisContext &ctx);
+        void write(FrameAnalysisContext &ctx);
+
+    private:
+
+        std::map<int, real> poreRadiusAtResidue_;
+        std::map<int, real> solventDensityAtResidue_;
+};
+
+
+/*!
+ * \brief Adds the pore surface of every n-th frame to a time-resolved mesh
+ * sequence.
+ */
+class MeshSequenceStage : public AbstractFrameAnalysisStage
+{
+    public:
+
+        // constructor:
+        MeshSequenceStage(
+                GltfSequenceExporter &meshSequence,
+                int stride,
+                real extrapDist,
+                real gridSampleDist,
+                real correctionThreshold);
+
+        // stage hooks:
+        void evaluate(FrameAnalysisContext &ctx);
+
+    private:
+
+        GltfSequenceExporter &meshSequence_;
+        int stride_;
+        real extrapDist_;
+        real gridSampleDist_;
+        real correctionThreshold_;
+};
+
+#endif
+
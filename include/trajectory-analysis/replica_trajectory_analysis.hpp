@@ -0,0 +1,151 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#ifndef REPLICA_TRAJECTORY_ANALYSIS_HPP
+#define REPLICA_TRAJECTORY_ANALYSIS_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <gromacs/analysisdata/analysisdata.h>
+#include <gromacs/selection/selection.h>
+#include <gromacs/selection/selectioncollection.h>
+
+#include "trajectory-analysis/frame_analysis_pipeline.hpp"
+
+
+/*!
+ * \brief Selections on which the stages of a FrameAnalysisPipeline operate.
+ *
+ * The pathway selections belong to a collection that is evaluated before 
+ * the pipeline is run, while the pore and solvent mapping collections are
+ * evaluated by the stages themselves.
+ */
+struct FrameSelections
+{
+    int numRequiredAtoms(
+            bool includeSolvent) const;
+
+    gmx::Selection pathway_;
+    gmx::Selection ipp_;
+    gmx::SelectionCollection *poreMappingSelCol_ = nullptr;
+    gmx::Selection poreMappingCal_;
+    gmx::Selection poreMappingCog_;
+    gmx::SelectionCollection *solvMappingSelCol_ = nullptr;
+    gmx::Selection solvMappingCog_;
+};
+
+
+/*!
+ * \brief Per-frame analysis of a trajectory read outside the Gromacs runner.
+ *
+ * This is used for additional replica trajectories and, if requested, for 
+ * the main trajectory itself (see ChapTrajectoryAnalysis).
+ *
+ * Replicas of a simulation share the topology of the trajectory processed by
+ * the Gromacs runner, so that all setup derived from it (van der Waals radii,
+ * residue information, parameters) can be shared as well. Each replica only
+ * owns the state that changes from frame to frame: its own selection 
+ * collections, which are compiled against the shared topology by the caller,
+ * a FrameAnalysisPipeline assembled from the resulting selections, and an 
+ * AnalysisData object with the same layout as the main frame stream, which
+ * is written to a separate stream file.
+ *
+ * The trajectory is read directly with an AsyncTrajectoryReader in run(), 
+ * which decodes frames ahead of their analysis and does not touch any state
+ * shared with other replicas, so that run() can be called on a separate 
+ * thread for each replica. Reading stops early once the optional stop 
+ * condition holds after a frame has been analysed.
+ */
+class ReplicaTrajectoryAnalysis
+{
+    public:
+
+        // constructor:
+        explicit ReplicaTrajectoryAnalysis(
+                const std::string &trajectoryFileName);
+
+        // setup:
+        void setReadAhead(
+                size_t numFrames);
+        void setMaxAtoms(
+                int numAtoms);
+        void setTimeRange(
+                real begin,
+                real end,
+                real dt);
+        void setStopCondition(
+                std::function<bool(const FrameAnalysisContext&)> stop);
+        gmx::SelectionCollection& pathwaySelections();
+        gmx::SelectionCollection& poreMappingSelections();
+        gmx::SelectionCollection& solventMappingSelections();
+        FrameSelections& selections();
+        FrameAnalysisPipeline& pipeline();
+        void setFrameStream(
+                const gmx::AbstractAnalysisData &layout,
+                const std::string &fileName,
+                const std::vector<std::string> &dataSetNames,
+                const std::vector<std::vector<std::string>> &columnNames);
+
+        // analysis of all frames:
+        int run();
+
+        // getter methods:
+        const std::string& trajectoryFileName() const;
+        const std::string& frameStreamFileName() const;
+
+
+    private:
+
+        // input and output files:
+        std::string trajectoryFileName_;
+        std::string frameStreamFileName_;
+        size_t readAhead_;
+        int maxAtoms_;
+        real beginTime_;
+        real endTime_;
+        real deltaTime_;
+        std::function<bool(const FrameAnalysisContext&)> stopCondition_;
+
+        // selections of this replica:
+        gmx::SelectionCollection pathwaySelCol_;
+        gmx::SelectionCollection poreMappingSelCol_;
+        gmx::SelectionCollection solvMappingSelCol_;
+        FrameSelections selections_;
+
+        // per-frame analysis and its output:
+        FrameAnalysisPipeline pipeline_;
+        gmx::AnalysisData frameStreamData_;
+
+        // selection collections can not be copied:
+        ReplicaTrajectoryAnalysis(const ReplicaTrajectoryAnalysis&) = delete;
+        ReplicaTrajectoryAnalysis& operator=(
+                const ReplicaTrajectoryAnalysis&) = delete;
+};
+
+#endif
@@ -33,6 +33,7 @@ import json                             # read in JSON files
 import numpy as np                      # manipulate numeric vectors
 from matplotlib import pyplot as pl     # plotting facilities
 import argparse                         # parse command line arguments
+import os                               # locate referenced array files
 
 # get parameters from user input:
 parser = argparse.ArgumentParser()
@@ -57,6 +58,30 @@ args = parser.parse_args()
 with open(args.filename) as data_file:
     data = json.load(data_file)
 
+# time series may be stored in NumPy files next to the JSON file:
+data_dir = os.path.dirname(os.path.abspath(args.filename))
+
+def load_array(section, name):
+    value = data[section][name]
+    if isinstance(value, dict):
+        return np.load(os.path.join(data_dir, value["file"]), mmap_mode = "r")
+    return np.array(value)
+
+# returns time, arc length, and value of a profile time series as matrices:
+def load_profile_time_series(name):
+    section = "pathwayProfileTimeSeries"
+    x = load_array(section, name)
+    t = load_array(section, "t")
+    s = load_array(section, "s")
+    if x.ndim == 2:
+        T, S = np.meshgrid(t, s, indexing = "ij")
+        return T, S, x
+    num_t = np.size(np.unique(t))
+    num_s = np.size(np.unique(s))
+    return (t.reshape(num_t, num_s),
+            s.reshape(num_t, num_s),
+            x.reshape(num_t, num_s))
+
 
 ################################################################################
 # PATHWAY PROFILE PLOTS
@@ -68,16 +93,7 @@ with open(args.filename) as data_file:
 
 pl.figure("radius_profile")
 
-s = np.array(data["pathwayProfileTimeSeries"]["s"])
-t = np.array(data["pathwayProfileTimeSeries"]["t"])
-r = np.array(data["pathwayProfileTimeSeries"]["radius"])
-
-num_t = np.size(np.unique(t))
-num_s = np.size(np.unique(s))
-
-S = s.reshape(num_t, num_s)
-T = t.reshape(num_t, num_s)
-R = r.reshape(num_t, num_s)
+T, S, R = load_profile_time_series("radius")
 
 pl.pcolormesh(
     T,
@@ -104,16 +120,7 @@ pl.close("radius_profile")
 
 pl.figure("density_profile")
 
-s = np.array(data["pathwayProfileTimeSeries"]["s"])
-t = np.array(data["pathwayProfileTimeSeries"]["t"])
-n = np.array(data["pathwayProfileTimeSeries"]["density"])
-
-num_t = np.size(np.unique(t))
-num_s = np.size(np.unique(s))
-
-S = s.reshape(num_t, num_s)
-T = t.reshape(num_t, num_s)
-N = n.reshape(num_t, num_s)
+T, S, N = load_profile_time_series("density")
 
 pl.pcolormesh(
     T,
@@ -140,16 +147,7 @@ pl.close("density_profile")
 
 pl.figure("pf_hydrophobicity_profile")
 
-s = np.array(data["pathwayProfileTimeSeries"]["s"])
-t = np.array(data["pathwayProfileTimeSeries"]["t"])
-h = np.array(data["pathwayProfileTimeSeries"]["pfHydrophobicity"])
-
-num_t = np.size(np.unique(t))
-num_s = np.size(np.unique(s))
-
-S = s.reshape(num_t, num_s)
-T = t.reshape(num_t, num_s)
-H = h.reshape(num_t, num_s)
+T, S, H = load_profile_time_series("pfHydrophobicity")
 
 pl.pcolormesh(
     T,
@@ -157,8 +155,8 @@ pl.pcolormesh(
     H,
     cmap = "BrBG_r")
 pl.clim(
-    -max(abs(np.array(data["pathwayProfileTimeSeries"]["pfHydrophobicity"]))),
-    max(abs(np.array(data["pathwayProfileTimeSeries"]["pfHydrophobicity"]))))
+    -np.max(np.abs(H)),
+    np.max(np.abs(H)))
 
 cbar = pl.colorbar()
 cbar.ax.set_ylabel("H (a.u.)")
@@ -33,6 +33,7 @@ import json                             # read in JSON files
 import numpy as np                      # manipulate numeric vectors
 from matplotlib import pyplot as pl     # plotting facilities
 import argparse                         # parse command line arguments
+import os                               # locate referenced array files
 
 # get parameters from user input:
 parser = argparse.ArgumentParser()
@@ -57,6 +58,15 @@ args = parser.parse_args()
 with open(args.filename) as data_file:
     data = json.load(data_file)
 
+# time series may be stored in NumPy files next to the JSON file:
+data_dir = os.path.dirname(os.path.abspath(args.filename))
+
+def load_time_series(name):
+    value = data["pathwayScalarTimeSeries"][name]
+    if isinstance(value, dict):
+        return np.load(os.path.join(data_dir, value["file"]), mmap_mode = "r")
+    return np.array(value)
+
 
 ################################################################################
 # TIME SERIES PLOTS
@@ -69,8 +79,8 @@ with open(args.filename) as data_file:
 pl.figure("length")
 
 pl.plot(
-	np.array(data["pathwayScalarTimeSeries"]["t"]),
-    np.array(data["pathwayScalarTimeSeries"]["length"]),
+	load_time_series("t"),
+    load_time_series("length"),
 	"k-")
 
 pl.margins(x = 0)
@@ -91,8 +101,8 @@ pl.close("length")
 pl.figure("volume")
 
 pl.plot(
-	np.array(data["pathwayScalarTimeSeries"]["t"]),
-    np.array(data["pathwayScalarTimeSeries"]["volume"]),
+	load_time_series("t"),
+    load_time_series("volume"),
 	"k-")
 
 pl.margins(x = 0)
@@ -113,8 +123,8 @@ pl.close("volume")
 pl.figure("number")
 
 pl.plot(
-	np.array(data["pathwayScalarTimeSeries"]["t"]),
-    np.array(data["pathwayScalarTimeSeries"]["numPathway"]),
+	load_time_series("t"),
+    load_time_series("numPathway"),
 	"k-")
 
 pl.margins(x = 0)
@@ -138,9 +148,9 @@ pl.axhline(
 	y = 33.3679,
 	linestyle = "dashed")
 
-density = np.array(data["pathwayScalarTimeSeries"]["numPathway"]) / np.array(data["pathwayScalarTimeSeries"]["volume"])
+density = load_time_series("numPathway") / load_time_series("volume")
 pl.plot(
-	np.array(data["pathwayScalarTimeSeries"]["t"]),
+	load_time_series("t"),
     density,
 	"k-")
 
@@ -162,8 +172,8 @@ pl.close("density")
 pl.figure("min_radius")
 
 pl.plot(
-	np.array(data["pathwayScalarTimeSeries"]["t"]),
-	np.array(data["pathwayScalarTimeSeries"]["minRadius"]),
+	load_time_series("t"),
+	load_time_series("minRadius"),
 	"k-")
 
 pl.margins(x = 0)
@@ -184,8 +194,8 @@ pl.close("min_radius")
 pl.figure("min_density")
 
 pl.plot(
-	np.array(data["pathwayScalarTimeSeries"]["t"]),
-	np.array(data["pathwayScalarTimeSeries"]["minSolventDensity"]),
+	load_time_series("t"),
+	load_time_series("minSolventDensity"),
 	"k-")
 
 pl.margins(x = 0)
@@ -206,8 +216,8 @@ pl.close("min_density")
 pl.figure("argmin_radius")
 
 pl.plot(
-	np.array(data["pathwayScalarTimeSeries"]["t"]),
-	np.array(data["pathwayScalarTimeSeries"]["argMinRadius"]),
+	load_time_series("t"),
+	load_time_series("argMinRadius"),
 	"k-")
 
 pl.margins(x = 0)
@@ -228,8 +238,8 @@ pl.close("argmin_radius")
 pl.figure("argmin_density")
 
 pl.plot(
-	np.array(data["pathwayScalarTimeSeries"]["t"]),
-	np.array(data["pathwayScalarTimeSeries"]["argMinSolventDensity"]),
+	load_time_series("t"),
+	load_time_series("argMinSolventDensity"),
 	"k-")
 
 pl.margins(x = 0)
@@ -0,0 +1,1171 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <array>
+#include <stdexcept>
+#include <string>
+
+#include "aggregation/frame_aggregate.hpp"
+
+#include "aggregation/boltzmann_energy_calculator.hpp"
+#include "aggregation/number_density_calculator.hpp"
+#include "geometry/cubic_spline_interp_1D.hpp"
+#include "geometry/linear_spline_interp_1D.hpp"
+#include "io/spline_curve_1D_json_converter.hpp"
+#include "statistics/autocorrelation_statistics.hpp"
+#include "statistics/block_average_statistics.hpp"
+#include "statistics/profile_quantile_statistics.hpp"
+
+
+/*
+ * Names of scalar properties in the order in which they are stored. These are
+ * the columns of the pathSummary data set in the stream file, except for 
+ * numPathway (numPath in the stream file).
+ */
+static const std::array<const char*, 13> scalarNames = {{
+        "argMinRadius", "minRadius", "length", "volume", "numPathway",
+        "numSample", "solventRangeLo", "solventRangeHi", 
+        "argMinSolventDensity", "minSolventDensity", "arcLengthLo", 
+        "arcLengthHi", "bandWidth"}};
+enum {eScalarArgMinRadius, eScalarMinRadius, eScalarLength, eScalarVolume,
+      eScalarNumPathway, eScalarNumSample, eScalarSolventRangeLo,
+      eScalarSolventRangeHi, eScalarArgMinSolventDensity, 
+      eScalarMinSolventDensity, eScalarArcLengthLo, eScalarArcLengthHi,
+      eScalarBandWidth};
+
+
+/*
+ * Names of profiles in the order in which they are stored.
+ */
+static const std::array<const char*, 5> profileNames = {{
+        "radius", "plHydrophobicity", "pfHydrophobicity", "density", 
+        "energy"}};
+enum {eProfileRadius, eProfilePlHydrophobicity, eProfilePfHydrophobicity,
+      eProfileDensity, eProfileEnergy};
+
+
+/*
+ * Names of residue properties in the order in which they are stored.
+ */
+static const std::array<const char*, 10> residueNames = {{
+        "s", "rho", "phi", "poreLining", "poreFacing", "poreRadius", 
+        "solventDensity", "x", "y", "z"}};
+enum {eResidueS, eResidueRho, eResiduePhi, eResiduePoreLining, 
+      eResiduePoreFacing, eResiduePoreRadius, eResidueSolventDensity,
+      eResidueX, eResidueY, eResidueZ};
+
+
+/*
+ * Auxiliary function for converting a vector of numbers into a JSON array.
+ */
+template<typename T>
+static rapidjson::Value
+arrayToJson(
+        const std::vector<T> &values, 
+        rapidjson::Document::AllocatorType &alloc)
+{
+    rapidjson::Value array(rapidjson::kArrayType);
+    array.Reserve(values.size(), alloc);
+    for(auto value : values)
+    {
+        array.PushBack(value, alloc);
+    }
+    return array;
+}
+
+
+/*
+ * Auxiliary function for reading a named array of numbers from a JSON object.
+ */
+static std::vector<real>
+arrayFromJson(const rapidjson::Value &json, const char *name)
+{
+    if( !json.HasMember(name) || !json[name].IsArray() )
+    {
+        throw std::runtime_error(std::string("ERROR: Aggregate is missing "
+                                 "array ") + name + ".");
+    }
+    std::vector<real> values;
+    values.reserve(json[name].Size());
+    for(auto &value : json[name].GetArray())
+    {
+        values.push_back(value.GetDouble());
+    }
+    return values;
+}
+
+
+/*
+ * Auxiliary function for converting the internal state of a 
+ * SummaryStatistics object to JSON.
+ */
+static rapidjson::Value
+summaryToJson(
+        const SummaryStatistics &summary, 
+        rapidjson::Document::AllocatorType &alloc)
+{
+    rapidjson::Value json(rapidjson::kObjectType);
+    json.AddMember("min", summary.min(), alloc);
+    json.AddMember("max", summary.max(), alloc);
+    json.AddMember("mean", summary.mean(), alloc);
+    json.AddMember("sumSquaredMeanDiff", summary.sumSquaredMeanDiff(), alloc);
+    json.AddMember("num", summary.num(), alloc);
+    return json;
+}
+
+
+/*
+ * Auxiliary function for recreating a SummaryStatistics object from JSON. 
+ * Statistics without samples are returned in their initial state.
+ */
+static SummaryStatistics
+summaryFromJson(const rapidjson::Value &json)
+{
+    if( !json.IsObject() || !json.HasMember("num") )
+    {
+        throw std::runtime_error("ERROR: Aggregate contains invalid summary "
+                                 "statistics.");
+    }
+    if( json["num"].GetInt() == 0 )
+    {
+        return SummaryStatistics();
+    }
+    return SummaryStatistics(
+            json["min"].GetDouble(),
+            json["max"].GetDouble(),
+            json["mean"].GetDouble(),
+            json["sumSquaredMeanDiff"].GetDouble(),
+            json["num"].GetInt());
+}
+
+
+/*
+ * Auxiliary function for converting a vector of SummaryStatistics to JSON.
+ */
+static rapidjson::Value
+summaryVectorToJson(
+        const std::vector<SummaryStatistics> &summaries,
+        rapidjson::Document::AllocatorType &alloc)
+{
+    rapidjson::Value json(rapidjson::kArrayType);
+    json.Reserve(summaries.size(), alloc);
+    for(auto &summary : summaries)
+    {
+        json.PushBack(summaryToJson(summary, alloc), alloc);
+    }
+    return json;
+}
+
+
+/*
+ * Auxiliary function for recreating a vector of SummaryStatistics from JSON.
+ */
+static std::vector<SummaryStatistics>
+summaryVectorFromJson(const rapidjson::Value &json)
+{
+    if( !json.IsArray() )
+    {
+        throw std::runtime_error("ERROR: Aggregate contains invalid summary "
+                                 "statistics.");
+    }
+    std::vector<SummaryStatistics> summaries;
+    summaries.reserve(json.Size());
+    for(auto &summary : json.GetArray())
+    {
+        summaries.push_back(summaryFromJson(summary));
+    }
+    return summaries;
+}
+
+
+/*!
+ * Constructor. Profiles are sampled at the given support points and the 
+ * energy profile is shifted so that its mean is zero at the two anchor 
+ * points.
+ */
+FrameAggregate::FrameAggregate(
+        const std::vector<real> &supportPoints,
+        real anchorPointLo,
+        real anchorPointHi)
+    : supportPoints_(supportPoints)
+    , anchorPointLo_(anchorPointLo)
+    , anchorPointHi_(anchorPointHi)
+    , scalarSummary_(scalarNames.size())
+    , scalarTimeSeries_(scalarNames.size())
+    , profileSummary_(
+            profileNames.size(), 
+            ProfileSummaryStatistics(supportPoints.size()))
+    , profileTimeSeries_(profileNames.size())
+    , residueSummary_(residueNames.size())
+    , hasSolventHistogram_(false)
+{
+
+}
+
+
+/*!
+ * Enables the trajectory-wide histogram of solvent positions with the given
+ * bin width. The mean solvent density profile is then estimated from this 
+ * histogram rather than averaged over the per-frame densities. Frames added 
+ * with update() must contain the solvent positions.
+ */
+void
+FrameAggregate::setSolventHistogram(
+        real binWidth)
+{
+    if( numFrames() > 0 )
+    {
+        throw std::logic_error("Solvent histogram must be set up before "
+                               "frames are added.");
+    }
+    solventHistogram_.setBinWidth(binWidth);
+    hasSolventHistogram_ = true;
+}
+
+
+/*!
+ * Samples all profiles of a frame read from the stream file at the support 
+ * points. The energy at the anchor points is obtained by linear interpolation
+ * between support points. This does not modify the aggregate and can be 
+ * called for several frames in parallel.
+ */
+void
+FrameAggregate::sample(
+        const FrameStreamData &frame,
+        FrameProfileSample &sample) const
+{
+    // sample radius at support points:
+    MolecularPath molPath = molecularPath(frame);
+    sample.radius_ = molPath.sampleRadii(supportPoints_); 
+
+    // sample points from hydrophobicity splines:
+    SplineCurve1D pfHydrophobicitySpline = 
+            SplineCurve1DJsonConverter::fromUniqueKnots(
+                    frame.pfHydrophobicitySpline_.knots_, 
+                    frame.pfHydrophobicitySpline_.ctrl_, 
+                    1);
+    sample.pfHydrophobicity_ = 
+            pfHydrophobicitySpline.evaluateMultiple(supportPoints_, 0);
+    SplineCurve1D plHydrophobicitySpline = 
+            SplineCurve1DJsonConverter::fromUniqueKnots(
+                    frame.plHydrophobicitySpline_.knots_, 
+                    frame.plHydrophobicitySpline_.ctrl_, 
+                    1);
+    sample.plHydrophobicity_ = 
+            plHydrophobicitySpline.evaluateMultiple(supportPoints_, 0);
+
+    // sample points from solvent density spline:
+    SplineCurve1D solventDensitySpline = 
+            SplineCurve1DJsonConverter::fromUniqueKnots(
+                    frame.solventDensitySpline_.knots_, 
+                    frame.solventDensitySpline_.ctrl_, 
+                    1);
+    sample.solventDensity_ = 
+            solventDensitySpline.evaluateMultiple(supportPoints_, 0);
+
+    // get total number of particles in sample for this time step:
+    int totalNumber = frame.numSample_;
+
+    // convert to number density:
+    // TODO this should be done in per-frame analysis:
+    NumberDensityCalculator ndc;
+    sample.solventDensity_ = ndc(
+            sample.solventDensity_, 
+            sample.radius_, 
+            totalNumber);
+
+    // convert to energy:
+    BoltzmannEnergyCalculator bec;
+    sample.energy_ = bec.calculate(sample.solventDensity_);
+
+    // calculate energy at anchor points by linear interpolation:
+    LinearSplineInterp1D interp;
+    auto energySpline = interp(supportPoints_, sample.energy_);
+    sample.energyAnchorLo_ = energySpline.evaluate(anchorPointLo_, 0);
+    sample.energyAnchorHi_ = energySpline.evaluate(anchorPointHi_, 0);
+}
+
+
+/*!
+ * Adds a frame and its sampled profiles to the aggregate. Frames must be 
+ * added in order. The first frame determines the pore residues and the 
+ * pathway used for visualisation.
+ */
+void
+FrameAggregate::update(
+        const FrameStreamData &frame,
+        const FrameProfileSample &sample)
+{
+    // first frame defines pathway and pore forming residues:
+    if( numFrames() == 0 )
+    {
+        firstFrame_ = frame;
+        poreResIds_.assign(frame.resId_.begin(), frame.resId_.end());
+        for(auto &summary : residueSummary_)
+        {
+            summary.assign(poreResIds_.size(), SummaryStatistics());
+        }
+    }
+
+    // scalar properties in order of scalarNames:
+    std::array<real, 13> scalars = {{
+            frame.argMinRadius_, frame.minRadius_, frame.length_, 
+            frame.volume_, frame.numPath_, frame.numSample_, 
+            frame.solventRangeLo_, frame.solventRangeHi_, 
+            frame.argMinSolventDensity_, frame.minSolventDensity_, 
+            frame.arcLengthLo_, frame.arcLengthHi_, frame.bandWidth_}};
+    timeStamps_.push_back(frame.timeStamp_);
+    for(size_t i = 0; i < scalars.size(); i++)
+    {
+        scalarSummary_[i].update(scalars[i]);
+        scalarTimeSeries_[i].push_back(scalars[i]);
+    }
+
+    // profiles in order of profileNames:
+    std::array<const std::vector<real>*, 5> profiles = {{
+            &sample.radius_, &sample.plHydrophobicity_, 
+            &sample.pfHydrophobicity_, &sample.solventDensity_, 
+            &sample.energy_}};
+    for(size_t i = 0; i < profiles.size(); i++)
+    {
+        profileSummary_[i].update(*profiles[i]);
+        profileTimeSeries_[i].insert(
+                profileTimeSeries_[i].end(),
+                profiles[i] -> begin(),
+                profiles[i] -> end());
+    }
+    anchorEnergyLo_.update(sample.energyAnchorLo_);
+    anchorEnergyHi_.update(sample.energyAnchorHi_);
+
+    // add solvent particles inside sample to trajectory-wide histogram:
+    if( hasSolventHistogram_ )
+    {
+        std::vector<real> solventSampleS;
+        solventSampleS.reserve(frame.solventS_.size());
+        for(size_t i = 0; i < frame.solventS_.size(); i++)
+        {
+            if( frame.solventInSample_.at(i) != 0.0 )
+            {
+                solventSampleS.push_back(frame.solventS_[i]);
+            }
+        }
+        solventHistogram_.accumulate(solventSampleS);
+    }
+
+    // get total number of particles in sample for this time step:
+    int totalNumber = frame.numSample_;
+
+    // loop over all pore forming residues:
+    for(size_t i = 0; i < poreResIds_.size(); i++)
+    {
+        residueSummary_[eResidueS].at(i).update(frame.resS_.at(i));
+        residueSummary_[eResidueRho].at(i).update(frame.resRho_.at(i));
+        residueSummary_[eResiduePhi].at(i).update(frame.resPhi_.at(i));
+        residueSummary_[eResiduePoreLining].at(i).update(
+                frame.resPoreLining_.at(i));
+        residueSummary_[eResiduePoreFacing].at(i).update(
+                frame.resPoreFacing_.at(i));
+        residueSummary_[eResidueX].at(i).update(frame.resX_.at(i));
+        residueSummary_[eResidueY].at(i).update(frame.resY_.at(i));
+        residueSummary_[eResidueZ].at(i).update(frame.resZ_.at(i));
+
+        // residue-local number density requires additional post-processing:
+        real rad = frame.resPoreRadius_.at(i);
+        real den = frame.resSolventDensity_.at(i);
+        residueSummary_[eResiduePoreRadius].at(i).update(rad);
+        residueSummary_[eResidueSolventDensity].at(i).update(
+                den*totalNumber/(M_PI*rad*rad));
+    }
+}
+
+
+/*!
+ * Appends the frames aggregated in other to this aggregate. Both must use 
+ * the same support and anchor points and the same pore residues, and all 
+ * frames in other must come after those in this aggregate.
+ */
+void
+FrameAggregate::merge(
+        const FrameAggregate &other)
+{
+    // sanity checks:
+    if( other.supportPoints_ != supportPoints_ ||
+        other.anchorPointLo_ != anchorPointLo_ ||
+        other.anchorPointHi_ != anchorPointHi_ )
+    {
+        throw std::runtime_error("ERROR: Can not merge aggregates with "
+                                 "different support points.");
+    }
+    if( other.hasSolventHistogram_ != hasSolventHistogram_ )
+    {
+        throw std::runtime_error("ERROR: Can not merge aggregates with and "
+                                 "without solvent histogram.");
+    }
+    if( other.numFrames() == 0 )
+    {
+        return;
+    }
+    if( numFrames() == 0 )
+    {
+        *this = other;
+        return;
+    }
+    if( other.poreResIds_ != poreResIds_ )
+    {
+        throw std::runtime_error("ERROR: Can not merge aggregates with "
+                                 "different pore residues.");
+    }
+
+    // combine scalar properties:
+    timeStamps_.insert(
+            timeStamps_.end(), 
+            other.timeStamps_.begin(), 
+            other.timeStamps_.end());
+    for(size_t i = 0; i < scalarSummary_.size(); i++)
+    {
+        scalarSummary_[i].merge(other.scalarSummary_[i]);
+        scalarTimeSeries_[i].insert(
+                scalarTimeSeries_[i].end(),
+                other.scalarTimeSeries_[i].begin(),
+                other.scalarTimeSeries_[i].end());
+    }
+
+    // combine profiles:
+    for(size_t i = 0; i < profileSummary_.size(); i++)
+    {
+        profileSummary_[i].merge(other.profileSummary_[i]);
+        profileTimeSeries_[i].insert(
+                profileTimeSeries_[i].end(),
+                other.profileTimeSeries_[i].begin(),
+                other.profileTimeSeries_[i].end());
+    }
+    anchorEnergyLo_.merge(other.anchorEnergyLo_);
+    anchorEnergyHi_.merge(other.anchorEnergyHi_);
+    if( hasSolventHistogram_ )
+    {
+        solventHistogram_.mergeAccumulated(other.solventHistogram_);
+    }
+
+    // combine residue properties:
+    for(size_t i = 0; i < residueSummary_.size(); i++)
+    {
+        for(size_t j = 0; j < poreResIds_.size(); j++)
+        {
+            residueSummary_[i][j].merge(other.residueSummary_[i][j]);
+        }
+    }
+}
+
+
+/*!
+ * Summarises the time-averaged profile of the given name over a set of 
+ * replica aggregates. The summary statistics at each support point are 
+ * updated once with the mean profile of each replica, so that their variance
+ * is the between-replica variance. Energy profiles are shifted by the anchor 
+ * energy of each replica individually. All replicas must use the same 
+ * support points.
+ */
+std::vector<SummaryStatistics>
+FrameAggregate::ensembleProfile(
+        const std::vector<FrameAggregate> &replicas,
+        const std::string &profile)
+{
+    // find index of requested profile:
+    size_t idx = 0;
+    while( idx < profileNames.size() && profile != profileNames[idx] )
+    {
+        idx++;
+    }
+    if( idx == profileNames.size() )
+    {
+        throw std::logic_error("Requested profile " + profile + " does not "
+                               "exist.");
+    }
+    if( replicas.empty() )
+    {
+        return std::vector<SummaryStatistics>();
+    }
+
+    // update summary with time-averaged profile of each replica:
+    std::vector<SummaryStatistics> ensemble(
+            replicas.front().supportPoints_.size());
+    for(const auto &replica : replicas)
+    {
+        if( replica.supportPoints_ != replicas.front().supportPoints_ )
+        {
+            throw std::runtime_error("ERROR: Can not combine replicas with "
+                                     "different support points.");
+        }
+        if( replica.numFrames() == 0 )
+        {
+            continue;
+        }
+
+        ProfileSummaryStatistics summary = replica.profileSummary_[idx];
+        if( idx == eProfileDensity )
+        {
+            summary = replica.densityProfile();
+        }
+        if( idx == eProfileEnergy )
+        {
+            summary.shift(replica.energyShift());
+        }
+        SummaryStatistics::updateMultiple(ensemble, summary.mean());
+    }
+
+    return ensemble;
+}
+
+
+/*!
+ * Converts the complete state of the aggregate into a JSON object.
+ */
+rapidjson::Value
+FrameAggregate::toJson(
+        rapidjson::Document::AllocatorType &alloc) const
+{
+    rapidjson::Value json(rapidjson::kObjectType);
+
+    // support and anchor points:
+    json.AddMember("supportPoints", arrayToJson(supportPoints_, alloc), alloc);
+    json.AddMember("anchorPointLo", anchorPointLo_, alloc);
+    json.AddMember("anchorPointHi", anchorPointHi_, alloc);
+
+    // pathway of first frame:
+    rapidjson::Value firstFrame(rapidjson::kObjectType);
+    firstFrame.AddMember(
+            "origPointsX", arrayToJson(firstFrame_.origPointsX_, alloc), alloc);
+    firstFrame.AddMember(
+            "origPointsY", arrayToJson(firstFrame_.origPointsY_, alloc), alloc);
+    firstFrame.AddMember(
+            "origPointsZ", arrayToJson(firstFrame_.origPointsZ_, alloc), alloc);
+    firstFrame.AddMember(
+            "origPointsR", arrayToJson(firstFrame_.origPointsR_, alloc), alloc);
+    firstFrame.AddMember(
+            "radiusKnots", 
+            arrayToJson(firstFrame_.radiusSpline_.knots_, alloc), 
+            alloc);
+    firstFrame.AddMember(
+            "radiusCtrl", 
+            arrayToJson(firstFrame_.radiusSpline_.ctrl_, alloc), 
+            alloc);
+    firstFrame.AddMember(
+            "centreLineKnots", 
+            arrayToJson(firstFrame_.centreLineKnots_, alloc), 
+            alloc);
+    firstFrame.AddMember(
+            "centreLineCtrlX", 
+            arrayToJson(firstFrame_.centreLineCtrlX_, alloc), 
+            alloc);
+    firstFrame.AddMember(
+            "centreLineCtrlY", 
+            arrayToJson(firstFrame_.centreLineCtrlY_, alloc), 
+            alloc);
+    firstFrame.AddMember(
+            "centreLineCtrlZ", 
+            arrayToJson(firstFrame_.centreLineCtrlZ_, alloc), 
+            alloc);
+    json.AddMember("firstFrame", firstFrame, alloc);
+
+    // scalar properties:
+    json.AddMember("timeStamps", arrayToJson(timeStamps_, alloc), alloc);
+    rapidjson::Value scalars(rapidjson::kObjectType);
+    for(size_t i = 0; i < scalarNames.size(); i++)
+    {
+        rapidjson::Value scalar(rapidjson::kObjectType);
+        scalar.AddMember(
+                "summary", summaryToJson(scalarSummary_[i], alloc), alloc);
+        scalar.AddMember(
+                "timeSeries", arrayToJson(scalarTimeSeries_[i], alloc), alloc);
+        scalars.AddMember(rapidjson::StringRef(scalarNames[i]), scalar, alloc);
+    }
+    json.AddMember("scalars", scalars, alloc);
+
+    // profiles:
+    rapidjson::Value profiles(rapidjson::kObjectType);
+    for(size_t i = 0; i < profileNames.size(); i++)
+    {
+        std::vector<SummaryStatistics> summary;
+        for(size_t j = 0; j < profileSummary_[i].size(); j++)
+        {
+            summary.push_back(profileSummary_[i].at(j));
+        }
+        rapidjson::Value profile(rapidjson::kObjectType);
+        profile.AddMember(
+                "summary", summaryVectorToJson(summary, alloc), alloc);
+        profile.AddMember(
+                "timeSeries", 
+                arrayToJson(profileTimeSeries_[i], alloc), 
+                alloc);
+        profiles.AddMember(
+                rapidjson::StringRef(profileNames[i]), profile, alloc);
+    }
+    json.AddMember("profiles", profiles, alloc);
+    json.AddMember(
+            "anchorEnergyLo", summaryToJson(anchorEnergyLo_, alloc), alloc);
+    json.AddMember(
+            "anchorEnergyHi", summaryToJson(anchorEnergyHi_, alloc), alloc);
+
+    // residue properties:
+    rapidjson::Value residues(rapidjson::kObjectType);
+    residues.AddMember("id", arrayToJson(poreResIds_, alloc), alloc);
+    for(size_t i = 0; i < residueNames.size(); i++)
+    {
+        residues.AddMember(
+                rapidjson::StringRef(residueNames[i]), 
+                summaryVectorToJson(residueSummary_[i], alloc),
+                alloc);
+    }
+    json.AddMember("residues", residues, alloc);
+
+    // trajectory-wide solvent histogram:
+    if( hasSolventHistogram_ )
+    {
+        rapidjson::Value histogram(rapidjson::kObjectType);
+        histogram.AddMember(
+                "binWidth", solventHistogram_.binWidth(), alloc);
+        histogram.AddMember(
+                "firstBreak", 
+                static_cast<int64_t>(solventHistogram_.accumulatedFirstBreak()), 
+                alloc);
+        rapidjson::Value counts(rapidjson::kArrayType);
+        for(auto count : solventHistogram_.accumulatedCounts())
+        {
+            counts.PushBack(static_cast<uint64_t>(count), alloc);
+        }
+        histogram.AddMember("counts", counts, alloc);
+        json.AddMember("solventHistogram", histogram, alloc);
+    }
+
+    return json;
+}
+
+
+/*!
+ * Recreates an aggregate from a JSON object created with toJson().
+ */
+FrameAggregate
+FrameAggregate::fromJson(
+        const rapidjson::Value &json)
+{
+    // sanity checks:
+    if( !json.IsObject() || 
+        !json.HasMember("anchorPointLo") || 
+        !json.HasMember("anchorPointHi") ||
+        !json.HasMember("firstFrame") ||
+        !json.HasMember("scalars") ||
+        !json.HasMember("profiles") ||
+        !json.HasMember("anchorEnergyLo") ||
+        !json.HasMember("anchorEnergyHi") ||
+        !json.HasMember("residues") )
+    {
+        throw std::runtime_error("ERROR: Invalid aggregate.");
+    }
+
+    // support and anchor points:
+    FrameAggregate aggregate(
+            arrayFromJson(json, "supportPoints"),
+            json["anchorPointLo"].GetDouble(),
+            json["anchorPointHi"].GetDouble());
+
+    // pathway of first frame:
+    const rapidjson::Value &firstFrame = json["firstFrame"];
+    aggregate.firstFrame_.origPointsX_ = arrayFromJson(
+            firstFrame, "origPointsX");
+    aggregate.firstFrame_.origPointsY_ = arrayFromJson(
+            firstFrame, "origPointsY");
+    aggregate.firstFrame_.origPointsZ_ = arrayFromJson(
+            firstFrame, "origPointsZ");
+    aggregate.firstFrame_.origPointsR_ = arrayFromJson(
+            firstFrame, "origPointsR");
+    aggregate.firstFrame_.radiusSpline_.knots_ = arrayFromJson(
+            firstFrame, "radiusKnots");
+    aggregate.firstFrame_.radiusSpline_.ctrl_ = arrayFromJson(
+            firstFrame, "radiusCtrl");
+    aggregate.firstFrame_.centreLineKnots_ = arrayFromJson(
+            firstFrame, "centreLineKnots");
+    aggregate.firstFrame_.centreLineCtrlX_ = arrayFromJson(
+            firstFrame, "centreLineCtrlX");
+    aggregate.firstFrame_.centreLineCtrlY_ = arrayFromJson(
+            firstFrame, "centreLineCtrlY");
+    aggregate.firstFrame_.centreLineCtrlZ_ = arrayFromJson(
+            firstFrame, "centreLineCtrlZ");
+
+    // scalar properties:
+    aggregate.timeStamps_ = arrayFromJson(json, "timeStamps");
+    for(size_t i = 0; i < scalarNames.size(); i++)
+    {
+        if( !json["scalars"].HasMember(scalarNames[i]) )
+        {
+            throw std::runtime_error(std::string("ERROR: Aggregate is missing "
+                                     "scalar ") + scalarNames[i] + ".");
+        }
+        const rapidjson::Value &scalar = json["scalars"][scalarNames[i]];
+        aggregate.scalarSummary_[i] = summaryFromJson(scalar["summary"]);
+        aggregate.scalarTimeSeries_[i] = arrayFromJson(scalar, "timeSeries");
+    }
+
+    // profiles:
+    for(size_t i = 0; i < profileNames.size(); i++)
+    {
+        if( !json["profiles"].HasMember(profileNames[i]) )
+        {
+            throw std::runtime_error(std::string("ERROR: Aggregate is missing "
+                                     "profile ") + profileNames[i] + ".");
+        }
+        const rapidjson::Value &profile = json["profiles"][profileNames[i]];
+        aggregate.profileSummary_[i] = ProfileSummaryStatistics(
+                summaryVectorFromJson(profile["summary"]));
+        aggregate.profileTimeSeries_[i] = arrayFromJson(profile, "timeSeries");
+    }
+    aggregate.anchorEnergyLo_ = summaryFromJson(json["anchorEnergyLo"]);
+    aggregate.anchorEnergyHi_ = summaryFromJson(json["anchorEnergyHi"]);
+
+    // residue properties:
+    const rapidjson::Value &residues = json["residues"];
+    for(auto id : arrayFromJson(residues, "id"))
+    {
+        aggregate.poreResIds_.push_back(static_cast<int>(id));
+    }
+    for(size_t i = 0; i < residueNames.size(); i++)
+    {
+        if( !residues.HasMember(residueNames[i]) )
+        {
+            throw std::runtime_error(std::string("ERROR: Aggregate is missing "
+                                     "residue property ") + residueNames[i] + 
+                                     ".");
+        }
+        aggregate.residueSummary_[i] = summaryVectorFromJson(
+                residues[residueNames[i]]);
+    }
+
+    // trajectory-wide solvent histogram:
+    if( json.HasMember("solventHistogram") )
+    {
+        const rapidjson::Value &histogram = json["solventHistogram"];
+        if( !histogram.IsObject() ||
+            !histogram.HasMember("binWidth") ||
+            !histogram.HasMember("firstBreak") ||
+            !histogram.HasMember("counts") ||
+            !histogram["counts"].IsArray() )
+        {
+            throw std::runtime_error("ERROR: Aggregate contains invalid "
+                                     "solvent histogram.");
+        }
+        std::vector<size_t> counts;
+        for(auto &count : histogram["counts"].GetArray())
+        {
+            counts.push_back(count.GetUint64());
+        }
+        aggregate.solventHistogram_.setBinWidth(
+                histogram["binWidth"].GetDouble());
+        aggregate.solventHistogram_.addAccumulated(
+                histogram["firstBreak"].GetInt64(), 
+                counts);
+        aggregate.hasSolventHistogram_ = true;
+    }
+
+    // consistency of array sizes:
+    size_t numFrames = aggregate.timeStamps_.size();
+    size_t numPoints = aggregate.supportPoints_.size();
+    for(size_t i = 0; i < scalarNames.size(); i++)
+    {
+        if( aggregate.scalarTimeSeries_[i].size() != numFrames )
+        {
+            throw std::runtime_error("ERROR: Inconsistent number of frames "
+                                     "in aggregate.");
+        }
+    }
+    for(size_t i = 0; i < profileNames.size(); i++)
+    {
+        if( aggregate.profileSummary_[i].size() != numPoints ||
+            aggregate.profileTimeSeries_[i].size() != numFrames*numPoints )
+        {
+            throw std::runtime_error("ERROR: Inconsistent number of support "
+                                     "points in aggregate.");
+        }
+    }
+    for(size_t i = 0; i < residueNames.size(); i++)
+    {
+        if( aggregate.residueSummary_[i].size() != 
+            aggregate.poreResIds_.size() )
+        {
+            throw std::runtime_error("ERROR: Inconsistent number of residues "
+                                     "in aggregate.");
+        }
+    }
+
+    return aggregate;
+}
+
+
+/*!
+ * Returns the number of frames in the aggregate.
+ */
+size_t
+FrameAggregate::numFrames() const
+{
+    return timeStamps_.size();
+}
+
+
+/*!
+ * Returns the support points at which profiles are sampled.
+ */
+std::vector<real>
+FrameAggregate::supportPoints() const
+{
+    return supportPoints_;
+}
+
+
+/*!
+ * Returns the time stamps of all aggregated frames.
+ */
+std::vector<real>
+FrameAggregate::timeStamps() const
+{
+    return timeStamps_;
+}
+
+
+/*!
+ * Returns the IDs of the pore forming residues.
+ */
+std::vector<int>
+FrameAggregate::poreResIds() const
+{
+    return poreResIds_;
+}
+
+
+/*!
+ * Returns the summary statistics of the pore-lining attribute of each pore 
+ * forming residue.
+ */
+std::vector<SummaryStatistics>
+FrameAggregate::residuePoreLining() const
+{
+    return residueSummary_[eResiduePoreLining];
+}
+
+
+/*!
+ * Returns the summary statistics of the pore-facing attribute of each pore 
+ * forming residue.
+ */
+std::vector<SummaryStatistics>
+FrameAggregate::residuePoreFacing() const
+{
+    return residueSummary_[eResiduePoreFacing];
+}
+
+
+/*!
+ * Adds all time-averaged results to the given results file. Quantiles and
+ * correlation-aware error estimates are computed here by replaying the time 
+ * series in order, so that the results do not depend on whether frames were
+ * added to a single aggregate or to several aggregates that were merged. The
+ * results file is not closed, so that further information can be appended.
+ */
+void
+FrameAggregate::writeResults(
+        ResultsJsonStreamWriter &results,
+        const ResidueInformationProvider &resInfo) const
+{
+    // correlation-aware error estimates for selected scalar properties:
+    std::vector<BlockAverageStatistics> scalarBlockAvg(scalarNames.size());
+    std::vector<AutocorrelationStatistics> scalarAutocorr(scalarNames.size());
+    for(size_t i : {eScalarMinRadius, eScalarLength, eScalarVolume, 
+                    eScalarNumPathway, eScalarMinSolventDensity})
+    {
+        for(auto value : scalarTimeSeries_[i])
+        {
+            scalarBlockAvg[i].update(value);
+            scalarAutocorr[i].update(value);
+        }
+    }
+
+    // quantiles of all profiles and error estimates for radius and energy:
+    size_t numPoints = supportPoints_.size();
+    std::vector<real> quantileProbs = {0.05, 0.5, 0.95};
+    std::vector<ProfileQuantileStatistics> quantiles(
+            profileNames.size(), 
+            ProfileQuantileStatistics(numPoints, quantileProbs));
+    std::vector<BlockAverageStatistics> radiusBlockAvg(numPoints);
+    std::vector<BlockAverageStatistics> energyBlockAvg(numPoints);
+    std::vector<AutocorrelationStatistics> radiusAutocorr(numPoints);
+    std::vector<AutocorrelationStatistics> energyAutocorr(numPoints);
+    for(size_t f = 0; f < numFrames(); f++)
+    {
+        for(size_t i = 0; i < profileNames.size(); i++)
+        {
+            quantiles[i].update(profileRow(i, f));
+        }
+        std::vector<real> radius = profileRow(eProfileRadius, f);
+        BlockAverageStatistics::updateMultiple(radiusBlockAvg, radius);
+        AutocorrelationStatistics::updateMultiple(radiusAutocorr, radius);
+        std::vector<real> energy = profileRow(eProfileEnergy, f);
+        BlockAverageStatistics::updateMultiple(energyBlockAvg, energy);
+        AutocorrelationStatistics::updateMultiple(energyAutocorr, energy);
+    }
+
+    // shift of energy profile so that energy at anchor points is zero:
+    ProfileSummaryStatistics energySummary = profileSummary_[eProfileEnergy];
+    energySummary.shift(energyShift());
+    quantiles[eProfileEnergy].shift(energyShift());
+
+    // add summary statistics for scalar variables describing the pathway:
+    results.addPathwaySummary(
+            "argMinRadius", 
+            scalarSummary_[eScalarArgMinRadius]);
+    for(size_t i : {eScalarMinRadius, eScalarLength, eScalarVolume, 
+                    eScalarNumPathway})
+    {
+        results.addPathwaySummary(
+                scalarNames[i], 
+                scalarSummary_[i], 
+                scalarBlockAvg[i], 
+                scalarAutocorr[i]);
+    }
+    results.addPathwaySummary(
+            "numSample", 
+            scalarSummary_[eScalarNumSample]);
+    results.addPathwaySummary(
+            "argMinSolventDensity", 
+            scalarSummary_[eScalarArgMinSolventDensity]);
+    results.addPathwaySummary(
+            "minSolventDensity", 
+            scalarSummary_[eScalarMinSolventDensity], 
+            scalarBlockAvg[eScalarMinSolventDensity], 
+            scalarAutocorr[eScalarMinSolventDensity]);
+    results.addPathwaySummary(
+            "bandWidth", 
+            scalarSummary_[eScalarBandWidth]);
+
+    // add time-averaged pathway profiles:
+    results.addSupportPoints(supportPoints_);
+    for(size_t i : {eProfileRadius, eProfilePlHydrophobicity, 
+                    eProfilePfHydrophobicity})
+    {
+        results.addPathwayProfile(
+                profileNames[i], 
+                profileSummary_[i], 
+                quantiles[i]);
+    }
+    results.addPathwayProfile(
+            "density", 
+            densityProfile(), 
+            quantiles[eProfileDensity]);
+    results.addPathwayProfile(
+            "energy", 
+            energySummary, 
+            quantiles[eProfileEnergy]);
+    results.addPathwayProfileErrors("radius", radiusBlockAvg, radiusAutocorr);
+    results.addPathwayProfileErrors("energy", energyBlockAvg, energyAutocorr);
+    
+    // add scalar time series data to output:
+    results.addTimeStamps(timeStamps_);
+    for(size_t i : {eScalarArgMinRadius, eScalarMinRadius, eScalarLength, 
+                    eScalarVolume, eScalarNumPathway, eScalarNumSample, 
+                    eScalarArgMinSolventDensity, eScalarMinSolventDensity, 
+                    eScalarBandWidth})
+    {
+        results.addPathwayScalarTimeSeries(
+                scalarNames[i], 
+                scalarTimeSeries_[i]);
+    }
+
+    // add vector-valued time series data to output:
+    results.addPathwayGridPoints(timeStamps_, supportPoints_);
+    for(size_t i : {eProfileRadius, eProfileDensity, 
+                    eProfilePlHydrophobicity, eProfilePfHydrophobicity})
+    {
+        results.addPathwayProfileTimeSeries(
+                profileNames[i], 
+                profileTimeSeries_[i]);
+    }
+
+    // add per-residue data to output document:
+    results.addResidueInformation(poreResIds_, resInfo);
+    for(size_t i = 0; i < residueNames.size(); i++)
+    {
+        results.addResidueSummary(residueNames[i], residueSummary_[i]);
+    }
+}
+
+
+/*!
+ * Returns the pathway of the first frame with the time-averaged radius, 
+ * density, energy, and hydrophobicity profiles attached as scalar properties
+ * for visualisation.
+ */
+MolecularPath
+FrameAggregate::averagePath() const
+{
+    // retrieve averaged properties:
+    std::vector<real> supportPoints = supportPoints_;
+    std::vector<real> avgRadius = profileSummary_[eProfileRadius].mean();
+    std::vector<real> avgSolventDensity = densityProfile().mean();
+    ProfileSummaryStatistics energySummary = profileSummary_[eProfileEnergy];
+    energySummary.shift(energyShift());
+    std::vector<real> avgEnergy = energySummary.mean();
+    std::vector<real> avgPlHydrophobicity = 
+            profileSummary_[eProfilePlHydrophobicity].mean();
+    std::vector<real> avgPfHydrophobicity = 
+            profileSummary_[eProfilePfHydrophobicity].mean();
+
+    // averaged properties as spline curves:
+    CubicSplineInterp1D interp;
+    auto avgRadiusSpl = interp(
+            supportPoints, 
+            avgRadius, 
+            eSplineInterpBoundaryHermite);
+    auto avgSolventDensitySpl = interp(
+            supportPoints, 
+            avgSolventDensity, 
+            eSplineInterpBoundaryHermite);
+    auto avgEnergySpl = interp(
+            supportPoints, 
+            avgEnergy, 
+            eSplineInterpBoundaryHermite);
+    auto avgPlHydrophobicitySpl = interp(
+            supportPoints, 
+            avgPlHydrophobicity, 
+            eSplineInterpBoundaryHermite);
+    auto avgPfHydrophobicitySpl = interp(
+            supportPoints, 
+            avgPfHydrophobicity, 
+            eSplineInterpBoundaryHermite);
+
+    // associate properties with pathway:
+    MolecularPath molPath = molecularPath(firstFrame_);
+    molPath.addScalarProperty("avg_radius", avgRadiusSpl, false);
+    molPath.addScalarProperty("avg_density", avgSolventDensitySpl, false);
+    // FIXME: NaN energy values can not be exported to OBJ!
+    molPath.addScalarProperty("avg_energy", avgEnergySpl, false);
+    molPath.addScalarProperty(
+            "avg_pl_hydrophobicity", avgPlHydrophobicitySpl, true);
+    molPath.addScalarProperty(
+            "avg_pf_hydrophobicity", avgPfHydrophobicitySpl, true);
+
+    return molPath;
+}
+
+
+/*!
+ * Creates a MolecularPath from the pathway data of a frame read from the 
+ * stream file.
+ */
+MolecularPath
+FrameAggregate::molecularPath(
+        const FrameStreamData &frame)
+{
+    return MolecularPath(
+            frame.origPoints(),
+            frame.origPointsR_,
+            frame.radiusSpline_.knots_,
+            frame.radiusSpline_.ctrl_,
+            frame.centreLineKnots_,
+            frame.centreLineCtrlPoints());
+}
+
+
+/*
+ * Returns the given profile in the given frame.
+ */
+std::vector<real>
+FrameAggregate::profileRow(
+        size_t profile,
+        size_t frame) const
+{
+    size_t numPoints = supportPoints_.size();
+    auto begin = profileTimeSeries_[profile].begin() + frame*numPoints;
+    return std::vector<real>(begin, begin + numPoints);
+}
+
+
+/*
+ * Returns the shift of the energy profile required to make the mean energy
+ * at the anchor points zero.
+ */
+real
+FrameAggregate::energyShift() const
+{
+    return -0.5*(anchorEnergyLo_.mean() + anchorEnergyHi_.mean());
+}
+
+
+/*
+ * Returns the summary statistics of the solvent density profile. With a 
+ * trajectory-wide solvent histogram, the mean is replaced by the number 
+ * density calculated from this histogram, the time-averaged radius, and the
+ * average number of particles in the sample, while minimum, maximum, and 
+ * standard deviation still describe the per-frame densities.
+ */
+ProfileSummaryStatistics
+FrameAggregate::densityProfile() const
+{
+    if( !hasSolventHistogram_ || numFrames() == 0 )
+    {
+        return profileSummary_[eProfileDensity];
+    }
+
+    // probability density of all solvent positions at support points:
+    SplineCurve1D probabilityDensity = solventHistogram_.accumulatedDensity();
+    std::vector<real> density = probabilityDensity.evaluateMultiple(
+            supportPoints_, 
+            0);
+
+    // convert to number density using average number of particles:
+    // (scaled separately, as the total number may exceed the range of int)
+    NumberDensityCalculator ndc;
+    density = ndc(density, profileSummary_[eProfileRadius].mean(), 1);
+    real avgNumSample = static_cast<real>(
+            solventHistogram_.numAccumulatedSamples())/numFrames();
+    for(auto &d : density)
+    {
+        d *= avgNumSample;
+    }
+
+    // replace mean of per-frame densities:
+    const ProfileSummaryStatistics &perFrame = profileSummary_[eProfileDensity];
+    std::vector<SummaryStatistics> summary;
+    summary.reserve(perFrame.size());
+    for(size_t i = 0; i < perFrame.size(); i++)
+    {
+        if( perFrame.num(i) == 0 )
+        {
+            summary.push_back(perFrame.at(i));
+            continue;
+        }
+        summary.push_back(SummaryStatistics(
+                perFrame.min(i),
+                perFrame.max(i),
+                density[i],
+                perFrame.at(i).sumSquaredMeanDiff(),
+                perFrame.num(i)));
+    }
+    return ProfileSummaryStatistics(summary);
+}
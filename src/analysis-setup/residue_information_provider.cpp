@@ -162,6 +162,40 @@ ResidueInformationProvider::setDefaultHydrophobicity(const real hydrophobicity)
 }
 
 
+/*!
+ * Sets the name of the residue of given ID. This is used where no topology is
+ * available, e.g. when merging shard files.
+ */
+void
+ResidueInformationProvider::setName(const int id, const std::string &name)
+{
+    name_[id] = name;
+}
+
+
+/*!
+ * Sets the chain ID of the residue of given ID.
+ */
+void
+ResidueInformationProvider::setChain(const int id, const std::string &chain)
+{
+    chain_[id] = chain;
+}
+
+
+/*!
+ * Sets the hydrophobicity of all residues of the given name, overwriting any 
+ * existing lookup table entry.
+ */
+void
+ResidueInformationProvider::setHydrophobicity(
+        const std::string &name,
+        const real hydrophobicity)
+{
+    hydrophobicity_[name] = hydrophobicity;
+}
+
+
 /*!
  * Returns vector of all IDs for which a name is known.
  */
@@ -23,12 +23,10 @@
 
 
 #include <cmath>
+#include <stdexcept>
 
 #include "gromacs/analysisdata/dataframe.h"
 
-#include "external/rapidjson/stringbuffer.h"
-#include "external/rapidjson/writer.h"
-
 #include "io/analysis_data_json_frame_exporter.hpp"
 
 
@@ -46,155 +44,146 @@ AnalysisDataJsonFrameExporter::flags() const
 
 
 /*!
- * Currently, this will open a file to which JSON data will be written. If this
- * file already exists, its content will be deleted, otherwise the file will be
- * created empty. The file stream is closed before the end of this function and
- * will be reopened for each individual frame.
+ * Opens the file to which JSON data will be written. If this file already 
+ * exists, its content will be deleted, otherwise the file will be created 
+ * empty. The file remains open until dataFinished() is called. This also 
+ * prepares the arrays holding the values of each column.
  */
 void
 AnalysisDataJsonFrameExporter::dataStarted(
         gmx::AbstractAnalysisData* /* data */)
 {
     // open file and overwrite if it already exists:
-    file_.open(fileName_.c_str(), std::fstream::out);
-
-    // TODO: header?
+    file_.open(fileName_);
 
-    // close file:
-    file_.close();
+    // one value array per column:
+    values_.resize(dataSetNames_.size());
+    for(size_t i = 0; i < values_.size(); i++)
+    {
+        values_[i].resize(columnNames_.at(i).size());
+    }
 }
 
 
 /*!
- * This function resets the internal JSON document, adds a time stamp and frame
- * number to it, and prepares the objects and arrays that will hold all data.
- * It carries out no file system operations, which are handled by 
- * frameFinished() only.
+ * This function stores the time stamp and frame number and empties the value
+ * arrays of all columns without releasing their memory. It carries out no 
+ * file system operations, which are handled by frameFinished() only.
  */
 void
 AnalysisDataJsonFrameExporter::frameStarted(
         const gmx::AnalysisDataFrameHeader &frame)
 {   
-    // calling setObject will call destructor and deallocate data:
-    json_.SetObject();
-    rapidjson::Document::AllocatorType& allocator = json_.GetAllocator();
-
-    // add frame number and time stamp:
-    int i = frame.index();
-    real t = frame.x();
-    json_.AddMember("i", i, allocator);
-    json_.AddMember("t", t, allocator);
+    // frame number and time stamp:
+    frameIndex_ = frame.index();
+    frameTime_ = frame.x();
 
-    // add object for each data set:
-    for(auto it = dataSetNames_.begin(); it != dataSetNames_.end(); it++)
+    // clear values from previous frame:
+    for(auto &dataSet : values_)
     {
-        // create an empty dataset object to be filled when points are added:
-        rapidjson::Value dataSet;
-        dataSet.SetObject();
-
-        // loop over column names and add arrays for each column:
-        int colIdx = std::distance(dataSetNames_.begin(), it);
-        for(auto colName : columnNames_[colIdx])
+        for(auto &column : dataSet)
         {
-            // prepare array for column:
-            rapidjson::Value column;
-            column.SetArray();
-
-            // add to dataset object:
-            rapidjson::Value columnName(colName, allocator);
-            dataSet.AddMember(columnName, column, allocator);
+            column.clear();
         }
-
-        // add dataset to document:
-        rapidjson::Value dataSetName(*it, allocator);
-        json_.AddMember(dataSetName, dataSet, allocator);
     }
 }
 
 
 /*!
- * Will look for the correct data frame and for this point set in the JSON
- * document prepared by frameStarted() and adds data to all column arrays. This
- * function does not perform any file system operations, which are handled by
- * frameFinished() only.
- *
- * \todo Handle errors where data set or column names are missing.
+ * Appends the values in this point set to the arrays of the corresponding
+ * data set and columns. This function does not perform any file system 
+ * operations, which are handled by frameFinished() only.
  */
 void
 AnalysisDataJsonFrameExporter::pointsAdded(
         const gmx::AnalysisDataPointSetRef &points)
 {
-    // create an allocator:
-    rapidjson::Document::AllocatorType& allocator = json_.GetAllocator();
-
-    // obtain name of data set:
-    std::string dataSetName = dataSetNames_.at(points.dataSetIndex());    
+    // value arrays of this data set:
+    std::vector<std::vector<real>> &dataSet = values_.at(
+            points.dataSetIndex());
 
     // loop over all columns:
     for(size_t i = 0; i < points.values().size(); i++)
     {
-        // obtain name of column:
-        std::string columnName = columnNames_.at(points.dataSetIndex()).at(i);
-
         // sanity check:
-        if( std::isnan( points.values().at(i).value() ) )
+        real value = points.values()[i].value();
+        if( std::isnan(value) )
         {
-            throw std::runtime_error("Data value " + dataSetName + "/" + columnName + " is NaN and can not be "
-                                     "written to JSON file.");
+            throw std::runtime_error("Data value " + 
+                    dataSetNames_.at(points.dataSetIndex()) + "/" + 
+                    columnNames_.at(points.dataSetIndex()).at(i) + 
+                    " is NaN and can not be written to JSON file.");
         }
 
         // add value to column array:
-        rapidjson::Value val( points.values().at(i).value() );
-        json_[dataSetName][columnName].PushBack(val, allocator);
+        dataSet.at(i).push_back(value);
     }   
 }
 
 
 /*!
- * Opens the file to which the JSON data will be written. The file is opened
- * in append mode after having been created/cleared by dataStarted(). The 
- * JSON document created in frameStarted() is stringified and the resulting 
- * string is streamed to the file. A new line character is also added. 
- *
- * This function handles all file system operations (i.e. opening and closing 
- * of the file and writing a string to it) and does not manipulate the JSON
- * document prepared by startFrame() and pointsAdded(). Spliiting the 
- * functionality in this way should make clean error handling possible.
- *
- * \todo Check validity of JSON document before writing.
- * \todo Check that file write was successful.
+ * Serialises the current frame as a single line of JSON into the buffer of 
+ * the file writer, which passes it on to its writer thread once enough data
+ * has accumulated. The output is identical to that of stringifying a JSON
+ * document with the frame number and time stamp followed by one object per 
+ * data set holding one array per column.
  */
 void
 AnalysisDataJsonFrameExporter::frameFinished(
         const gmx::AnalysisDataFrameHeader& /*frame*/)
 {
-    // open output file separately for each frame:
-    file_.open(fileName_.c_str(), std::fstream::app);
+    // write frame directly into file buffer:
+    writer_.Reset(file_.buffer());
+    bool success = writer_.StartObject();
 
-    // create buffer writer string writer:
-    rapidjson::StringBuffer buffer;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-    json_.Accept(writer);
+    // add frame number and time stamp:
+    success = success && writer_.Key("i") && writer_.Int(frameIndex_);
+    success = success && writer_.Key("t") && writer_.Double(frameTime_);
 
-    // stringify JSON document and add it to file as new line:
-    std::string jsonLine(buffer.GetString(), buffer.GetSize());
-    file_<<jsonLine<<std::endl;
+    // add object for each data set:
+    for(size_t i = 0; i < values_.size(); i++)
+    {
+        success = success && writer_.Key(dataSetNames_[i]);
+        success = success && writer_.StartObject();
 
-    // TODO: should probably check if write was successful
+        // add array for each column:
+        for(size_t j = 0; j < values_[i].size(); j++)
+        {
+            success = success && writer_.Key(columnNames_[i][j]);
+            success = success && writer_.StartArray();
+            for(auto value : values_[i][j])
+            {
+                success = success && writer_.Double(value);
+            }
+            success = success && writer_.EndArray();
+        }
 
-    // close output file:
-    file_.close();
+        success = success && writer_.EndObject();
+    }
+    success = success && writer_.EndObject();
+
+    // sanity check:
+    // (writer will refuse to write infinite values)
+    if( !success )
+    {
+        throw std::runtime_error("Could not write frame " + 
+                std::to_string(frameIndex_) + " to JSON file.");
+    }
+
+    // terminate line and pass buffer to writer thread if it is full:
+    file_.buffer().Put('\n');
+    file_.commit();
 }
 
 
 /*!
- * Currently this does nothing and is implemented only because this is a pure
- * virtual function of the base class.
+ * Writes all remaining data to the file and closes it. Data for all frames is
+ * guaranteed to be in the file only after this function has returned.
  */
 void
 AnalysisDataJsonFrameExporter::dataFinished()
 {
-
+    file_.close();
 }
 
 
@@ -0,0 +1,286 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <stdexcept>
+#include <utility>
+
+#include "io/async_file_writer.hpp"
+
+
+/*!
+ * Constructor. The buffer size determines how many characters are collected
+ * before a buffer is handed to the writer thread, while the maximum queue 
+ * length limits how many full buffers can be waiting to be written.
+ */
+AsyncFileWriter::AsyncFileWriter(
+        size_t bufferSize,
+        size_t maxQueueLength)
+    : bufferSize_(bufferSize)
+    , maxQueueLength_(maxQueueLength)
+    , buffer_(new rapidjson::StringBuffer())
+    , finished_(false)
+    , writeFailed_(false)
+{
+    // sanity check:
+    if( maxQueueLength_ == 0 )
+    {
+        throw std::logic_error("Writer queue length must be positive!");
+    }
+}
+
+
+/*!
+ * Destructor. Stops the writer thread if close() has not been called, e.g. 
+ * because an exception was thrown during the analysis. Pending buffers are 
+ * still written to the file in this case, but errors are ignored.
+ */
+AsyncFileWriter::~AsyncFileWriter()
+{
+    if( writerThread_.joinable() )
+    {
+        handOverBuffer();
+        stopWriterThread();
+    }
+}
+
+
+/*!
+ * Opens the given file for writing and starts the writer thread. If the file
+ * already exists, its content will be deleted, otherwise the file will be 
+ * created empty.
+ */
+void
+AsyncFileWriter::open(
+        const std::string &fileName)
+{
+    // sanity check:
+    if( writerThread_.joinable() )
+    {
+        throw std::logic_error("File " + fileName_ + " is still open.");
+    }
+
+    // open file and overwrite if it already exists:
+    fileName_ = fileName;
+    file_.open(fileName_.c_str(), std::ofstream::out | std::ofstream::trunc);
+    if( !file_.is_open() )
+    {
+        throw std::runtime_error("ERROR: Could not open file " + fileName_ + 
+                                 ".");
+    }
+
+    // start writer thread:
+    buffer_ -> Clear();
+    finished_ = false;
+    writeFailed_ = false;
+    writerThread_ = std::thread(&AsyncFileWriter::writeLoop, this);
+}
+
+
+/*!
+ * Writes any remaining content of the buffer to the file, waits for the
+ * writer thread to finish, and closes the file.
+ */
+void
+AsyncFileWriter::close()
+{
+    if( !writerThread_.joinable() )
+    {
+        return;
+    }
+
+    // write remaining data and stop writer thread:
+    handOverBuffer();
+    stopWriterThread();
+
+    // close file and check that all writes succeeded:
+    file_.close();
+    checkWriteErrors();
+}
+
+
+/*!
+ * Returns true if the file is open, i.e. if open() has been called but 
+ * close() has not.
+ */
+bool
+AsyncFileWriter::isOpen() const
+{
+    return file_.is_open();
+}
+
+
+/*!
+ * Returns the buffer to which output should be written. The buffer may change
+ * after each call to commit() or flush(), so references to it should not be 
+ * held on to across these calls.
+ */
+rapidjson::StringBuffer&
+AsyncFileWriter::buffer()
+{
+    return *buffer_;
+}
+
+
+/*!
+ * Hands the current buffer over to the writer thread if it contains at least
+ * as many characters as the buffer size given on construction. This should
+ * be called after each complete record (e.g. one line of a file), so that 
+ * records are not split across buffers.
+ */
+void
+AsyncFileWriter::commit()
+{
+    if( buffer_ -> GetSize() >= bufferSize_ )
+    {
+        flush();
+    }
+}
+
+
+/*!
+ * Hands the current buffer over to the writer thread regardless of its size
+ * and replaces it with an empty one. Blocks if the queue of buffers waiting
+ * to be written is full.
+ */
+void
+AsyncFileWriter::flush()
+{
+    handOverBuffer();
+
+    // report errors as early as possible:
+    checkWriteErrors();
+}
+
+
+/*!
+ * Auxiliary function that moves the current buffer to the queue of filled 
+ * buffers and obtains a new one, reusing memory of already written buffers 
+ * if possible. Does not throw on write errors so that it can be used from the
+ * destructor.
+ */
+void
+AsyncFileWriter::handOverBuffer()
+{
+    // nothing to do for empty buffer or if writer is not running:
+    if( buffer_ -> GetSize() == 0 || !writerThread_.joinable() )
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // wait until there is space in the queue:
+    bufferWritten_.wait(lock, [this]{
+            return filledBuffers_.size() < maxQueueLength_;});
+
+    // pass buffer to writer thread:
+    filledBuffers_.push_back(std::move(buffer_));
+
+    // obtain new buffer:
+    if( freeBuffers_.empty() )
+    {
+        buffer_.reset(new rapidjson::StringBuffer());
+    }
+    else
+    {
+        buffer_ = std::move(freeBuffers_.front());
+        freeBuffers_.pop_front();
+    }
+
+    // wake up writer thread:
+    lock.unlock();
+    bufferFilled_.notify_one();
+}
+
+
+/*!
+ * Main loop of the writer thread. Waits for filled buffers, writes their 
+ * content to the file, and returns them to the pool of free buffers. The 
+ * file is not accessed by any other thread while this is running.
+ */
+void
+AsyncFileWriter::writeLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while( true )
+    {
+        // wait for data or termination:
+        bufferFilled_.wait(lock, [this]{
+                return !filledBuffers_.empty() || finished_;});
+        if( filledBuffers_.empty() )
+        {
+            break;
+        }
+
+        // take buffer from queue:
+        std::unique_ptr<rapidjson::StringBuffer> buffer = std::move(
+                filledBuffers_.front());
+        filledBuffers_.pop_front();
+
+        // write without holding the lock:
+        lock.unlock();
+        file_.write(buffer -> GetString(), buffer -> GetSize());
+        bool writeFailed = !file_.good();
+        buffer -> Clear();
+        lock.lock();
+
+        // return buffer for reuse:
+        writeFailed_ = writeFailed_ || writeFailed;
+        freeBuffers_.push_back(std::move(buffer));
+        bufferWritten_.notify_one();
+    }
+}
+
+
+/*!
+ * Signals the writer thread that no more data will arrive and waits for it to
+ * write all remaining buffers.
+ */
+void
+AsyncFileWriter::stopWriterThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finished_ = true;
+    }
+    bufferFilled_.notify_one();
+    writerThread_.join();
+}
+
+
+/*!
+ * Throws an exception if the writer thread failed to write to the file.
+ */
+void
+AsyncFileWriter::checkWriteErrors()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if( writeFailed_ )
+    {
+        throw std::runtime_error("ERROR: Could not write to file " + 
+                                 fileName_ + ".");
+    }
+}
+
@@ -0,0 +1,484 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <gromacs/math/vec.h>
+
+#include "io/async_trajectory_reader.hpp"
+
+
+/*!
+ * Constructor. The number of buffers determines how many frames the reader
+ * thread may decode ahead of the calling thread.
+ */
+AsyncTrajectoryReader::AsyncTrajectoryReader(
+        size_t numBuffers)
+    : isOpen_(false)
+    , oenv_(nullptr)
+    , status_(nullptr)
+    , useXtcReader_(false)
+    , nextXtcFrame_(0)
+    , maxAtoms_(0)
+    , beginTime_(std::numeric_limits<real>::lowest())
+    , endTime_(std::numeric_limits<real>::max())
+    , deltaTime_(0.0)
+    , buffers_(numBuffers)
+    , firstFilled_(0)
+    , numFilled_(0)
+    , holdsFrame_(false)
+    , endOfFile_(false)
+    , stopped_(false)
+{
+    // sanity check:
+    if( numBuffers == 0 )
+    {
+        throw std::logic_error("Number of frame buffers must be positive!");
+    }
+}
+
+
+/*!
+ * Destructor. Stops the reader thread and closes the trajectory if close() 
+ * has not been called, e.g. because an exception was thrown during the 
+ * analysis.
+ */
+AsyncTrajectoryReader::~AsyncTrajectoryReader()
+{
+    close();
+}
+
+
+/*!
+ * Sets the number of atoms whose coordinates are decoded from each frame of
+ * an XTC file. Coordinates of atoms with an index of at least this number 
+ * may be left at zero. If the number is not positive, all atoms are 
+ * decoded. Takes effect when the next trajectory is opened.
+ */
+void
+AsyncTrajectoryReader::setMaxAtoms(
+        int numAtoms)
+{
+    maxAtoms_ = numAtoms;
+}
+
+
+/*!
+ * Sets the range of time stamps of the frames read from an XTC file. Only 
+ * frames from begin to end are read and of these only frames whose time 
+ * differs from that of the first frame read by a multiple of dt, if dt is 
+ * positive. This follows the meaning of the -b, -e, and -dt options of the 
+ * Gromacs trajectory analysis framework. Takes effect when the next 
+ * trajectory is opened.
+ */
+void
+AsyncTrajectoryReader::setTimeRange(
+        real begin,
+        real end,
+        real dt)
+{
+    beginTime_ = begin;
+    endTime_ = end;
+    deltaTime_ = dt;
+}
+
+
+/*!
+ * Opens the given trajectory, reads its first frame on the calling thread, 
+ * so that errors in opening the file are reported immediately, and starts 
+ * the reader thread. All frame buffers are allocated here for the number of
+ * atoms in the first frame.
+ */
+void
+AsyncTrajectoryReader::open(
+        const std::string &fileName)
+{
+    // sanity check:
+    if( isOpen_ )
+    {
+        throw std::logic_error("Trajectory " + fileName_ + " is still open.");
+    }
+
+    // read first frame:
+    fileName_ = fileName;
+    useXtcReader_ = XtcReader::isXtcFile(fileName_);
+    if( useXtcReader_ )
+    {
+        openXtcFile();
+    }
+    else
+    {
+        openTrajectory();
+    }
+    firstFilled_ = 0;
+    numFilled_ = 1;
+    holdsFrame_ = false;
+    endOfFile_ = false;
+    stopped_ = false;
+    readError_ = nullptr;
+    isOpen_ = true;
+
+    // start reader thread:
+    readerThread_ = std::thread(&AsyncTrajectoryReader::readLoop, this);
+}
+
+
+/*!
+ * Stops the reader thread and closes the trajectory. Frames obtained from 
+ * nextFrame() are invalid afterwards.
+ */
+void
+AsyncTrajectoryReader::close()
+{
+    if( !isOpen_ )
+    {
+        return;
+    }
+
+    // stop reader thread before file is closed:
+    stopReaderThread();
+    isOpen_ = false;
+
+    // XTC files are read without Gromacs resources:
+    if( useXtcReader_ )
+    {
+        xtcReader_.close();
+        return;
+    }
+
+    // free Gromacs resources:
+    close_trx(status_);
+    done_frame(&decodedFrame_);
+    output_env_done(oenv_);
+    status_ = nullptr;
+    oenv_ = nullptr;
+}
+
+
+/*
+ * Opens a trajectory with the Gromacs trajectory I/O, allocates the frame 
+ * buffers, and copies the first frame into the first buffer.
+ */
+void
+AsyncTrajectoryReader::openTrajectory()
+{
+    // read first frame:
+    // (Gromacs may also throw if the file can not be opened)
+    output_env_init_default(&oenv_);
+    bool frameDecoded = false;
+    try
+    {
+        frameDecoded = read_first_frame(
+                oenv_, 
+                &status_, 
+                fileName_.c_str(), 
+                &decodedFrame_, 
+                TRX_NEED_X);
+    }
+    catch(...)
+    {
+        frameDecoded = false;
+    }
+    if( !frameDecoded )
+    {
+        output_env_done(oenv_);
+        oenv_ = nullptr;
+        status_ = nullptr;
+        throw std::runtime_error("ERROR: Could not read first frame of "
+                                 "trajectory " + fileName_ + ".");
+    }
+
+    // allocate buffers and store first frame:
+    for(auto &buffer : buffers_)
+    {
+        buffer.x_.resize(decodedFrame_.natoms);
+    }
+    copyFrame(decodedFrame_, buffers_.front());
+}
+
+
+/*
+ * Opens an XTC file with the XtcReader, selects the frames in the time 
+ * range from its frame index, allocates the frame buffers, and decodes the 
+ * first selected frame into the first buffer.
+ */
+void
+AsyncTrajectoryReader::openXtcFile()
+{
+    xtcReader_.open(fileName_);
+    try
+    {
+        // select frames by time stamp:
+        selectXtcFrames();
+        if( xtcFrames_.empty() )
+        {
+            throw std::runtime_error("ERROR: No frame of trajectory " + 
+                                     fileName_ + " is within the selected "
+                                     "time range.");
+        }
+
+        // allocate buffers and decode first frame:
+        for(auto &buffer : buffers_)
+        {
+            buffer.x_.assign(xtcReader_.numAtoms(), gmx::RVec(0.0, 0.0, 0.0));
+        }
+        readXtcFrame(xtcFrames_.front(), buffers_.front());
+        nextXtcFrame_ = 1;
+    }
+    catch(...)
+    {
+        xtcReader_.close();
+        throw;
+    }
+}
+
+
+/*
+ * Selects the frames of an XTC file within the time range from the time 
+ * stamps in the frame index. As in the Gromacs time control, reading stops
+ * at the first frame after the end time and the time step is counted from
+ * the first frame read.
+ */
+void
+AsyncTrajectoryReader::selectXtcFrames()
+{
+    xtcFrames_.clear();
+    for(size_t i = 0; i < xtcReader_.numFrames(); i++)
+    {
+        real time = xtcReader_.time(i);
+        if( time < beginTime_ )
+        {
+            continue;
+        }
+        if( time > endTime_ )
+        {
+            break;
+        }
+        if( deltaTime_ > 0.0 && !xtcFrames_.empty() )
+        {
+            // allow for rounding of time stamps:
+            double numSteps = (time - xtcReader_.time(xtcFrames_.front())) / 
+                              deltaTime_;
+            if( std::fabs(numSteps - std::round(numSteps)) > 1e-3 )
+            {
+                continue;
+            }
+        }
+        xtcFrames_.push_back(i);
+    }
+}
+
+
+/*
+ * Decodes the given frame of an XTC file directly into a frame buffer, 
+ * limited to the maximum number of atoms.
+ */
+void
+AsyncTrajectoryReader::readXtcFrame(
+        size_t frame,
+        FrameBuffer &target)
+{
+    t_trxframe &fr = target.frame_;
+    fr = t_trxframe();
+    std::int64_t step;
+    xtcReader_.readFrame(
+            frame, 
+            maxAtoms_, 
+            step, 
+            fr.time, 
+            fr.box, 
+            as_rvec_array(target.x_.data()));
+    fr.natoms = static_cast<int>(target.x_.size());
+    fr.bStep = TRUE;
+    fr.step = step;
+    fr.bTime = TRUE;
+    fr.bBox = TRUE;
+    fr.bX = TRUE;
+    fr.x = as_rvec_array(target.x_.data());
+}
+
+
+/*!
+ * Returns the next frame of the trajectory, blocking until it has been 
+ * decoded, or a null pointer if the end of the trajectory has been reached.
+ * The frame returned by the previous call is released to the reader thread
+ * and must no longer be accessed.
+ */
+const t_trxframe*
+AsyncTrajectoryReader::nextFrame()
+{
+    // sanity check:
+    if( !isOpen_ )
+    {
+        throw std::logic_error("No trajectory is open.");
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // release previous frame:
+    if( holdsFrame_ )
+    {
+        firstFilled_ = (firstFilled_ + 1) % buffers_.size();
+        numFilled_--;
+        holdsFrame_ = false;
+        frameReleased_.notify_one();
+    }
+
+    // wait for next frame:
+    frameRead_.wait(lock, [this]{
+            return numFilled_ > 0 || endOfFile_;});
+    if( numFilled_ == 0 )
+    {
+        if( readError_ )
+        {
+            std::rethrow_exception(readError_);
+        }
+        return nullptr;
+    }
+
+    holdsFrame_ = true;
+    return &buffers_[firstFilled_].frame_;
+}
+
+
+/*!
+ * Main loop of the reader thread. Decodes frames into a frame owned by this
+ * thread and copies them into the next free buffer of the ring, or in case
+ * of XTC files decodes them directly into the next free buffer. The 
+ * trajectory file is not accessed by any other thread while this is running.
+ */
+void
+AsyncTrajectoryReader::readLoop()
+{
+    try
+    {
+        while( true )
+        {
+            // decode next frame without holding the lock:
+            // (XTC frames are decoded once a buffer is free)
+            bool frameDecoded = useXtcReader_
+                    ? nextXtcFrame_ < xtcFrames_.size()
+                    : read_next_frame(oenv_, status_, &decodedFrame_);
+
+            // wait for free buffer:
+            std::unique_lock<std::mutex> lock(mutex_);
+            if( !frameDecoded )
+            {
+                break;
+            }
+            frameReleased_.wait(lock, [this]{
+                    return numFilled_ < buffers_.size() || stopped_;});
+            if( stopped_ )
+            {
+                return;
+            }
+
+            // free buffers are not accessed by the calling thread:
+            FrameBuffer &buffer = 
+                    buffers_[(firstFilled_ + numFilled_) % buffers_.size()];
+            lock.unlock();
+            if( useXtcReader_ )
+            {
+                readXtcFrame(xtcFrames_[nextXtcFrame_++], buffer);
+            }
+            else
+            {
+                copyFrame(decodedFrame_, buffer);
+            }
+            lock.lock();
+
+            // pass frame to calling thread:
+            numFilled_++;
+            frameRead_.notify_one();
+        }
+    }
+    catch(...)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        readError_ = std::current_exception();
+    }
+
+    // signal end of trajectory:
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        endOfFile_ = true;
+    }
+    frameRead_.notify_one();
+}
+
+
+/*!
+ * Copies time, step, box, and coordinates of a decoded frame into a frame
+ * buffer. Velocities and forces are not kept.
+ */
+void
+AsyncTrajectoryReader::copyFrame(
+        const t_trxframe &source,
+        FrameBuffer &target)
+{
+    // sanity check:
+    if( source.natoms != static_cast<int>(target.x_.size()) )
+    {
+        throw std::runtime_error("ERROR: Number of atoms changes within "
+                                 "trajectory " + fileName_ + ".");
+    }
+
+    // copy header and coordinates:
+    target.frame_ = source;
+    for(int i = 0; i < source.natoms; i++)
+    {
+        copy_rvec(source.x[i], target.x_[i]);
+    }
+    target.frame_.x = as_rvec_array(target.x_.data());
+
+    // velocities and forces are owned by the decoded frame:
+    target.frame_.bV = FALSE;
+    target.frame_.v = nullptr;
+    target.frame_.bF = FALSE;
+    target.frame_.f = nullptr;
+}
+
+
+/*!
+ * Signals the reader thread to stop and waits for it to finish.
+ */
+void
+AsyncTrajectoryReader::stopReaderThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+    }
+    frameReleased_.notify_one();
+    if( readerThread_.joinable() )
+    {
+        readerThread_.join();
+    }
+}
@@ -0,0 +1,165 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "io/binary_buffer.hpp"
+
+
+/*!
+ * Reserves memory for the given number of bytes.
+ */
+void
+BinaryBuffer::reserve(size_t size)
+{
+    data_.reserve(size);
+}
+
+
+/*!
+ * Appends a single byte.
+ */
+void
+BinaryBuffer::appendUint8(uint8_t value)
+{
+    data_.push_back(static_cast<char>(value));
+}
+
+
+/*!
+ * Appends an unsigned 32 bit integer in little endian byte order.
+ */
+void
+BinaryBuffer::appendUint32(uint32_t value)
+{
+    char bytes[4];
+    bytes[0] = static_cast<char>(value & 0xFF);
+    bytes[1] = static_cast<char>((value >> 8) & 0xFF);
+    bytes[2] = static_cast<char>((value >> 16) & 0xFF);
+    bytes[3] = static_cast<char>((value >> 24) & 0xFF);
+    data_.append(bytes, 4);
+}
+
+
+/*!
+ * Appends a single precision IEEE 754 floating point number in little endian
+ * byte order.
+ */
+void
+BinaryBuffer::appendFloat(float value)
+{
+    // reinterpret bit pattern as integer:
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    appendUint32(bits);
+}
+
+
+/*!
+ * Appends the characters of a string (without terminating null character).
+ */
+void
+BinaryBuffer::appendString(const std::string &str)
+{
+    data_.append(str);
+}
+
+
+/*!
+ * Appends fill characters until the buffer size is a multiple of the given
+ * alignment.
+ */
+void
+BinaryBuffer::pad(size_t alignment, char fill)
+{
+    size_t padding = (alignment - data_.size() % alignment) % alignment;
+    data_.append(padding, fill);
+}
+
+
+/*!
+ * Returns the buffer content.
+ */
+const std::string&
+BinaryBuffer::data() const
+{
+    return data_;
+}
+
+
+/*!
+ * Returns the number of bytes in the buffer.
+ */
+size_t
+BinaryBuffer::size() const
+{
+    return data_.size();
+}
+
+
+/*!
+ * Writes the buffer content to a binary file of the given name.
+ */
+void
+BinaryBuffer::write(const std::string &fileName) const
+{
+    write(fileName, {this});
+}
+
+
+/*!
+ * Writes the content of several buffers to a binary file of the given name, 
+ * one after the other. This avoids concatenating large buffers in memory 
+ * before writing them.
+ */
+void
+BinaryBuffer::write(
+        const std::string &fileName,
+        const std::vector<const BinaryBuffer*> &buffers)
+{
+    std::ofstream file(
+            fileName.c_str(), 
+            std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    if( !file.is_open() )
+    {
+        throw std::runtime_error("ERROR: Could not open file " + 
+                                 fileName + ".");
+    }
+
+    for(auto buffer : buffers)
+    {
+        file.write(buffer -> data_.data(), buffer -> data_.size());
+    }
+    file.close();
+    if( file.fail() )
+    {
+        throw std::runtime_error("ERROR: Could not write to file " + 
+                                 fileName + ".");
+    }
+}
+
@@ -0,0 +1,522 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include "io/frame_stream_reader.hpp"
+
+
+/*!
+ * Returns the original path points as a vector of three-dimensional vectors.
+ */
+std::vector<gmx::RVec>
+FrameStreamData::origPoints() const
+{
+    std::vector<gmx::RVec> points;
+    points.reserve(origPointsX_.size());
+    for(size_t i = 0; i < origPointsX_.size(); i++)
+    {
+        points.push_back(gmx::RVec(
+                origPointsX_[i], 
+                origPointsY_.at(i), 
+                origPointsZ_.at(i)));
+    }
+    return points;
+}
+
+
+/*!
+ * Returns the control points of the centre line spline as a vector of 
+ * three-dimensional vectors.
+ */
+std::vector<gmx::RVec>
+FrameStreamData::centreLineCtrlPoints() const
+{
+    std::vector<gmx::RVec> points;
+    points.reserve(centreLineCtrlX_.size());
+    for(size_t i = 0; i < centreLineCtrlX_.size(); i++)
+    {
+        points.push_back(gmx::RVec(
+                centreLineCtrlX_[i], 
+                centreLineCtrlY_.at(i), 
+                centreLineCtrlZ_.at(i)));
+    }
+    return points;
+}
+
+
+/*!
+ * Empties all arrays while retaining their capacity.
+ */
+void
+FrameStreamData::clear()
+{
+    std::vector<std::vector<real>*> arrays = {
+            &origPointsX_, &origPointsY_, &origPointsZ_, &origPointsR_,
+            &radiusSpline_.knots_, &radiusSpline_.ctrl_,
+            &centreLineKnots_, 
+            &centreLineCtrlX_, &centreLineCtrlY_, &centreLineCtrlZ_,
+            &resId_, &resS_, &resRho_, &resPhi_, 
+            &resPoreLining_, &resPoreFacing_, 
+            &resPoreRadius_, &resSolventDensity_,
+            &resX_, &resY_, &resZ_,
+            &solventS_, &solventInPore_, &solventInSample_,
+            &solventDensitySpline_.knots_, &solventDensitySpline_.ctrl_,
+            &plHydrophobicitySpline_.knots_, &plHydrophobicitySpline_.ctrl_,
+            &pfHydrophobicitySpline_.knots_, &pfHydrophobicitySpline_.ctrl_};
+    for(auto array : arrays)
+    {
+        array -> clear();
+    }
+}
+
+
+/*!
+ * \brief Destination of the values in one column of the stream file.
+ *
+ * Exactly one of array_ and scalar_ is set, depending on whether the column
+ * holds an array or a single value per frame.
+ */
+struct FrameStreamTarget
+{
+    const char *dataSet_;
+    const char *column_;
+    std::vector<real> *array_;
+    real *scalar_;
+};
+
+
+/*
+ * Auxiliary function that decides whether a column depends on the density
+ * estimation or hydrophobicity parameters, i.e. whether it is also written
+ * for each parameter set of a sweep.
+ */
+static bool
+isSweptColumn(const FrameStreamTarget &target)
+{
+    if( std::strcmp(target.dataSet_, "pathSummary") == 0 )
+    {
+        return std::strcmp(target.column_, "solventRangeLo") == 0 ||
+               std::strcmp(target.column_, "solventRangeHi") == 0 ||
+               std::strcmp(target.column_, "argMinSolventDensity") == 0 ||
+               std::strcmp(target.column_, "minSolventDensity") == 0 ||
+               std::strcmp(target.column_, "bandWidth") == 0;
+    }
+    if( std::strcmp(target.dataSet_, "residuePositions") == 0 )
+    {
+        return std::strcmp(target.column_, "solventDensity") == 0;
+    }
+    return std::strcmp(target.dataSet_, "solventDensitySpline") == 0 ||
+           std::strcmp(target.dataSet_, "plHydrophobicitySpline") == 0 ||
+           std::strcmp(target.dataSet_, "pfHydrophobicitySpline") == 0;
+}
+
+
+/*!
+ * \brief SAX handler that copies selected values from a single line of the 
+ * stream file into a FrameStreamData object.
+ *
+ * The handler keeps track of the current data set name and, upon 
+ * encountering a column key, looks up the member of FrameStreamData that 
+ * values in this column should be written to. Columns without a 
+ * corresponding member are skipped. The solvent positions are only 
+ * extracted (and required) if requested. If a data set suffix is given, 
+ * columns that depend on the density and hydrophobicity parameters are read
+ * from the correspondingly suffixed data sets instead.
+ */
+class FrameStreamSaxHandler 
+    : public rapidjson::BaseReaderHandler<
+            rapidjson::UTF8<>, 
+            FrameStreamSaxHandler>
+{
+    public:
+
+        /*!
+         * Constructor. Sets up the table of columns to be extracted into the
+         * given frame.
+         */
+        FrameStreamSaxHandler(
+                FrameStreamData &frame, 
+                bool readSolvent,
+                const std::string &dataSetSuffix)
+            : frame_(frame)
+            , targets_{{
+                {"pathSummary", "timeStamp", nullptr, &frame.timeStamp_},
+                {"pathSummary", "argMinRadius", nullptr, &frame.argMinRadius_},
+                {"pathSummary", "minRadius", nullptr, &frame.minRadius_},
+                {"pathSummary", "length", nullptr, &frame.length_},
+                {"pathSummary", "volume", nullptr, &frame.volume_},
+                {"pathSummary", "numPath", nullptr, &frame.numPath_},
+                {"pathSummary", "numSample", nullptr, &frame.numSample_},
+                {"pathSummary", "solventRangeLo", nullptr, 
+                 &frame.solventRangeLo_},
+                {"pathSummary", "solventRangeHi", nullptr, 
+                 &frame.solventRangeHi_},
+                {"pathSummary", "argMinSolventDensity", nullptr, 
+                 &frame.argMinSolventDensity_},
+                {"pathSummary", "minSolventDensity", nullptr, 
+                 &frame.minSolventDensity_},
+                {"pathSummary", "arcLengthLo", nullptr, &frame.arcLengthLo_},
+                {"pathSummary", "arcLengthHi", nullptr, &frame.arcLengthHi_},
+                {"pathSummary", "bandWidth", nullptr, &frame.bandWidth_},
+                {"molPathOrigPoints", "x", &frame.origPointsX_, nullptr},
+                {"molPathOrigPoints", "y", &frame.origPointsY_, nullptr},
+                {"molPathOrigPoints", "z", &frame.origPointsZ_, nullptr},
+                {"molPathOrigPoints", "r", &frame.origPointsR_, nullptr},
+                {"molPathRadiusSpline", "knots", 
+                 &frame.radiusSpline_.knots_, nullptr},
+                {"molPathRadiusSpline", "ctrl", 
+                 &frame.radiusSpline_.ctrl_, nullptr},
+                {"molPathCentreLineSpline", "knots", 
+                 &frame.centreLineKnots_, nullptr},
+                {"molPathCentreLineSpline", "ctrlX", 
+                 &frame.centreLineCtrlX_, nullptr},
+                {"molPathCentreLineSpline", "ctrlY", 
+                 &frame.centreLineCtrlY_, nullptr},
+                {"molPathCentreLineSpline", "ctrlZ", 
+                 &frame.centreLineCtrlZ_, nullptr},
+                {"residuePositions", "resId", &frame.resId_, nullptr},
+                {"residuePositions", "s", &frame.resS_, nullptr},
+                {"residuePositions", "rho", &frame.resRho_, nullptr},
+                {"residuePositions", "phi", &frame.resPhi_, nullptr},
+                {"residuePositions", "poreLining", 
+                 &frame.resPoreLining_, nullptr},
+                {"residuePositions", "poreFacing", 
+                 &frame.resPoreFacing_, nullptr},
+                {"residuePositions", "poreRadius", 
+                 &frame.resPoreRadius_, nullptr},
+                {"residuePositions", "solventDensity", 
+                 &frame.resSolventDensity_, nullptr},
+                {"residuePositions", "x", &frame.resX_, nullptr},
+                {"residuePositions", "y", &frame.resY_, nullptr},
+                {"residuePositions", "z", &frame.resZ_, nullptr},
+                {"solventDensitySpline", "knots", 
+                 &frame.solventDensitySpline_.knots_, nullptr},
+                {"solventDensitySpline", "ctrl", 
+                 &frame.solventDensitySpline_.ctrl_, nullptr},
+                {"plHydrophobicitySpline", "knots", 
+                 &frame.plHydrophobicitySpline_.knots_, nullptr},
+                {"plHydrophobicitySpline", "ctrl", 
+                 &frame.plHydrophobicitySpline_.ctrl_, nullptr},
+                {"pfHydrophobicitySpline", "knots", 
+                 &frame.pfHydrophobicitySpline_.knots_, nullptr},
+                {"pfHydrophobicitySpline", "ctrl", 
+                 &frame.pfHydrophobicitySpline_.ctrl_, nullptr},
+                {"solventPositions", "s", &frame.solventS_, nullptr},
+                {"solventPositions", "inPore", 
+                 &frame.solventInPore_, nullptr},
+                {"solventPositions", "inSample", 
+                 &frame.solventInSample_, nullptr}}}
+            , numTargets_(readSolvent ? targets_.size() : 
+                                        targets_.size() - 3)
+            , depth_(0)
+            , dataSet_(nullptr)
+            , array_(nullptr)
+            , scalar_(nullptr)
+            , frameIndexNext_(false)
+            , numColumnsFound_(0)
+        {
+            for(size_t i = 0; i < targets_.size(); i++)
+            {
+                dataSetNames_[i] = targets_[i].dataSet_;
+                if( isSweptColumn(targets_[i]) )
+                {
+                    dataSetNames_[i] += dataSetSuffix;
+                }
+            }
+        }
+
+        /*!
+         * Returns true if values for all columns of interest were found.
+         */
+        bool complete() const
+        {
+            return numColumnsFound_ == numTargets_;
+        }
+
+        // SAX interface:
+        bool StartObject()
+        {
+            depth_++;
+            return true;
+        }
+
+        bool EndObject(rapidjson::SizeType /*memberCount*/)
+        {
+            depth_--;
+            return true;
+        }
+
+        bool EndArray(rapidjson::SizeType /*elementCount*/)
+        {
+            array_ = nullptr;
+            scalar_ = nullptr;
+            return true;
+        }
+
+        bool Key(const char *str, rapidjson::SizeType /*length*/, bool /*copy*/)
+        {
+            array_ = nullptr;
+            scalar_ = nullptr;
+            frameIndexNext_ = false;
+
+            // frame number, time stamp, or name of data set:
+            if( depth_ == 1 )
+            {
+                if( std::strcmp(str, "i") == 0 )
+                {
+                    frameIndexNext_ = true;
+                }
+                else if( std::strcmp(str, "t") == 0 )
+                {
+                    scalar_ = &frame_.frameTime_;
+                }
+                else
+                {
+                    // only the data sets of interest need to be recognised:
+                    dataSet_ = nullptr;
+                    for(size_t i = 0; i < numTargets_; i++)
+                    {
+                        if( dataSetNames_[i] == str )
+                        {
+                            dataSet_ = &dataSetNames_[i];
+                            break;
+                        }
+                    }
+                }
+            }
+
+            // name of column within data set:
+            else if( depth_ == 2 && dataSet_ != nullptr )
+            {
+                for(size_t i = 0; i < numTargets_; i++)
+                {
+                    if( dataSetNames_[i] == *dataSet_ &&
+                        std::strcmp(str, targets_[i].column_) == 0 )
+                    {
+                        array_ = targets_[i].array_;
+                        scalar_ = targets_[i].scalar_;
+                        numColumnsFound_++;
+                        break;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        bool Int(int i)
+        {
+            if( frameIndexNext_ )
+            {
+                frame_.frameIndex_ = i;
+                frameIndexNext_ = false;
+                return true;
+            }
+            return Double(i);
+        }
+
+        bool Uint(unsigned int i)
+        {
+            if( frameIndexNext_ )
+            {
+                frame_.frameIndex_ = i;
+                frameIndexNext_ = false;
+                return true;
+            }
+            return Double(i);
+        }
+
+        bool Int64(int64_t i)
+        {
+            return Double(static_cast<double>(i));
+        }
+
+        bool Uint64(uint64_t i)
+        {
+            return Double(static_cast<double>(i));
+        }
+
+        bool Double(double d)
+        {
+            if( array_ != nullptr )
+            {
+                array_ -> push_back(d);
+            }
+            else if( scalar_ != nullptr )
+            {
+                // scalar columns hold a single value:
+                *scalar_ = d;
+                scalar_ = nullptr;
+            }
+            return true;
+        }
+
+    private:
+
+        // frame to write to and columns of interest:
+        // (optional solvent columns come last)
+        FrameStreamData &frame_;
+        std::array<FrameStreamTarget, 44> targets_;
+        std::array<std::string, 44> dataSetNames_;
+        size_t numTargets_;
+
+        // current position in document:
+        int depth_;
+        const std::string *dataSet_;
+
+        // where to write values to:
+        std::vector<real> *array_;
+        real *scalar_;
+        bool frameIndexNext_;
+
+        // number of columns found:
+        size_t numColumnsFound_;
+};
+
+
+/*!
+ * Constructor.
+ */
+FrameStreamReader::FrameStreamReader()
+    : readSolventPositions_(false)
+    , dataSetSuffix_("")
+    , numFramesRead_(0)
+{
+
+}
+
+
+/*!
+ * Opens the stream file for reading.
+ */
+void
+FrameStreamReader::open(
+        const std::string &fileName)
+{
+    fileName_ = fileName;
+    file_.open(fileName_.c_str(), std::ifstream::in);
+    if( !file_.is_open() )
+    {
+        throw std::runtime_error("ERROR: Could not open file " + fileName_ + 
+                                 ".");
+    }
+    numFramesRead_ = 0;
+}
+
+
+/*!
+ * Closes the stream file.
+ */
+void
+FrameStreamReader::close()
+{
+    file_.close();
+}
+
+
+/*!
+ * Sets whether the arc length coordinates and inside flags of the solvent 
+ * particles are read as well. These are required for re-estimating the 
+ * solvent density, but not for aggregation.
+ */
+void
+FrameStreamReader::setReadSolventPositions(
+        bool readSolventPositions)
+{
+    readSolventPositions_ = readSolventPositions;
+}
+
+
+/*!
+ * Sets the suffix of the data sets from which the density and hydrophobicity
+ * dependent columns are read. This is used to read the results for one 
+ * parameter set of a sweep, e.g. with suffix "_sweep1". An empty suffix 
+ * (the default) selects the results for the primary parameters.
+ */
+void
+FrameStreamReader::setDataSetSuffix(
+        const std::string &dataSetSuffix)
+{
+    dataSetSuffix_ = dataSetSuffix;
+}
+
+
+/*!
+ * Reads the next line of the stream file into the given frame object. Returns
+ * false if the end of the file has been reached, in which case the frame 
+ * object is left unchanged. Throws an exception if the line is not a valid 
+ * JSON object or if data required for aggregation is missing.
+ */
+bool
+FrameStreamReader::readFrame(
+        FrameStreamData &frame)
+{
+    // read next line into reused buffer:
+    if( !std::getline(file_, line_) )
+    {
+        return false;
+    }
+
+    // parse line in-situ and copy required values into frame:
+    frame.clear();
+    FrameStreamSaxHandler handler(
+            frame, 
+            readSolventPositions_, 
+            dataSetSuffix_);
+    rapidjson::InsituStringStream lineStream(&line_[0]);
+    reader_.Parse<rapidjson::kParseInsituFlag>(lineStream, handler);
+
+    // sanity checks:
+    if( reader_.HasParseError() )
+    {
+        throw std::runtime_error("Line " + std::to_string(numFramesRead_) + 
+        " read from " + fileName_ + " is not valid JSON object.");
+    }
+
+    // all data sets and columns except solvent positions are required:
+    // (unless solvent positions were requested)
+    if( !handler.complete() )
+    {
+        throw std::runtime_error("Line " + std::to_string(numFramesRead_) + 
+        " read from " + fileName_ + " does not contain all required data.");
+    }
+
+    numFramesRead_++;
+    return true;
+}
+
+
+/*!
+ * Returns the number of frames read since the file was opened.
+ */
+int
+FrameStreamReader::numFramesRead() const
+{
+    return numFramesRead_;
+}
+
@@ -0,0 +1,747 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+
+#include "external/rapidjson/stringbuffer.h"
+#include "external/rapidjson/writer.h"
+
+#include "io/gltf_io.hpp"
+
+
+// constants defined by the glTF 2.0 specification:
+static const uint32_t GLB_MAGIC = 0x46546C67;
+static const uint32_t GLB_VERSION = 2;
+static const uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+static const uint32_t GLB_CHUNK_BIN = 0x004E4942;
+static const unsigned int GLTF_ARRAY_BUFFER = 34962;
+static const unsigned int GLTF_ELEMENT_ARRAY_BUFFER = 34963;
+static const unsigned int GLTF_FLOAT = 5126;
+static const unsigned int GLTF_UNSIGNED_INT = 5125;
+static const unsigned int GLTF_TRIANGLES = 4;
+
+typedef rapidjson::Writer<rapidjson::StringBuffer> GltfJsonWriter;
+
+
+/*
+ * Appends positions, normals, and scalar properties of a mesh to the binary
+ * buffer (in this order) and appends the bounding box of the vertex positions
+ * to the bounds vector (minimum followed by maximum coordinates).
+ */
+static void
+appendFrameData(
+        BinaryBuffer &bin,
+        const SurfaceMesh &mesh,
+        std::vector<float> &bounds)
+{
+    // positions and their bounding box:
+    std::vector<float> posMin(3, std::numeric_limits<float>::max());
+    std::vector<float> posMax(3, std::numeric_limits<float>::lowest());
+    for(const auto &pos : mesh.positions_)
+    {
+        for(int i = 0; i < 3; i++)
+        {
+            float x = pos[i];
+            bin.appendFloat(x);
+            posMin[i] = std::min(posMin[i], x);
+            posMax[i] = std::max(posMax[i], x);
+        }
+    }
+    bounds.insert(bounds.end(), posMin.begin(), posMin.end());
+    bounds.insert(bounds.end(), posMax.begin(), posMax.end());
+
+    // normals:
+    for(const auto &norm : mesh.normals_)
+    {
+        bin.appendFloat(norm[XX]);
+        bin.appendFloat(norm[YY]);
+        bin.appendFloat(norm[ZZ]);
+    }
+
+    // scalar properties:
+    for(const auto &prop : mesh.properties_)
+    {
+        for(auto val : prop.second)
+        {
+            bin.appendFloat(val);
+        }
+    }
+}
+
+
+/*
+ * Writes a buffer view object to the JSON chunk. A target of zero is omitted.
+ */
+static void
+writeBufferView(
+        GltfJsonWriter &writer,
+        size_t byteOffset,
+        size_t byteLength,
+        unsigned int target)
+{
+    writer.StartObject();
+    writer.Key("buffer");
+    writer.Uint(0);
+    writer.Key("byteOffset");
+    writer.Uint64(byteOffset);
+    writer.Key("byteLength");
+    writer.Uint64(byteLength);
+    if( target != 0 )
+    {
+        writer.Key("target");
+        writer.Uint(target);
+    }
+    writer.EndObject();
+}
+
+
+/*
+ * Starts an accessor object in the JSON chunk and writes its mandatory 
+ * members. The object is left open so that the caller can add optional 
+ * members (e.g. bounds) and must be closed by the caller.
+ */
+static void
+writeAccessor(
+        GltfJsonWriter &writer,
+        unsigned int bufferView,
+        unsigned int componentType,
+        size_t count,
+        const char *type)
+{
+    writer.StartObject();
+    writer.Key("bufferView");
+    writer.Uint(bufferView);
+    writer.Key("componentType");
+    writer.Uint(componentType);
+    writer.Key("count");
+    writer.Uint64(count);
+    writer.Key("type");
+    writer.String(type);
+}
+
+
+/*
+ * Writes an array of floating point numbers to the JSON chunk.
+ */
+static void
+writeFloatArray(
+        GltfJsonWriter &writer,
+        std::vector<float>::const_iterator begin,
+        std::vector<float>::const_iterator end)
+{
+    writer.StartArray();
+    for(auto it = begin; it != end; it++)
+    {
+        writer.Double(*it);
+    }
+    writer.EndArray();
+}
+
+
+/*
+ * Returns the key frames of the flip book animation for the given frame, 
+ * which is visible from its own key frame until the key frame of the next 
+ * frame and invisible otherwise. Each key frame is given by its index and 
+ * the scale of the node from this key frame onwards.
+ */
+static std::vector<std::pair<size_t, float>>
+frameKeys(
+        size_t frame,
+        size_t numFrames)
+{
+    std::vector<std::pair<size_t, float>> keys;
+    if( frame > 0 )
+    {
+        keys.push_back(std::make_pair(0, 0.0f));
+    }
+    keys.push_back(std::make_pair(frame, 1.0f));
+    if( frame < numFrames - 1 )
+    {
+        keys.push_back(std::make_pair(frame + 1, 0.0f));
+    }
+
+    return keys;
+}
+
+
+/*
+ * Serialises the JSON chunk for one or more frames with identical 
+ * connectivity and properties. The binary chunk is expected to contain the
+ * vertex data of all frames (as written by appendFrameData()), followed by 
+ * the triangle indices and, if time stamps are given, the animation data (as
+ * written by appendAnimationData()). 
+ */
+static std::string
+gltfJson(
+        const std::string &name,
+        const std::vector<std::string> &propertyNames,
+        size_t numVertices,
+        size_t numIndices,
+        const std::vector<float> &bounds,
+        const std::vector<real> &times,
+        real frameDuration,
+        size_t binLength)
+{
+    // layout of binary chunk:
+    size_t numFrames = bounds.size()/6;
+    size_t numAttributes = 2 + propertyNames.size();
+    size_t frameLength = numVertices*(6 + propertyNames.size())*sizeof(float);
+    size_t indexOffset = numFrames*frameLength;
+    size_t animOffset = indexOffset + numIndices*sizeof(uint32_t);
+    bool isAnimated = !times.empty() && numFrames > 1;
+
+    // index of shared objects:
+    unsigned int indexView = numFrames*numAttributes;
+    unsigned int animView = indexView + 1;
+    unsigned int indexAccessor = numFrames*numAttributes;
+
+    rapidjson::StringBuffer json;
+    GltfJsonWriter writer(json);
+    writer.StartObject();
+
+    // asset information:
+    writer.Key("asset");
+    writer.StartObject();
+    writer.Key("version");
+    writer.String("2.0");
+    writer.Key("generator");
+    writer.String("CHAP");
+    writer.EndObject();
+
+    // scene with one node per frame:
+    writer.Key("scene");
+    writer.Uint(0);
+    writer.Key("scenes");
+    writer.StartArray();
+    writer.StartObject();
+    writer.Key("nodes");
+    writer.StartArray();
+    for(size_t f = 0; f < numFrames; f++)
+    {
+        writer.Uint(f);
+    }
+    writer.EndArray();
+    writer.EndObject();
+    writer.EndArray();
+    writer.Key("nodes");
+    writer.StartArray();
+    for(size_t f = 0; f < numFrames; f++)
+    {
+        writer.StartObject();
+        writer.Key("mesh");
+        writer.Uint(f);
+        writer.Key("name");
+        writer.String(numFrames > 1 
+                      ? (name + "_" + std::to_string(f)).c_str() 
+                      : name.c_str());
+        if( !times.empty() )
+        {
+            writer.Key("extras");
+            writer.StartObject();
+            writer.Key("time");
+            writer.Double(times[f]);
+            writer.EndObject();
+        }
+        if( isAnimated && f > 0 )
+        {
+            writer.Key("scale");
+            writer.StartArray();
+            writer.Double(0.0);
+            writer.Double(0.0);
+            writer.Double(0.0);
+            writer.EndArray();
+        }
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    // one mesh per frame, all referencing the same indices:
+    writer.Key("meshes");
+    writer.StartArray();
+    for(size_t f = 0; f < numFrames; f++)
+    {
+        unsigned int firstAccessor = f*numAttributes;
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(name.c_str());
+        writer.Key("primitives");
+        writer.StartArray();
+        writer.StartObject();
+        writer.Key("attributes");
+        writer.StartObject();
+        writer.Key("POSITION");
+        writer.Uint(firstAccessor);
+        writer.Key("NORMAL");
+        writer.Uint(firstAccessor + 1);
+        for(size_t i = 0; i < propertyNames.size(); i++)
+        {
+            writer.Key(GltfExporter::attributeName(propertyNames[i]).c_str());
+            writer.Uint(firstAccessor + 2 + i);
+        }
+        writer.EndObject();
+        writer.Key("indices");
+        writer.Uint(indexAccessor);
+        writer.Key("mode");
+        writer.Uint(GLTF_TRIANGLES);
+        writer.EndObject();
+        writer.EndArray();
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    // one buffer view per attribute and frame, one for the indices, and one
+    // for all animation data:
+    writer.Key("bufferViews");
+    writer.StartArray();
+    for(size_t f = 0; f < numFrames; f++)
+    {
+        size_t offset = f*frameLength;
+        writeBufferView(
+                writer, 
+                offset, 
+                numVertices*3*sizeof(float), 
+                GLTF_ARRAY_BUFFER);
+        writeBufferView(
+                writer, 
+                offset + numVertices*3*sizeof(float), 
+                numVertices*3*sizeof(float), 
+                GLTF_ARRAY_BUFFER);
+        for(size_t i = 0; i < propertyNames.size(); i++)
+        {
+            writeBufferView(
+                    writer, 
+                    offset + numVertices*(6 + i)*sizeof(float), 
+                    numVertices*sizeof(float), 
+                    GLTF_ARRAY_BUFFER);
+        }
+    }
+    writeBufferView(
+            writer, 
+            indexOffset, 
+            numIndices*sizeof(uint32_t), 
+            GLTF_ELEMENT_ARRAY_BUFFER);
+    if( isAnimated )
+    {
+        writeBufferView(writer, animOffset, binLength - animOffset, 0);
+    }
+    writer.EndArray();
+
+    // accessors describing the content of each buffer view:
+    writer.Key("accessors");
+    writer.StartArray();
+    for(size_t f = 0; f < numFrames; f++)
+    {
+        unsigned int firstView = f*numAttributes;
+        writeAccessor(writer, firstView, GLTF_FLOAT, numVertices, "VEC3");
+        auto frameBounds = bounds.begin() + 6*f;
+        writer.Key("min");
+        writeFloatArray(writer, frameBounds, frameBounds + 3);
+        writer.Key("max");
+        writeFloatArray(writer, frameBounds + 3, frameBounds + 6);
+        writer.EndObject();
+        writeAccessor(writer, firstView + 1, GLTF_FLOAT, numVertices, "VEC3");
+        writer.EndObject();
+        for(size_t i = 0; i < propertyNames.size(); i++)
+        {
+            writeAccessor(
+                    writer, 
+                    firstView + 2 + i, 
+                    GLTF_FLOAT, 
+                    numVertices, 
+                    "SCALAR");
+            writer.EndObject();
+        }
+    }
+    writeAccessor(
+            writer, 
+            indexView, 
+            GLTF_UNSIGNED_INT, 
+            numIndices, 
+            "SCALAR");
+    writer.EndObject();
+    if( isAnimated )
+    {
+        // key frame times and node scales of each frame:
+        size_t offset = 0;
+        for(size_t f = 0; f < numFrames; f++)
+        {
+            auto keys = frameKeys(f, numFrames);
+            writeAccessor(writer, animView, GLTF_FLOAT, keys.size(), "SCALAR");
+            writer.Key("byteOffset");
+            writer.Uint64(offset);
+            writer.Key("min");
+            writer.StartArray();
+            writer.Double(keys.front().first*frameDuration);
+            writer.EndArray();
+            writer.Key("max");
+            writer.StartArray();
+            writer.Double(keys.back().first*frameDuration);
+            writer.EndArray();
+            writer.EndObject();
+            offset += keys.size()*sizeof(float);
+            writeAccessor(writer, animView, GLTF_FLOAT, keys.size(), "VEC3");
+            writer.Key("byteOffset");
+            writer.Uint64(offset);
+            writer.EndObject();
+            offset += keys.size()*3*sizeof(float);
+        }
+    }
+    writer.EndArray();
+
+    // flip book animation toggling the visibility of frames:
+    if( isAnimated )
+    {
+        writer.Key("animations");
+        writer.StartArray();
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(name.c_str());
+        writer.Key("channels");
+        writer.StartArray();
+        for(size_t f = 0; f < numFrames; f++)
+        {
+            writer.StartObject();
+            writer.Key("sampler");
+            writer.Uint(f);
+            writer.Key("target");
+            writer.StartObject();
+            writer.Key("node");
+            writer.Uint(f);
+            writer.Key("path");
+            writer.String("scale");
+            writer.EndObject();
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.Key("samplers");
+        writer.StartArray();
+        for(size_t f = 0; f < numFrames; f++)
+        {
+            writer.StartObject();
+            writer.Key("input");
+            writer.Uint(indexAccessor + 1 + 2*f);
+            writer.Key("output");
+            writer.Uint(indexAccessor + 2 + 2*f);
+            writer.Key("interpolation");
+            writer.String("STEP");
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+        writer.EndArray();
+    }
+
+    // single binary buffer:
+    writer.Key("buffers");
+    writer.StartArray();
+    writer.StartObject();
+    writer.Key("byteLength");
+    writer.Uint64(binLength);
+    writer.EndObject();
+    writer.EndArray();
+
+    writer.EndObject();
+    if( !writer.IsComplete() )
+    {
+        throw std::runtime_error("ERROR: Could not serialise glTF JSON "
+                                 "chunk.");
+    }
+
+    return std::string(json.GetString(), json.GetSize());
+}
+
+
+/*
+ * Appends the key frame times and node scales of the flip book animation to
+ * the binary buffer, in the order expected by gltfJson().
+ */
+static void
+appendAnimationData(
+        BinaryBuffer &bin,
+        size_t numFrames,
+        real frameDuration)
+{
+    for(size_t f = 0; f < numFrames; f++)
+    {
+        auto keys = frameKeys(f, numFrames);
+        for(auto &key : keys)
+        {
+            bin.appendFloat(key.first*frameDuration);
+        }
+        for(auto &key : keys)
+        {
+            bin.appendFloat(key.second);
+            bin.appendFloat(key.second);
+            bin.appendFloat(key.second);
+        }
+    }
+}
+
+
+/*
+ * Writes a GLB container with the given JSON chunk and a binary chunk that 
+ * consists of the given buffers. The JSON chunk is padded with spaces, the 
+ * binary chunk with zeros.
+ */
+static void
+writeGlb(
+        const std::string &fileName,
+        const std::string &json,
+        std::vector<const BinaryBuffer*> binParts)
+{
+    // JSON chunk:
+    BinaryBuffer jsonChunk;
+    jsonChunk.appendString(json);
+    jsonChunk.pad(4, ' ');
+
+    // binary chunk padding:
+    size_t binLength = 0;
+    for(auto part : binParts)
+    {
+        binLength += part -> size();
+    }
+    BinaryBuffer binPadding;
+    binPadding.appendString(std::string((4 - binLength % 4) % 4, '\0'));
+    binLength += binPadding.size();
+
+    // header and chunk headers:
+    BinaryBuffer head;
+    size_t totalLength = 12 + 8 + jsonChunk.size() + 8 + binLength;
+    head.appendUint32(GLB_MAGIC);
+    head.appendUint32(GLB_VERSION);
+    head.appendUint32(totalLength);
+    head.appendUint32(jsonChunk.size());
+    head.appendUint32(GLB_CHUNK_JSON);
+    head.appendString(jsonChunk.data());
+    head.appendUint32(binLength);
+    head.appendUint32(GLB_CHUNK_BIN);
+
+    // write to file without concatenating binary parts:
+    binParts.insert(binParts.begin(), &head);
+    binParts.push_back(&binPadding);
+    BinaryBuffer::write(fileName, binParts);
+}
+
+
+/*!
+ * Writes the given mesh to a binary glTF file of the given name. The binary
+ * chunk contains positions, normals, one block per scalar property, and the
+ * triangle indices, in this order.
+ */
+void
+GltfExporter::write(
+        const std::string &fileName,
+        const SurfaceMesh &mesh)
+{
+    // sanity checks:
+    if( !mesh.valid() )
+    {
+        throw std::logic_error("GltfExporter encountered invalid mesh.");
+    }
+    if( mesh.numVertices() == 0 || mesh.numTriangles() == 0 )
+    {
+        throw std::logic_error("GltfExporter can not write empty mesh.");
+    }
+
+    // assemble binary chunk:
+    BinaryBuffer bin;
+    bin.reserve(mesh.numVertices()*(6 + mesh.properties_.size())*sizeof(float) 
+                + mesh.indices_.size()*sizeof(uint32_t));
+    std::vector<float> bounds;
+    appendFrameData(bin, mesh, bounds);
+    for(auto idx : mesh.indices_)
+    {
+        bin.appendUint32(idx);
+    }
+
+    // assemble JSON chunk:
+    std::vector<std::string> propertyNames;
+    for(const auto &prop : mesh.properties_)
+    {
+        propertyNames.push_back(prop.first);
+    }
+    std::string json = gltfJson(
+            mesh.name_,
+            propertyNames,
+            mesh.numVertices(),
+            mesh.indices_.size(),
+            bounds,
+            std::vector<real>(),
+            0.0,
+            bin.size());
+
+    // write to file:
+    writeGlb(fileName, json, {&bin});
+}
+
+
+/*!
+ * Returns the name of the application specific mesh attribute under which a
+ * scalar property is stored.
+ */
+std::string
+GltfExporter::attributeName(const std::string &propertyName)
+{
+    std::string name = "_" + propertyName;
+    std::transform(
+            name.begin(), 
+            name.end(), 
+            name.begin(), 
+            [](unsigned char c){return std::toupper(c);});
+    return name;
+}
+
+
+/*!
+ * Constructor sets default frame duration of one tenth of a second.
+ */
+GltfSequenceExporter::GltfSequenceExporter()
+    : frameDuration_(0.1)
+    , numVertices_(0)
+{
+
+}
+
+
+/*!
+ * Sets the duration in seconds for which each frame is shown when the 
+ * animation is played.
+ */
+void
+GltfSequenceExporter::setFrameDuration(real frameDuration)
+{
+    if( frameDuration <= 0.0 )
+    {
+        throw std::logic_error("Frame duration must be positive.");
+    }
+
+    frameDuration_ = frameDuration;
+}
+
+
+/*!
+ * Adds a frame to the sequence. The first frame fixes the connectivity and
+ * the set of scalar properties, all subsequent frames must match it.
+ */
+void
+GltfSequenceExporter::addFrame(
+        const SurfaceMesh &mesh,
+        real time)
+{
+    // sanity checks:
+    if( !mesh.valid() )
+    {
+        throw std::logic_error("GltfSequenceExporter encountered invalid "
+                               "mesh.");
+    }
+    if( mesh.numVertices() == 0 || mesh.numTriangles() == 0 )
+    {
+        throw std::logic_error("GltfSequenceExporter can not add empty "
+                               "mesh.");
+    }
+
+    // properties of mesh:
+    std::vector<std::string> propertyNames;
+    for(const auto &prop : mesh.properties_)
+    {
+        propertyNames.push_back(prop.first);
+    }
+
+    // first frame defines connectivity:
+    if( times_.empty() )
+    {
+        name_ = mesh.name_;
+        propertyNames_ = propertyNames;
+        indices_ = mesh.indices_;
+        numVertices_ = mesh.numVertices();
+    }
+    else if( mesh.numVertices() != numVertices_ || 
+             mesh.indices_ != indices_ ||
+             propertyNames != propertyNames_ )
+    {
+        throw std::logic_error("Connectivity or properties of mesh do not "
+                               "match previous frames in "
+                               "GltfSequenceExporter.");
+    }
+
+    // add vertex data of this frame:
+    appendFrameData(frameData_, mesh, bounds_);
+    times_.push_back(time);
+}
+
+
+/*!
+ * Returns the number of frames added so far.
+ */
+size_t
+GltfSequenceExporter::numFrames() const
+{
+    return times_.size();
+}
+
+
+/*!
+ * Writes all frames added so far to a binary glTF file of the given name.
+ */
+void
+GltfSequenceExporter::write(const std::string &fileName)
+{
+    // sanity check:
+    if( times_.empty() )
+    {
+        throw std::logic_error("GltfSequenceExporter can not write empty "
+                               "sequence.");
+    }
+
+    // shared indices and animation data follow the per-frame data:
+    BinaryBuffer tail;
+    for(auto idx : indices_)
+    {
+        tail.appendUint32(idx);
+    }
+    if( times_.size() > 1 )
+    {
+        appendAnimationData(tail, times_.size(), frameDuration_);
+    }
+
+    // assemble JSON chunk:
+    std::string json = gltfJson(
+            name_,
+            propertyNames_,
+            numVertices_,
+            indices_.size(),
+            bounds_,
+            times_,
+            frameDuration_,
+            frameData_.size() + tail.size());
+
+    // write to file:
+    writeGlb(fileName, json, {&frameData_, &tail});
+}
+
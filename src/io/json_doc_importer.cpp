@@ -22,39 +22,97 @@
 // THE SOFTWARE.
 
 
-#include <fstream>
 #include <exception>
 #include <stdexcept>
-#include <sstream>
-#include <iostream>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "config/builtin_data.hpp"
 #include "io/json_doc_importer.hpp"
 
 
 /*!
- * Returns a JSON document corresponding to the given JSON file.
+ * Returns a JSON document corresponding to the given JSON file. The file is 
+ * memory mapped and parsed in place.
  */
 rapidjson::Document
 JsonDocImporter::operator()(std::string fileName)
 {
-    // read entire file into memory:
-    std::stringstream ss;
-    std::ifstream file;
-    file.open(fileName.c_str());
+    // open file and determine its size:
+    int fd = open(fileName.c_str(), O_RDONLY);
+    struct stat fileStat;
+    if( fd < 0 || fstat(fd, &fileStat) != 0 )
+    {
+        if( fd >= 0 )
+        {
+            close(fd);
+        }
+        throw std::runtime_error("ERROR: Could not open file " + fileName + ".");
+    }
+    size_t size = fileStat.st_size;
+
+    // empty files can not be mapped and are not valid JSON objects anyway:
+    if( size == 0 )
+    {
+        close(fd);
+        throw std::invalid_argument("Invalid JSON object.");
+    }
 
-    // make sure file could be opened:
-    if( !file.is_open() )
+    // map file content into memory:
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if( data == MAP_FAILED )
     {
         throw std::runtime_error("ERROR: Could not open file " + fileName + ".");
     }
 
-    // read file into string stream:
-    ss << file.rdbuf();
-    file.close();
+    // parse directly from mapping and release it in any case:
+    try
+    {
+        rapidjson::Document json = parse(static_cast<const char*>(data), size);
+        munmap(data, size);
+        return json;
+    }
+    catch(...)
+    {
+        munmap(data, size);
+        throw;
+    }
+}
+
+
+/*!
+ * Returns a JSON document corresponding to a data file that has been compiled
+ * into the binary. Names are paths relative to share/data, e.g. 
+ * vdwradii/hole_simple.json.
+ */
+rapidjson::Document
+JsonDocImporter::fromBuiltin(std::string name)
+{
+    const BuiltinDataFile *file = builtinDataFile(name);
+    if( file == nullptr )
+    {
+        throw std::runtime_error("ERROR: No built-in data file " + name + ".");
+    }
+
+    return parse(file -> data_, file -> size_);
+}
+
 
-    // create JSON document from file:
+/*!
+ * Creates a JSON document from a character buffer of the given size. The 
+ * buffer need not be null-terminated. NaN and infinite numbers are accepted,
+ * as these can legitimately occur in shard files (e.g. infinite energies).
+ */
+rapidjson::Document
+JsonDocImporter::parse(const char *data, size_t size)
+{
+    // create JSON document from buffer:
     rapidjson::Document json;
-    json.Parse<0>(ss.str().c_str());
+    json.Parse<rapidjson::kParseNanAndInfFlag>(data, size);
 
     // check validity of JSON object:
     if( json.IsObject() == false )
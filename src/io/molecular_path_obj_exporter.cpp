@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <future>
 #include <iomanip>
 #include <sstream>
 #include <vector>
@@ -31,7 +32,9 @@
 #include <gromacs/math/vec.h>
 #include <gromacs/utility/real.h> 
 
+#include "io/gltf_io.hpp"
 #include "io/molecular_path_obj_exporter.hpp"
+#include "io/ply_io.hpp"
 
 #include "geometry/cubic_spline_interp_3D.hpp"
 
@@ -51,418 +54,356 @@ RegularVertexGrid::RegularVertexGrid(
 
 
 /*!
- * Adds a vertex at the given coordinates for the given property.
+ * Sets the vertices of the grid, which are shared by all properties. The 
+ * vector must be linearly indexed as \f$ i N_\phi + j \f$. Any previously 
+ * calculated vertex normals are discarded.
  */
 void
-RegularVertexGrid::addVertex(
-        size_t i, 
-        size_t j,
-        std::string p,
-        gmx::RVec vertex, 
-        real weight)
+RegularVertexGrid::setVertices(
+        std::vector<gmx::RVec> vertices)
 {
-    // TODO: this situation should really be handled by a NaN colour
-    if( std::isnan(weight) )
+    // sanity check:
+    if( vertices.size() != s_.size()*phi_.size() )
     {
-        weight = 0.5;
+        throw std::logic_error("Number of vertices does not match size of "
+                               "RegularVertexGrid.");
     }
 
-    p_.insert(p);
-    std::tuple<size_t, size_t, std::string> key(i, j, p);
-    vertices_[key] = vertex;
-    weights_[key] = weight;
+    vertices_ = std::move(vertices);
+    normals_.clear();
 }
 
 
 /*!
- * Returns a vector of all vertices for a given property.
+ * Sets the per-vertex weights of the given property, which are linearly 
+ * indexed in the same way as the vertices. A property that has been set
+ * before is overwritten.
  */
-std::vector<gmx::RVec>
-RegularVertexGrid::vertices(
-        std::string p)
+void
+RegularVertexGrid::setWeights(
+        std::string p,
+        std::vector<real> weights)
 {
-    // build linearly indexed vector from dual indexed map:
-    std::vector<gmx::RVec> vert;
-    vert.reserve(vertices_.size());
-    for(size_t i = 0; i < s_.size(); i++)
+    // sanity check:
+    if( weights.size() != s_.size()*phi_.size() )
+    {
+        throw std::logic_error("Number of weights does not match size of "
+                               "RegularVertexGrid.");
+    }
+
+    // TODO: this situation should really be handled by a NaN colour
+    for(auto &weight : weights)
     {
-        for(size_t j = 0; j < phi_.size(); j++)
+        if( std::isnan(weight) )
         {
-            std::tuple<size_t, size_t, std::string> key(i, j, p);
-            if( vertices_.find(key) != vertices_.end() )
-            {
-                vert.push_back(vertices_[key]); 
-            }
-            else
-            {
-                throw std::logic_error("Invalid vertex reference encountered.");
-            }
+            weight = 0.5;
         }
     }
 
-    return vert;
+    auto it = std::find(p_.begin(), p_.end(), p);
+    if( it != p_.end() )
+    {
+        weights_[std::distance(p_.begin(), it)] = std::move(weights);
+    }
+    else
+    {
+        p_.push_back(p);
+        weights_.push_back(std::move(weights));
+    }
 }
 
 
 /*!
- * Returns vector of vertex normals for a given property.
+ * Returns a vector of all vertices.
  */
-std::vector<gmx::RVec>
-RegularVertexGrid::normals(
-        std::string p)
+const std::vector<gmx::RVec>&
+RegularVertexGrid::vertices() const
 {
-    std::vector<gmx::RVec> norm;
-    norm.reserve(normals_.size());
-    for(size_t i = 0; i < s_.size(); i++)
+    if( vertices_.empty() )
     {
-        for(size_t j = 0; j < phi_.size(); j++)
-        {
-            std::tuple<size_t, size_t, std::string> key(i, j, p);
-            if( normals_.find(key) != normals_.end() )
-            {
-                norm.push_back(normals_[key]); 
-            }
-            else
-            {
-                throw std::logic_error("Invalid vertex normal reference "
-                                       "encountered.");
-            }
-        }
+        throw std::logic_error("Invalid vertex reference encountered.");
     }
 
-    return norm;
+    return vertices_;
 }
 
 
 /*!
- * Calculates vertex normals from triangular faces.
+ * Returns vector of vertex normals.
+ */
+const std::vector<gmx::RVec>&
+RegularVertexGrid::normals() const
+{
+    if( normals_.size() != vertices_.size() || normals_.empty() )
+    {
+        throw std::logic_error("Invalid vertex normal reference "
+                               "encountered.");
+    }
+
+    return normals_;
+}
+
+
+/*!
+ * Calculates vertex normals from triangular faces. The normal of each face 
+ * is calculated once and added to each of its three vertices, so that the
+ * vertex normal is the area weighted average of the adjacent face normals.
  */
 void
 RegularVertexGrid::normalsFromFaces()
 {
-    // array sizes for index wrap:
-    int mI = s_.size();
-    int mJ = phi_.size();
+    // sanity check:
+    if( vertices_.empty() )
+    {
+        throw std::logic_error("RegularVertexGrid cannot generate normals "
+                               "on incomplete grid.");
+    }
 
-    for(auto p : p_)
+    // triangulation of grid:
+    std::vector<unsigned int> indices = triangleIndices();
+    normals_.assign(vertices_.size(), gmx::RVec(0.0, 0.0, 0.0));
+
+    // accumulate face normals in adjacent vertices:
+    for(size_t k = 0; k < indices.size(); k += 3)
     {
-        for(int i = 0; i < s_.size(); i++)
-        {
-            for(int j = 0; j < phi_.size(); j++)
-            {
-                // index pairs for neighbouring vertices:
-                std::tuple<size_t, size_t, std::string> crntKey(
-                        i, 
-                        j,
-                        p);
-                std::tuple<size_t, size_t, std::string> leftKey(
-                        i, 
-                        (j - 1 + mJ) % mJ,
-                        p);
-                std::tuple<size_t, size_t, std::string> rghtKey(
-                        i, 
-                        (j + 1 + mJ) % mJ,
-                        p);
-                std::tuple<size_t, size_t, std::string> upprKey(
-                        (i + 1 + mI) % mI, 
-                        j,
-                        p);
-                std::tuple<size_t, size_t, std::string> lowrKey((
-                        i - 1 + mI) % mI, 
-                        j,
-                        p);
-                std::tuple<size_t, size_t, std::string> dglrKey(
-                        (i - 1 + mI) % mI, 
-                        (j + 1 + mJ) % mJ,
-                        p);
-                std::tuple<size_t, size_t, std::string> dgulKey(
-                        (i + 1 + mI) % mI, 
-                        (j - 1 + mJ) % mJ,
-                        p);
-
-                // handle endpoints in direction along spline:
-                if( i == 0 )
-                {
-                    lowrKey = crntKey; 
-                    dglrKey = crntKey;
-                }
-                if( i == s_.size() - 1 )
-                {
-                    upprKey = crntKey;
-                    dgulKey = crntKey;
-                }
+        gmx::RVec sideA;
+        gmx::RVec sideB;
+        gmx::RVec faceNorm;
+        rvec_sub(vertices_[indices[k + 1]], vertices_[indices[k]], sideA);
+        rvec_sub(vertices_[indices[k + 2]], vertices_[indices[k]], sideB);
+        cprod(sideA, sideB, faceNorm);
+        rvec_inc(normals_[indices[k]], faceNorm);
+        rvec_inc(normals_[indices[k + 1]], faceNorm);
+        rvec_inc(normals_[indices[k + 2]], faceNorm);
+    }
 
-                // neighbouring vertices:
-                gmx::RVec crntVert = vertices_.at(crntKey);
-                gmx::RVec leftVert = vertices_.at(leftKey);
-                gmx::RVec rghtVert = vertices_.at(rghtKey);
-                gmx::RVec upprVert = vertices_.at(upprKey);
-                gmx::RVec lowrVert = vertices_.at(lowrKey);
-                gmx::RVec dglrVert = vertices_.at(dglrKey);
-                gmx::RVec dgulVert = vertices_.at(dgulKey);
-
-                // initialise normal as null vector:
-                gmx::RVec norm(0.0, 0.0, 0.0);
-                gmx::RVec sideA;
-                gmx::RVec sideB;
-
-                // North-East triangle:
-                rvec_sub(rghtVert, crntVert, sideA);
-                rvec_sub(upprVert, crntVert, sideB);
-                addTriangleNorm(sideA, sideB, norm);
-                
-                // North-North-West triangle:
-                rvec_sub(upprVert, crntVert, sideA);
-                rvec_sub(dgulVert, crntVert, sideB);
-                addTriangleNorm(sideA, sideB, norm);
-
-                // West-North-West triangle:
-                rvec_sub(dgulVert, crntVert, sideA);
-                rvec_sub(leftVert, crntVert, sideB);
-                addTriangleNorm(sideA, sideB, norm);
-
-                // South-West triangle:
-                rvec_sub(leftVert, crntVert, sideA);
-                rvec_sub(lowrVert, crntVert, sideB);
-                addTriangleNorm(sideA, sideB, norm);
-
-                // South-South-East triangle:
-                rvec_sub(lowrVert, crntVert, sideA);
-                rvec_sub(dglrVert, crntVert, sideB);
-                addTriangleNorm(sideA, sideB, norm);
-                
-                // East-South-East triangle:
-                rvec_sub(dglrVert, crntVert, sideA);
-                rvec_sub(rghtVert, crntVert, sideB);
-                addTriangleNorm(sideA, sideB, norm);
-
-                // normalise normal:
-                unitv(norm, norm);
-                
-                // add to container of normals:
-                normals_[crntKey] = norm;
-            }
-        }
+    // normalise normals:
+    for(auto &norm : normals_)
+    {
+        unitv(norm, norm);
     }
 }
 
 
 /*!
- * Returns a vector of vertices plus a scalar weight.
+ * Returns a vector of vertices plus the scalar weight of the given property.
  */
 std::vector<std::pair<gmx::RVec, real>>
 RegularVertexGrid::weightedVertices(
-        std::string p)
+        std::string p) const
 {
-    // build linearly indexed vector from dual indexed map:
-    std::vector<std::pair<gmx::RVec, real>> vert;
-    vert.reserve(vertices_.size());
-    for(size_t i = 0; i < s_.size(); i++)
+    const std::vector<gmx::RVec> &vert = vertices();
+    const std::vector<real> &weights = weights_[propertyIndex(p)];
+
+    std::vector<std::pair<gmx::RVec, real>> weightedVert;
+    weightedVert.reserve(vert.size());
+    for(size_t k = 0; k < vert.size(); k++)
     {
-        for(size_t j = 0; j < phi_.size(); j++)
-        {
-            std::tuple<size_t, size_t, std::string> key(i, j, p);
-            if( vertices_.find(key) != vertices_.end() && 
-                weights_.find(key) != weights_.end() )
-            {
-                std::pair<gmx::RVec, real> vertex(vertices_[key], weights_[key]);
-                vert.push_back(vertex); 
-            }
-            else
-            {
-                throw std::logic_error("Invalid vertex reference encountered.");
-            }
-        }
+        weightedVert.push_back(std::make_pair(vert[k], weights[k]));
     }
 
-    return vert;
+    return weightedVert;
 }
 
 
 /*!
- * Returns colour scale for the given property.
+ * Returns colour scale for the given property. The range of the scale spans
+ * the weights of all properties.
  */
 ColourScale
-RegularVertexGrid::colourScale(std::string p)
+RegularVertexGrid::colourScale(std::string p) const
 {
-    return colourScales_.at(p);
-}
+    // sanity check:
+    propertyIndex(p);
+
+    // find scalar property data range:
+    real minRange = std::numeric_limits<real>::max();
+    real maxRange = std::numeric_limits<real>::min();
+    for(const auto &weights : weights_)
+    {
+        for(auto w : weights)
+        {
+            if( w < minRange )
+            {
+                minRange = w;
+            }
+            if( w > maxRange )
+            {
+                maxRange = w;
+            }
+        }
+    }
 
+    // prepare colour scale:
+    ColourScale colScale(p);
+    colScale.setRange(minRange, maxRange);
+    colScale.setResolution(100);   // NOTE: limited by number of MTL materials
 
-/*!
- * Auxiliary method for adding the contribution of two triangle sides to a
- * vertex normal.
- */
-void
-RegularVertexGrid::addTriangleNorm(
-        const gmx::RVec &sideA,
-        const gmx::RVec &sideB,
-        gmx::RVec &norm)
-{
-    gmx::RVec tmp;
-    cprod(sideA, sideB, tmp);
-    rvec_add(norm, tmp, norm);
+    return colScale;
 }
 
 
 /*!
  * Calculates and returns vector of triangular faces for the given property.
+ * Vertex indices are one-based and offset by the number of vertices in the 
+ * grid times the number of properties added before this one, so that they 
+ * refer to a single OBJ object in which the vertices are repeated for each 
+ * property in order of insertion. This function does not modify the grid
+ * and can be called for different properties concurrently.
  */
 std::vector<WavefrontObjFace>
 RegularVertexGrid::faces(
-        std::string p)
+        std::string p) const
 {
     // sanity checks:
-    if( phi_.size() * s_.size() * p_.size() != vertices_.size() )
+    if( !isComplete() )
     {
         throw std::logic_error("RegularVertexGrid cannot generate faces "
                                "on incomplete grid.");
     }
-
-    if( !normals_.empty() && normals_.size() != vertices_.size() )
+    size_t pIdx = propertyIndex(p);
+    bool hasNormals = !normals_.empty();
+    if( hasNormals && normals_.size() != vertices_.size() )
     {
         throw std::logic_error("Number of vertex normals does not equal "
                                "number of vertices in RegularVertexGrid.");
     }
     
-    // find scalar property data range:
-    real minRange = std::numeric_limits<real>::max();
-    real maxRange = std::numeric_limits<real>::min();
-    for(auto it = weights_.begin(); it != weights_.end(); it++)
+    // colour scale of this property:
+    ColourScale colScale = colourScale(p);
+
+    // number of vertices per property grid:
+    int vertOffset = vertices_.size()*pIdx;
+
+    // triangulation and weights of this property:
+    std::vector<unsigned int> indices = triangleIndices();
+    const std::vector<real> &weights = weights_[pIdx];
+
+    // preallocate face vector:
+    std::vector<WavefrontObjFace> faces;
+    faces.reserve(indices.size()/3);
+
+    // loop over triangles:
+    for(size_t k = 0; k < indices.size(); k += 3)
     {
-        if( it -> second < minRange )
+        // face weight is average of vertex weights:
+        real scalar = weights[indices[k]] 
+                    + weights[indices[k + 1]] 
+                    + weights[indices[k + 2]];
+        scalar /= 3.0;
+
+        // name of material from colour scale:
+        std::string mtlName = colScale.scalarToColourName(scalar); 
+
+        // one-based vertex indices:
+        std::vector<int> vertIdx = {
+                vertOffset + static_cast<int>(indices[k]) + 1,
+                vertOffset + static_cast<int>(indices[k + 1]) + 1,
+                vertOffset + static_cast<int>(indices[k + 2]) + 1};
+
+        // create face:
+        if( hasNormals )
         {
-            minRange = it -> second;
+            faces.push_back( WavefrontObjFace(vertIdx, vertIdx, mtlName) );
         }
-        if( it -> second > maxRange )
+        else
         {
-            maxRange = it -> second;
+            faces.push_back( WavefrontObjFace(vertIdx, mtlName) );
         }
     }
 
-    // prepare colour scale:
-    ColourScale colScale(p);
-    colScale.setRange(minRange, maxRange);
-    colScale.setResolution(100);   // NOTE: limited by number of MTL materials
-    colourScales_.insert(std::pair<std::string, ColourScale>(p, colScale));
+    // return face vector:
+    return faces;
+}
 
-    // number of vertices per property grid:
-    size_t propIdx = std::distance(p_.begin(), find(p_.begin(), p_.end(), p));
-    size_t vertOffset = s_.size() * phi_.size() * propIdx;
 
-    // preallocate face vector:
-    std::vector<WavefrontObjFace> faces;
-    faces.reserve(phi_.size()*s_.size());
+/*!
+ * Returns the zero-based vertex indices of the triangular faces of the grid
+ * as a flat vector of consecutive triples. Each grid cell is split into two
+ * triangles, where the faces wrapping around in \f$ \phi \f$ direction come
+ * after all other faces. As the geometry of the grid is the same for all 
+ * properties, the indices refer to a single property grid, i.e. to the 
+ * vertices as returned by vertices() for any given property.
+ */
+std::vector<unsigned int>
+RegularVertexGrid::triangleIndices() const
+{
+    // sanity checks:
+    if( s_.size() < 2 || phi_.size() < 2 )
+    {
+        throw std::logic_error("RegularVertexGrid cannot generate triangles "
+                               "on grid with fewer than two points in each "
+                               "direction.");
+    }
+
+    // preallocate index vector:
+    unsigned int numPhi = phi_.size();
+    std::vector<unsigned int> indices;
+    indices.reserve(6*(s_.size() - 1)*numPhi);
 
     // loop over grid:
-    for(size_t i = 0; i < s_.size() - 1; i++)
+    for(unsigned int i = 0; i < s_.size() - 1; i++)
     {
-        for(size_t j = 0; j < phi_.size() - 1; j++)
+        for(unsigned int j = 0; j < numPhi - 1; j++)
         {
             // calculate linear indices:
-            int kbl = vertOffset + i * phi_.size() + j; 
-            int kbr = kbl + 1;
-            int ktl = kbl + phi_.size();
-            int ktr = kbr + phi_.size();
-
-            // vertex keys:
-            std::tuple<size_t, size_t, std::string> keyBl(i,     j,     p);
-            std::tuple<size_t, size_t, std::string> keyBr(i,     j + 1, p);
-            std::tuple<size_t, size_t, std::string> keyTl(i + 1, j,     p);
-            std::tuple<size_t, size_t, std::string> keyTr(i + 1, j + 1, p);
-
-            // face weight is average of vertex weights:
-            real scalarA = weights_.at(keyBl) 
-                         + weights_.at(keyTr) 
-                         + weights_.at(keyTl);
-            real scalarB = weights_.at(keyBl) 
-                         + weights_.at(keyBr) 
-                         + weights_.at(keyTr);
-            scalarA /= 3.0;
-            scalarB /= 3.0;
-
-            // name of material from colour scale:
-            std::string mtlNameA = colScale.scalarToColourName(scalarA); 
-            std::string mtlNameB = colScale.scalarToColourName(scalarB); 
+            unsigned int kbl = i*numPhi + j;
+            unsigned int kbr = kbl + 1;
+            unsigned int ktl = kbl + numPhi;
+            unsigned int ktr = kbr + numPhi;
 
             // two faces per square:
-            if( normals_.empty() )
-            {
-                faces.push_back( WavefrontObjFace(
-                        {kbl + 1, ktr + 1, ktl + 1},
-                        mtlNameA) );
-                faces.push_back( WavefrontObjFace(
-                        {kbl + 1, kbr + 1, ktr + 1},
-                        mtlNameB) );
-            }
-            else
-            {
-                faces.push_back( WavefrontObjFace(
-                        {kbl + 1, ktr + 1, ktl + 1},
-                        {kbl + 1, ktr + 1, ktl + 1},
-                        mtlNameA) );
-                faces.push_back( WavefrontObjFace(
-                        {kbl + 1, kbr + 1, ktr + 1},
-                        {kbl + 1, kbr + 1, ktr + 1},
-                        mtlNameB) );
-            }
+            indices.insert(indices.end(), {kbl, ktr, ktl});
+            indices.insert(indices.end(), {kbl, kbr, ktr});
         }
     }
 
     // wrap around:
-    for(size_t i = 0; i < s_.size() - 1; i++)
+    for(unsigned int i = 0; i < s_.size() - 1; i++)
     {
         // calculate linear indices:
-        int kbl = vertOffset + i*phi_.size() + phi_.size() - 1; 
-        int kbr = vertOffset + i*phi_.size();
-        int ktl = kbl + phi_.size();
-        int ktr = kbr + phi_.size();
-
-        // vertex keys:
-        std::tuple<size_t, size_t, std::string> keyBl(i, phi_.size() - 1, p);
-        std::tuple<size_t, size_t, std::string> keyBr(i, 0, p);
-        std::tuple<size_t, size_t, std::string> keyTl(i + 1, phi_.size() - 1, p);
-        std::tuple<size_t, size_t, std::string> keyTr(i + 1, 0, p);
+        unsigned int kbl = i*numPhi + numPhi - 1;
+        unsigned int kbr = i*numPhi;
+        unsigned int ktl = kbl + numPhi;
+        unsigned int ktr = kbr + numPhi;
 
-        // face weight is average of vertex weights:
-        real scalarA = weights_[keyBl] + weights_[keyTr] + weights_[keyTl];
-        real scalarB = weights_[keyBl] + weights_[keyBr] + weights_[keyTr];
-        scalarA /= 3.0;
-        scalarB /= 3.0;
+        // two faces per square:
+        indices.insert(indices.end(), {kbl, ktr, ktl});
+        indices.insert(indices.end(), {kbl, kbr, ktr});
+    }
 
-        // name of material from colour scale:
-        std::string mtlNameA = colScale.scalarToColourName(scalarA); 
-        std::string mtlNameB = colScale.scalarToColourName(scalarB); 
+    return indices;
+}
 
-        // two faces per square:
-        if( normals_.empty() )
-        {
-            faces.push_back( WavefrontObjFace(
-                    {kbl + 1, ktr + 1, ktl + 1},
-                    mtlNameA) );
-            faces.push_back( WavefrontObjFace(
-                    {kbl + 1, kbr + 1, ktr + 1},
-                    mtlNameB) );
-        }
-        else
-        {
 
-            faces.push_back( WavefrontObjFace(
-                    {kbl + 1, ktr + 1, ktl + 1},
-                    {kbl + 1, ktr + 1, ktl + 1},
-                    mtlNameA) );
-            faces.push_back( WavefrontObjFace(
-                    {kbl + 1, kbr + 1, ktr + 1},
-                    {kbl + 1, kbr + 1, ktr + 1},
-                    mtlNameB) );
-        }
+/*!
+ * Returns the index of the given property in the per-property weights. 
+ * Throws if the property has not been added to the grid.
+ */
+size_t
+RegularVertexGrid::propertyIndex(
+        const std::string &p) const
+{
+    auto it = std::find(p_.begin(), p_.end(), p);
+    if( it == p_.end() )
+    {
+        throw std::logic_error("Property " + p + " not found in "
+                               "RegularVertexGrid.");
     }
 
-    // return face vector:
-    return faces;
+    return std::distance(p_.begin(), it);
 }
 
 
+/*!
+ * Returns true if the vertices and at least one property have been set.
+ */
+bool
+RegularVertexGrid::isComplete() const
+{
+    return !vertices_.empty() && !p_.empty();
+}
+
 
 /*
  * Constructor sets default values for parameters.
@@ -471,6 +412,8 @@ MolecularPathObjExporter::MolecularPathObjExporter()
     : extrapDist_(0.0)
     , gridSampleDist_(-1.0)
     , correctionThreshold_(0.1)
+    , decimalPlaces_(6)
+    , meshFormat_(eMeshFormatObj)
 {
     
 }
@@ -520,9 +463,40 @@ MolecularPathObjExporter::setCorrectionThreshold(real correctionThreshold)
 }
 
 
+/*!
+ * Sets the number of decimal places with which vertex coordinates and 
+ * normals are written to the OBJ file.
+ */
+void
+MolecularPathObjExporter::setPrecision(int decimalPlaces)
+{
+    // sanity check:
+    if( decimalPlaces < 1 )
+    {
+        throw std::runtime_error("Number of decimal places for "
+                                 "MolecularPathObjExporter must be "
+                                 "positive!");
+    }
+
+    decimalPlaces_ = decimalPlaces;
+}
+
+
+/*!
+ * Sets the file format in which the pathway surface is written. For the 
+ * binary formats, no MTL file is written and colour palettes are ignored.
+ */
+void
+MolecularPathObjExporter::setMeshFormat(eMeshFormat meshFormat)
+{
+    meshFormat_ = meshFormat;
+}
+
+
 /*!
  * High level driver for exporting a MolecularPath object to an OBJ and MTL
- * file.
+ * file or to a binary PLY or glTF file, depending on the mesh format. File 
+ * extensions are appended to the given base name.
  */
 void
 MolecularPathObjExporter::operator()(
@@ -531,24 +505,32 @@ MolecularPathObjExporter::operator()(
         MolecularPath &molPath,
         std::map<std::string, ColourPalette> palettes)
 {
-    // define evaluation range:   
-    std::pair<real, real> range(molPath.sLo() - extrapDist_,
-                                molPath.sHi() + extrapDist_);
+    // Write Binary Mesh with Per-Vertex Properties
+    //-------------------------------------------------------------------------
 
-    // define resolution:
-    // TODO: make this a parameter?
-    int numPhi = 50;
-    int numLen = std::pow(2, 8) + 1;
-    std::pair<size_t, size_t> resolution(numLen, numPhi);
-    
-    // pathway geometry:
-    auto centreLine = molPath.centreLine();
-    auto pathRadius = molPath.pathRadius();
+    if( meshFormat_ != eMeshFormatObj )
+    {
+        // shared vertex mesh with all properties as attributes:
+        SurfaceMesh mesh = surfaceMesh(objectName, molPath);
 
-    // pathway properties:
-    // (radius is added here to ensure that there is always one property)
-    molPath.addScalarProperty("radius", pathRadius, false);
-    auto properties = molPath.scalarProperties();   
+        // write to file in requested format:
+        if( meshFormat_ == eMeshFormatPly )
+        {
+            PlyExporter plyExp;
+            plyExp.write(fileName + ".ply", mesh);
+        }
+        else
+        {
+            GltfExporter gltfExp;
+            gltfExp.write(fileName + ".glb", mesh);
+        }
+
+        return;
+    }
+
+    // generate the vertex grid:
+    std::map<std::string, std::pair<SplineCurve1D, bool>> properties;
+    RegularVertexGrid grid = generatePathwayGrid(molPath, properties);
 
 
     // Build OBJ & MTL Objects of Coloured Pore Surface
@@ -557,27 +539,33 @@ MolecularPathObjExporter::operator()(
     // prepare objects:
     WavefrontObjObject obj(objectName);
     WavefrontMtlObject mtl;
-  
-    // generate the vertex grid:
-    RegularVertexGrid grid = generateGrid(
-            centreLine,
-            pathRadius,
-            properties,
-            resolution,
-            range);
+
+    // vertex normals are shared by all properties:
+    grid.normalsFromFaces();
+    const std::vector<gmx::RVec> &vertexNormals = grid.normals();
+
+    // colour faces of all properties concurrently:
+    std::vector<std::future<std::vector<WavefrontObjFace>>> faceFutures;
+    for(auto &prop : properties)
+    {
+        faceFutures.push_back( std::async(
+                std::launch::async,
+                &RegularVertexGrid::faces,
+                &grid,
+                prop.first) );
+    }
 
     // loop over properties:
-    for(auto prop : properties)
+    auto faceFuture = faceFutures.begin();
+    for(auto &prop : properties)
     {
-        // obtain vertices, normals, and faces from grid:
-        grid.normalsFromFaces();
+        // obtain vertices and faces from grid:
         auto vertices = grid.weightedVertices(prop.first);
-        auto vertexNormals = grid.normals(prop.first);
-        auto faces = grid.faces(prop.first);
+        auto faces = (faceFuture++) -> get();
 
         // add faces to surface:
         WavefrontObjGroup group(prop.first);
-        for(auto face : faces)
+        for(auto &face : faces)
         {
             group.addFace(face);
         }
@@ -640,6 +628,7 @@ MolecularPathObjExporter::operator()(
 
     // create OBJ exporter and write to file:
     WavefrontObjExporter objExp;
+    objExp.setPrecision(decimalPlaces_);
     objExp.write(objFileName, obj);
 
     // create an MTL exporter and write to file:
@@ -648,10 +637,121 @@ MolecularPathObjExporter::operator()(
 }
 
 
+/*!
+ * Generates the surface of a MolecularPath as a SurfaceMesh with all scalar
+ * properties of the path (and its radius) attached to the vertices. The mesh
+ * is given in Angstrom. As the resolution of the underlying grid is fixed, 
+ * meshes generated from different MolecularPath objects have the same 
+ * connectivity.
+ */
+SurfaceMesh
+MolecularPathObjExporter::surfaceMesh(
+        std::string objectName,
+        MolecularPath &molPath)
+{
+    // generate the vertex grid:
+    std::map<std::string, std::pair<SplineCurve1D, bool>> properties;
+    RegularVertexGrid grid = generatePathwayGrid(molPath, properties);
+
+    // shared vertex mesh with all properties as attributes:
+    grid.normalsFromFaces();
+    SurfaceMesh mesh = generateSurfaceMesh(objectName, grid, properties);
+
+    // scale mesh by factor of 10 to convert nm to Ang:
+    mesh.scale(10.0);
+
+    return mesh;
+}
+
+
+/*!
+ * Creates the regular vertex grid for the given MolecularPath. The radius of
+ * the path is added as a scalar property (to ensure that there is always one
+ * property) and the properties mapped onto the grid are returned in the 
+ * second argument.
+ */
+RegularVertexGrid
+MolecularPathObjExporter::generatePathwayGrid(
+        MolecularPath &molPath,
+        std::map<std::string, std::pair<SplineCurve1D, bool>> &properties)
+{
+    // define evaluation range:   
+    std::pair<real, real> range(molPath.sLo() - extrapDist_,
+                                molPath.sHi() + extrapDist_);
+
+    // define resolution:
+    // TODO: make this a parameter?
+    int numPhi = 50;
+    int numLen = std::pow(2, 8) + 1;
+    std::pair<size_t, size_t> resolution(numLen, numPhi);
+    
+    // pathway geometry:
+    auto centreLine = molPath.centreLine();
+    auto pathRadius = molPath.pathRadius();
+
+    // pathway properties:
+    molPath.addScalarProperty("radius", pathRadius, false);
+    properties = molPath.scalarProperties();   
+
+    // generate the vertex grid:
+    return generateGrid(
+            centreLine,
+            pathRadius,
+            properties,
+            resolution,
+            range);
+}
+
+
+/*!
+ * Assembles a SurfaceMesh from the given grid. Positions and normals are
+ * taken from the grid and each property is sampled at the grid's \f$ s \f$ 
+ * coordinates and replicated around the circumference, so that the mesh 
+ * carries the physical rather than the rescaled property values. Vertex 
+ * normals must have been calculated before calling this function.
+ */
+SurfaceMesh
+MolecularPathObjExporter::generateSurfaceMesh(
+        std::string objectName,
+        RegularVertexGrid &grid,
+        std::map<std::string, std::pair<SplineCurve1D, bool>> &properties)
+{
+    // sanity check:
+    if( properties.empty() )
+    {
+        throw std::logic_error("Can not generate surface mesh without "
+                               "properties.");
+    }
+
+    // geometry is shared by all properties:
+    SurfaceMesh mesh(objectName);
+    mesh.setVertices(grid.vertices(), grid.normals());
+    mesh.setTriangles(grid.triangleIndices());
+
+    // per-vertex values of scalar properties:
+    size_t numPhi = grid.phi_.size();
+    for(auto &prop : properties)
+    {
+        std::vector<real> values;
+        values.reserve(grid.s_.size()*numPhi);
+        for(auto s : grid.s_)
+        {
+            values.insert(
+                    values.end(), 
+                    numPhi, 
+                    prop.second.first.evaluate(s, 0));
+        }
+        mesh.addProperty(prop.first, values);
+    }
+
+    return mesh;
+}
+
+
 /*!
  * Creates a regular vertex grid from a given centre line and radius spline.
- * This function loops over all given properties and for each property calls
- * generatePropertyGrid().
+ * The surface geometry is generated only once by generateGeometry() and each
+ * property is then attached to it by generatePropertyWeights().
  */
 RegularVertexGrid
 MolecularPathObjExporter::generateGrid(
@@ -690,14 +790,13 @@ MolecularPathObjExporter::generateGrid(
     // generate grid from coordinates:
     RegularVertexGrid grid(s, phi);
 
-    // loop over properties and add vertices:
+    // surface geometry is the same for all properties:
+    generateGeometry(centreLine, radius, grid);
+
+    // attach properties as per-vertex weights:
     for(auto &prop : properties)
     {
-        generatePropertyGrid(
-                centreLine,
-                radius,
-                prop,
-                grid);
+        generatePropertyWeights(prop, grid);
     }
 
     // return the overall grid:
@@ -706,15 +805,15 @@ MolecularPathObjExporter::generateGrid(
 
 
 /*!
- * This function creates the actual vertices used in the RegularVertexGrid and
- * calculates the colour property by sampling the given spline curve at the
- * appropriate location.
+ * This function creates the actual vertices used in the RegularVertexGrid. 
+ * Vertex rings are sampled along the centre line, rings that clash with their
+ * neighbours are discarded, and the remaining rings are interpolated onto the
+ * grid coordinates. 
  */
 void
-MolecularPathObjExporter::generatePropertyGrid(
+MolecularPathObjExporter::generateGeometry(
         SplineCurve3D &centreLine,
         SplineCurve1D &radius,
-        std::pair<std::string, std::pair<SplineCurve1D, bool>> property,
         RegularVertexGrid &grid)
 {   
     // extract grid coordinates:
@@ -890,6 +989,32 @@ MolecularPathObjExporter::generatePropertyGrid(
     // build mesh
     // ------------------------------------------------------------------------
 
+    // loop over target grid coordinates and collect vertices:
+    std::vector<gmx::RVec> vertices;
+    vertices.reserve(grid.s_.size()*grid.phi_.size());
+    for(size_t i = 0; i < grid.s_.size(); i++)
+    {
+        for(size_t k = 0; k < grid.phi_.size(); k++)
+        {
+            vertices.push_back( curves[k].evaluate(grid.s_[i], 0) );
+        }
+    }
+
+    // add to grid in one go:
+    grid.setVertices(vertices);
+}
+
+
+/*!
+ * Calculates the colour property by sampling the given spline curve at the
+ * grid's \f$ s \f$ coordinates and attaches it to all vertices of the 
+ * corresponding ring of the RegularVertexGrid.
+ */
+void
+MolecularPathObjExporter::generatePropertyWeights(
+        std::pair<const std::string, std::pair<SplineCurve1D, bool>> &property,
+        RegularVertexGrid &grid)
+{
     // sample scalar property along the path and rescale to unit interval:
     std::vector<real> prop;
     prop.reserve(grid.s_.size());
@@ -899,19 +1024,16 @@ MolecularPathObjExporter::generatePropertyGrid(
     }
     shiftAndScale(prop, property.second.second);
 
-    // loop over target grid coordinates and add vertices:
+    // same weight for all vertices in a ring:
+    std::vector<real> weights;
+    weights.reserve(grid.s_.size()*grid.phi_.size());
     for(size_t i = 0; i < grid.s_.size(); i++)
     {
-        for(size_t k = 0; k < grid.phi_.size(); k++)
-        {
-            grid.addVertex(
-                    i, 
-                    k, 
-                    property.first, 
-                    curves[k].evaluate(grid.s_[i], 0),
-                    prop[i]);
-        }
+        weights.insert(weights.end(), grid.phi_.size(), prop[i]);
     }
+
+    // add to grid:
+    grid.setWeights(property.first, weights);
 }
 
 
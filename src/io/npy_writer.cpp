@@ -0,0 +1,155 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+#include "io/npy_writer.hpp"
+
+
+/*!
+ * Writes an array of given shape to a .npy file. Any existing file of the 
+ * same name is overwritten. The number of elements in data must equal the 
+ * product of the shape.
+ */
+void
+NpyWriter::write(
+        const std::string &fileName,
+        const std::vector<real> &data,
+        const std::vector<size_t> &shape)
+{
+    // sanity check:
+    size_t numElements = 1;
+    for(auto n : shape)
+    {
+        numElements *= n;
+    }
+    if( numElements != data.size() )
+    {
+        throw std::logic_error("Number of array elements does not match "
+                               "array shape.");
+    }
+
+    // open output file:
+    std::ofstream file(
+            fileName.c_str(), 
+            std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    if( !file.is_open() )
+    {
+        throw std::runtime_error("ERROR: Could not open file " + 
+                                 fileName + ".");
+    }
+
+    // write header followed by data directly from memory:
+    std::string head = header(shape);
+    file.write(head.c_str(), head.size());
+    file.write(
+            reinterpret_cast<const char*>(data.data()), 
+            data.size()*sizeof(real));
+
+    // check that all data was written:
+    file.close();
+    if( file.fail() )
+    {
+        throw std::runtime_error("ERROR: Could not write to file " + 
+                                 fileName + ".");
+    }
+}
+
+
+/*!
+ * Creates the header of a .npy file, consisting of the magic string, the 
+ * format version, the header length, and a Python dictionary literal 
+ * describing the array. The dictionary is padded with spaces and terminated
+ * by a newline so that the data section starts at a multiple of 64 bytes.
+ */
+std::string
+NpyWriter::header(
+        const std::vector<size_t> &shape)
+{
+    // shape is written as Python tuple:
+    std::string shapeStr = "(";
+    for(size_t i = 0; i < shape.size(); i++)
+    {
+        if( i > 0 )
+        {
+            shapeStr += ", ";
+        }
+        shapeStr += std::to_string(shape[i]);
+    }
+    if( shape.size() == 1 )
+    {
+        shapeStr += ",";
+    }
+    shapeStr += ")";
+
+    // dictionary describing the array:
+    std::string dict = "{'descr': '" + descr() + "', "
+                       "'fortran_order': False, "
+                       "'shape': " + shapeStr + ", }";
+
+    // pad to alignment, accounting for magic string, version, length, and 
+    // terminating newline:
+    const size_t preambleLength = 10;
+    const size_t alignment = 64;
+    size_t totalLength = preambleLength + dict.size() + 1;
+    size_t padding = (alignment - totalLength % alignment) % alignment;
+    dict += std::string(padding, ' ') + "\n";
+
+    // header length is stored as little endian 16 bit integer:
+    if( dict.size() > UINT16_MAX )
+    {
+        throw std::logic_error("Array shape too large for NPY header.");
+    }
+    uint16_t headerLength = static_cast<uint16_t>(dict.size());
+
+    // assemble header:
+    std::string head("\x93NUMPY\x01\x00", 8);
+    head += static_cast<char>(headerLength & 0xFF);
+    head += static_cast<char>((headerLength >> 8) & 0xFF);
+    head += dict;
+
+    return head;
+}
+
+
+/*!
+ * Returns the NumPy type description of real in native byte order, i.e. 
+ * '<f4' for single precision on a little endian machine.
+ */
+std::string
+NpyWriter::descr()
+{
+    // determine byte order of this machine:
+    const uint16_t probe = 1;
+    bool littleEndian = *reinterpret_cast<const unsigned char*>(&probe) == 1;
+
+    std::string d = littleEndian ? "<" : ">";
+    d += "f" + std::to_string(sizeof(real));
+    return d;
+}
+
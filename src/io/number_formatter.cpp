@@ -0,0 +1,103 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "external/rapidjson/internal/dtoa.h"
+#include "external/rapidjson/internal/itoa.h"
+
+#include "io/number_formatter.hpp"
+
+
+/*!
+ * Appends a floating point number with at most the given number of decimal 
+ * places to the buffer. 
+ */
+void
+NumberFormatter::appendReal(
+        rapidjson::StringBuffer &buffer,
+        real value,
+        int decimalPlaces)
+{
+    // sanity check:
+    if( decimalPlaces < 1 )
+    {
+        throw std::logic_error("Number of decimal places must be positive.");
+    }
+
+    // Grisu2 can not handle non-finite numbers:
+    if( std::isnan(value) )
+    {
+        appendString(buffer, "nan");
+        return;
+    }
+    if( std::isinf(value) )
+    {
+        appendString(buffer, value > 0 ? "inf" : "-inf");
+        return;
+    }
+
+    // reserve sufficient space, format in place, and return unused space:
+    const size_t maxLength = 32;
+    char *begin = buffer.Push(maxLength);
+    char *end = rapidjson::internal::dtoa(
+            static_cast<double>(value), 
+            begin, 
+            decimalPlaces);
+    buffer.Pop(maxLength - static_cast<size_t>(end - begin));
+}
+
+
+/*!
+ * Appends an integer to the buffer.
+ */
+void
+NumberFormatter::appendInt(
+        rapidjson::StringBuffer &buffer,
+        int value)
+{
+    // reserve sufficient space, format in place, and return unused space:
+    const size_t maxLength = 12;
+    char *begin = buffer.Push(maxLength);
+    char *end = rapidjson::internal::i32toa(value, begin);
+    buffer.Pop(maxLength - static_cast<size_t>(end - begin));
+}
+
+
+/*!
+ * Appends a string to the buffer.
+ */
+void
+NumberFormatter::appendString(
+        rapidjson::StringBuffer &buffer,
+        const std::string &str)
+{
+    char *begin = buffer.Push(str.size());
+    std::memcpy(begin, str.data(), str.size());
+}
+
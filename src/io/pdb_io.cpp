@@ -51,6 +51,31 @@ PdbStructure::fromTopology(
 }
 
 
+/*!
+ * Creates a PdbStructure from a structure file in any format understood by 
+ * Gromacs. The topology read from the file is intentionally kept alive, as 
+ * the atoms refer to its symbol table.
+ */
+void
+PdbStructure::fromFile(
+        const std::string &fileName)
+{
+    // read structure file:
+    t_topology *topol = new t_topology;
+    read_tps_conf(
+            fileName.c_str(),       // input file name
+            topol,                  // topology
+            &ePBC_,                 // periodic BC
+            &coords_,               // atom coordinates
+            NULL,                   // velocities
+            box_,                   // box matrix
+            FALSE);                 // masses not required
+
+    // retrieve list of atoms in topology:
+    atoms_ = topol -> atoms;
+}
+
+
 /*!
  * Sets the occupancy and bfac fields of the PDB file to the time averaged 
  * pore-lining and pore-facing attributes.
@@ -0,0 +1,105 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <stdexcept>
+
+#include "io/binary_buffer.hpp"
+#include "io/ply_io.hpp"
+
+
+/*!
+ * Writes the given mesh to a binary PLY file of the given name. The complete
+ * file is assembled in memory and written in a single call.
+ */
+void
+PlyExporter::write(
+        const std::string &fileName,
+        const SurfaceMesh &mesh)
+{
+    // sanity checks:
+    if( !mesh.valid() )
+    {
+        throw std::logic_error("PlyExporter encountered invalid mesh.");
+    }
+
+    // header:
+    std::string header = "ply\n"
+                         "format binary_little_endian 1.0\n"
+                         "comment produced by CHAP\n"
+                         "obj_info " + mesh.name_ + "\n"
+                         "element vertex " + 
+                         std::to_string(mesh.numVertices()) + "\n"
+                         "property float x\n"
+                         "property float y\n"
+                         "property float z\n"
+                         "property float nx\n"
+                         "property float ny\n"
+                         "property float nz\n";
+    for(const auto &prop : mesh.properties_)
+    {
+        header += "property float " + prop.first + "\n";
+    }
+    header += "element face " + std::to_string(mesh.numTriangles()) + "\n"
+              "property list uchar uint vertex_indices\n"
+              "end_header\n";
+
+    // preallocate buffer:
+    size_t numVertexFloats = 6 + mesh.properties_.size();
+    BinaryBuffer buffer;
+    buffer.reserve(
+            header.size() + 
+            mesh.numVertices()*numVertexFloats*sizeof(float) +
+            mesh.numTriangles()*(1 + 3*sizeof(uint32_t)));
+    buffer.appendString(header);
+
+    // vertex data with interleaved attributes:
+    for(size_t i = 0; i < mesh.numVertices(); i++)
+    {
+        buffer.appendFloat(mesh.positions_[i][XX]);
+        buffer.appendFloat(mesh.positions_[i][YY]);
+        buffer.appendFloat(mesh.positions_[i][ZZ]);
+        buffer.appendFloat(mesh.normals_[i][XX]);
+        buffer.appendFloat(mesh.normals_[i][YY]);
+        buffer.appendFloat(mesh.normals_[i][ZZ]);
+        for(const auto &prop : mesh.properties_)
+        {
+            buffer.appendFloat(prop.second[i]);
+        }
+    }
+
+    // triangle data:
+    for(size_t i = 0; i < mesh.indices_.size(); i += 3)
+    {
+        buffer.appendUint8(3);
+        buffer.appendUint32(mesh.indices_[i]);
+        buffer.appendUint32(mesh.indices_[i + 1]);
+        buffer.appendUint32(mesh.indices_[i + 2]);
+    }
+
+    // write to file:
+    buffer.write(fileName);
+}
+
@@ -22,6 +22,8 @@
 // THE SOFTWARE.
 
 
+#include <cmath>
+#include <cstdio>
 #include <fstream>
 #include <exception>
 
@@ -51,7 +53,7 @@ ResultsJsonExporter::ResultsJsonExporter()
     rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
 
     // add reproducibility information:
-    rapidjson::Value reproInfo = reproducibilityInformation();
+    rapidjson::Value reproInfo = reproducibilityInformation(alloc);
     doc_.AddMember("reproducibilityInformation", reproInfo, alloc);
     
     // create a pathway summary object:
@@ -100,6 +102,40 @@ ResultsJsonExporter::addPathwaySummary(
 }
 
 
+/*!
+ * Overload of addPathwaySummary() that in addition adds standard errors of 
+ * the mean and statistical inefficiencies that account for the correlation 
+ * between successive frames. Both the block averaging (suffix "Block") and 
+ * the autocorrelation estimates (suffix "Acf") are added.
+ */
+void
+ResultsJsonExporter::addPathwaySummary(
+        std::string name,
+        const SummaryStatistics &summary,
+        const BlockAverageStatistics &blockAvg,
+        const AutocorrelationStatistics &autocorr)
+{
+    // add summary statistics:
+    addPathwaySummary(name, summary);
+
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // add error estimates to summary object:
+    rapidjson::Value &sumObj = doc_["pathwaySummary"][name.c_str()];
+    sumObj.AddMember("seBlock", blockAvg.standardError(), alloc);
+    sumObj.AddMember(
+            "statIneffBlock", 
+            blockAvg.statisticalInefficiency(), 
+            alloc);
+    sumObj.AddMember("seAcf", autocorr.standardError(), alloc);
+    sumObj.AddMember(
+            "statIneffAcf", 
+            autocorr.statisticalInefficiency(), 
+            alloc);
+}
+
+
 /*!
  * Adds a set of support points to the output document. May only be called 
  * once.
@@ -176,6 +212,152 @@ ResultsJsonExporter::addPathwayProfile(
 }
 
 
+/*!
+ * Overload of addPathwayProfile() for profiles accumulated in a 
+ * ProfileSummaryStatistics object. The output is identical to that obtained
+ * from the equivalent vector of SummaryStatistics.
+ */
+void
+ResultsJsonExporter::addPathwayProfile(
+        std::string name,
+        const ProfileSummaryStatistics &profile)
+{
+    // sanity checks:
+    if( !doc_["pathwayProfile"].HasMember("s") )
+    {
+        throw std::logic_error("Can not add profile to JSON document before "
+                               "support points have been added.");
+    }
+    if( profile.size() != doc_["pathwayProfile"]["s"].Size() )
+    {
+        throw std::logic_error("Number of data points in profile must equal "
+                               "number of suppoert points.");
+    }
+
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // create JSON arrays for the various summary statistics:
+    rapidjson::Value min(rapidjson::kArrayType);
+    rapidjson::Value max(rapidjson::kArrayType);
+    rapidjson::Value mean(rapidjson::kArrayType);
+    rapidjson::Value sd(rapidjson::kArrayType);
+
+    // loop over the profile and fill JSON arrays:
+    for(size_t i = 0; i < profile.size(); i++)
+    {
+        min.PushBack(profile.min(i), alloc);
+        max.PushBack(profile.max(i), alloc);
+        mean.PushBack(profile.mean(i), alloc);
+        sd.PushBack(profile.sd(i), alloc);
+    }
+
+    // add to table (as individual columns:
+    doc_["pathwayProfile"].AddMember(toVal(name + "Min"), min, alloc);
+    doc_["pathwayProfile"].AddMember(toVal(name + "Max"), max, alloc);
+    doc_["pathwayProfile"].AddMember(toVal(name + "Mean"), mean, alloc);
+    doc_["pathwayProfile"].AddMember(toVal(name + "Sd"), sd, alloc);
+}
+
+
+/*!
+ * Overload of addPathwayProfile() that in addition to minimum, maximum, mean,
+ * and standard deviation also adds the estimated quantile profiles. The 
+ * median is added with suffix "Median", all other quantiles with suffix "Q" 
+ * followed by the two digit percentage (e.g. "radiusQ05" for the five 
+ * percent quantile of the radius profile).
+ */
+void
+ResultsJsonExporter::addPathwayProfile(
+        std::string name,
+        const ProfileSummaryStatistics &profile,
+        const ProfileQuantileStatistics &quantiles)
+{
+    // sanity check:
+    if( quantiles.size() != profile.size() )
+    {
+        throw std::logic_error("Quantile profile must have as many data "
+                               "points as summary statistics profile.");
+    }
+
+    // add summary statistics:
+    addPathwayProfile(name, profile);
+
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // add each quantile as individual column:
+    std::vector<real> probs = quantiles.probs();
+    for(size_t j = 0; j < probs.size(); j++)
+    {
+        rapidjson::Value q(rapidjson::kArrayType);
+        for(auto val : quantiles.quantile(j))
+        {
+            q.PushBack(val, alloc);
+        }
+        doc_["pathwayProfile"].AddMember(
+                toVal(name + quantileSuffix(probs[j])), q, alloc);
+    }
+}
+
+
+/*!
+ * Adds standard errors of the mean and statistical inefficiencies at each 
+ * support point of a profile as individual columns. Estimates from block 
+ * averaging are added with suffixes "SeBlock" and "StatIneffBlock", those 
+ * from autocorrelation analysis with suffixes "SeAcf" and "StatIneffAcf".
+ *
+ * Note that this requires that addSupportPoints() has already been called.
+ */
+void
+ResultsJsonExporter::addPathwayProfileErrors(
+        std::string name,
+        const std::vector<BlockAverageStatistics> &blockAvg,
+        const std::vector<AutocorrelationStatistics> &autocorr)
+{
+    // sanity checks:
+    if( !doc_["pathwayProfile"].HasMember("s") )
+    {
+        throw std::logic_error("Can not add profile to JSON document before "
+                               "support points have been added.");
+    }
+    if( blockAvg.size() != doc_["pathwayProfile"]["s"].Size() ||
+        autocorr.size() != doc_["pathwayProfile"]["s"].Size() )
+    {
+        throw std::logic_error("Number of data points in profile must equal "
+                               "number of suppoert points.");
+    }
+
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // create JSON arrays for the error estimates:
+    rapidjson::Value seBlock(rapidjson::kArrayType);
+    rapidjson::Value statIneffBlock(rapidjson::kArrayType);
+    rapidjson::Value seAcf(rapidjson::kArrayType);
+    rapidjson::Value statIneffAcf(rapidjson::kArrayType);
+
+    // loop over the profile and fill JSON arrays:
+    for(size_t i = 0; i < blockAvg.size(); i++)
+    {
+        seBlock.PushBack(blockAvg[i].standardError(), alloc);
+        statIneffBlock.PushBack(blockAvg[i].statisticalInefficiency(), alloc);
+        seAcf.PushBack(autocorr[i].standardError(), alloc);
+        statIneffAcf.PushBack(autocorr[i].statisticalInefficiency(), alloc);
+    }
+
+    // add to table (as individual columns):
+    doc_["pathwayProfile"].AddMember(
+            toVal(name + "SeBlock"), seBlock, alloc);
+    doc_["pathwayProfile"].AddMember(
+            toVal(name + "StatIneffBlock"), statIneffBlock, alloc);
+    doc_["pathwayProfile"].AddMember(
+            toVal(name + "SeAcf"), seAcf, alloc);
+    doc_["pathwayProfile"].AddMember(
+            toVal(name + "StatIneffAcf"), statIneffAcf, alloc);
+}
+
+
 /*!
  * Adds common time stamps for all scalar time series to output document.
  */
@@ -384,6 +566,104 @@ ResultsJsonExporter::addResidueSummary(
 }
 
 
+/*!
+ * Adds information on the convergence of the time-averaged profiles to the 
+ * output document. If the profiles have converged, the index and time stamp
+ * of the frame at which convergence was declared are also added.
+ */
+void
+ResultsJsonExporter::addConvergenceInformation(
+        bool converged,
+        int frame,
+        real time)
+{
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // create convergence object:
+    rapidjson::Value convergence;
+    convergence.SetObject();
+    convergence.AddMember("converged", converged, alloc);
+    if( converged )
+    {
+        convergence.AddMember("frame", frame, alloc);
+        convergence.AddMember("t", time, alloc);
+    }
+
+    // add to output document:
+    doc_.AddMember("convergence", convergence, alloc);
+}
+
+
+/*!
+ * Adds the names of the replicas whose results are averaged in an ensemble
+ * analysis to the output document. This must be called before any ensemble 
+ * profile is added.
+ */
+void
+ResultsJsonExporter::addEnsembleInformation(
+        const std::vector<std::string> &replicas)
+{
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // create ensemble object:
+    rapidjson::Value ensemble;
+    ensemble.SetObject();
+    ensemble.AddMember("numReplicas", static_cast<int>(replicas.size()), alloc);
+    rapidjson::Value replicaNames(rapidjson::kArrayType);
+    for(auto &replica : replicas)
+    {
+        replicaNames.PushBack(toVal(replica), alloc);
+    }
+    ensemble.AddMember("replicas", replicaNames, alloc);
+
+    // add to output document:
+    doc_.AddMember("ensemble", ensemble, alloc);
+}
+
+
+/*!
+ * Adds summary statistics of a profile over the replicas of an ensemble. The
+ * variance at each support point is the between-replica variance of the 
+ * time-averaged profiles.
+ */
+void
+ResultsJsonExporter::addEnsembleProfile(
+        std::string name,
+        const std::vector<SummaryStatistics> &profile)
+{
+    // sanity check:
+    if( !doc_.HasMember("ensemble") )
+    {
+        throw std::logic_error("Can not add ensemble profile before ensemble "
+                               "information has been added.");
+    }
+
+    // obtain an allocator:
+    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
+
+    // create a JSON array for each summary statistic:
+    rapidjson::Value min(rapidjson::kArrayType);
+    rapidjson::Value max(rapidjson::kArrayType);
+    rapidjson::Value mean(rapidjson::kArrayType);
+    rapidjson::Value var(rapidjson::kArrayType);
+    for(const auto &p : profile)
+    {
+        min.PushBack(p.min(), alloc);
+        max.PushBack(p.max(), alloc);
+        mean.PushBack(p.mean(), alloc);
+        var.PushBack(p.var(), alloc);
+    }
+
+    // add to output document:
+    doc_["ensemble"].AddMember(toVal(name + "Min"), min, alloc);
+    doc_["ensemble"].AddMember(toVal(name + "Max"), max, alloc);
+    doc_["ensemble"].AddMember(toVal(name + "Mean"), mean, alloc);
+    doc_["ensemble"].AddMember(toVal(name + "Var"), var, alloc);
+}
+
+
 /*!
  * Writes the JSON document to a file of the given name.
  */
@@ -419,15 +699,35 @@ ResultsJsonExporter::toVal(const std::string &str)
 }
 
 
+/*!
+ * Helper function that creates the name suffix for a quantile of the given
+ * probability.
+ */
+std::string
+ResultsJsonExporter::quantileSuffix(real p)
+{
+    // median has a dedicated name:
+    int percent = std::round(100.0*p);
+    if( percent == 50 )
+    {
+        return "Median";
+    }
+
+    // other quantiles are named by percentage:
+    char suffix[8];
+    std::snprintf(suffix, sizeof(suffix), "Q%02d", percent);
+    return std::string(suffix);
+}
+
+
 /*!
  * Returns a JSON object containing the CHAP version number and call string.
+ * The given allocator is used for all strings and nested objects.
  */
 rapidjson::Value
-ResultsJsonExporter::reproducibilityInformation()
+ResultsJsonExporter::reproducibilityInformation(
+        rapidjson::Document::AllocatorType &alloc)
 {
-    // obtain an allocator:
-    rapidjson::Document::AllocatorType &alloc = doc_.GetAllocator();
-
     // create an object to contain reproducibility information:
     rapidjson::Value reproInfo;
     reproInfo.SetObject();
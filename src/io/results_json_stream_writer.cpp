@@ -0,0 +1,1047 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <exception>
+#include <stdexcept>
+
+#include "io/npy_writer.hpp"
+#include "io/results_json_exporter.hpp"
+#include "io/results_json_stream_writer.hpp"
+#include "io/summary_statistics_json_converter.hpp"
+#include "io/summary_statistics_vector_json_converter.hpp"
+
+
+/*!
+ * Constructor only sets up the serialisation machinery. The output file is 
+ * created in open().
+ */
+ResultsJsonStreamWriter::ResultsJsonStreamWriter()
+    : file_()
+    , stream_()
+    , writer_(stream_)
+    , section_(eSectionNone)
+    , tsFormat_(eTimeSeriesFormatJson)
+    , hasSupportPoints_(false)
+    , numSupportPoints_(0)
+    , hasTimeStamps_(false)
+    , numTimeStamps_(0)
+    , hasGridPoints_(false)
+    , numGridPoints_(0)
+    , numGridTimeStamps_(0)
+    , numGridSupportPoints_(0)
+    , hasResidueInformation_(false)
+    , numResidues_(0)
+{
+
+}
+
+
+/*!
+ * Opens the output file, starts the top level JSON object, and writes the 
+ * reproducibility information. Any existing file of the same name is 
+ * overwritten. Time series arrays written in NPY format are placed in the 
+ * same directory and named after the JSON file.
+ */
+void
+ResultsJsonStreamWriter::open(
+        const std::string &fileName,
+        eTimeSeriesFormat tsFormat)
+{
+    // array files are named after output file without extension:
+    tsFormat_ = tsFormat;
+    size_t sep = fileName.find_last_of('/');
+    arrayDirectory_ = (sep == std::string::npos) ? 
+                      "" : fileName.substr(0, sep + 1);
+    arrayBaseName_ = fileName.substr(arrayDirectory_.size());
+    const std::string ext = ".json";
+    if( arrayBaseName_.size() > ext.size() &&
+        arrayBaseName_.compare(
+                arrayBaseName_.size() - ext.size(), 
+                ext.size(), 
+                ext) == 0 )
+    {
+        arrayBaseName_.resize(arrayBaseName_.size() - ext.size());
+    }
+
+    // open output file and attach writer to its buffer:
+    file_.open(fileName);
+    stream_.reset(file_.buffer());
+    writer_.Reset(stream_);
+
+    // reset state from any previous file:
+    section_ = eSectionNone;
+    hasSupportPoints_ = false;
+    numSupportPoints_ = 0;
+    hasTimeStamps_ = false;
+    numTimeStamps_ = 0;
+    hasGridPoints_ = false;
+    numGridPoints_ = 0;
+    numGridTimeStamps_ = 0;
+    numGridSupportPoints_ = 0;
+    hasResidueInformation_ = false;
+    numResidues_ = 0;
+    hasEnsembleInformation_ = false;
+
+    // start overall document:
+    checkWriter(writer_.StartObject());
+
+    // add reproducibility information:
+    rapidjson::Document doc;
+    writeKey(sectionName(eSectionReproducibilityInformation));
+    writeValue(ResultsJsonExporter::reproducibilityInformation(
+            doc.GetAllocator()));
+    section_ = eSectionReproducibilityInformation;
+    commit();
+}
+
+
+/*!
+ * Completes all remaining top level objects, terminates the document with a
+ * newline, and closes the output file.
+ */
+void
+ResultsJsonStreamWriter::close()
+{
+    // nothing to do if file was never opened:
+    if( section_ == eSectionNone )
+    {
+        return;
+    }
+
+    // complete outstanding objects and overall document:
+    enterSection(eSectionEnd);
+    checkWriter(writer_.EndObject());
+    if( !writer_.IsComplete() )
+    {
+        throw std::logic_error("Results JSON document is incomplete.");
+    }
+    stream_.Put('\n');
+
+    // write remaining output to disk:
+    file_.close();
+    section_ = eSectionNone;
+}
+
+
+/*!
+ * Adds summary statistics of a named variable to the output.
+ */
+void
+ResultsJsonStreamWriter::addPathwaySummary(
+        std::string name,
+        const SummaryStatistics &summary)
+{
+    enterSection(eSectionPathwaySummary);
+
+    // convert summary statistics and write to file:
+    rapidjson::Document doc;
+    writeKey(name);
+    writeValue(SummaryStatisticsJsonConverter::convert(
+            summary, 
+            doc.GetAllocator()));
+    commit();
+}
+
+
+/*!
+ * Overload of addPathwaySummary() that in addition adds standard errors of 
+ * the mean and statistical inefficiencies from block averaging (suffix 
+ * "Block") and autocorrelation analysis (suffix "Acf").
+ */
+void
+ResultsJsonStreamWriter::addPathwaySummary(
+        std::string name,
+        const SummaryStatistics &summary,
+        const BlockAverageStatistics &blockAvg,
+        const AutocorrelationStatistics &autocorr)
+{
+    enterSection(eSectionPathwaySummary);
+
+    // convert summary statistics:
+    rapidjson::Document doc;
+    rapidjson::Document::AllocatorType &alloc = doc.GetAllocator();
+    rapidjson::Value sumObj = SummaryStatisticsJsonConverter::convert(
+            summary, 
+            alloc);
+
+    // add error estimates to summary object:
+    sumObj.AddMember("seBlock", blockAvg.standardError(), alloc);
+    sumObj.AddMember(
+            "statIneffBlock", 
+            blockAvg.statisticalInefficiency(), 
+            alloc);
+    sumObj.AddMember("seAcf", autocorr.standardError(), alloc);
+    sumObj.AddMember(
+            "statIneffAcf", 
+            autocorr.statisticalInefficiency(), 
+            alloc);
+
+    // write to file:
+    writeKey(name);
+    writeValue(sumObj);
+    commit();
+}
+
+
+/*!
+ * Adds a set of support points to the pathway profile. May only be called 
+ * once.
+ */
+void
+ResultsJsonStreamWriter::addSupportPoints(
+        const std::vector<real> &supportPoints)
+{
+    enterSection(eSectionPathwayProfile);
+
+    writeKey("s");
+    writeRealArray(supportPoints);
+    commit();
+
+    hasSupportPoints_ = true;
+    numSupportPoints_ = supportPoints.size();
+}
+
+
+/*!
+ * Adds minimum, maximum, mean, and standard deviation of a profile as 
+ * individual columns. Requires that addSupportPoints() has already been 
+ * called.
+ */
+void
+ResultsJsonStreamWriter::addPathwayProfile(
+        std::string name,
+        const std::vector<SummaryStatistics> &profile)
+{
+    checkProfileSize(profile.size());
+    enterSection(eSectionPathwayProfile);
+
+    // write each summary statistic as individual column:
+    writeKey(name + "Min");
+    checkWriter(writer_.StartArray());
+    for(const auto &p : profile)
+    {
+        writeReal(p.min());
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey(name + "Max");
+    checkWriter(writer_.StartArray());
+    for(const auto &p : profile)
+    {
+        writeReal(p.max());
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey(name + "Mean");
+    checkWriter(writer_.StartArray());
+    for(const auto &p : profile)
+    {
+        writeReal(p.mean());
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey(name + "Sd");
+    checkWriter(writer_.StartArray());
+    for(const auto &p : profile)
+    {
+        writeReal(p.sd());
+    }
+    checkWriter(writer_.EndArray());
+
+    commit();
+}
+
+
+/*!
+ * Overload of addPathwayProfile() for profiles accumulated in a 
+ * ProfileSummaryStatistics object.
+ */
+void
+ResultsJsonStreamWriter::addPathwayProfile(
+        std::string name,
+        const ProfileSummaryStatistics &profile)
+{
+    checkProfileSize(profile.size());
+    enterSection(eSectionPathwayProfile);
+
+    // write each summary statistic as individual column:
+    writeKey(name + "Min");
+    checkWriter(writer_.StartArray());
+    for(size_t i = 0; i < profile.size(); i++)
+    {
+        writeReal(profile.min(i));
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey(name + "Max");
+    checkWriter(writer_.StartArray());
+    for(size_t i = 0; i < profile.size(); i++)
+    {
+        writeReal(profile.max(i));
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey(name + "Mean");
+    checkWriter(writer_.StartArray());
+    for(size_t i = 0; i < profile.size(); i++)
+    {
+        writeReal(profile.mean(i));
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey(name + "Sd");
+    checkWriter(writer_.StartArray());
+    for(size_t i = 0; i < profile.size(); i++)
+    {
+        writeReal(profile.sd(i));
+    }
+    checkWriter(writer_.EndArray());
+
+    commit();
+}
+
+
+/*!
+ * Overload of addPathwayProfile() that in addition writes the estimated 
+ * quantile profiles, named as in ResultsJsonExporter::quantileSuffix().
+ */
+void
+ResultsJsonStreamWriter::addPathwayProfile(
+        std::string name,
+        const ProfileSummaryStatistics &profile,
+        const ProfileQuantileStatistics &quantiles)
+{
+    // sanity check:
+    if( quantiles.size() != profile.size() )
+    {
+        throw std::logic_error("Quantile profile must have as many data "
+                               "points as summary statistics profile.");
+    }
+
+    // add summary statistics:
+    addPathwayProfile(name, profile);
+
+    // add each quantile as individual column:
+    std::vector<real> probs = quantiles.probs();
+    for(size_t j = 0; j < probs.size(); j++)
+    {
+        writeKey(name + ResultsJsonExporter::quantileSuffix(probs[j]));
+        writeRealArray(quantiles.quantile(j));
+    }
+    commit();
+}
+
+
+/*!
+ * Adds standard errors of the mean and statistical inefficiencies at each 
+ * support point of a profile as individual columns. Requires that 
+ * addSupportPoints() has already been called.
+ */
+void
+ResultsJsonStreamWriter::addPathwayProfileErrors(
+        std::string name,
+        const std::vector<BlockAverageStatistics> &blockAvg,
+        const std::vector<AutocorrelationStatistics> &autocorr)
+{
+    checkProfileSize(blockAvg.size());
+    checkProfileSize(autocorr.size());
+    enterSection(eSectionPathwayProfile);
+
+    // write each error estimate as individual column:
+    writeKey(name + "SeBlock");
+    checkWriter(writer_.StartArray());
+    for(const auto &b : blockAvg)
+    {
+        writeReal(b.standardError());
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey(name + "StatIneffBlock");
+    checkWriter(writer_.StartArray());
+    for(const auto &b : blockAvg)
+    {
+        writeReal(b.statisticalInefficiency());
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey(name + "SeAcf");
+    checkWriter(writer_.StartArray());
+    for(const auto &a : autocorr)
+    {
+        writeReal(a.standardError());
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey(name + "StatIneffAcf");
+    checkWriter(writer_.StartArray());
+    for(const auto &a : autocorr)
+    {
+        writeReal(a.statisticalInefficiency());
+    }
+    checkWriter(writer_.EndArray());
+
+    commit();
+}
+
+
+/*!
+ * Adds common time stamps for all scalar time series. 
+ */
+void
+ResultsJsonStreamWriter::addTimeStamps(
+        const std::vector<real> &timeStamps)
+{
+    enterSection(eSectionPathwayScalarTimeSeries);
+
+    if( tsFormat_ == eTimeSeriesFormatNpy )
+    {
+        writeArrayFile("t", timeStamps, {timeStamps.size()});
+    }
+    else
+    {
+        writeKey("t");
+        writeRealArray(timeStamps);
+    }
+    commit();
+
+    hasTimeStamps_ = true;
+    numTimeStamps_ = timeStamps.size();
+}
+
+
+/*!
+ * Adds a named scalar time series. Requires that addTimeStamps() has been
+ * called before.
+ */
+void
+ResultsJsonStreamWriter::addPathwayScalarTimeSeries(
+        std::string name,
+        const std::vector<real> &timeSeries)
+{
+    // sanity checks:
+    if( !hasTimeStamps_ )
+    {
+        throw std::logic_error("Can not add time series data before adding "
+                               "time stamps.");
+    }
+    if( timeSeries.size() != numTimeStamps_ )
+    {
+        throw std::logic_error("Time series must have as many data points "
+                               "as there are time stamp values.");
+    }
+    enterSection(eSectionPathwayScalarTimeSeries);
+
+    if( tsFormat_ == eTimeSeriesFormatNpy )
+    {
+        writeArrayFile(name, timeSeries, {timeSeries.size()});
+    }
+    else
+    {
+        writeKey(name);
+        writeRealArray(timeSeries);
+    }
+    commit();
+}
+
+
+/*!
+ * Adds temporal and spatial grid points for the long-format table of profile
+ * data over time and space. The grid is written one time step at a time and
+ * never held in memory as a whole. In NPY format, only the time stamps and 
+ * support points are written as the axes of the profile matrices. Should 
+ * only be called once.
+ */
+void
+ResultsJsonStreamWriter::addPathwayGridPoints(
+        const std::vector<real> &timeStamps,
+        const std::vector<real> &supportPoints)
+{
+    enterSection(eSectionPathwayProfileTimeSeries);
+
+    // record grid dimensions:
+    hasGridPoints_ = true;
+    numGridPoints_ = timeStamps.size()*supportPoints.size();
+    numGridTimeStamps_ = timeStamps.size();
+    numGridSupportPoints_ = supportPoints.size();
+
+    // matrix axes are written as separate arrays:
+    if( tsFormat_ == eTimeSeriesFormatNpy )
+    {
+        writeArrayFile("t", timeStamps, {timeStamps.size()});
+        writeArrayFile("s", supportPoints, {supportPoints.size()});
+        commit();
+        return;
+    }
+
+    // time coordinate of each grid point:
+    writeKey("t");
+    checkWriter(writer_.StartArray());
+    for(auto t : timeStamps)
+    {
+        for(size_t i = 0; i < supportPoints.size(); i++)
+        {
+            writeReal(t);
+        }
+        commit();
+    }
+    checkWriter(writer_.EndArray());
+
+    // spatial coordinate of each grid point:
+    writeKey("s");
+    checkWriter(writer_.StartArray());
+    for(size_t i = 0; i < timeStamps.size(); i++)
+    {
+        for(auto s : supportPoints)
+        {
+            writeReal(s);
+        }
+        commit();
+    }
+    checkWriter(writer_.EndArray());
+    commit();
+}
+
+
+/*!
+ * Adds a vector-valued time series in long format. Requires that 
+ * addPathwayGridPoints() has been called before and checks that the number 
+ * of data points in the time series is equal to the number of grid points. 
+ */
+void
+ResultsJsonStreamWriter::addPathwayProfileTimeSeries(
+        std::string name,
+        const std::vector<std::vector<real>> &timeSeries)
+{
+    // sanity checks:
+    if( !hasGridPoints_ )
+    {
+        throw std::logic_error("Can not at profile time series data before "
+                               "setting space time grid.");
+    }
+    size_t numDataPoints = 0;
+    if( !timeSeries.empty() )
+    {
+        numDataPoints = timeSeries.size() * timeSeries.back().size();
+    }
+    if( numDataPoints != numGridPoints_ )
+    {
+        throw std::logic_error("Time series must have as many data points "
+                               "as grid points.");
+    }
+
+    // concatenate time steps:
+    std::vector<real> values;
+    values.reserve(numDataPoints);
+    for(const auto &p : timeSeries)
+    {
+        values.insert(values.end(), p.begin(), p.end());
+    }
+    addPathwayProfileTimeSeries(name, values);
+}
+
+
+/*!
+ * Overload of addPathwayProfileTimeSeries() for a time series stored as a 
+ * contiguous array with all support points of the first time step followed 
+ * by those of the next time step and so on. In JSON format, data is written
+ * one time step at a time. In NPY format, the array is written to file as a
+ * single block.
+ */
+void
+ResultsJsonStreamWriter::addPathwayProfileTimeSeries(
+        std::string name,
+        const std::vector<real> &timeSeries)
+{
+    // sanity checks:
+    if( !hasGridPoints_ )
+    {
+        throw std::logic_error("Can not at profile time series data before "
+                               "setting space time grid.");
+    }
+    if( timeSeries.size() != numGridPoints_ )
+    {
+        throw std::logic_error("Time series must have as many data points "
+                               "as grid points.");
+    }
+    enterSection(eSectionPathwayProfileTimeSeries);
+
+    // write as matrix with one row per time step:
+    if( tsFormat_ == eTimeSeriesFormatNpy )
+    {
+        writeArrayFile(
+                name, 
+                timeSeries, 
+                {numGridTimeStamps_, numGridSupportPoints_});
+        commit();
+        return;
+    }
+
+    // loop over time points:
+    writeKey(name);
+    checkWriter(writer_.StartArray());
+    for(size_t i = 0; i < timeSeries.size(); i++)
+    {
+        writeReal(timeSeries[i]);
+        if( (i + 1) % numGridSupportPoints_ == 0 )
+        {
+            commit();
+        }
+    }
+    checkWriter(writer_.EndArray());
+    commit();
+}
+
+
+/*!
+ * Adds time-constant residue information (residue ID, name, chain, and 
+ * hydrophobicity). Can only be called once.
+ */
+void
+ResultsJsonStreamWriter::addResidueInformation(
+        const std::vector<int> &resId,
+        const ResidueInformationProvider &resInf)
+{
+    enterSection(eSectionResidueSummary);
+
+    writeKey("id");
+    checkWriter(writer_.StartArray());
+    for(auto i : resId)
+    {
+        checkWriter(writer_.Int(i));
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey("name");
+    checkWriter(writer_.StartArray());
+    for(auto i : resId)
+    {
+        std::string name = resInf.name(i);
+        checkWriter(writer_.String(
+                name.c_str(), 
+                static_cast<rapidjson::SizeType>(name.size())));
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey("chain");
+    checkWriter(writer_.StartArray());
+    for(auto i : resId)
+    {
+        std::string chain = resInf.chain(i);
+        checkWriter(writer_.String(
+                chain.c_str(), 
+                static_cast<rapidjson::SizeType>(chain.size())));
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey("hydrophobicity");
+    checkWriter(writer_.StartArray());
+    for(auto i : resId)
+    {
+        writeReal(resInf.hydrophobicity(i));
+    }
+    checkWriter(writer_.EndArray());
+    commit();
+
+    hasResidueInformation_ = true;
+    numResidues_ = resId.size();
+}
+
+
+/*!
+ * Adds summary statistics of a time-dependent residue property. Requires 
+ * that addResidueInformation() has been called beforehand and that the 
+ * number of data points equals the number of residues.
+ */
+void
+ResultsJsonStreamWriter::addResidueSummary(
+        std::string name,
+        const std::vector<SummaryStatistics> &resSummary)
+{
+    // sanity checks:
+    if( !hasResidueInformation_ )
+    {
+        throw std::logic_error("Can not add summary statistics to residue "
+                               "summary before residue information has been "
+                               "added.");
+    }
+    if( resSummary.size() != numResidues_ )
+    {
+        throw std::logic_error("Number of data points in summary statistics "
+                               "vector must equal number residues.");
+    }
+    enterSection(eSectionResidueSummary);
+
+    // convert the summary statistics to JSON format and write to file:
+    rapidjson::Document doc;
+    writeKey(name);
+    writeValue(SummaryStatisticsVectorJsonConverter::convert(
+            resSummary, 
+            doc.GetAllocator()));
+    commit();
+}
+
+
+/*!
+ * Adds information on the convergence of the time-averaged profiles. If the
+ * profiles have converged, the index and time stamp of the frame at which 
+ * convergence was declared are also added.
+ */
+void
+ResultsJsonStreamWriter::addConvergenceInformation(
+        bool converged,
+        int frame,
+        real time)
+{
+    enterSection(eSectionConvergence);
+
+    writeKey(sectionName(eSectionConvergence));
+    checkWriter(writer_.StartObject());
+    writeKey("converged");
+    checkWriter(writer_.Bool(converged));
+    if( converged )
+    {
+        writeKey("frame");
+        checkWriter(writer_.Int(frame));
+        writeKey("t");
+        writeReal(time);
+    }
+    checkWriter(writer_.EndObject());
+    commit();
+}
+
+
+/*!
+ * Adds the names of the replicas whose results are averaged in an ensemble
+ * analysis. This must be called before any ensemble profile is added.
+ */
+void
+ResultsJsonStreamWriter::addEnsembleInformation(
+        const std::vector<std::string> &replicas)
+{
+    enterSection(eSectionEnsemble);
+
+    writeKey("numReplicas");
+    checkWriter(writer_.Int(static_cast<int>(replicas.size())));
+    writeKey("replicas");
+    checkWriter(writer_.StartArray());
+    for(auto &replica : replicas)
+    {
+        checkWriter(writer_.String(
+                replica.c_str(), 
+                static_cast<rapidjson::SizeType>(replica.size())));
+    }
+    checkWriter(writer_.EndArray());
+
+    hasEnsembleInformation_ = true;
+    commit();
+}
+
+
+/*!
+ * Adds summary statistics of a profile over the replicas of an ensemble. 
+ * Each summary statistic at a support point has been updated with the 
+ * time-averaged profile of each replica, so that its variance is the 
+ * between-replica variance. Requires that addEnsembleInformation() has been
+ * called.
+ */
+void
+ResultsJsonStreamWriter::addEnsembleProfile(
+        std::string name,
+        const std::vector<SummaryStatistics> &profile)
+{
+    // sanity checks:
+    if( !hasEnsembleInformation_ )
+    {
+        throw std::logic_error("Can not add ensemble profile before ensemble "
+                               "information has been added.");
+    }
+    checkProfileSize(profile.size());
+    enterSection(eSectionEnsemble);
+
+    // write each summary statistic as individual column:
+    writeKey(name + "Min");
+    checkWriter(writer_.StartArray());
+    for(const auto &p : profile)
+    {
+        writeReal(p.min());
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey(name + "Max");
+    checkWriter(writer_.StartArray());
+    for(const auto &p : profile)
+    {
+        writeReal(p.max());
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey(name + "Mean");
+    checkWriter(writer_.StartArray());
+    for(const auto &p : profile)
+    {
+        writeReal(p.mean());
+    }
+    checkWriter(writer_.EndArray());
+
+    writeKey(name + "Var");
+    checkWriter(writer_.StartArray());
+    for(const auto &p : profile)
+    {
+        writeReal(p.var());
+    }
+    checkWriter(writer_.EndArray());
+
+    commit();
+}
+
+
+/*!
+ * Advances the output to the given top level object. The currently open 
+ * object is completed and any objects in between are written as empty 
+ * objects, so that the file always contains all top level objects in the 
+ * same order as the output of ResultsJsonExporter.
+ */
+void
+ResultsJsonStreamWriter::enterSection(Section section)
+{
+    // sanity checks:
+    if( section_ == eSectionNone )
+    {
+        throw std::logic_error("Can not add results before output file has "
+                               "been opened.");
+    }
+    if( section < section_ )
+    {
+        throw std::logic_error("Can not add data to " + 
+                               std::string(sectionName(section)) + 
+                               " after " + 
+                               std::string(sectionName(section_)) + 
+                               " has been written.");
+    }
+    if( section == section_ )
+    {
+        return;
+    }
+
+    // object sections are those enclosed in braces by this function:
+    auto isObjectSection = [](int s)
+    {
+        return (s >= eSectionPathwaySummary && s <= eSectionResidueSummary) ||
+               s == eSectionEnsemble;
+    };
+
+    // complete current object:
+    if( isObjectSection(section_) )
+    {
+        checkWriter(writer_.EndObject());
+    }
+
+    // write empty objects for skipped sections (ensemble is optional):
+    for(int s = section_ + 1; s < section; s++)
+    {
+        if( isObjectSection(s) && s != eSectionEnsemble )
+        {
+            writeKey(sectionName(static_cast<Section>(s)));
+            checkWriter(writer_.StartObject());
+            checkWriter(writer_.EndObject());
+        }
+    }
+
+    // open new object:
+    if( isObjectSection(section) )
+    {
+        writeKey(sectionName(section));
+        checkWriter(writer_.StartObject());
+    }
+    section_ = section;
+}
+
+
+/*!
+ * Writes an object member name.
+ */
+void
+ResultsJsonStreamWriter::writeKey(const std::string &key)
+{
+    checkWriter(writer_.Key(
+            key.c_str(), 
+            static_cast<rapidjson::SizeType>(key.size())));
+}
+
+
+/*!
+ * Writes a complete JSON value, e.g. a small object created by one of the 
+ * JSON converters.
+ */
+void
+ResultsJsonStreamWriter::writeValue(const rapidjson::Value &value)
+{
+    checkWriter(value.Accept(writer_));
+}
+
+
+/*!
+ * Writes a single number. Numbers are written in double precision, exactly
+ * as a rapidjson::Value created from a real.
+ */
+void
+ResultsJsonStreamWriter::writeReal(real value)
+{
+    checkWriter(writer_.Double(static_cast<double>(value)));
+}
+
+
+/*!
+ * Writes a vector of numbers as a JSON array.
+ */
+void
+ResultsJsonStreamWriter::writeRealArray(const std::vector<real> &values)
+{
+    checkWriter(writer_.StartArray());
+    for(auto val : values)
+    {
+        writeReal(val);
+    }
+    checkWriter(writer_.EndArray());
+}
+
+
+/*!
+ * Writes an array to a NPY file and adds a reference to it to the current
+ * object. The reference contains the file name relative to the JSON file as
+ * well as the data type and shape of the array.
+ */
+void
+ResultsJsonStreamWriter::writeArrayFile(
+        const std::string &name,
+        const std::vector<real> &values,
+        const std::vector<size_t> &shape)
+{
+    // write array to file named after section and array:
+    std::string fileName = arrayBaseName_ + "_" + sectionName(section_) + 
+                           "_" + name + ".npy";
+    NpyWriter::write(arrayDirectory_ + fileName, values, shape);
+
+    // add reference to JSON output:
+    writeKey(name);
+    checkWriter(writer_.StartObject());
+    writeKey("file");
+    checkWriter(writer_.String(
+            fileName.c_str(), 
+            static_cast<rapidjson::SizeType>(fileName.size())));
+    writeKey("dtype");
+    std::string dtype = NpyWriter::descr();
+    checkWriter(writer_.String(
+            dtype.c_str(), 
+            static_cast<rapidjson::SizeType>(dtype.size())));
+    writeKey("shape");
+    checkWriter(writer_.StartArray());
+    for(auto n : shape)
+    {
+        checkWriter(writer_.Uint64(n));
+    }
+    checkWriter(writer_.EndArray());
+    checkWriter(writer_.EndObject());
+}
+
+
+/*!
+ * Hands the current buffer over to the file writer if it is sufficiently 
+ * full and points the output stream to the new buffer.
+ */
+void
+ResultsJsonStreamWriter::commit()
+{
+    file_.commit();
+    stream_.reset(file_.buffer());
+}
+
+
+/*!
+ * Throws if the writer has rejected a value. This happens e.g. for NaN or 
+ * infinite numbers, which can not be represented in JSON.
+ */
+void
+ResultsJsonStreamWriter::checkWriter(bool success)
+{
+    if( !success )
+    {
+        throw std::runtime_error("ERROR: Could not write results to JSON "
+                                 "file, possibly due to a NaN or infinite "
+                                 "value.");
+    }
+}
+
+
+/*!
+ * Checks that support points have been written and that a profile of the 
+ * given size matches them.
+ */
+void
+ResultsJsonStreamWriter::checkProfileSize(size_t size)
+{
+    if( !hasSupportPoints_ )
+    {
+        throw std::logic_error("Can not add profile to JSON document before "
+                               "support points have been added.");
+    }
+    if( size != numSupportPoints_ )
+    {
+        throw std::logic_error("Number of data points in profile must equal "
+                               "number of suppoert points.");
+    }
+}
+
+
+/*!
+ * Returns the member name of a top level object.
+ */
+const char*
+ResultsJsonStreamWriter::sectionName(Section section)
+{
+    switch( section )
+    {
+        case eSectionReproducibilityInformation:
+            return "reproducibilityInformation";
+        case eSectionPathwaySummary:
+            return "pathwaySummary";
+        case eSectionPathwayProfile:
+            return "pathwayProfile";
+        case eSectionPathwayScalarTimeSeries:
+            return "pathwayScalarTimeSeries";
+        case eSectionPathwayProfileTimeSeries:
+            return "pathwayProfileTimeSeries";
+        case eSectionResidueSummary:
+            return "residueSummary";
+        case eSectionConvergence:
+            return "convergence";
+        case eSectionEnsemble:
+            return "ensemble";
+        default:
+            return "output";
+    }
+}
+
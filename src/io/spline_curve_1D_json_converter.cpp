@@ -65,6 +65,28 @@ SplineCurve1DJsonConverter::fromJson(
         ctrlPoints.push_back(val["ctrl"][i].GetDouble());
     }
 
+    // return spline curve object;
+    return fromUniqueKnots(knots, ctrlPoints, degree);
+}
+
+
+/*!
+ * Creates a SplineCurve1D from unique knots and control points as they are 
+ * stored in the JSON serialisation, i.e. adds the duplicate endpoint knots.
+ */
+SplineCurve1D
+SplineCurve1DJsonConverter::fromUniqueKnots(
+        std::vector<real> knots,
+        const std::vector<real> &ctrlPoints,
+        unsigned int degree)
+{
+    // sanity check:
+    if( knots.empty() || knots.size() != ctrlPoints.size() )
+    {
+        throw std::logic_error("Can not construct 1D spline curve! "
+                               "Unequal number of knots and ctrl points.");
+    }
+
     // add duplicate endpoint knots:
     for(unsigned int i = 0; i< degree; i++)
     {
@@ -0,0 +1,174 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <stdexcept>
+
+#include "io/surface_mesh.hpp"
+
+
+/*!
+ * Constructs an empty mesh with the given name.
+ */
+SurfaceMesh::SurfaceMesh(std::string name)
+    : name_(name)
+{
+
+}
+
+
+/*!
+ * Sets vertex positions and normals. Both vectors must be of the same size.
+ */
+void
+SurfaceMesh::setVertices(
+        const std::vector<gmx::RVec> &positions,
+        const std::vector<gmx::RVec> &normals)
+{
+    // sanity check:
+    if( positions.size() != normals.size() )
+    {
+        throw std::logic_error("Number of vertex normals must equal number "
+                               "of vertices.");
+    }
+
+    positions_ = positions;
+    normals_ = normals;
+}
+
+
+/*!
+ * Sets the triangles of the mesh. Each consecutive triple of indices defines
+ * one triangle.
+ */
+void
+SurfaceMesh::setTriangles(
+        const std::vector<unsigned int> &indices)
+{
+    // sanity check:
+    if( indices.size() % 3 != 0 )
+    {
+        throw std::logic_error("Number of triangle indices must be a "
+                               "multiple of three.");
+    }
+
+    indices_ = indices;
+}
+
+
+/*!
+ * Adds a named scalar property with one value per vertex. Vertices must have
+ * been set before.
+ */
+void
+SurfaceMesh::addProperty(
+        std::string name,
+        const std::vector<real> &values)
+{
+    // sanity check:
+    if( values.size() != positions_.size() )
+    {
+        throw std::logic_error("Number of property values must equal number "
+                               "of vertices.");
+    }
+
+    properties_.push_back(std::make_pair(name, values));
+}
+
+
+/*!
+ * Scales all vertex positions by the given factor (e.g. to convert from nm to
+ * Angstrom). Normals are left unchanged.
+ */
+void
+SurfaceMesh::scale(real fac)
+{
+    for(auto &pos : positions_)
+    {
+        pos[XX] *= fac;
+        pos[YY] *= fac;
+        pos[ZZ] *= fac;
+    }
+}
+
+
+/*!
+ * Returns the number of vertices.
+ */
+size_t
+SurfaceMesh::numVertices() const
+{
+    return positions_.size();
+}
+
+
+/*!
+ * Returns the number of triangles.
+ */
+size_t
+SurfaceMesh::numTriangles() const
+{
+    return indices_.size() / 3;
+}
+
+
+/*!
+ * Returns a flag indicating whether the mesh is valid, i.e. all vertex 
+ * attributes have one entry per vertex and all triangles reference existing
+ * vertices.
+ */
+bool
+SurfaceMesh::valid() const
+{
+    // all attributes are given per vertex:
+    if( normals_.size() != positions_.size() )
+    {
+        return false;
+    }
+    for(const auto &prop : properties_)
+    {
+        if( prop.second.size() != positions_.size() )
+        {
+            return false;
+        }
+    }
+
+    // all triangles reference existing vertices:
+    if( indices_.size() % 3 != 0 )
+    {
+        return false;
+    }
+    for(auto idx : indices_)
+    {
+        if( idx >= positions_.size() )
+        {
+            return false;
+        }
+    }
+
+    // if nothing failed, return true:
+    return true;
+}
+
@@ -22,6 +22,9 @@
 // THE SOFTWARE.
 
 
+#include <stdexcept>
+
+#include "io/number_formatter.hpp"
 #include "io/wavefront_mtl_io.hpp"
 
 
@@ -79,63 +82,84 @@ WavefrontMtlObject::addMaterial(WavefrontMtlMaterial material)
 
 
 /*!
- * Writes MTL object to file.
+ * Constructor sets the default number of decimal places.
  */
-void
-WavefrontMtlExporter::write(std::string fileName, WavefrontMtlObject object)
+WavefrontMtlExporter::WavefrontMtlExporter()
+    : decimalPlaces_(6)
 {
-    file_.open(fileName.c_str(), std::fstream::out);
-    
-    // loop over materials:
-    for(auto material : object.materials_)
-    {
-        // write material specifications to file:
-        writeMaterialName(material.name_);
-        writeAmbientColour(material.ambientColour_);
-        writeDiffuseColour(material.diffuseColour_);
-        writeSpecularColour(material.specularColour_);
-    }
 
-    file_.close();
 }
 
 
 /*!
- * Writes material name to MTL file.
+ * Sets the maximum number of decimal places with which colour values are
+ * written. Must be positive.
  */
 void
-WavefrontMtlExporter::writeMaterialName(std::string name)
+WavefrontMtlExporter::setPrecision(int decimalPlaces)
 {
-    file_<<"newmtl "<<name<<std::endl;
+    if( decimalPlaces < 1 )
+    {
+        throw std::logic_error("Number of decimal places must be positive.");
+    }
+    decimalPlaces_ = decimalPlaces;
 }
 
 
 /*!
- * Writes ambient colour to MTL file.
+ * Writes MTL object to file.
  */
 void
-WavefrontMtlExporter::writeAmbientColour(const gmx::RVec &col)
+WavefrontMtlExporter::write(
+        std::string fileName, 
+        const WavefrontMtlObject &object)
 {
-    file_<<"Ka "<<col[XX]<<" "<<col[YY]<<" "<<col[ZZ]<<std::endl;
+    file_.open(fileName);
+    
+    // loop over materials:
+    for(const auto &material : object.materials_)
+    {
+        // write material specifications to file:
+        writeMaterialName(material.name_);
+        writeColour("Ka", material.ambientColour_);
+        writeColour("Kd", material.diffuseColour_);
+        writeColour("Ks", material.specularColour_);
+    }
+
+    file_.close();
 }
 
 
 /*!
- * Writes diffuse colour to MTL file.
+ * Writes material name to MTL file.
  */
 void
-WavefrontMtlExporter::writeDiffuseColour(const gmx::RVec &col)
+WavefrontMtlExporter::writeMaterialName(const std::string &name)
 {
-    file_<<"Kd "<<col[XX]<<" "<<col[YY]<<" "<<col[ZZ]<<std::endl;
+    rapidjson::StringBuffer &buf = file_.buffer();
+    NumberFormatter::appendString(buf, "newmtl ");
+    NumberFormatter::appendString(buf, name);
+    buf.Put('\n');
+    file_.commit();
 }
 
 
 /*!
- * Writes specular colour to MTL file.
+ * Writes a colour line (i.e. ambient, diffuse, or specular colour as 
+ * indicated by the keyword) to MTL file.
  */
 void
-WavefrontMtlExporter::writeSpecularColour(const gmx::RVec &col)
+WavefrontMtlExporter::writeColour(const char *keyword, const gmx::RVec &col)
 {
-    file_<<"Ks "<<col[XX]<<" "<<col[YY]<<" "<<col[ZZ]<<std::endl;
+    rapidjson::StringBuffer &buf = file_.buffer();
+    NumberFormatter::appendString(buf, keyword);
+    buf.Put(' ');
+    NumberFormatter::appendReal(buf, col[XX], decimalPlaces_);
+    buf.Put(' ');
+    NumberFormatter::appendReal(buf, col[YY], decimalPlaces_);
+    buf.Put(' ');
+    NumberFormatter::appendReal(buf, col[ZZ], decimalPlaces_);
+    buf.Put('\n');
+    file_.commit();
 }
 
@@ -24,6 +24,7 @@
 
 #include <algorithm>
 
+#include "io/number_formatter.hpp"
 #include "io/wavefront_obj_io.hpp"
 
 
@@ -345,12 +346,37 @@ WavefrontObjObject::valid() const
 }
 
 
+/*!
+ * Constructor sets the default number of decimal places.
+ */
+WavefrontObjExporter::WavefrontObjExporter()
+    : decimalPlaces_(6)
+{
+
+}
+
+
+/*!
+ * Sets the maximum number of decimal places with which vertex coordinates,
+ * weights and normals are written. Must be positive.
+ */
+void
+WavefrontObjExporter::setPrecision(int decimalPlaces)
+{
+    if( decimalPlaces < 1 )
+    {
+        throw std::logic_error("Number of decimal places must be positive.");
+    }
+    decimalPlaces_ = decimalPlaces;
+}
+
+
 /*!
  * Writes an OBJ object to a file of the given name. 
  */
 void
 WavefrontObjExporter::write(std::string fileName,
-                            WavefrontObjObject object)
+                            const WavefrontObjObject &object)
 {
     // sanity checks:
     if( !object.valid() )
@@ -359,8 +385,9 @@ WavefrontObjExporter::write(std::string fileName,
                                "OBJ object.");
     }
 
-    // open file stream:
-    obj_.open(fileName.c_str(), std::fstream::out);
+    // open file and reset material state from any previous file:
+    file_.open(fileName);
+    crntMtlName_ = "";
 
     // writer header comment:
     writeComment("produced by CHAP");
@@ -372,22 +399,21 @@ WavefrontObjExporter::write(std::string fileName,
     writeObject(object.name_);
 
     // write vertices:
-    obj_<<std::endl;
+    writeEmptyLine();
     for(unsigned int i = 0; i < object.vertices_.size(); i++)
     {
         writeVertex(object.vertices_[i]);
     }
 
     // write vertex normals:
-    obj_<<std::endl;
+    writeEmptyLine();
     for(unsigned int i = 0; i < object.normals_.size(); i++)
     {
         writeVertexNormal(object.normals_[i]);
     }
 
     // write groups:
-    std::vector<WavefrontObjGroup>::iterator it;
-    for(it = object.groups_.begin(); it != object.groups_.end(); it++)
+    for(auto it = object.groups_.begin(); it != object.groups_.end(); it++)
     {
         // write group name:
         writeGroup(it -> groupname_);
@@ -399,8 +425,8 @@ WavefrontObjExporter::write(std::string fileName,
         }
     }
 
-    // close file stream:
-    obj_.close();
+    // write remaining buffer and close file:
+    file_.close();
 }
 
 
@@ -408,9 +434,13 @@ WavefrontObjExporter::write(std::string fileName,
  * Writes a comment line to an OBJ file.
  */
 void
-WavefrontObjExporter::writeComment(std::string comment)
+WavefrontObjExporter::writeComment(const std::string &comment)
 {
-    obj_ <<"# "<<comment<<std::endl;
+    rapidjson::StringBuffer &buf = file_.buffer();
+    NumberFormatter::appendString(buf, "# ");
+    NumberFormatter::appendString(buf, comment);
+    buf.Put('\n');
+    file_.commit();
 }
 
 
@@ -418,12 +448,16 @@ WavefrontObjExporter::writeComment(std::string comment)
  * Writes material library referenct to an OBJ file.
  */
 void
-WavefrontObjExporter::writeMaterialLibrary(std::string mtl)
+WavefrontObjExporter::writeMaterialLibrary(const std::string &mtl)
 {
     // library set?
     if( mtl != "" )
     {
-        obj_<<"mtllib "<<mtl<<std::endl;
+        rapidjson::StringBuffer &buf = file_.buffer();
+        NumberFormatter::appendString(buf, "mtllib ");
+        NumberFormatter::appendString(buf, mtl);
+        buf.Put('\n');
+        file_.commit();
     }
 }
 
@@ -432,10 +466,13 @@ WavefrontObjExporter::writeMaterialLibrary(std::string mtl)
  * Writes a group line to an OBJ file.
  */
 void
-WavefrontObjExporter::writeGroup(std::string group)
+WavefrontObjExporter::writeGroup(const std::string &group)
 {
-    obj_ <<std::endl;
-    obj_ <<"g "<<group<<std::endl;
+    rapidjson::StringBuffer &buf = file_.buffer();
+    NumberFormatter::appendString(buf, "\ng ");
+    NumberFormatter::appendString(buf, group);
+    buf.Put('\n');
+    file_.commit();
 }
 
 
@@ -443,10 +480,13 @@ WavefrontObjExporter::writeGroup(std::string group)
  * Writes an object line to an OBJ file.
  */
 void
-WavefrontObjExporter::writeObject(std::string object)
+WavefrontObjExporter::writeObject(const std::string &object)
 {
-    obj_ <<std::endl;
-    obj_ <<"o "<<object<<std::endl;
+    rapidjson::StringBuffer &buf = file_.buffer();
+    NumberFormatter::appendString(buf, "\no ");
+    NumberFormatter::appendString(buf, object);
+    buf.Put('\n');
+    file_.commit();
 }
 
 
@@ -454,12 +494,20 @@ WavefrontObjExporter::writeObject(std::string object)
  * Writes a vertex entry to an OBJ file.
  */
 void
-WavefrontObjExporter::writeVertex(std::pair<gmx::RVec, real> vertex)
+WavefrontObjExporter::writeVertex(const std::pair<gmx::RVec, real> &vertex)
 {
-    obj_<<"v "<<vertex.first[XX]<<" "
-              <<vertex.first[YY]<<" "
-              <<vertex.first[ZZ]<<" "
-              <<vertex.second<<std::endl;
+    rapidjson::StringBuffer &buf = file_.buffer();
+    buf.Put('v');
+    buf.Put(' ');
+    NumberFormatter::appendReal(buf, vertex.first[XX], decimalPlaces_);
+    buf.Put(' ');
+    NumberFormatter::appendReal(buf, vertex.first[YY], decimalPlaces_);
+    buf.Put(' ');
+    NumberFormatter::appendReal(buf, vertex.first[ZZ], decimalPlaces_);
+    buf.Put(' ');
+    NumberFormatter::appendReal(buf, vertex.second, decimalPlaces_);
+    buf.Put('\n');
+    file_.commit();
 }
 
 
@@ -467,20 +515,31 @@ WavefrontObjExporter::writeVertex(std::pair<gmx::RVec, real> vertex)
  * Writes a vertex normal to an OBJ file.
  */
 void
-WavefrontObjExporter::writeVertexNormal(gmx::RVec norm)
+WavefrontObjExporter::writeVertexNormal(const gmx::RVec &norm)
 {
-    obj_<<"vn "<<norm[XX]<<" "
-               <<norm[YY]<<" "
-               <<norm[ZZ]<<std::endl;
+    rapidjson::StringBuffer &buf = file_.buffer();
+    buf.Put('v');
+    buf.Put('n');
+    buf.Put(' ');
+    NumberFormatter::appendReal(buf, norm[XX], decimalPlaces_);
+    buf.Put(' ');
+    NumberFormatter::appendReal(buf, norm[YY], decimalPlaces_);
+    buf.Put(' ');
+    NumberFormatter::appendReal(buf, norm[ZZ], decimalPlaces_);
+    buf.Put('\n');
+    file_.commit();
 }
 
 
-/*
- *
+/*!
+ * Writes a face entry to an OBJ file, preceded by a material line if the 
+ * material of the face differs from that of the previous face.
  */
 void
 WavefrontObjExporter::writeFace(const WavefrontObjFace &face)
 {
+    rapidjson::StringBuffer &buf = file_.buffer();
+
     // need to write material?
     if( face.mtlName_ != "" )
     {
@@ -488,25 +547,39 @@ WavefrontObjExporter::writeFace(const WavefrontObjFace &face)
         if( face.mtlName_ != crntMtlName_ )
         {
             crntMtlName_ = face.mtlName_;
-            obj_<<"usemtl "<<face.mtlName_<<std::endl;
+            NumberFormatter::appendString(buf, "usemtl ");
+            NumberFormatter::appendString(buf, face.mtlName_);
+            buf.Put('\n');
         }
     }
 
     // write actual face entry:
-    obj_<<"f ";
-
+    buf.Put('f');
+    buf.Put(' ');
     for(size_t i = 0; i < face.numVertices(); i++)
     {
-        obj_<<face.vertexIdx(i);
+        NumberFormatter::appendInt(buf, face.vertexIdx(i));
 
         if( face.hasNormals() )
         {
-            obj_<<"//"<<face.normalIdx(i);
+            buf.Put('/');
+            buf.Put('/');
+            NumberFormatter::appendInt(buf, face.normalIdx(i));
         }
 
-        obj_<<" ";
+        buf.Put(' ');
     }
+    buf.Put('\n');
+    file_.commit();
+}
+
 
-    obj_<<std::endl;
+/*!
+ * Writes an empty line to an OBJ file.
+ */
+void
+WavefrontObjExporter::writeEmptyLine()
+{
+    file_.buffer().Put('\n');
 }
 
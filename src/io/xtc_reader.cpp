@@ -0,0 +1,627 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "io/xtc_reader.hpp"
+
+
+/*
+ * Magic number at the start of each XTC frame.
+ */
+static const int xtcMagic = 1995;
+
+/*
+ * Size of the frame header up to the number of atoms repeated before the 
+ * coordinates and of the additional header of compressed coordinates.
+ */
+static const size_t xtcHeaderSize = 56;
+static const size_t xtcCompressedHeaderSize = 36;
+
+/*
+ * Frames with at most this many atoms are stored uncompressed.
+ */
+static const int xtcMaxUncompressed = 9;
+
+/*
+ * Table of integer sizes used by the XTC compression algorithm to encode 
+ * small differences between successive atoms.
+ */
+static const int magicInts[] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 8, 10, 12, 16, 20, 25, 32, 40, 50, 64,
+        80, 101, 128, 161, 203, 256, 322, 406, 512, 645, 812, 1024, 1290,
+        1625, 2048, 2580, 3250, 4096, 5060, 6501, 8192, 10321, 13003, 
+        16384, 20642, 26007, 32768, 41285, 52015, 65536, 82570, 104031, 
+        131072, 165140, 208063, 262144, 330280, 416127, 524287, 660561, 
+        832255, 1048576, 1321122, 1664510, 2097152, 2642245, 3329021, 
+        4194304, 5284491, 6658042, 8388607, 10568983, 13316085, 16777216};
+static const int firstIdx = 9;
+static const int lastIdx = sizeof(magicInts) / sizeof(*magicInts);
+
+
+/*
+ * Auxiliary function that decodes a big endian (XDR) integer.
+ */
+static int
+xdrInt(const unsigned char *data)
+{
+    std::uint32_t value = (std::uint32_t(data[0]) << 24) | 
+                          (std::uint32_t(data[1]) << 16) |
+                          (std::uint32_t(data[2]) << 8) | 
+                           std::uint32_t(data[3]);
+    return static_cast<int>(value);
+}
+
+
+/*
+ * Auxiliary function that decodes a big endian (XDR) single precision float.
+ */
+static float
+xdrFloat(const unsigned char *data)
+{
+    std::uint32_t bits = static_cast<std::uint32_t>(xdrInt(data));
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+
+/*
+ * Auxiliary function returning the number of bits needed to represent 
+ * integers up to the given size.
+ */
+static int
+sizeOfInt(unsigned int size)
+{
+    std::uint64_t num = 1;
+    int numBits = 0;
+    while( size >= num && numBits < 32 )
+    {
+        numBits++;
+        num <<= 1;
+    }
+    return numBits;
+}
+
+
+/*
+ * Auxiliary function returning the number of bits needed to represent three
+ * integers with the given sizes packed into a single number.
+ */
+static int
+sizeOfInts(const unsigned int sizes[3])
+{
+    unsigned int bytes[32];
+    unsigned int numBytes = 1;
+    bytes[0] = 1;
+    for(int i = 0; i < 3; i++)
+    {
+        unsigned int tmp = 0;
+        unsigned int byteCount = 0;
+        for(byteCount = 0; byteCount < numBytes; byteCount++)
+        {
+            tmp = bytes[byteCount]*sizes[i] + tmp;
+            bytes[byteCount] = tmp & 0xff;
+            tmp >>= 8;
+        }
+        while( tmp != 0 )
+        {
+            bytes[byteCount++] = tmp & 0xff;
+            tmp >>= 8;
+        }
+        numBytes = byteCount;
+    }
+
+    unsigned int num = 1;
+    int numBits = 0;
+    numBytes--;
+    while( bytes[numBytes] >= num )
+    {
+        numBits++;
+        num *= 2;
+    }
+    return numBits + numBytes*8;
+}
+
+
+/*
+ * \brief Reads bits and packed integers from the compressed coordinates of
+ * an XTC frame.
+ */
+class XtcBitReader
+{
+    public:
+
+        // constructor:
+        explicit XtcBitReader(const unsigned char *data)
+            : data_(data)
+            , count_(0)
+            , lastBits_(0)
+            , lastByte_(0)
+        {
+        }
+
+        // number of bytes consumed so far:
+        size_t count() const
+        {
+            return count_;
+        }
+
+        // reads an unsigned integer of the given number of bits:
+        int receiveBits(int numBits)
+        {
+            unsigned int mask = numBits < 32 ? (1u << numBits) - 1 : ~0u;
+            unsigned int num = 0;
+            while( numBits >= 8 )
+            {
+                lastByte_ = (lastByte_ << 8) | data_[count_++];
+                num |= (lastByte_ >> lastBits_) << (numBits - 8);
+                numBits -= 8;
+            }
+            if( numBits > 0 )
+            {
+                if( static_cast<int>(lastBits_) < numBits )
+                {
+                    lastBits_ += 8;
+                    lastByte_ = (lastByte_ << 8) | data_[count_++];
+                }
+                lastBits_ -= numBits;
+                num |= (lastByte_ >> lastBits_) & ((1u << numBits) - 1);
+            }
+            return static_cast<int>(num & mask);
+        }
+
+        // reads three integers packed into a number of the given bit size:
+        void receiveInts(int numBits, const unsigned int sizes[3], int nums[3])
+        {
+            unsigned int bytes[32] = {0, 0, 0, 0};
+            int numBytes = 0;
+            while( numBits > 8 )
+            {
+                bytes[numBytes++] = receiveBits(8);
+                numBits -= 8;
+            }
+            if( numBits > 0 )
+            {
+                bytes[numBytes++] = receiveBits(numBits);
+            }
+            for(int i = 2; i > 0; i--)
+            {
+                unsigned int num = 0;
+                for(int j = numBytes - 1; j >= 0; j--)
+                {
+                    num = (num << 8) | bytes[j];
+                    unsigned int p = num / sizes[i];
+                    bytes[j] = p;
+                    num = num - p*sizes[i];
+                }
+                nums[i] = static_cast<int>(num);
+            }
+            nums[0] = static_cast<int>(
+                    bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | 
+                    (bytes[3] << 24));
+        }
+
+    private:
+
+        const unsigned char *data_;
+        size_t count_;
+        unsigned int lastBits_;
+        unsigned int lastByte_;
+};
+
+
+/*!
+ * Opens the given XTC file and builds the index of frame offsets and time 
+ * stamps from the frame headers. Throws if the file can not be opened or is
+ * not a valid XTC file.
+ */
+void
+XtcReader::open(
+        const std::string &fileName)
+{
+    // open file:
+    close();
+    fileName_ = fileName;
+    file_.open(fileName_.c_str(), std::ifstream::in | std::ifstream::binary);
+    if( !file_.is_open() )
+    {
+        throw std::runtime_error("ERROR: Could not open file " + fileName_ + 
+                                 ".");
+    }
+
+    // read frame headers and skip coordinates:
+    std::streamoff offset = 0;
+    while( readBytes(header_, xtcHeaderSize) )
+    {
+        // sanity checks:
+        int numAtoms = xdrInt(&header_[4]);
+        if( xdrInt(&header_[0]) != xtcMagic || numAtoms <= 0 ||
+            (!offsets_.empty() && numAtoms != numAtoms_) )
+        {
+            throw std::runtime_error("ERROR: Invalid header in frame " + 
+                                     std::to_string(offsets_.size()) + 
+                                     " of XTC file " + fileName_ + ".");
+        }
+        numAtoms_ = numAtoms;
+        offsets_.push_back(offset);
+        times_.push_back(xdrFloat(&header_[12]));
+
+        // size of coordinate block:
+        std::streamoff frameSize = xtcHeaderSize;
+        if( numAtoms_ <= xtcMaxUncompressed )
+        {
+            frameSize += 3*sizeof(float)*numAtoms_;
+        }
+        else
+        {
+            frameSize += xtcCompressedHeaderSize;
+            if( readBytes(header_, xtcCompressedHeaderSize) )
+            {
+                std::streamoff numBytes = static_cast<unsigned int>(
+                        xdrInt(&header_[xtcCompressedHeaderSize - 4]));
+                frameSize += (numBytes + 3)/4*4;
+            }
+        }
+
+        // advance to next frame:
+        offset += frameSize;
+        file_.seekg(offset);
+    }
+
+    // a truncated last frame is ignored:
+    file_.clear();
+    file_.seekg(0, std::ifstream::end);
+    std::streamoff fileSize = file_.tellg();
+    if( !offsets_.empty() && fileSize < offset )
+    {
+        offsets_.pop_back();
+        times_.pop_back();
+    }
+    file_.clear();
+    if( offsets_.empty() )
+    {
+        throw std::runtime_error("ERROR: XTC file " + fileName_ + " contains "
+                                 "no complete frames.");
+    }
+}
+
+
+/*!
+ * Closes the file and clears the frame index.
+ */
+void
+XtcReader::close()
+{
+    if( file_.is_open() )
+    {
+        file_.close();
+    }
+    file_.clear();
+    numAtoms_ = 0;
+    offsets_.clear();
+    times_.clear();
+}
+
+
+/*!
+ * Returns the number of complete frames in the file.
+ */
+size_t
+XtcReader::numFrames() const
+{
+    return offsets_.size();
+}
+
+
+/*!
+ * Returns the number of atoms in each frame.
+ */
+int
+XtcReader::numAtoms() const
+{
+    return numAtoms_;
+}
+
+
+/*!
+ * Returns the time stamp of the given frame.
+ */
+real
+XtcReader::time(
+        size_t frame) const
+{
+    return times_.at(frame);
+}
+
+
+/*!
+ * Decodes the given frame. Coordinates are written to x for at least the 
+ * first maxAtoms atoms, or for all atoms if maxAtoms is not positive or 
+ * exceeds the number of atoms. The array x must be large enough to hold 
+ * numAtoms() coordinates. Returns the number of atoms whose coordinates 
+ * have been written.
+ */
+int
+XtcReader::readFrame(
+        size_t frame,
+        int maxAtoms,
+        std::int64_t &step,
+        real &time,
+        matrix box,
+        rvec *x)
+{
+    // number of atoms to decode:
+    if( maxAtoms <= 0 || maxAtoms > numAtoms_ )
+    {
+        maxAtoms = numAtoms_;
+    }
+
+    // read frame header:
+    file_.seekg(offsets_.at(frame));
+    if( !readBytes(header_, xtcHeaderSize) )
+    {
+        throw std::runtime_error("ERROR: Could not read frame " + 
+                                 std::to_string(frame) + " of XTC file " + 
+                                 fileName_ + ".");
+    }
+    step = static_cast<unsigned int>(xdrInt(&header_[8]));
+    time = xdrFloat(&header_[12]);
+    for(int i = 0; i < 3; i++)
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            box[i][j] = xdrFloat(&header_[16 + 4*(3*i + j)]);
+        }
+    }
+
+    // small systems are stored uncompressed:
+    if( numAtoms_ <= xtcMaxUncompressed )
+    {
+        if( !readBytes(compressed_, 3*sizeof(float)*numAtoms_) )
+        {
+            throw std::runtime_error("ERROR: Could not read coordinates of "
+                                     "frame " + std::to_string(frame) + 
+                                     " of XTC file " + fileName_ + ".");
+        }
+        for(int i = 0; i < numAtoms_; i++)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                x[i][j] = xdrFloat(&compressed_[4*(3*i + j)]);
+            }
+        }
+        return numAtoms_;
+    }
+
+    // header of compressed coordinates:
+    if( !readBytes(header_, xtcCompressedHeaderSize) )
+    {
+        throw std::runtime_error("ERROR: Could not read frame " + 
+                                 std::to_string(frame) + " of XTC file " + 
+                                 fileName_ + ".");
+    }
+    real precision = xdrFloat(&header_[0]);
+    int minInt[3];
+    int maxInt[3];
+    for(int j = 0; j < 3; j++)
+    {
+        minInt[j] = xdrInt(&header_[4 + 4*j]);
+        maxInt[j] = xdrInt(&header_[16 + 4*j]);
+    }
+    int smallIdx = xdrInt(&header_[28]);
+    size_t numBytes = static_cast<unsigned int>(xdrInt(&header_[32]));
+    if( precision <= 0.0 || smallIdx < firstIdx || smallIdx >= lastIdx )
+    {
+        throw std::runtime_error("ERROR: Invalid compression parameters in "
+                                 "frame " + std::to_string(frame) + " of XTC "
+                                 "file " + fileName_ + ".");
+    }
+
+    // read compressed data, padding guards against reading past its end:
+    const size_t padding = 32;
+    if( !readBytes(compressed_, numBytes) )
+    {
+        throw std::runtime_error("ERROR: Could not read coordinates of "
+                                 "frame " + std::to_string(frame) + 
+                                 " of XTC file " + fileName_ + ".");
+    }
+    compressed_.resize(numBytes + padding, 0);
+
+    // sizes of integer coordinates:
+    unsigned int sizeInt[3];
+    int bitSizeInt[3] = {0, 0, 0};
+    int bitSize = 0;
+    for(int j = 0; j < 3; j++)
+    {
+        sizeInt[j] = static_cast<unsigned int>(maxInt[j] - minInt[j] + 1);
+    }
+    if( (sizeInt[0] | sizeInt[1] | sizeInt[2]) > 0xffffff )
+    {
+        for(int j = 0; j < 3; j++)
+        {
+            bitSizeInt[j] = sizeOfInt(sizeInt[j]);
+        }
+    }
+    else
+    {
+        bitSize = sizeOfInts(sizeInt);
+    }
+
+    // sizes of small differences between successive atoms:
+    int smaller = magicInts[std::max(firstIdx, smallIdx - 1)] / 2;
+    int smallNum = magicInts[smallIdx] / 2;
+    unsigned int sizeSmall[3];
+    sizeSmall[0] = sizeSmall[1] = sizeSmall[2] = magicInts[smallIdx];
+
+    // decode atoms until enough coordinates have been written:
+    XtcBitReader bits(compressed_.data());
+    real invPrecision = 1.0/precision;
+    int numWritten = 0;
+    int run = 0;
+    int i = 0;
+    auto write = [&](const int coord[3])
+    {
+        if( numWritten < numAtoms_ )
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                x[numWritten][j] = coord[j]*invPrecision;
+            }
+        }
+        numWritten++;
+    };
+    while( i < numAtoms_ && numWritten < maxAtoms )
+    {
+        // full coordinates of first atom in run:
+        int thisCoord[3];
+        if( bitSize == 0 )
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                thisCoord[j] = bits.receiveBits(bitSizeInt[j]);
+            }
+        }
+        else
+        {
+            bits.receiveInts(bitSize, sizeInt, thisCoord);
+        }
+        i++;
+        int prevCoord[3];
+        for(int j = 0; j < 3; j++)
+        {
+            thisCoord[j] += minInt[j];
+            prevCoord[j] = thisCoord[j];
+        }
+
+        // run length is only transmitted if it changes:
+        int isSmaller = 0;
+        if( bits.receiveBits(1) == 1 )
+        {
+            run = bits.receiveBits(5);
+            isSmaller = run % 3;
+            run -= isSmaller;
+            isSmaller--;
+        }
+
+        // differences of further atoms in run:
+        if( run > 0 )
+        {
+            for(int k = 0; k < run; k += 3)
+            {
+                bits.receiveInts(smallIdx, sizeSmall, thisCoord);
+                i++;
+                for(int j = 0; j < 3; j++)
+                {
+                    thisCoord[j] += prevCoord[j] - smallNum;
+                }
+                if( k == 0 )
+                {
+                    // first two atoms are interchanged for better compression
+                    // of water molecules:
+                    std::swap(thisCoord, prevCoord);
+                    write(prevCoord);
+                }
+                else
+                {
+                    std::copy(thisCoord, thisCoord + 3, prevCoord);
+                }
+                write(thisCoord);
+            }
+        }
+        else
+        {
+            write(thisCoord);
+        }
+
+        // adapt size of small differences:
+        smallIdx += isSmaller;
+        if( smallIdx < firstIdx || smallIdx >= lastIdx )
+        {
+            throw std::runtime_error("ERROR: Corrupt coordinates in frame " + 
+                                     std::to_string(frame) + " of XTC file " + 
+                                     fileName_ + ".");
+        }
+        if( isSmaller < 0 )
+        {
+            smallNum = smaller;
+            smaller = smallIdx > firstIdx ? magicInts[smallIdx - 1] / 2 : 0;
+        }
+        else if( isSmaller > 0 )
+        {
+            smaller = smallNum;
+            smallNum = magicInts[smallIdx] / 2;
+        }
+        sizeSmall[0] = sizeSmall[1] = sizeSmall[2] = magicInts[smallIdx];
+
+        // sanity check:
+        if( bits.count() > numBytes )
+        {
+            throw std::runtime_error("ERROR: Corrupt coordinates in frame " + 
+                                     std::to_string(frame) + " of XTC file " + 
+                                     fileName_ + ".");
+        }
+    }
+
+    return std::min(numWritten, numAtoms_);
+}
+
+
+/*!
+ * Returns true if the given file name has the extension of an XTC file.
+ */
+bool
+XtcReader::isXtcFile(
+        const std::string &fileName)
+{
+    const std::string extension = ".xtc";
+    return fileName.size() >= extension.size() &&
+           fileName.compare(
+                fileName.size() - extension.size(), 
+                extension.size(), 
+                extension) == 0;
+}
+
+
+/*
+ * Reads the given number of bytes from the current position of the file into
+ * the buffer. Returns false if the end of the file is reached before.
+ */
+bool
+XtcReader::readBytes(
+        std::vector<unsigned char> &buffer,
+        size_t numBytes)
+{
+    buffer.resize(numBytes);
+    if( numBytes == 0 )
+    {
+        return true;
+    }
+    file_.read(reinterpret_cast<char*>(buffer.data()), numBytes);
+    return static_cast<size_t>(file_.gcount()) == numBytes;
+}
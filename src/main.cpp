@@ -22,10 +22,12 @@
 // THE SOFTWARE.
 
 
+#include <cstring>
 #include <vector>
 
 #include "config/back_matter.hpp"
 #include "config/front_matter.hpp"
+#include "trajectory-analysis/chap_merge.hpp"
 #include "trajectory-analysis/chap_trajectory_analysis.hpp"
 
 using namespace gmx;
@@ -44,8 +46,22 @@ int main(int argc, char **argv)
     argv = modArgv.data();
     argc++;
 
-    // run trajectory analysis:
-	int status = TrajectoryAnalysisCommandLineRunner::runAsMain<ChapTrajectoryAnalysis>(argc, argv);
+    // merge shard files or run trajectory analysis:
+    int status = 0;
+    if( argc > 1 && std::strcmp(argv[1], "merge") == 0 )
+    {
+        status = ICommandLineOptionsModule::runAsMain(
+                argc - 1, 
+                argv + 1, 
+                "merge", 
+                "Merge CHAP shard files", 
+                &ChapMerge::create);
+    }
+    else
+    {
+        status = TrajectoryAnalysisCommandLineRunner::runAsMain<
+                ChapTrajectoryAnalysis>(argc, argv);
+    }
 
     // print back matter:
     BackMatter::print();
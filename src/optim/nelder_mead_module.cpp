@@ -23,6 +23,7 @@
 
 
 #include <algorithm>
+#include <iostream>
 
 #include "optim/nelder_mead_module.hpp"
 
@@ -31,12 +31,13 @@
 
 
 /*!
- * Constructor.
+ * Constructor. The van der Waals radii are shared rather than copied, as the
+ * same radii are typically used for the path finders of many frames.
  */
 AbstractProbePathFinder::AbstractProbePathFinder(
         std::map<std::string, real> params,
         gmx::RVec initProbePos,
-        std::vector<real> vdwRadii)
+        std::shared_ptr<const std::vector<real>> vdwRadii)
     : AbstractPathFinder(params)
     , vdwRadii_(vdwRadii)
     , initProbePos_(initProbePos)
@@ -47,7 +48,7 @@ AbstractProbePathFinder::AbstractProbePathFinder(
     probeRadius_ = 0.0;
 
     // find maximum vdw radius:
-    maxVdwRadius_ = *std::max_element(vdwRadii.begin(), vdwRadii.end());
+    maxVdwRadius_ = *std::max_element(vdwRadii_ -> begin(), vdwRadii_ -> end());
 }
 
 
@@ -106,7 +107,7 @@ AbstractProbePathFinder::findMinimalFreeDistance(
         pairDist = std::sqrt(pair.distance2());
 
         // get vdW radius of reference atom:
-        poreAtomVdwRadius = vdwRadii_.at(pair.refIndex());
+        poreAtomVdwRadius = (*vdwRadii_)[pair.refIndex()];
 
         // update void radius if necessary:
         if( (pairDist - poreAtomVdwRadius - probeRadius_) < minimalFreeDistance )
@@ -42,7 +42,7 @@ InplaneOptimisedProbePathFinder::InplaneOptimisedProbePathFinder(
         gmx::RVec chanDirVec,
         t_pbc *pbc,
         gmx::AnalysisNeighborhoodPositions porePos,
-        std::vector<real> vdwRadii)
+        std::shared_ptr<const std::vector<real>> vdwRadii)
     : AbstractProbePathFinder(params, initProbePos, vdwRadii)
     , porePos_(porePos)
     , pbc_(pbc)
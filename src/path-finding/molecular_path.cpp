@@ -183,6 +183,87 @@ MolecularPath::MolecularPath(
                 doc["molPathRadiusSpline"]["ctrl"][i].GetDouble() );
     } 
 
+    // extract centre line spline from data:
+    std::vector<real> centreLineKnots;
+    std::vector<gmx::RVec> centreLineCtrlPoints;
+    for(size_t i = 0; i < doc["molPathCentreLineSpline"]["knots"].Size(); i++)
+    {
+        centreLineKnots.push_back( 
+                doc["molPathCentreLineSpline"]["knots"][i].GetDouble() );
+        centreLineCtrlPoints.push_back( 
+                gmx::RVec(doc["molPathCentreLineSpline"]["ctrlX"][i].GetDouble(),
+                          doc["molPathCentreLineSpline"]["ctrlY"][i].GetDouble(),
+                          doc["molPathCentreLineSpline"]["ctrlZ"][i].GetDouble()));
+    } 
+
+    // build spline curves:
+    initSplines(
+            poreRadiusKnots, 
+            poreRadiusCtrlPoints, 
+            centreLineKnots, 
+            centreLineCtrlPoints);
+}
+
+
+/*!
+ * Constructor for creating a MolecularPath from previously computed spline 
+ * curves, e.g. when reading back the per-frame data written during the 
+ * analysis. In addition to the original path points and radii, this takes 
+ * the unique knots and control points of the cubic radius and centre line 
+ * splines.
+ */
+MolecularPath::MolecularPath(
+        const std::vector<gmx::RVec> &pathPoints,
+        const std::vector<real> &pathRadii,
+        const std::vector<real> &poreRadiusKnots,
+        const std::vector<real> &poreRadiusCtrlPoints,
+        const std::vector<real> &centreLineKnots,
+        const std::vector<gmx::RVec> &centreLineCtrlPoints)
+    : pathPoints_(pathPoints)
+    , pathRadii_(pathRadii)
+    , centreLine_()
+    , poreRadius_()
+{
+    // sanity checks:
+    if( pathPoints_.size() != pathRadii_.size() )
+    {
+        throw std::logic_error("Number of path points and radii passed to "
+        "MolecularPath constructor differs.");
+    }
+    if( poreRadiusKnots.empty() || 
+        poreRadiusKnots.size() != poreRadiusCtrlPoints.size() )
+    {
+        throw std::logic_error("Invalid radius spline passed to MolecularPath "
+        "constructor.");
+    }
+    if( centreLineKnots.empty() || 
+        centreLineKnots.size() != centreLineCtrlPoints.size() )
+    {
+        throw std::logic_error("Invalid centre line spline passed to "
+        "MolecularPath constructor.");
+    }
+
+    // build spline curves:
+    initSplines(
+            poreRadiusKnots, 
+            poreRadiusCtrlPoints, 
+            centreLineKnots, 
+            centreLineCtrlPoints);
+}
+
+
+/*!
+ * Auxiliary function for constructors that builds the radius and centre line
+ * spline curves from their unique knots and control points and sets the 
+ * opening coordinates and length of the pathway accordingly.
+ */
+void
+MolecularPath::initSplines(
+        std::vector<real> poreRadiusKnots,
+        const std::vector<real> &poreRadiusCtrlPoints,
+        std::vector<real> centreLineKnots,
+        const std::vector<gmx::RVec> &centreLineCtrlPoints)
+{
     // add duplicate knots at endpoints:
     int poreRadiusSplineDegree = 3; // TODO: should not be hardcoded
     poreRadiusKnots.insert(
@@ -200,19 +281,6 @@ MolecularPath::MolecularPath(
             poreRadiusKnots,
             poreRadiusCtrlPoints);
 
-    // extract centre line spline from data:
-    std::vector<real> centreLineKnots;
-    std::vector<gmx::RVec> centreLineCtrlPoints;
-    for(size_t i = 0; i < doc["molPathCentreLineSpline"]["knots"].Size(); i++)
-    {
-        centreLineKnots.push_back( 
-                doc["molPathCentreLineSpline"]["knots"][i].GetDouble() );
-        centreLineCtrlPoints.push_back( 
-                gmx::RVec(doc["molPathCentreLineSpline"]["ctrlX"][i].GetDouble(),
-                          doc["molPathCentreLineSpline"]["ctrlY"][i].GetDouble(),
-                          doc["molPathCentreLineSpline"]["ctrlZ"][i].GetDouble()));
-    } 
-
     // add duplicate knots at endpoints:
     int centreLineSplineDegree = 3; // TODO: should not be hardcoded
     centreLineKnots.insert(
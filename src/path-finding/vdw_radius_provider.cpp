@@ -24,6 +24,8 @@
 
 #include <algorithm>
 #include <iostream>
+#include <map>
+#include <tuple>
 
 //#include <gromacs/topology/atomprop.h> 
 #include <gromacs/topology/atoms.h>  
@@ -68,6 +70,9 @@ VdwRadiusProvider::setDefaultVdwRadius(real defRad)
     if( defRad >= 0 )
     {
         defRad_ = defRad;
+
+        // cached radii may have fallen back on previous default:
+        vdwRadiusCache_.clear();
     }
     else
     {
@@ -134,6 +139,8 @@ VdwRadiusProvider::lookupTableFromJson(rapidjson::Document &jsonDoc)
 
     // prepare loopup table for vdW radii:
     vdwRadiusLookupTable_.clear();
+    partAtmNameIndex_.clear();
+    vdwRadiusCache_.clear();
 
     // loop over array and extract vdW radius lookup table:
     rapidjson::Value::ConstValueIterator it;
@@ -163,7 +170,7 @@ VdwRadiusProvider::lookupTableFromJson(rapidjson::Document &jsonDoc)
         vdwRadiusLookupTable_.push_back(rec);
     }
 
-    // check sanity of input table:
+    // check sanity of input table and build index:
     validateLookupTable();
 }
 
@@ -179,10 +186,10 @@ VdwRadiusProvider::lookupTableFromJson(rapidjson::Document &jsonDoc)
  */
 std::unordered_map<int, real>
 VdwRadiusProvider::vdwRadiiForTopology(const gmx::TopologyInformation &top,
-                                       std::vector<int> mappedIds)
+                                       const std::vector<int> &mappedIds)
 {
     // get list of all atoms:
-    t_atoms atoms = top.topology() -> atoms;
+    const t_atoms &atoms = top.topology() -> atoms;
 
     // sanity check:
     int maxId = (*std::max_element(mappedIds.begin(), mappedIds.end()));
@@ -193,18 +200,33 @@ VdwRadiusProvider::vdwRadiiForTopology(const gmx::TopologyInformation &top,
 
     // allocate memory for results vector:
     std::unordered_map<int, real> vdwRadii;
-    vdwRadii.reserve(atoms.nr);
+    vdwRadii.reserve(mappedIds.size());
+
+    // names are shared through the symbol table, so atoms of the same type 
+    // can be recognised by their name pointers and element:
+    std::map<std::tuple<char**, char**, std::string>, real> atomTypeRadii;
 
     // loop over all atoms in topology and find vdW radii:
     for(size_t i = 0; i < mappedIds.size(); i++)
     {
-        // get atom and residue names:
-        std::string atmName = *(atoms.atomname[mappedIds[i]]);
-        std::string resName = *(atoms.resinfo[atoms.atom[mappedIds[i]].resind].name);
-        std::string elemSym(atoms.atom[mappedIds[i]].elem);
+        // identify atom type:
+        const t_atom &atom = atoms.atom[mappedIds[i]];
+        auto atomType = std::make_tuple(atoms.atomname[mappedIds[i]],
+                                        atoms.resinfo[atom.resind].name,
+                                        std::string(atom.elem));
+
+        // look up radius only once per atom type:
+        auto it = atomTypeRadii.find(atomType);
+        if( it == atomTypeRadii.end() )
+        {
+            real vdwRad = vdwRadiusForAtom(*std::get<0>(atomType), 
+                                           *std::get<1>(atomType),
+                                           std::get<2>(atomType));
+            it = atomTypeRadii.insert(std::make_pair(atomType, vdwRad)).first;
+        }
 
         // add radius for this atom to results vector:
-        vdwRadii[mappedIds[i]] = vdwRadiusForAtom(atmName, resName, elemSym);
+        vdwRadii[mappedIds[i]] = it -> second;
     }
 
     // return vector of vdW radii:
@@ -214,25 +236,24 @@ VdwRadiusProvider::vdwRadiiForTopology(const gmx::TopologyInformation &top,
 
 /*!
  * \brief Validates that a lookup table contains no duplicate entries.
+ *
+ * Duplicates are detected while building the index of the lookup table by
+ * atom name and residue name, so that validation takes linear time.
  */
 void
 VdwRadiusProvider::validateLookupTable()
 {
-    // iterators over lookup table:
-    std::vector<VdwRadiusRecord>::iterator it;
-    std::vector<VdwRadiusRecord>::iterator jt;
-
-    // loop over all entries in lookup table:
-    for(it = vdwRadiusLookupTable_.begin(); it != vdwRadiusLookupTable_.end(); it++)
+    // build index and check for duplicate entries at the same time:
+    atmNameIndex_.clear();
+    for(size_t i = 0; i < vdwRadiusLookupTable_.size(); i++)
     {
-        // loop over remaining entries and try to find exact matches:
-        for(jt = it + 1; jt != vdwRadiusLookupTable_.end(); jt++)
+        const VdwRadiusRecord &rec = vdwRadiusLookupTable_[i];
+        bool inserted = atmNameIndex_[rec.atmName_].insert(
+                std::make_pair(rec.resName_, i)).second;
+        if( !inserted )
         {
-            if( jt -> atmName_ == it -> atmName_ && jt -> resName_ == it -> resName_ )
-            {
-                // throw exceptions if identical records are found:
-                throw std::runtime_error("Van der Waals radius record with atom name "+it->atmName_+" and residue name "+it -> resName_+" appears more than once in lookup table.");
-            }
+            // throw exceptions if identical records are found:
+            throw std::runtime_error("Van der Waals radius record with atom name "+rec.atmName_+" and residue name "+rec.resName_+" appears more than once in lookup table.");
         }
     }
 }
@@ -244,45 +265,57 @@ VdwRadiusProvider::validateLookupTable()
  * Given a combination of atom name, residue name, and element, name, this 
  * function tries return the corresponding van der Waals radius. If 
  * setDefaultVdwRadius() has not been called, an exception will be thrown is
- * no match is found in the internal lookup table.
+ * no match is found in the internal lookup table. Results are cached, so that
+ * each combination of names is only looked up once.
  */
 real
-VdwRadiusProvider::vdwRadiusForAtom(std::string atmName, 
-                                    std::string resName,
-                                    std::string elemSym)
+VdwRadiusProvider::vdwRadiusForAtom(const std::string &atmName, 
+                                    const std::string &resName,
+                                    const std::string &elemSym)
 {
-    // build vector of atom name matches:
-    std::vector<VdwRadiusRecord> atmNameMatches = matchAtmName(atmName);
+    // check for previous lookup of the same names:
+    std::string key = atmName + '\t' + resName + '\t' + elemSym;
+    auto it = vdwRadiusCache_.find(key);
+    if( it != vdwRadiusCache_.end() )
+    {
+        return it -> second;
+    }
+
+    // perform lookup and cache result:
+    real vdwRad = lookupVdwRadius(atmName, resName, elemSym);
+    vdwRadiusCache_[key] = vdwRad;
+    return vdwRad;
+}
 
-    // try to find residue name match:
-    std::vector<VdwRadiusRecord>::const_iterator it;
-    it = matchResName(resName, atmNameMatches);
 
-    // if match found, return corresponding value:
-    if( it != atmNameMatches.end() )
+/*!
+ * \brief Internal utility function implementing the lookup decision tree.
+ */
+real
+VdwRadiusProvider::lookupVdwRadius(const std::string &atmName, 
+                                   const std::string &resName,
+                                   std::string elemSym)
+{
+    // try exact atom name match:
+    const VdwRadiusRecord *rec = matchAtmName(atmName, resName);
+    if( rec != nullptr )
     {
-        return(it -> vdwRad_);
+        return(rec -> vdwRad_);
     }
 
     // if no exact atom name match, try partial atom name match:
-    atmNameMatches = matchPartAtmName(atmName);
-    it = matchResName(resName, atmNameMatches);
-    
-    // if match found, return corresponding value:
-    if( it != atmNameMatches.end() )
+    rec = matchPartAtmName(atmName, resName);
+    if( rec != nullptr )
     {
-        return(it -> vdwRad_);
+        return(rec -> vdwRad_);
     }
 
     // if no exact or partial atom name match, try matching element names:
     std::transform(elemSym.begin(), elemSym.end(), elemSym.begin(), ::toupper);
-    atmNameMatches = matchAtmName(elemSym);
-    it = matchResName(resName, atmNameMatches);
-
-    // if match found, return corresponding value:
-    if( it != atmNameMatches.end() )
+    rec = matchAtmName(elemSym, resName);
+    if( rec != nullptr )
     {
-        return(it -> vdwRad_);
+        return(rec -> vdwRad_);
     }
 
     // if not exact, partial, or element name match found, return default radius:
@@ -293,119 +326,127 @@ VdwRadiusProvider::vdwRadiusForAtom(std::string atmName,
 /*!
  * \brief Internal utility function for matching atom names.
  *
- * Searches internal lookup table for records with matching atom names and 
- * returns a vector of all such records. If no matching record was found, the
- * returned vector will be empty.
+ * Looks up the record with exactly matching atom name and residue name in the
+ * index of the lookup table. If there is no such record, the record with 
+ * matching atom name and wildcard residue name ('???') is used instead. 
+ * Returns a null pointer if neither exists.
  */
-std::vector<VdwRadiusRecord>
-VdwRadiusProvider::matchAtmName(std::string atmName)
+const VdwRadiusRecord*
+VdwRadiusProvider::matchAtmName(const std::string &atmName,
+                                const std::string &resName)
 {
-    // build vector of atom name matches:
-    std::vector<VdwRadiusRecord> matches;
-    std::vector<VdwRadiusRecord>::iterator it;
-    for(it = vdwRadiusLookupTable_.begin(); it != vdwRadiusLookupTable_.end(); it++)
-    {       
-        if(it -> atmName_ == atmName )
-        {
-            matches.push_back(*it);
-        }
+    // find records with matching atom name:
+    auto atmIt = atmNameIndex_.find(atmName);
+    if( atmIt == atmNameIndex_.end() )
+    {
+        return nullptr;
     }
 
-    // return vector of matches:
-    return matches;
+    // try exact residue name match first, then wildcard match:
+    auto resIt = atmIt -> second.find(resName);
+    if( resIt == atmIt -> second.end() )
+    {
+        resIt = atmIt -> second.find("???");
+    }
+    if( resIt == atmIt -> second.end() )
+    {
+        return nullptr;
+    }
+
+    return &vdwRadiusLookupTable_[resIt -> second];
 }
 
 
 /*!
  * \brief Internal utility function for partially matching atom names.
  *
- * Searches internal lookup table for records with matching atom names and 
- * returns a vector of all such records. In this context, a matching record is 
- * one where the atom name in the lookup table has at least as many characters
- * as the trial atom name (passed as argument) and where the \f$ i \f$ -th 
- * character in the record atom name is either equal to the \f$ i \f$ -th 
- * character in the trial atom name or is a wildcard character ('?').
+ * Amongst all records partially matching the given atom name (see 
+ * partAtmNameMatches()), returns the first one with exactly matching residue
+ * name or, failing that, the first one with wildcard residue name ('???'). 
+ * Returns a null pointer if there is no such record.
  */
-std::vector<VdwRadiusRecord>
-VdwRadiusProvider::matchPartAtmName(std::string atmName)
-{    
-    // build vector of atom name matches:
-    std::vector<VdwRadiusRecord> matches;
-    std::vector<VdwRadiusRecord>::iterator it;
-    for(it = vdwRadiusLookupTable_.begin(); it != vdwRadiusLookupTable_.end(); it++)
-    {     
-        // skip values where name in lookup table is shorter than trial name:
-        if( it -> atmName_.size() < atmName.size() )
-        {
-            continue;
-        }
+const VdwRadiusRecord*
+VdwRadiusProvider::matchPartAtmName(const std::string &atmName,
+                                    const std::string &resName)
+{
+    const std::vector<size_t> &matches = partAtmNameMatches(atmName);
 
-        // check for wildcard match:
-        bool comp = true;        
-        for(size_t i = 0; i < atmName.size(); i++ )
+    // loop over entries and try to match residue name:
+    for(auto i : matches)
+    {
+        if( vdwRadiusLookupTable_[i].resName_ == resName )
         {
-            if( it -> atmName_[i] != atmName[i] && it -> atmName_[i] != '?' )
-            {
-                comp = false;
-            }
+            return &vdwRadiusLookupTable_[i];
         }
+    }
 
-        // if wildcard match, add this record to vector of matches:
-        if( comp == true )
+    // if no exact res name match found, look for wildcard match:
+    for(auto i : matches)
+    {
+        if( vdwRadiusLookupTable_[i].resName_ == "???" )
         {
-            matches.push_back(*it);
+            return &vdwRadiusLookupTable_[i];
         }
     }
 
-    // return vector of matches:
-    return matches;
+    // no match found:
+    return nullptr;
 }
 
 
 /*!
- * \brief Internal utility function for matching residue names.
+ * \brief Internal utility function for finding partial atom name matches.
  *
- * Searches the records vector for an element with matching residue name. If 
- * successful, the function returns an iterator pointing to the VdwRadiusRecord
- * with matching residue name. If no matching residue name can be found, the
- * iterator will point to the end of the vector.
+ * Returns the indices of all records in the lookup table that partially match
+ * the given atom name in table order. In this context, a matching record is 
+ * one where the atom name in the lookup table has at least as many characters
+ * as the trial atom name (passed as argument) and where the \f$ i \f$ -th 
+ * character in the record atom name is either equal to the \f$ i \f$ -th 
+ * character in the trial atom name or is a wildcard character ('?'). The 
+ * matches are computed only once for each distinct trial atom name.
  */
-std::vector<VdwRadiusRecord>::const_iterator
-VdwRadiusProvider::matchResName(std::string resName,
-                                const std::vector<VdwRadiusRecord> &records)
+const std::vector<size_t>&
+VdwRadiusProvider::partAtmNameMatches(const std::string &atmName)
 {
-    std::vector<VdwRadiusRecord>::const_iterator it;
-
-    // save a bit of effort, if records is empty:
-    if( records.empty() )
+    // has this atom name been seen before?
+    auto it = partAtmNameIndex_.find(atmName);
+    if( it != partAtmNameIndex_.end() )
     {
-        it = records.end();
-        return it;
+        return it -> second;
     }
 
-    // loop over entries and try to match residue name:
-    for(it = records.begin(); it != records.end(); it++)
-    {
-        if( it -> resName_ == resName )
+    // build vector of atom name matches:
+    std::vector<size_t> matches;
+    for(size_t i = 0; i < vdwRadiusLookupTable_.size(); i++)
+    {     
+        const std::string &recName = vdwRadiusLookupTable_[i].atmName_;
+
+        // skip values where name in lookup table is shorter than trial name:
+        if( recName.size() < atmName.size() )
         {
-            return(it);
+            continue;
         }
-    }
 
-    // if no exact res name match found, look for wildcard match:
-    if( it == records.end() )
-    {
-        for(it = records.begin(); it != records.end(); it++)
+        // check for wildcard match:
+        bool comp = true;        
+        for(size_t j = 0; j < atmName.size(); j++ )
         {
-            if( it -> resName_ == std::string("???") )
+            if( recName[j] != atmName[j] && recName[j] != '?' )
             {
-                return(it);
+                comp = false;
+                break;
             }
-        } 
-    }   
+        }
+
+        // if wildcard match, add this record to vector of matches:
+        if( comp == true )
+        {
+            matches.push_back(i);
+        }
+    }
 
-    // if no match was found, point iterator to end of vector:
-    return(it);
+    // add to index:
+    return partAtmNameIndex_[atmName] = std::move(matches);
 }
 
 
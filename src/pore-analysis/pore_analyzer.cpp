@@ -0,0 +1,510 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <stdexcept>
+
+#include <gromacs/math/vec.h>
+#include <gromacs/pbcutil/pbc.h>
+
+#include "pore-analysis/pore_analyzer.hpp"
+
+#include "path-finding/inplane_optimised_probe_path_finder.hpp"
+#include "path-finding/naive_cylindrical_path_finder.hpp"
+
+
+/*!
+ * Constructor. Sets all parameters to the defaults of the chap executable, 
+ * except for the random seed of the simulated annealing, which is fixed so
+ * that repeated analyses of the same coordinates give identical pathways.
+ */
+PoreAnalyzer::PoreAnalyzer()
+    : method_(ePathFindingMethodInplaneOptimised)
+    , initProbePosIsSet_(false)
+    , initProbePos_(0.0, 0.0, 0.0)
+    , chanDirVec_(0.0, 0.0, 1.0)
+    , pathAlignmentMethod_(ePathAlignmentMethodIpp)
+    , poreLiningMargin_(0.75)
+{
+    // path finding parameters in map:
+    par_["pfProbeMaxSteps"] = 10000;
+    par_["pfCylRad"] = 1.0;
+    par_["pfCylNumSteps"] = par_["pfProbeMaxSteps"];
+    par_["pfCylStepLength"] = 0.1;
+    par_["saMaxCoolingIter"] = 0;
+    par_["saRandomSeed"] = 15011992;
+    par_["saNumCostSamples"] = 50;
+    par_["saInitTemp"] = 0.1;
+    par_["saCoolingFactor"] = 0.98;
+    par_["saStepLengthFactor"] = 0.001;
+    par_["nmMaxIter"] = 100;
+    par_["nmInitShift"] = 0.1;
+
+    // path finding parameters in struct:
+    params_.setProbeStepLength(0.1);
+    params_.setMaxProbeRadius(1.0);
+    params_.setMaxProbeSteps(10000);
+}
+
+
+/*!
+ * Sets the indices of the atoms lining the permeation pathway and their van
+ * der Waals radii. Both vectors must have the same length.
+ */
+void
+PoreAnalyzer::setPathwayAtoms(
+        const std::vector<int> &atomIndices,
+        const std::vector<real> &vdwRadii)
+{
+    if( atomIndices.size() != vdwRadii.size() )
+    {
+        throw std::logic_error("ERROR: Number of pathway atoms and number of "
+                               "van der Waals radii differ.");
+    }
+
+    pathwayAtoms_ = atomIndices;
+    vdwRadii_ = std::make_shared<const std::vector<real>>(vdwRadii);
+}
+
+
+/*!
+ * Sets the atoms whose centre of geometry is used as initial probe position.
+ * If this is not set, the pathway atoms are used instead. Has no effect if 
+ * the initial probe position is set explicitly.
+ */
+void
+PoreAnalyzer::setInitProbePosAtoms(
+        const std::vector<int> &atomIndices)
+{
+    ippAtoms_ = atomIndices;
+}
+
+
+/*!
+ * Sets the pore-forming residues. Keys of residueAtoms are residue IDs and 
+ * are used to look up hydrophobicities and to identify residues in the 
+ * result. Residues without an entry in calphaAtoms use their centre of 
+ * geometry in place of the C-alpha position and are hence never pore-facing.
+ */
+void
+PoreAnalyzer::setPoreResidues(
+        const std::map<int, std::vector<int>> &residueAtoms,
+        const std::map<int, int> &calphaAtoms)
+{
+    residueAtoms_ = residueAtoms;
+    calphaAtoms_ = calphaAtoms;
+}
+
+
+/*!
+ * Sets the solvent particles. Keys of particleAtoms identify particles in
+ * the result.
+ */
+void
+PoreAnalyzer::setSolventParticles(
+        const std::map<int, std::vector<int>> &particleAtoms)
+{
+    solventAtoms_ = particleAtoms;
+}
+
+
+/*!
+ * Sets the path finding method and its parameters. Entries in par overwrite 
+ * the corresponding default values, all other defaults are kept.
+ */
+void
+PoreAnalyzer::setPathFindingMethod(
+        ePathFindingMethod method,
+        const std::map<std::string, real> &par,
+        const PathFindingParameters &params)
+{
+    method_ = method;
+    for(auto p : par)
+    {
+        par_[p.first] = p.second;
+    }
+    params_ = params;
+}
+
+
+/*!
+ * Sets a fixed initial probe position. 
+ */
+void
+PoreAnalyzer::setInitProbePos(
+        const gmx::RVec &initProbePos)
+{
+    initProbePos_ = initProbePos;
+    initProbePosIsSet_ = true;
+}
+
+
+/*!
+ * Sets the channel direction vector.
+ */
+void
+PoreAnalyzer::setChanDirVec(
+        const gmx::RVec &chanDirVec)
+{
+    chanDirVec_ = chanDirVec;
+}
+
+
+/*!
+ * Sets how the pathway coordinate system is aligned.
+ */
+void
+PoreAnalyzer::setPathAlignmentMethod(
+        ePathAlignmentMethod method)
+{
+    pathAlignmentMethod_ = method;
+}
+
+
+/*!
+ * Sets the margin used in deciding whether residues are pore-lining.
+ */
+void
+PoreAnalyzer::setPoreLiningMargin(
+        real margin)
+{
+    poreLiningMargin_ = margin;
+}
+
+
+/*!
+ * Enables estimation of hydrophobicity profiles. The residue information is
+ * copied, so that resInfo need not outlive the analyser.
+ */
+void
+PoreAnalyzer::setHydrophobicity(
+        const ResidueInformationProvider &resInfo,
+        const DensityEstimationParameters &params,
+        real bandWidth)
+{
+    resInfo_ = resInfo;
+    hydrophobicity_.reset(
+            new HydrophobicityProfileStage(resInfo_, params, bandWidth));
+}
+
+
+/*!
+ * Enables estimation of the solvent density.
+ */
+void
+PoreAnalyzer::setDensityEstimation(
+        eDensityEstimator method,
+        const DensityEstimationParameters &params,
+        real bandWidth)
+{
+    density_.reset(new SolventDensityStage(method, params, bandWidth));
+}
+
+
+/*!
+ * Analyses a single set of coordinates. The array x must contain at least
+ * numAtoms positions and all atom indices must be smaller than numAtoms. If
+ * no box is given, periodicity is ignored.
+ */
+PoreAnalysisResult
+PoreAnalyzer::analyse(
+        const rvec *x,
+        int numAtoms,
+        const matrix box)
+{
+    // sanity checks:
+    if( pathwayAtoms_.empty() )
+    {
+        throw std::logic_error("ERROR: No pathway atoms given.");
+    }
+    checkAtomIndices(pathwayAtoms_, numAtoms);
+    checkAtomIndices(ippAtoms_, numAtoms);
+    for(auto res : residueAtoms_)
+    {
+        checkAtomIndices(res.second, numAtoms);
+    }
+    for(auto cal : calphaAtoms_)
+    {
+        checkAtomIndices(std::vector<int>(1, cal.second), numAtoms);
+    }
+    for(auto sol : solventAtoms_)
+    {
+        checkAtomIndices(sol.second, numAtoms);
+    }
+
+    // set up periodic boundary conditions:
+    // NOTE: an empty box means that periodicity is ignored
+    matrix boxMat = {{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}};
+    if( box != nullptr )
+    {
+        copy_mat(box, boxMat);
+    }
+    t_pbc pbc;
+    set_pbc(&pbc, -1, boxMat);
+
+    // run analysis steps on a local context:
+    FrameAnalysisContext ctx;
+    ctx.pbc_ = &pbc;
+    findPath(x, &pbc, ctx);
+    if( !residueAtoms_.empty() )
+    {
+        mapPoreResidues(x, ctx);
+    }
+    if( !solventAtoms_.empty() )
+    {
+        mapSolvent(x, ctx);
+    }
+
+    // estimate profiles if requested:
+    if( hydrophobicity_ )
+    {
+        if( residueAtoms_.empty() )
+        {
+            hydrophobicity_ -> zero(ctx, ctx.hydrophobicity_);
+        }
+        else
+        {
+            hydrophobicity_ -> estimate(ctx, ctx.hydrophobicity_);
+        }
+    }
+    if( density_ )
+    {
+        if( solventAtoms_.empty() )
+        {
+            density_ -> zero(ctx, ctx.solventDensity_);
+        }
+        else
+        {
+            density_ -> estimate(ctx, ctx.solventDensity_);
+        }
+    }
+
+    // move results out of context:
+    PoreAnalysisResult result;
+    result.initProbePos_ = ctx.initProbePos_;
+    result.molPath_ = std::move(ctx.molPath_);
+    result.poreCogMappedCoords_ = std::move(ctx.poreCogMappedCoords_);
+    result.poreCalMappedCoords_ = std::move(ctx.poreCalMappedCoords_);
+    result.poreLining_ = std::move(ctx.poreLining_);
+    result.poreFacing_ = std::move(ctx.poreFacing_);
+    result.hydrophobicity_ = std::move(ctx.hydrophobicity_);
+    result.solventMappedCoords_ = std::move(ctx.solventMappedCoords_);
+    result.solvInsideSample_ = std::move(ctx.solvInsideSample_);
+    result.solvInsidePore_ = std::move(ctx.solvInsidePore_);
+    result.numSolvInsideSample_ = ctx.numSolvInsideSample_;
+    result.numSolvInsidePore_ = ctx.numSolvInsidePore_;
+    result.solventDensity_ = std::move(ctx.solventDensity_);
+    return result;
+}
+
+
+/*
+ * Finds the permeation pathway through the pathway atoms and stores it in 
+ * the given context. Mirrors PathFindingStage::evaluate(), but uses the 
+ * centre of geometry rather than the centre of mass as initial probe 
+ * position, as no masses are available.
+ */
+void
+PoreAnalyzer::findPath(
+        const rvec *x,
+        t_pbc *pbc,
+        FrameAnalysisContext &ctx) const
+{
+    // determine initial probe position:
+    gmx::RVec initProbePos = initProbePos_;
+    if( initProbePosIsSet_ == false )
+    {
+        initProbePos = centreOfGeometry(
+                x, 
+                ippAtoms_.empty() ? pathwayAtoms_ : ippAtoms_);
+    }
+    ctx.initProbePos_ = initProbePos;
+
+    // gather positions of pathway atoms:
+    std::vector<gmx::RVec> pathwayPos;
+    pathwayPos.reserve(pathwayAtoms_.size());
+    for(auto idx : pathwayAtoms_)
+    {
+        pathwayPos.push_back(gmx::RVec(x[idx]));
+    }
+
+    // create path finding module:
+    std::unique_ptr<AbstractPathFinder> pfm;
+    if( method_ == ePathFindingMethodInplaneOptimised )
+    {
+        pfm.reset(new InplaneOptimisedProbePathFinder(
+                par_,
+                initProbePos,
+                chanDirVec_,
+                pbc,
+                gmx::AnalysisNeighborhoodPositions(pathwayPos),
+                vdwRadii_));
+    }
+    else if( method_ == ePathFindingMethodNaiveCylindrical )
+    {
+        pfm.reset(new NaiveCylindricalPathFinder(
+                par_,
+                initProbePos,
+                chanDirVec_));
+    }
+
+    // find path and retrieve molecular path object:
+    pfm -> setParameters(params_);
+    pfm -> findPath();
+    ctx.molPath_.reset(new MolecularPath(pfm -> getMolecularPath()));
+
+    // map initial probe position onto pathway:
+    std::vector<gmx::RVec> ipp(1, initProbePos);
+    std::vector<gmx::RVec> mappedIpp = ctx.molPath_ -> mapPositions(ipp);
+
+    // shift coordinates of molecular path if requested:
+    if( pathAlignmentMethod_ == ePathAlignmentMethodIpp )
+    {
+        ctx.molPath_ -> shift(mappedIpp.front());
+        ctx.molPath_ -> mapPositions(ipp);
+    }
+}
+
+
+/*
+ * Maps the centres of geometry and C-alpha atoms of the pore residues onto
+ * the pathway and decides which residues are pore-lining and pore-facing.
+ */
+void
+PoreAnalyzer::mapPoreResidues(
+        const rvec *x,
+        FrameAnalysisContext &ctx) const
+{
+    // positions of residue centres and C-alphas in order of residue ID:
+    std::vector<gmx::RVec> cogPos;
+    std::vector<gmx::RVec> calPos;
+    cogPos.reserve(residueAtoms_.size());
+    calPos.reserve(residueAtoms_.size());
+    for(auto res : residueAtoms_)
+    {
+        cogPos.push_back(centreOfGeometry(x, res.second));
+
+        auto cal = calphaAtoms_.find(res.first);
+        if( cal != calphaAtoms_.end() )
+        {
+            calPos.push_back(gmx::RVec(x[cal -> second]));
+        }
+        else
+        {
+            calPos.push_back(cogPos.back());
+        }
+    }
+
+    // map onto pathway:
+    std::vector<gmx::RVec> cogMapped = ctx.molPath_ -> mapPositions(cogPos);
+    std::vector<gmx::RVec> calMapped = ctx.molPath_ -> mapPositions(calPos);
+    int i = 0;
+    for(auto res : residueAtoms_)
+    {
+        ctx.poreCogMappedCoords_[res.first] = cogMapped[i];
+        ctx.poreCalMappedCoords_[res.first] = calMapped[i];
+        i++;
+    }
+
+    // decide which residues are pore-lining and pore-facing:
+    PoreResidueMappingStage::classifyResidues(ctx, poreLiningMargin_, true);
+}
+
+
+/*
+ * Maps the centres of geometry of the solvent particles onto the pathway and
+ * decides which of them lie inside the sample region and the pore.
+ */
+void
+PoreAnalyzer::mapSolvent(
+        const rvec *x,
+        FrameAnalysisContext &ctx) const
+{
+    // positions of particle centres in order of particle ID:
+    std::vector<gmx::RVec> cogPos;
+    cogPos.reserve(solventAtoms_.size());
+    for(auto sol : solventAtoms_)
+    {
+        cogPos.push_back(centreOfGeometry(x, sol.second));
+    }
+
+    // map onto pathway:
+    std::vector<gmx::RVec> cogMapped = ctx.molPath_ -> mapPositions(cogPos);
+    int i = 0;
+    for(auto sol : solventAtoms_)
+    {
+        ctx.solventMappedCoords_[sol.first] = cogMapped[i];
+        i++;
+    }
+
+    // decide which particles are inside sample region and pore:
+    SolventMappingStage::classifySolvent(ctx);
+}
+
+
+/*
+ * Centre of geometry of the given atoms.
+ */
+gmx::RVec
+PoreAnalyzer::centreOfGeometry(
+        const rvec *x,
+        const std::vector<int> &atomIndices)
+{
+    gmx::RVec cog(0.0, 0.0, 0.0);
+    for(auto idx : atomIndices)
+    {
+        cog[XX] += x[idx][XX];
+        cog[YY] += x[idx][YY];
+        cog[ZZ] += x[idx][ZZ];
+    }
+    if( !atomIndices.empty() )
+    {
+        cog[XX] /= atomIndices.size();
+        cog[YY] /= atomIndices.size();
+        cog[ZZ] /= atomIndices.size();
+    }
+    return cog;
+}
+
+
+/*
+ * Throws if any of the given atom indices lies outside the coordinate array.
+ */
+void
+PoreAnalyzer::checkAtomIndices(
+        const std::vector<int> &atomIndices,
+        int numAtoms)
+{
+    for(auto idx : atomIndices)
+    {
+        if( idx < 0 || idx >= numAtoms )
+        {
+            throw std::logic_error("ERROR: Atom index " + 
+                                   std::to_string(idx) + 
+                                   " exceeds coordinate array of " + 
+                                   std::to_string(numAtoms) + " atoms.");
+        }
+    }
+}
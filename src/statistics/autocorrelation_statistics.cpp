@@ -0,0 +1,265 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "statistics/autocorrelation_statistics.hpp"
+
+
+/*!
+ * Constructs an empty accumulator for autocorrelations up to the given
+ * maximum lag (in number of frames).
+ */
+AutocorrelationStatistics::AutocorrelationStatistics(
+        const size_t maxLag)
+    : maxLag_(maxLag)
+    , offset_(0.0)
+    , num_(0)
+    , sum_(0.0)
+    , sumSq_(0.0)
+    , lagProdSum_(maxLag + 1, 0.0)
+    , headSum_(maxLag + 1, 0.0)
+    , tailSum_(maxLag + 1, 0.0)
+    , recent_(maxLag, 0.0)
+    , recentPos_(0)
+{
+    // sanity check:
+    if( maxLag == 0 )
+    {
+        throw std::logic_error("Maximum lag of autocorrelation must be "
+                               "positive.");
+    }
+}
+
+
+/*!
+ * Adds a new value to the time series and updates the lagged products with 
+ * all values in the ring buffer.
+ *
+ * For each lag l the sum of the first N - l values (head) and the last N - l
+ * values (tail) is needed to subtract the mean. The tail sum is simply 
+ * incremented whenever a value with at least l predecessors arrives, while
+ * the head sum is incremented by the value l steps back.
+ */
+void
+AutocorrelationStatistics::update(
+        const real newValue)
+{
+    // skip non-finite values:
+    if( !std::isfinite(newValue) )
+    {
+        return;
+    }
+
+    // first value defines offset:
+    if( num_ == 0 )
+    {
+        offset_ = newValue;
+    }
+    double x = static_cast<double>(newValue) - offset_;
+
+    // update lagged products with previous values:
+    size_t numLags = std::min(num_, maxLag_);
+    for(size_t l = 1; l <= numLags; l++)
+    {
+        double prev = recent_[(recentPos_ + maxLag_ - l) % maxLag_];
+        lagProdSum_[l] += prev*x;
+        headSum_[l] += prev;
+        tailSum_[l] += x;
+    }
+
+    // update overall sums:
+    num_++;
+    sum_ += x;
+    sumSq_ += x*x;
+
+    // add to ring buffer:
+    recent_[recentPos_] = x;
+    recentPos_ = (recentPos_ + 1) % maxLag_;
+}
+
+
+/*!
+ * Convenience function to update a vector of AutocorrelationStatistics with a
+ * vector of new values, e.g. a profile sampled at a set of support points.
+ */
+void
+AutocorrelationStatistics::updateMultiple(
+        std::vector<AutocorrelationStatistics> &stat,
+        const std::vector<real> &newValues)
+{
+    // sanity check:
+    if( stat.size() != newValues.size() )
+    {
+        throw std::logic_error("Can not update autocorrelation statistics "
+                               "vector with data vector of different size.");
+    }
+
+    // update each value individually:
+    for(size_t i = 0; i < stat.size(); i++)
+    {
+        stat[i].update(newValues[i]);
+    }
+}
+
+
+/*!
+ * Returns the number of (finite) values in the time series.
+ */
+int
+AutocorrelationStatistics::num() const
+{
+    return num_;
+}
+
+
+/*!
+ * Returns the maximum lag for which autocorrelations are accumulated.
+ */
+size_t
+AutocorrelationStatistics::maxLag() const
+{
+    return maxLag_;
+}
+
+
+/*!
+ * Returns the mean of the time series.
+ */
+real
+AutocorrelationStatistics::mean() const
+{
+    if( num_ == 0 )
+    {
+        return 0.0;
+    }
+    return offset_ + sum_/num_;
+}
+
+
+/*!
+ * Returns the normalised autocorrelation at the given lag. Returns zero if 
+ * the lag exceeds maxLag() or the series is too short or has no variance.
+ */
+real
+AutocorrelationStatistics::autocorrelation(
+        const size_t lag) const
+{
+    double c0 = autocovariance(0);
+    if( lag > maxLag_ || lag >= num_ || c0 <= 0.0 )
+    {
+        return 0.0;
+    }
+    return autocovariance(lag)/c0;
+}
+
+
+/*!
+ * Returns the integrated autocorrelation time in units of frames using 
+ * automatic windowing as described in the class documentation. Returns 0.5,
+ * i.e. the value for uncorrelated data, if there is insufficient data.
+ */
+real
+AutocorrelationStatistics::integratedAutocorrelationTime() const
+{
+    // window factor for automatic windowing:
+    const double windowFactor = 5.0;
+
+    // sum autocorrelations within window:
+    double tau = 0.5;
+    size_t maxLag = std::min(maxLag_, num_ > 0 ? num_ - 1 : 0);
+    for(size_t l = 1; l <= maxLag; l++)
+    {
+        // truncate at first non-positive autocorrelation:
+        double rho = autocorrelation(l);
+        if( rho <= 0.0 )
+        {
+            break;
+        }
+        tau += rho;
+
+        // automatic window:
+        if( l >= windowFactor*tau )
+        {
+            break;
+        }
+    }
+    return tau;
+}
+
+
+/*!
+ * Returns the statistical inefficiency, i.e. twice the integrated 
+ * autocorrelation time.
+ */
+real
+AutocorrelationStatistics::statisticalInefficiency() const
+{
+    return 2.0*integratedAutocorrelationTime();
+}
+
+
+/*!
+ * Returns the standard error of the mean corrected for autocorrelation.
+ */
+real
+AutocorrelationStatistics::standardError() const
+{
+    if( num_ < 2 )
+    {
+        return 0.0;
+    }
+    double var = (sumSq_ - sum_*sum_/num_)/(num_ - 1.0);
+    if( var <= 0.0 )
+    {
+        return 0.0;
+    }
+    return std::sqrt(statisticalInefficiency()*var/num_);
+}
+
+
+/*!
+ * Auxiliary function returning the (biased) autocovariance at the given lag.
+ * The means of the leading and trailing parts of the series are subtracted
+ * separately, which reduces the bias due to the finite length of the series.
+ */
+double
+AutocorrelationStatistics::autocovariance(
+        const size_t lag) const
+{
+    if( lag >= num_ )
+    {
+        return 0.0;
+    }
+    if( lag == 0 )
+    {
+        return (sumSq_ - sum_*sum_/num_)/num_;
+    }
+    double n = num_ - lag;
+    double cov = lagProdSum_[lag] - headSum_[lag]*tailSum_[lag]/n;
+    return cov/num_;
+}
+
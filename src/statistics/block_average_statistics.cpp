@@ -0,0 +1,244 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "statistics/block_average_statistics.hpp"
+
+
+/*!
+ * Constructs an empty block averaging accumulator. By default, levels with at
+ * least 16 complete blocks are considered in the standard error estimate.
+ */
+BlockAverageStatistics::BlockAverageStatistics()
+    : minNumBlocks_(16)
+{
+
+}
+
+
+/*!
+ * Adds a new value to the time series. The value is added to the statistics
+ * on level zero and then propagated upwards: whenever a level already holds 
+ * an incomplete block, the new value completes it and the average of both 
+ * is passed on to the next level.
+ */
+void
+BlockAverageStatistics::update(
+        const real newValue)
+{
+    // skip non-finite values:
+    if( !std::isfinite(newValue) )
+    {
+        return;
+    }
+
+    // propagate block means through levels:
+    real value = newValue;
+    for(size_t k = 0; ; k++)
+    {
+        // create new level if necessary:
+        if( k == levels_.size() )
+        {
+            levels_.push_back(SummaryStatistics());
+            pending_.push_back(0.0);
+            hasPending_.push_back(false);
+        }
+
+        // add block mean to this level:
+        levels_[k].update(value);
+
+        // either start a new block on the next level or complete one:
+        if( !hasPending_[k] )
+        {
+            pending_[k] = value;
+            hasPending_[k] = true;
+            break;
+        }
+        value = 0.5*(pending_[k] + value);
+        hasPending_[k] = false;
+    }
+}
+
+
+/*!
+ * Convenience function to update a vector of BlockAverageStatistics with a 
+ * vector of new values, e.g. a profile sampled at a set of support points.
+ */
+void
+BlockAverageStatistics::updateMultiple(
+        std::vector<BlockAverageStatistics> &stat,
+        const std::vector<real> &newValues)
+{
+    // sanity check:
+    if( stat.size() != newValues.size() )
+    {
+        throw std::logic_error("Can not update block average statistics "
+                               "vector with data vector of different size.");
+    }
+
+    // update each value individually:
+    for(size_t i = 0; i < stat.size(); i++)
+    {
+        stat[i].update(newValues[i]);
+    }
+}
+
+
+/*!
+ * Sets the minimum number of complete blocks a level needs to have in order
+ * to be considered in the standard error estimate.
+ */
+void
+BlockAverageStatistics::setMinNumBlocks(
+        const int minNumBlocks)
+{
+    if( minNumBlocks < 2 )
+    {
+        throw std::logic_error("Minimum number of blocks must be at least "
+                               "two.");
+    }
+    minNumBlocks_ = minNumBlocks;
+}
+
+
+/*!
+ * Returns the number of (finite) values in the time series.
+ */
+int
+BlockAverageStatistics::num() const
+{
+    if( levels_.empty() )
+    {
+        return 0;
+    }
+    return levels_.front().num();
+}
+
+
+/*!
+ * Returns the mean of the time series.
+ */
+real
+BlockAverageStatistics::mean() const
+{
+    if( levels_.empty() )
+    {
+        return 0.0;
+    }
+    return levels_.front().mean();
+}
+
+
+/*!
+ * Returns the block averaging estimate of the standard error of the mean. 
+ * This is the largest standard error over all levels with at least 
+ * minNumBlocks() blocks. If no level has sufficiently many blocks, the naive
+ * standard error of level zero is returned.
+ */
+real
+BlockAverageStatistics::standardError() const
+{
+    real se = blockStandardError(0);
+    for(size_t k = 1; k < levels_.size(); k++)
+    {
+        if( levels_[k].num() >= minNumBlocks_ )
+        {
+            se = std::max(se, blockStandardError(k));
+        }
+    }
+    return se;
+}
+
+
+/*!
+ * Returns the statistical inefficiency, i.e. the ratio of the block averaging
+ * estimate of the variance of the mean to the naive estimate assuming 
+ * independent samples. Returns one if the time series has no variance.
+ */
+real
+BlockAverageStatistics::statisticalInefficiency() const
+{
+    real naiveSe = blockStandardError(0);
+    if( naiveSe <= 0.0 )
+    {
+        return 1.0;
+    }
+    real ratio = standardError()/naiveSe;
+    return ratio*ratio;
+}
+
+
+/*!
+ * Returns the minimum number of blocks considered in standardError().
+ */
+int
+BlockAverageStatistics::minNumBlocks() const
+{
+    return minNumBlocks_;
+}
+
+
+/*!
+ * Returns the number of blocking levels, which grows logarithmically with the
+ * length of the time series.
+ */
+size_t
+BlockAverageStatistics::numLevels() const
+{
+    return levels_.size();
+}
+
+
+/*!
+ * Returns the number of consecutive values averaged in each block on the 
+ * given level.
+ */
+int
+BlockAverageStatistics::blockSize(
+        const size_t level) const
+{
+    return 1 << level;
+}
+
+
+/*!
+ * Returns the standard error of the mean estimated from the block means on 
+ * the given level, i.e. the standard deviation of the block means divided by
+ * the square root of the number of blocks. Returns zero for levels with less
+ * than two blocks.
+ */
+real
+BlockAverageStatistics::blockStandardError(
+        const size_t level) const
+{
+    if( level >= levels_.size() || levels_[level].num() < 2 )
+    {
+        return 0.0;
+    }
+    return levels_[level].sd()/std::sqrt(levels_[level].num());
+}
+
@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 #include "statistics/gaussian_density_derivative.hpp"
 
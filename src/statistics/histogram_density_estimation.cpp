@@ -22,10 +22,14 @@
 // THE SOFTWARE.
 
 
+
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <numeric>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 #include "geometry/cubic_spline_interp_1D.hpp"
 #include "geometry/linear_spline_interp_1D.hpp"
@@ -34,10 +38,15 @@
 
 
 /*!
- * Sets initial bin width to zero.
+ * Sets initial bin width to zero and uses a single thread for binning by
+ * default.
  */
 HistogramDensityEstimator::HistogramDensityEstimator()
     : binWidth_(0.0)
+    , numThreads_(1)
+    , minSamplesPerThread_(10000)
+    , accumFirstBreak_(0)
+    , accumNumSamples_(0)
 {
 
 }
@@ -48,6 +57,10 @@ HistogramDensityEstimator::HistogramDensityEstimator()
  * returns a one-dimensional spline curve representing the probability density
  * of the samples. The spline curve is normalised such that its integral is
  * one.
+ *
+ * The samples do not need to be sorted. If the break points created for a 
+ * previous call also fit the range of the current sample, they are reused
+ * together with their midpoints.
  */
 SplineCurve1D
 HistogramDensityEstimator::estimate(
@@ -59,14 +72,17 @@ HistogramDensityEstimator::estimate(
         throw std::logic_error("Histogram bin width must be a positive number!");
     }
 
-    // make sure input data is sorted:
-    std::sort(samples.begin(), samples.end());
+    // determine data range:
+    real rangeLo;
+    real rangeHi;
+    sampleRange(samples, rangeLo, rangeHi);
 
-    // set up break points for this data set: 
-    std::vector<real> breaks = createBreaks(samples);
-
-    // compute midpoints corresponding to these breakpoints:
-    std::vector<real> midpoints = createMidpoints(breaks);
+    // set up break points and midpoints only if range has changed: 
+    if( !breaksCoverRange(rangeLo, rangeHi) )
+    {
+        breaks_ = createBreaks(rangeLo, rangeHi);
+        midpoints_ = createMidpoints(breaks_);
+    }
 
     // emergency break for histogram size:
     // (If number of bins gets too large, the spline interpolation code will
@@ -74,21 +90,21 @@ HistogramDensityEstimator::estimate(
     // situation, but in practice the reasonable size limit for number of 
     // histogram bins is probably lower due to performance constraints.)
     size_t maxBinNumber = 25000;
-    if( midpoints.size() > maxBinNumber )
+    if( midpoints_.size() > maxBinNumber )
     {
         throw std::runtime_error("Number of bins exceeds limit for spline "
         "interpolation! Need to increase bin width.");
     }
     
     // calculate density:
-    std::vector<real> density = calculateDensity(samples, breaks);
+    std::vector<real> density = calculateDensity(samples, breaks_);
 
     // sanity check:
-    if( density.size() != midpoints.size() )
+    if( density.size() != midpoints_.size() )
     {
         throw std::logic_error("Histogram has " + 
         std::string(std::to_string(density.size())) + " and " + 
-        std::string(std::to_string(midpoints.size())) + " midpoints!");
+        std::string(std::to_string(midpoints_.size())) + " midpoints!");
     }
 
     // scale by inverse bin width to get proper density:
@@ -100,7 +116,7 @@ HistogramDensityEstimator::estimate(
 
     // finally create spline curve from this:
     LinearSplineInterp1D Interp;
-    return Interp(midpoints, density);
+    return Interp(midpoints_, density);
 }
 
 
@@ -129,6 +145,9 @@ HistogramDensityEstimator::setParameters(
 /*!
  * Setter method for assigning a bin width for the histogram. Should be called
  * at least once prior to calling evaluate().
+ *
+ * Changing the bin width discards the cached break points as well as any 
+ * histogram built up with accumulate().
  */
 void
 HistogramDensityEstimator::setBinWidth(
@@ -140,41 +159,336 @@ HistogramDensityEstimator::setBinWidth(
         throw std::logic_error("Histogram bin width must be positive!");
     }
 
+    // cached breaks and accumulated counts are only valid for one bin width:
+    if( binWidth != binWidth_ )
+    {
+        breaks_.clear();
+        midpoints_.clear();
+        resetAccumulated();
+    }
+
     // set internal bin width parameter:
     binWidth_ = binWidth;
 }
 
 
 /*!
- * Auxiliary function for creating break points covering a given data range.
- * The break points are spaced equidistantly (the spacing is the bin width), 
- * starting from 1.5 bin widths  below the lower end of the data range and 
- * reaching up to at least 1.5 bin widths above the data range. This ensures
- * that the entire data range is covered and that the first and last bin are
- * always empty. This convention simplifies the construction of the 
- * SplineCurve1D interpolating the density, which will employs simple constant
- * extrapolation.
+ * Returns the bin width of the histogram.
  */
-std::vector<real>
-HistogramDensityEstimator::createBreaks(
+real
+HistogramDensityEstimator::binWidth() const
+{
+    return binWidth_;
+}
+
+
+/*!
+ * Sets the maximum number of threads used for binning samples. Each thread 
+ * processes a contiguous chunk of at least 10000 samples, so that small
+ * samples are still binned serially.
+ */
+void
+HistogramDensityEstimator::setNumThreads(
+        size_t numThreads)
+{
+    // sanity check:
+    if( numThreads == 0 )
+    {
+        throw std::logic_error("Number of histogram threads must be positive!");
+    }
+
+    numThreads_ = numThreads;
+}
+
+
+/*!
+ * Adds a set of samples to the trajectory-wide histogram. Unlike estimate(),
+ * this does not construct a density for the given samples, but merely adds
+ * their counts to a running histogram, which can be turned into a density
+ * with accumulatedDensity() once all frames have been processed.
+ *
+ * Break points of the accumulated histogram lie at integer multiples of the
+ * bin width, so that extending the histogram to a wider data range leaves
+ * the existing bins untouched. The grid always keeps at least one empty bin
+ * at either end.
+ */
+void
+HistogramDensityEstimator::accumulate(
         const std::vector<real> &samples)
 {
-    // handle case of empty sample:
-    real rangeLo = 0.0;
-    real rangeHi = 0.0;
-    if( samples.size() != 0 )
+    // sanity checks:
+    if( binWidth_ <= 0 )
+    {
+        throw std::logic_error("Histogram bin width must be a positive number!");
+    }
+
+    // nothing to do for empty sample:
+    if( samples.empty() )
+    {
+        return;
+    }
+
+    // index of first and last break needed for this sample:
+    real rangeLo;
+    real rangeHi;
+    sampleRange(samples, rangeLo, rangeHi);
+    extendAccumulated(
+            static_cast<long>(std::floor(rangeLo/binWidth_)) - 2,
+            static_cast<long>(std::ceil(rangeHi/binWidth_)) + 2);
+
+    // add counts for this sample:
+    std::vector<size_t> counts = countSamples(samples, accumBreaks_);
+    for(size_t i = 0; i < counts.size(); i++)
     {
-        rangeLo = samples.front();
-        rangeHi = samples.back();
+        accumCounts_[i] += counts[i];
+        accumNumSamples_ += counts[i];
     }
+}
 
-    // will shift by half a bin width past lower endpoint:
+
+/*!
+ * Adds the counts of a histogram on the same grid of break points to the 
+ * trajectory-wide histogram. The first count belongs to the bin starting at
+ * firstBreak times the bin width. This allows histograms accumulated over 
+ * different parts of a trajectory to be combined exactly (see also 
+ * mergeAccumulated()).
+ */
+void
+HistogramDensityEstimator::addAccumulated(
+        long firstBreak,
+        const std::vector<size_t> &counts)
+{
+    // sanity checks:
+    if( binWidth_ <= 0 )
+    {
+        throw std::logic_error("Histogram bin width must be a positive number!");
+    }
+
+    // nothing to do for empty histogram:
+    if( counts.empty() )
+    {
+        return;
+    }
+
+    // add counts on common grid:
+    extendAccumulated(firstBreak, firstBreak + static_cast<long>(counts.size()));
+    for(size_t i = 0; i < counts.size(); i++)
+    {
+        accumCounts_[firstBreak - accumFirstBreak_ + i] += counts[i];
+        accumNumSamples_ += counts[i];
+    }
+}
+
+
+/*!
+ * Adds the trajectory-wide histogram of another estimator with the same bin
+ * width to that of this estimator.
+ */
+void
+HistogramDensityEstimator::mergeAccumulated(
+        const HistogramDensityEstimator &other)
+{
+    if( other.binWidth_ != binWidth_ )
+    {
+        throw std::logic_error("Can not merge histograms with different bin "
+                               "widths!");
+    }
+    addAccumulated(other.accumFirstBreak_, other.accumCounts_);
+}
+
+
+/*!
+ * Returns the probability density of all samples passed to accumulate() as a
+ * linearly interpolated spline curve. The density is normalised in the same
+ * way as the one returned by estimate(). If no samples have been accumulated,
+ * an all-zero density is returned.
+ */
+SplineCurve1D
+HistogramDensityEstimator::accumulatedDensity() const
+{
+    // sanity checks:
+    if( binWidth_ <= 0 )
+    {
+        throw std::logic_error("Histogram bin width must be a positive number!");
+    }
+
+    // break points and midpoints:
+    std::vector<real> breaks = accumulatedBreaks();
+    std::vector<real> midpoints = createMidpoints(breaks);
+
+    // emergency break for histogram size (see estimate()):
+    size_t maxBinNumber = 25000;
+    if( midpoints.size() > maxBinNumber )
+    {
+        throw std::runtime_error("Number of bins exceeds limit for spline "
+        "interpolation! Need to increase bin width.");
+    }
+
+    // normalise counts to obtain density:
+    std::vector<real> density(midpoints.size(), 0.0);
+    if( accumNumSamples_ > 0 )
+    {
+        real norm = 1.0/(accumNumSamples_*binWidth_);
+        for(size_t i = 0; i < accumCounts_.size(); i++)
+        {
+            density[i] = accumCounts_[i]*norm;
+        }
+    }
+
+    // create spline curve from this:
+    LinearSplineInterp1D Interp;
+    return Interp(midpoints, density);
+}
+
+
+/*!
+ * Returns the break points of the accumulated histogram. If no samples have
+ * been accumulated yet, these are the break points for an empty sample.
+ */
+std::vector<real>
+HistogramDensityEstimator::accumulatedBreaks() const
+{
+    if( accumBreaks_.empty() )
+    {
+        return createBreaks(0.0, 0.0);
+    }
+    return accumBreaks_;
+}
+
+
+/*!
+ * Returns the index of the first break point of the accumulated histogram, 
+ * i.e. the position of this break point in multiples of the bin width.
+ */
+long
+HistogramDensityEstimator::accumulatedFirstBreak() const
+{
+    return accumFirstBreak_;
+}
+
+
+/*!
+ * Returns the number of samples in each bin of the accumulated histogram.
+ */
+std::vector<size_t>
+HistogramDensityEstimator::accumulatedCounts() const
+{
+    if( accumCounts_.empty() )
+    {
+        return std::vector<size_t>(accumulatedBreaks().size() - 1, 0);
+    }
+    return accumCounts_;
+}
+
+
+/*!
+ * Returns the total number of samples in the accumulated histogram.
+ */
+size_t
+HistogramDensityEstimator::numAccumulatedSamples() const
+{
+    return accumNumSamples_;
+}
+
+
+/*!
+ * Discards the accumulated histogram.
+ */
+void
+HistogramDensityEstimator::resetAccumulated()
+{
+    accumFirstBreak_ = 0;
+    accumBreaks_.clear();
+    accumCounts_.clear();
+    accumNumSamples_ = 0;
+}
+
+
+/*!
+ * Auxiliary function that extends the grid of the trajectory-wide histogram
+ * so that it spans the break points with indices firstBreak to lastBreak, 
+ * keeping all existing counts.
+ */
+void
+HistogramDensityEstimator::extendAccumulated(
+        long firstBreak,
+        long lastBreak)
+{
+    // never shrink an existing grid:
+    long oldFirstBreak = accumFirstBreak_;
+    long oldLastBreak = accumFirstBreak_ + 
+                        static_cast<long>(accumCounts_.size());
+    if( !accumCounts_.empty() )
+    {
+        firstBreak = std::min(firstBreak, oldFirstBreak);
+        lastBreak = std::max(lastBreak, oldLastBreak);
+    }
+    if( !accumCounts_.empty() && 
+        firstBreak == oldFirstBreak && 
+        lastBreak == oldLastBreak )
+    {
+        return;
+    }
+
+    // shift existing counts into extended grid:
+    std::vector<size_t> counts(lastBreak - firstBreak, 0);
+    std::copy(
+            accumCounts_.begin(),
+            accumCounts_.end(),
+            counts.begin() + (oldFirstBreak - firstBreak));
+    accumCounts_ = counts;
+    accumFirstBreak_ = firstBreak;
+
+    // recompute break points:
+    accumBreaks_.resize(accumCounts_.size() + 1);
+    for(size_t i = 0; i < accumBreaks_.size(); i++)
+    {
+        accumBreaks_[i] = (accumFirstBreak_ + static_cast<long>(i))*binWidth_;
+    }
+}
+
+
+/*!
+ * Auxiliary function for creating break points covering the range of a given
+ * sample, which need not be sorted. See the overload taking the range 
+ * endpoints for details.
+ */
+std::vector<real>
+HistogramDensityEstimator::createBreaks(
+        const std::vector<real> &samples) const
+{
+    real rangeLo;
+    real rangeHi;
+    sampleRange(samples, rangeLo, rangeHi);
+    return createBreaks(rangeLo, rangeHi);
+}
+
+
+/*!
+ * Auxiliary function for creating break points covering a given data range.
+ * The break points are spaced equidistantly (the spacing is the bin width), 
+ * starting from the second multiple of the bin width below the lower end of 
+ * the data range and reaching up to at least 1.5 bin widths above the data 
+ * range. This ensures that the entire data range is covered and that the 
+ * first and last bin are always empty. This convention simplifies the 
+ * construction of the SplineCurve1D interpolating the density, which will 
+ * employs simple constant extrapolation. 
+ *
+ * As the lowest break point is a multiple of the bin width, samples whose 
+ * ranges differ only slightly (as is typical for consecutive frames of a
+ * trajectory) share the same break points.
+ */
+std::vector<real>
+HistogramDensityEstimator::createBreaks(
+        real rangeLo,
+        real rangeHi) const
+{
+    // will shift by half a bin width past upper endpoint:
     real halfBinWidth = 0.5*binWidth_;
-    real breaksLo = rangeLo - 3.0*halfBinWidth;
 
     // build vector of breaks:
     std::vector<real> breaks;
-    breaks.push_back(breaksLo);
+    breaks.push_back(lowestBreak(rangeLo));
     while( breaks.back() <= rangeHi + 3.0*halfBinWidth )
     {
         breaks.push_back(breaks.back() + binWidth_);
@@ -185,6 +499,47 @@ HistogramDensityEstimator::createBreaks(
 }
 
 
+/*!
+ * Auxiliary function that returns the lowest break point createBreaks() uses
+ * for a data range with the given lower end. This is snapped to a multiple 
+ * of the bin width two bins below the bin containing the lower end, so that 
+ * the first bin is guaranteed to be empty.
+ */
+real
+HistogramDensityEstimator::lowestBreak(
+        real rangeLo) const
+{
+    return (std::floor(rangeLo/binWidth_) - 2.0)*binWidth_;
+}
+
+
+/*!
+ * Auxiliary function that checks whether the cached break points are 
+ * identical to those createBreaks() would construct for the given data range.
+ * This is the case if the lowest break point is the same and the upper end of
+ * the range still falls into the last bin. As the lowest break point is 
+ * snapped to a multiple of the bin width, the floating point comparison is 
+ * exact for all data ranges starting in the same bin.
+ */
+bool
+HistogramDensityEstimator::breaksCoverRange(
+        real rangeLo,
+        real rangeHi) const
+{
+    if( breaks_.size() < 2 )
+    {
+        return false;
+    }
+
+    real halfBinWidth = 0.5*binWidth_;
+    real breaksHi = rangeHi + 3.0*halfBinWidth;
+
+    return breaks_.front() == lowestBreak(rangeLo) && 
+           breaks_[breaks_.size() - 2] <= breaksHi &&
+           breaks_.back() > breaksHi;
+}
+
+
 /*!
  * Auxiliary function for computing midpoints from a given set of break points.
  * Midpoins are simply the average of two subsequent break points and form the
@@ -192,7 +547,7 @@ HistogramDensityEstimator::createBreaks(
  */
 std::vector<real>
 HistogramDensityEstimator::createMidpoints(
-        const std::vector<real> &breaks)
+        const std::vector<real> &breaks) const
 {
     // reserve memory for midpoints:
     std::vector<real> midpoints;
@@ -213,10 +568,10 @@ HistogramDensityEstimator::createMidpoints(
 /*!
  * Auxiliary function for calculating the probability density in each bin 
  * (strictly speaking this is a probability mass function rather than a 
- * probability density function). This function loops over the vector of break
- * points and in each interval counts the number of samples that fall into this
- * interval. The counts are then normalised by the number of samples to obtain
- * density. The function assumes that the set of samples is sorted. 
+ * probability density function). This function counts the number of samples
+ * in each interval between subsequent break points using countSamples(). The
+ * counts are then normalised by the number of samples to obtain density. The
+ * samples do not need to be sorted.
  */
 std::vector<real>
 HistogramDensityEstimator::calculateDensity(
@@ -232,25 +587,11 @@ HistogramDensityEstimator::calculateDensity(
         return density;
     }
 
-    // loop over intervals and count samples:
-    std::vector<int> counts;
-    counts.reserve(breaks.size() - 1);
-    auto boundLo = samples.begin();
-    auto boundHi = samples.end();
-    for(size_t i = 0; i < breaks.size() - 1; i++)
-    {
-        // iterator to first element greater equal lower break point:
-        boundLo = std::upper_bound(boundLo, samples.end(), breaks[i]);
-
-        // iterator to first element strictly greater than upper break point:
-        boundHi = std::upper_bound(boundLo, samples.end(), breaks[i+1]);
-
-        // count number of samples in this range:
-        counts.push_back(std::distance(boundLo, boundHi));
-    }
+    // count samples in each interval:
+    std::vector<size_t> counts = countSamples(samples, breaks);
 
     // sum over counts:
-    size_t sum = std::accumulate(counts.begin(), counts.end(), 0.0);
+    size_t sum = std::accumulate(counts.begin(), counts.end(), size_t(0));
 
     // sanity check:
     if( sum != samples.size() )
@@ -267,13 +608,149 @@ HistogramDensityEstimator::calculateDensity(
     }
 
     // calculate density:
-    std::transform(
-            counts.begin(),
-            counts.end(),
-            density.begin(),
-            std::bind2nd(std::divides<real>(), sum));
+    for(size_t i = 0; i < counts.size(); i++)
+    {
+        density[i] = static_cast<real>(counts[i])/sum;
+    }
 
     // return vector of densities:
     return(density);
 }
 
+
+/*!
+ * Auxiliary function that counts the number of samples falling into each 
+ * half-open interval (breaks[i], breaks[i+1]]. Samples outside the range 
+ * spanned by the break points are not counted.
+ *
+ * If more than one thread is permitted and the sample is large enough, the 
+ * sample is split into contiguous chunks, each of which is binned by a 
+ * separate thread into its own array of counts. These arrays are then summed
+ * up, so that no synchronisation is needed while binning.
+ */
+std::vector<size_t>
+HistogramDensityEstimator::countSamples(
+        const std::vector<real> &samples,
+        const std::vector<real> &breaks) const
+{
+    size_t numBins = breaks.size() - 1;
+
+    // number of threads to use for this sample:
+    size_t numThreads = std::min(
+            numThreads_, 
+            samples.size()/minSamplesPerThread_);
+
+    // small samples are binned serially:
+    if( numThreads <= 1 )
+    {
+        std::vector<size_t> counts(numBins, 0);
+        countSamplesRange(samples, breaks, 0, samples.size(), counts);
+        return counts;
+    }
+
+    // each thread bins a contiguous chunk into its private counts:
+    std::vector<std::vector<size_t>> threadCounts(
+            numThreads, 
+            std::vector<size_t>(numBins, 0));
+    std::vector<std::thread> threads;
+    size_t chunkSize = (samples.size() + numThreads - 1)/numThreads;
+    for(size_t i = 0; i < numThreads; i++)
+    {
+        size_t begin = std::min(i*chunkSize, samples.size());
+        size_t end = std::min(begin + chunkSize, samples.size());
+        threads.push_back(std::thread(
+                &HistogramDensityEstimator::countSamplesRange,
+                this,
+                std::cref(samples),
+                std::cref(breaks),
+                begin,
+                end,
+                std::ref(threadCounts[i])));
+    }
+    for(auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    // reduce counts over threads:
+    std::vector<size_t> counts = threadCounts.front();
+    for(size_t i = 1; i < threadCounts.size(); i++)
+    {
+        for(size_t j = 0; j < numBins; j++)
+        {
+            counts[j] += threadCounts[i][j];
+        }
+    }
+
+    return counts;
+}
+
+
+/*!
+ * Auxiliary function that bins the samples with index in [begin, end) and
+ * adds them to the given counts. As the break points are equidistant, the bin
+ * index is computed directly from the sample value. Rounding errors in this 
+ * computation are corrected by comparing against the neighbouring break 
+ * points, so that samples on a break point are assigned to the same bin as 
+ * a binary search would assign them to.
+ */
+void
+HistogramDensityEstimator::countSamplesRange(
+        const std::vector<real> &samples,
+        const std::vector<real> &breaks,
+        size_t begin,
+        size_t end,
+        std::vector<size_t> &counts) const
+{
+    size_t numBins = breaks.size() - 1;
+    real breaksLo = breaks.front();
+    real breaksHi = breaks.back();
+    real invBinWidth = numBins/(breaksHi - breaksLo);
+
+    for(size_t i = begin; i < end; i++)
+    {
+        // skip samples outside histogram range (this includes NaN):
+        real s = samples[i];
+        if( !(s > breaksLo && s <= breaksHi) )
+        {
+            continue;
+        }
+
+        // estimate bin index and correct for rounding errors:
+        size_t idx = std::min(
+                static_cast<size_t>((s - breaksLo)*invBinWidth), 
+                numBins - 1);
+        while( idx > 0 && s <= breaks[idx] )
+        {
+            idx--;
+        }
+        while( idx < numBins - 1 && s > breaks[idx + 1] )
+        {
+            idx++;
+        }
+
+        counts[idx]++;
+    }
+}
+
+
+/*!
+ * Auxiliary function that determines the smallest and largest value in a 
+ * sample. For an empty sample, both are set to zero.
+ */
+void
+HistogramDensityEstimator::sampleRange(
+        const std::vector<real> &samples,
+        real &rangeLo,
+        real &rangeHi) const
+{
+    // handle case of empty sample:
+    rangeLo = 0.0;
+    rangeHi = 0.0;
+    if( samples.size() != 0 )
+    {
+        auto range = std::minmax_element(samples.begin(), samples.end());
+        rangeLo = *range.first;
+        rangeHi = *range.second;
+    }
+}
@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 #include "geometry/linear_spline_interp_1D.hpp"
 #include "statistics/kernel_density_estimator.hpp"
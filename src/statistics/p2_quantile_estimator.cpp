@@ -0,0 +1,246 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "statistics/p2_quantile_estimator.hpp"
+
+
+/*!
+ * Constructs an estimator for the quantile with probability p, which must 
+ * lie in the closed interval [0, 1].
+ */
+P2QuantileEstimator::P2QuantileEstimator(
+        const real p)
+    : p_(p)
+    , num_(0)
+{
+    // sanity check:
+    if( p < 0.0 || p > 1.0 )
+    {
+        throw std::logic_error("Quantile probability must be in [0, 1].");
+    }
+
+    // initial marker positions (one-based) and their desired increments:
+    for(int i = 0; i < 5; i++)
+    {
+        height_[i] = 0.0;
+        pos_[i] = i + 1;
+    }
+    desiredPosIncrement_[0] = 0.0;
+    desiredPosIncrement_[1] = p/2.0;
+    desiredPosIncrement_[2] = p;
+    desiredPosIncrement_[3] = (1.0 + p)/2.0;
+    desiredPosIncrement_[4] = 1.0;
+    for(int i = 0; i < 5; i++)
+    {
+        desiredPos_[i] = 1.0 + 4.0*desiredPosIncrement_[i];
+    }
+}
+
+
+/*!
+ * Updates the quantile estimate with a new value. The first five values are
+ * stored directly as marker heights. Subsequent values update the marker
+ * positions and adjust the heights of the three inner markers where 
+ * necessary.
+ */
+void
+P2QuantileEstimator::update(
+        const real newValue)
+{
+    // skip non-finite values:
+    if( !std::isfinite(newValue) )
+    {
+        return;
+    }
+
+    // initialisation phase stores observations directly:
+    if( num_ < 5 )
+    {
+        height_[num_] = newValue;
+        num_++;
+        if( num_ == 5 )
+        {
+            std::sort(height_.begin(), height_.end());
+        }
+        return;
+    }
+    num_++;
+
+    // find cell containing new value and update extreme markers:
+    int k;
+    if( newValue < height_[0] )
+    {
+        height_[0] = newValue;
+        k = 0;
+    }
+    else if( newValue >= height_[4] )
+    {
+        height_[4] = newValue;
+        k = 3;
+    }
+    else
+    {
+        k = 0;
+        while( newValue >= height_[k + 1] )
+        {
+            k++;
+        }
+    }
+
+    // increment positions of markers above new value and desired positions:
+    for(int i = k + 1; i < 5; i++)
+    {
+        pos_[i]++;
+    }
+    for(int i = 0; i < 5; i++)
+    {
+        desiredPos_[i] += desiredPosIncrement_[i];
+    }
+
+    // adjust heights of inner markers if necessary:
+    for(int i = 1; i < 4; i++)
+    {
+        real d = desiredPos_[i] - pos_[i];
+        if( (d >= 1.0 && pos_[i + 1] - pos_[i] > 1) ||
+            (d <= -1.0 && pos_[i - 1] - pos_[i] < -1) )
+        {
+            int sign = (d > 0.0) ? 1 : -1;
+
+            // try parabolic prediction and fall back to linear if needed:
+            real h = parabolic(i, sign);
+            if( height_[i - 1] < h && h < height_[i + 1] )
+            {
+                height_[i] = h;
+            }
+            else
+            {
+                height_[i] = linear(i, sign);
+            }
+            pos_[i] += sign;
+        }
+    }
+}
+
+
+/*!
+ * Shifts the quantile estimate by the given amount. As with 
+ * SummaryStatistics::shift(), update() should no longer be called afterwards.
+ */
+void
+P2QuantileEstimator::shift(
+        const real shift)
+{
+    for(auto &h : height_)
+    {
+        h += shift;
+    }
+}
+
+
+/*!
+ * Returns the current quantile estimate. For fewer than five samples this is
+ * the exact sample quantile, in case of no samples zero is returned to retain
+ * compatibility with JSON.
+ */
+real
+P2QuantileEstimator::quantile() const
+{
+    // handle case of no data:
+    if( num_ == 0 )
+    {
+        return 0.0;
+    }
+
+    // exact quantile for small samples:
+    if( num_ < 5 )
+    {
+        std::array<real, 5> sorted = height_;
+        std::sort(sorted.begin(), sorted.begin() + num_);
+        real h = p_*(num_ - 1);
+        int lo = static_cast<int>(std::floor(h));
+        int hi = std::min(lo + 1, num_ - 1);
+        return sorted[lo] + (h - lo)*(sorted[hi] - sorted[lo]);
+    }
+
+    // central marker tracks desired quantile:
+    return height_[2];
+}
+
+
+/*!
+ * Returns the probability of the estimated quantile.
+ */
+real
+P2QuantileEstimator::p() const
+{
+    return p_;
+}
+
+
+/*!
+ * Returns the number of (finite) samples seen so far.
+ */
+int
+P2QuantileEstimator::num() const
+{
+    return num_;
+}
+
+
+/*!
+ * Piecewise parabolic prediction of the height of marker i when it is moved
+ * by d (plus or minus one) positions.
+ */
+inline real
+P2QuantileEstimator::parabolic(
+        const int i, 
+        const int d) const
+{
+    real nm = pos_[i - 1];
+    real n = pos_[i];
+    real np = pos_[i + 1];
+    return height_[i] + d/(np - nm)*(
+            (n - nm + d)*(height_[i + 1] - height_[i])/(np - n) +
+            (np - n - d)*(height_[i] - height_[i - 1])/(n - nm));
+}
+
+
+/*!
+ * Linear prediction of the height of marker i when it is moved by d (plus or
+ * minus one) positions. Used whenever the parabolic prediction would violate
+ * the ordering of marker heights.
+ */
+inline real
+P2QuantileEstimator::linear(
+        const int i, 
+        const int d) const
+{
+    return height_[i] + d*(height_[i + d] - height_[i])/(pos_[i + d] - pos_[i]);
+}
+
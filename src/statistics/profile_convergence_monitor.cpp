@@ -0,0 +1,224 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "statistics/profile_convergence_monitor.hpp"
+
+
+/*!
+ * Constructs an empty monitor that never declares convergence.
+ */
+ProfileConvergenceMonitor::ProfileConvergenceMonitor()
+    : tolerance_(0.0)
+    , checkInterval_(0)
+    , num_(0)
+    , converged_(false)
+    , maxMeanChange_(std::numeric_limits<real>::max())
+    , maxStandardError_(std::numeric_limits<real>::max())
+{
+
+}
+
+
+/*!
+ * Constructs a monitor for profiles with the given number of support points,
+ * which checks for convergence every checkInterval profiles.
+ */
+ProfileConvergenceMonitor::ProfileConvergenceMonitor(
+        const size_t numPoints,
+        const real tolerance,
+        const int checkInterval)
+    : tolerance_(tolerance)
+    , checkInterval_(checkInterval)
+    , num_(0)
+    , converged_(false)
+    , maxMeanChange_(std::numeric_limits<real>::max())
+    , maxStandardError_(std::numeric_limits<real>::max())
+    , summary_(numPoints)
+    , blockAvg_(numPoints)
+{
+    // sanity checks:
+    if( tolerance <= 0.0 )
+    {
+        throw std::logic_error("Convergence tolerance must be positive.");
+    }
+    if( checkInterval < 1 )
+    {
+        throw std::logic_error("Convergence check interval must be "
+                               "positive.");
+    }
+}
+
+
+/*!
+ * Adds a new profile and checks for convergence if the number of profiles 
+ * seen so far is a multiple of the check interval. Returns true if the 
+ * profile has converged.
+ */
+bool
+ProfileConvergenceMonitor::update(
+        const std::vector<real> &profile)
+{
+    // nothing to do if this monitor is inactive or already converged:
+    if( checkInterval_ < 1 || converged_ )
+    {
+        return converged_;
+    }
+
+    // treat capped infinities as infinite so that they are skipped:
+    std::vector<real> values(profile);
+    for(auto &v : values)
+    {
+        if( std::abs(v) >= std::numeric_limits<real>::max() )
+        {
+            v = std::numeric_limits<real>::infinity();
+        }
+    }
+
+    // update accumulators:
+    summary_.update(values);
+    BlockAverageStatistics::updateMultiple(blockAvg_, values);
+    num_++;
+
+    // check convergence at regular intervals:
+    if( num_ % checkInterval_ == 0 )
+    {
+        check();
+    }
+
+    return converged_;
+}
+
+
+/*!
+ * Returns true if the profile has converged.
+ */
+bool
+ProfileConvergenceMonitor::converged() const
+{
+    return converged_;
+}
+
+
+/*!
+ * Returns the number of profiles seen so far.
+ */
+int
+ProfileConvergenceMonitor::num() const
+{
+    return num_;
+}
+
+
+/*!
+ * Returns the number of profiles between convergence checks.
+ */
+int
+ProfileConvergenceMonitor::checkInterval() const
+{
+    return checkInterval_;
+}
+
+
+/*!
+ * Returns the convergence tolerance.
+ */
+real
+ProfileConvergenceMonitor::tolerance() const
+{
+    return tolerance_;
+}
+
+
+/*!
+ * Returns the largest change of the running mean over all support points 
+ * observed at the most recent check.
+ */
+real
+ProfileConvergenceMonitor::maxMeanChange() const
+{
+    return maxMeanChange_;
+}
+
+
+/*!
+ * Returns the largest standard error of the running mean over all support 
+ * points observed at the most recent check.
+ */
+real
+ProfileConvergenceMonitor::maxStandardError() const
+{
+    return maxStandardError_;
+}
+
+
+/*!
+ * Compares the current running mean to that of the previous check and 
+ * evaluates the convergence criterion. The first check only records the 
+ * running mean.
+ */
+void
+ProfileConvergenceMonitor::check()
+{
+    // current running mean:
+    std::vector<real> mean = summary_.mean();
+
+    // first check only establishes reference:
+    if( prevMean_.empty() )
+    {
+        prevMean_ = mean;
+        return;
+    }
+
+    // find largest change in mean and largest standard error:
+    maxMeanChange_ = 0.0;
+    maxStandardError_ = 0.0;
+    for(size_t i = 0; i < mean.size(); i++)
+    {
+        // ignore support points with insufficient data:
+        if( summary_.num(i) < 2 )
+        {
+            continue;
+        }
+
+        maxMeanChange_ = std::max(
+                maxMeanChange_, 
+                std::abs(mean[i] - prevMean_[i]));
+        maxStandardError_ = std::max(
+                maxStandardError_, 
+                blockAvg_[i].standardError());
+    }
+
+    // evaluate convergence criterion:
+    converged_ = (maxMeanChange_ < tolerance_) && 
+                 (maxStandardError_ < tolerance_);
+
+    // update reference:
+    prevMean_ = mean;
+}
+
@@ -0,0 +1,143 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <stdexcept>
+
+#include "statistics/profile_quantile_statistics.hpp"
+
+
+/*!
+ * Constructs an empty profile without support points or quantiles.
+ */
+ProfileQuantileStatistics::ProfileQuantileStatistics()
+    : numPoints_(0)
+{
+
+}
+
+
+/*!
+ * Constructs quantile estimators for the given probabilities at each of 
+ * numPoints support points.
+ */
+ProfileQuantileStatistics::ProfileQuantileStatistics(
+        const size_t numPoints,
+        const std::vector<real> &probs)
+    : probs_(probs)
+    , numPoints_(numPoints)
+{
+    estimators_.reserve(numPoints*probs.size());
+    for(auto p : probs_)
+    {
+        estimators_.insert(
+                estimators_.end(), 
+                numPoints, 
+                P2QuantileEstimator(p));
+    }
+}
+
+
+/*!
+ * Updates the quantile estimates at all support points with the given 
+ * profile, which must have one element per support point.
+ */
+void
+ProfileQuantileStatistics::update(
+        const std::vector<real> &newValues)
+{
+    // sanity check:
+    if( newValues.size() != numPoints_ )
+    {
+        throw std::logic_error("Can not update profile quantile statistics "
+                               "with data vector of different size.");
+    }
+
+    // update estimators for each quantile:
+    for(size_t j = 0; j < probs_.size(); j++)
+    {
+        P2QuantileEstimator *est = estimators_.data() + j*numPoints_;
+        for(size_t i = 0; i < numPoints_; i++)
+        {
+            est[i].update(newValues[i]);
+        }
+    }
+}
+
+
+/*!
+ * Shifts all quantile estimates by the given amount. 
+ */
+void
+ProfileQuantileStatistics::shift(
+        const real shift)
+{
+    for(auto &est : estimators_)
+    {
+        est.shift(shift);
+    }
+}
+
+
+/*!
+ * Returns the number of support points.
+ */
+size_t
+ProfileQuantileStatistics::size() const
+{
+    return numPoints_;
+}
+
+
+/*!
+ * Returns the probabilities of all estimated quantiles.
+ */
+std::vector<real>
+ProfileQuantileStatistics::probs() const
+{
+    return probs_;
+}
+
+
+/*!
+ * Returns the profile of the quantile with the given index into probs().
+ */
+std::vector<real>
+ProfileQuantileStatistics::quantile(
+        const size_t probIdx) const
+{
+    // sanity check:
+    if( probIdx >= probs_.size() )
+    {
+        throw std::out_of_range("Quantile index out of range.");
+    }
+
+    // extract estimates for this quantile:
+    std::vector<real> res(numPoints_);
+    for(size_t i = 0; i < numPoints_; i++)
+    {
+        res[i] = estimators_[probIdx*numPoints_ + i].quantile();
+    }
+    return res;
+}
+
@@ -0,0 +1,341 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "statistics/profile_summary_statistics.hpp"
+
+
+/*!
+ * Constructs an empty profile with no support points.
+ */
+ProfileSummaryStatistics::ProfileSummaryStatistics()
+{
+
+}
+
+
+/*!
+ * Constructs a profile with the given number of support points. All 
+ * statistics are initialised in the same way as in the SummaryStatistics
+ * default constructor.
+ */
+ProfileSummaryStatistics::ProfileSummaryStatistics(
+        const size_t numPoints)
+    : min_(numPoints, std::numeric_limits<real>::max())
+    , max_(numPoints, -std::numeric_limits<real>::max())
+    , mean_(numPoints, 0.0)
+    , sumSquaredMeanDiff_(numPoints, 0.0)
+    , num_(numPoints, 0)
+{
+
+}
+
+
+/*!
+ * Constructs a profile from the summary statistics at each support point, 
+ * i.e. this is the inverse of calling at() for each support point. Support 
+ * points without samples are initialised as in the other constructors, so 
+ * that the profile can subsequently be updated or merged.
+ */
+ProfileSummaryStatistics::ProfileSummaryStatistics(
+        const std::vector<SummaryStatistics> &stats)
+    : ProfileSummaryStatistics(stats.size())
+{
+    for(size_t i = 0; i < stats.size(); i++)
+    {
+        if( stats[i].num() > 0 )
+        {
+            min_[i] = stats[i].min();
+            max_[i] = stats[i].max();
+            mean_[i] = stats[i].mean();
+            sumSquaredMeanDiff_[i] = stats[i].sumSquaredMeanDiff();
+            num_[i] = stats[i].num();
+        }
+    }
+}
+
+
+/*!
+ * Updates the statistics at each support point with the corresponding element
+ * of the given profile. This is equivalent to calling 
+ * SummaryStatistics::update() for each support point, but operates directly 
+ * on the underlying arrays. Infinite values are skipped without branching out
+ * of the loop body by substituting the current mean, which leaves all 
+ * statistics at that support point unchanged.
+ */
+void
+ProfileSummaryStatistics::update(
+        const std::vector<real> &newValues)
+{
+    // sanity check:
+    if( newValues.size() != num_.size() )
+    {
+        throw std::logic_error("Can not update profile summary statistics "
+                               "with data vector of different size.");
+    }
+
+    // raw pointers to contiguous storage:
+    const real *x = newValues.data();
+    real *min = min_.data();
+    real *max = max_.data();
+    real *mean = mean_.data();
+    real *ssmd = sumSquaredMeanDiff_.data();
+    int *num = num_.data();
+
+    // update all support points in a single pass:
+    const size_t n = num_.size();
+    for(size_t i = 0; i < n; i++)
+    {
+        // infinite values do not contribute:
+        const bool isFinite = !std::isinf(x[i]);
+        const real val = isFinite ? x[i] : mean[i];
+        num[i] += isFinite;
+
+        // updating min and max is trivial:
+        max[i] = (isFinite && val > max[i]) ? val : max[i];
+        min[i] = (isFinite && val < min[i]) ? val : min[i];
+
+        // Welford update of mean and squared difference from mean:
+        const real delta = val - mean[i];
+        mean[i] += isFinite ? delta/num[i] : 0.0;
+        ssmd[i] += delta*(val - mean[i]);
+    }
+}
+
+
+/*!
+ * Merges the statistics of another profile into this one, where each support
+ * point is combined as in SummaryStatistics::merge(). Both profiles must have
+ * the same number of support points.
+ */
+void
+ProfileSummaryStatistics::merge(
+        const ProfileSummaryStatistics &other)
+{
+    // sanity check:
+    if( other.size() != size() )
+    {
+        throw std::logic_error("Can not merge profile summary statistics "
+                               "with different numbers of support points.");
+    }
+
+    // combine each support point:
+    for(size_t i = 0; i < num_.size(); i++)
+    {
+        // nothing to do if other profile has no data here:
+        if( other.num_[i] == 0 )
+        {
+            continue;
+        }
+
+        // combine minimum and maximum:
+        if( other.min_[i] < min_[i] )
+        {
+            min_[i] = other.min_[i];
+        }
+        if( other.max_[i] > max_[i] )
+        {
+            max_[i] = other.max_[i];
+        }
+
+        // pairwise combination of mean and squared difference from mean:
+        real numA = num_[i];
+        real numB = other.num_[i];
+        real numAB = numA + numB;
+        real delta = other.mean_[i] - mean_[i];
+        mean_[i] += delta*numB/numAB;
+        sumSquaredMeanDiff_[i] += other.sumSquaredMeanDiff_[i] +
+                                  delta*delta*numA*numB/numAB;
+        num_[i] += other.num_[i];
+    }
+}
+
+
+/*!
+ * Shifts minimum, maximum, and mean at all support points by the given 
+ * amount. As with SummaryStatistics::shift(), update() should no longer be 
+ * called after the profile has been shifted.
+ */
+void
+ProfileSummaryStatistics::shift(
+        const real shift)
+{
+    for(size_t i = 0; i < num_.size(); i++)
+    {
+        min_[i] += shift;
+        max_[i] += shift;
+        mean_[i] += shift;
+    }
+}
+
+
+/*!
+ * Returns the number of support points in the profile.
+ */
+size_t
+ProfileSummaryStatistics::size() const
+{
+    return num_.size();
+}
+
+
+/*!
+ * Returns the summary statistics at the given support point as a 
+ * SummaryStatistics object.
+ */
+SummaryStatistics
+ProfileSummaryStatistics::at(
+        const size_t idx) const
+{
+    return SummaryStatistics(
+            min_.at(idx),
+            max_.at(idx),
+            mean_.at(idx),
+            sumSquaredMeanDiff_.at(idx),
+            num_.at(idx));
+}
+
+
+/*!
+ * Returns the minimum at the given support point.
+ */
+real
+ProfileSummaryStatistics::min(const size_t idx) const
+{
+    return at(idx).min();
+}
+
+
+/*!
+ * Returns the maximum at the given support point.
+ */
+real
+ProfileSummaryStatistics::max(const size_t idx) const
+{
+    return at(idx).max();
+}
+
+
+/*!
+ * Returns the mean at the given support point.
+ */
+real
+ProfileSummaryStatistics::mean(const size_t idx) const
+{
+    return at(idx).mean();
+}
+
+
+/*!
+ * Returns the variance at the given support point.
+ */
+real
+ProfileSummaryStatistics::var(const size_t idx) const
+{
+    return at(idx).var();
+}
+
+
+/*!
+ * Returns the standard deviation at the given support point.
+ */
+real
+ProfileSummaryStatistics::sd(const size_t idx) const
+{
+    return at(idx).sd();
+}
+
+
+/*!
+ * Returns the number of samples at the given support point.
+ */
+int
+ProfileSummaryStatistics::num(const size_t idx) const
+{
+    return num_.at(idx);
+}
+
+
+/*!
+ * Returns the minimum at all support points.
+ */
+std::vector<real>
+ProfileSummaryStatistics::min() const
+{
+    std::vector<real> res(size());
+    for(size_t i = 0; i < size(); i++)
+    {
+        res[i] = min(i);
+    }
+    return res;
+}
+
+
+/*!
+ * Returns the maximum at all support points.
+ */
+std::vector<real>
+ProfileSummaryStatistics::max() const
+{
+    std::vector<real> res(size());
+    for(size_t i = 0; i < size(); i++)
+    {
+        res[i] = max(i);
+    }
+    return res;
+}
+
+
+/*!
+ * Returns the mean at all support points.
+ */
+std::vector<real>
+ProfileSummaryStatistics::mean() const
+{
+    std::vector<real> res(size());
+    for(size_t i = 0; i < size(); i++)
+    {
+        res[i] = mean(i);
+    }
+    return res;
+}
+
+
+/*!
+ * Returns the standard deviation at all support points.
+ */
+std::vector<real>
+ProfileSummaryStatistics::sd() const
+{
+    std::vector<real> res(size());
+    for(size_t i = 0; i < size(); i++)
+    {
+        res[i] = sd(i);
+    }
+    return res;
+}
+
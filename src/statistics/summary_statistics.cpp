@@ -46,6 +46,34 @@ SummaryStatistics::SummaryStatistics()
 }
 
 
+/*!
+ * Constructs a SummaryStatistics object directly from its internal state, 
+ * i.e. the minimum, maximum, mean, sum of squared differences from the mean,
+ * and number of samples. This is useful for reconstructing statistics that 
+ * have been accumulated elsewhere (e.g. by ProfileSummaryStatistics) and for
+ * combining them with merge().
+ */
+SummaryStatistics::SummaryStatistics(
+        const real min,
+        const real max,
+        const real mean,
+        const real sumSquaredMeanDiff,
+        const int num)
+    : min_(min)
+    , max_(max)
+    , mean_(mean)
+    , sumSquaredMeanDiff_(sumSquaredMeanDiff)
+    , num_(num)
+{
+    // sanity check:
+    if( num_ < 0 )
+    {
+        throw std::logic_error("Number of samples in summary statistics may "
+                               "not be negative.");
+    }
+}
+
+
 /*!
  * This method will update all summary statistics with the given new value and
  * also increment the sample counter.
@@ -105,6 +133,63 @@ SummaryStatistics::updateMultiple(
 }
 
 
+/*!
+ * Combines the summary statistics of another object with this one, so that
+ * afterwards this object describes the union of both datasets. Minimum and
+ * maximum are combined trivially, while mean and sum of squared differences
+ * from the mean are combined using the pairwise algorithm of Chan, Golub, and
+ * LeVeque (1979):
+ *
+ * \f[
+ *      \delta = \bar{x}_B - \bar{x}_A, \quad
+ *      \bar{x} = \bar{x}_A + \delta \frac{n_B}{n_A + n_B}, \quad
+ *      M_2 = M_{2,A} + M_{2,B} + \delta^2 \frac{n_A n_B}{n_A + n_B}
+ * \f]
+ *
+ * This is exact up to floating point rounding, i.e. merging two objects 
+ * gives the same result as calling update() on a single object with all data.
+ */
+void
+SummaryStatistics::merge(
+        const SummaryStatistics &other)
+{
+    // nothing to do if other object is empty:
+    if( other.num_ == 0 )
+    {
+        return;
+    }
+
+    // if this object is empty, simply take over other state:
+    if( num_ == 0 )
+    {
+        *this = other;
+        return;
+    }
+
+    // combine minimum and maximum:
+    if( other.min_ < min_ )
+    {
+        min_ = other.min_;
+    }
+    if( other.max_ > max_ )
+    {
+        max_ = other.max_;
+    }
+
+    // combine mean and squared difference from mean:
+    real numA = num_;
+    real numB = other.num_;
+    real numAB = numA + numB;
+    real delta = other.mean_ - mean_;
+    mean_ += delta*numB/numAB;
+    sumSquaredMeanDiff_ += other.sumSquaredMeanDiff_ + 
+                           delta*delta*numA*numB/numAB;
+
+    // update number of samples:
+    num_ += other.num_;
+}
+
+
 /*!
  * Shifts the value of minimum, maximum, and mean by the given amount. Standard
  * deviation, variance, and number of samples are unaffected. This is useful if
@@ -212,6 +297,19 @@ SummaryStatistics::num() const
 }
 
 
+/*!
+ * Getter method for obtaining the sum of squared differences from the mean.
+ * Together with mean() and num() this fully describes the state of the 
+ * variance accumulator and is needed to serialise statistics that are to be
+ * merged later.
+ */
+real
+SummaryStatistics::sumSquaredMeanDiff() const
+{
+    return sumSquaredMeanDiff_;
+}
+
+
 /*!
  * Convenience function for converting sum of squared differences from mean to
  * variance. This is written as a separate function to be used with both the
@@ -23,6 +23,7 @@
 
 
 #include <limits>
+#include <stdexcept>
 
 #include "geometry/linear_spline_interp_1D.hpp"
 #include "statistics/weighted_kernel_density_estimator.hpp"
@@ -0,0 +1,126 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include "trajectory-analysis/abstract_frame_analysis_stage.hpp"
+
+
+/*!
+ * Constructor. Inputs and outputs are given as bitwise or of eFrameData 
+ * flags. Stages are enabled by default.
+ */
+AbstractFrameAnalysisStage::AbstractFrameAnalysisStage(
+        std::string name,
+        unsigned int inputs,
+        unsigned int outputs)
+    : name_(name)
+    , inputs_(inputs)
+    , outputs_(outputs)
+    , enabled_(true)
+{
+
+}
+
+
+/*!
+ * Returns the name by which the stage is identified in the pipeline.
+ */
+std::string
+AbstractFrameAnalysisStage::name() const
+{
+    return name_;
+}
+
+
+/*!
+ * Returns the data this stage reads from the context.
+ */
+unsigned int
+AbstractFrameAnalysisStage::inputs() const
+{
+    return inputs_;
+}
+
+
+/*!
+ * Returns the data this stage writes to the context.
+ */
+unsigned int
+AbstractFrameAnalysisStage::outputs() const
+{
+    return outputs_;
+}
+
+
+/*!
+ * Enables or disables the stage. Disabled stages call skip() instead of 
+ * evaluate().
+ */
+void
+AbstractFrameAnalysisStage::setEnabled(bool enabled)
+{
+    enabled_ = enabled;
+}
+
+
+/*!
+ * Returns true if the stage is enabled.
+ */
+bool
+AbstractFrameAnalysisStage::isEnabled() const
+{
+    return enabled_;
+}
+
+
+/*!
+ * Default prepare hook, does nothing.
+ */
+void
+AbstractFrameAnalysisStage::prepare(FrameAnalysisContext& /*ctx*/)
+{
+
+}
+
+
+/*!
+ * Default skip hook, leaves outputs at their default values.
+ */
+void
+AbstractFrameAnalysisStage::skip(FrameAnalysisContext& /*ctx*/)
+{
+
+}
+
+
+/*!
+ * Default write hook, does nothing.
+ */
+void
+AbstractFrameAnalysisStage::write(FrameAnalysisContext& /*ctx*/)
+{
+
+}
+
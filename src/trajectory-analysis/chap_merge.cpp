@@ -0,0 +1,364 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include <gromacs/options/basicoptions.h>
+
+#include "trajectory-analysis/chap_merge.hpp"
+
+#include "aggregation/frame_aggregate.hpp"
+#include "analysis-setup/residue_information_provider.hpp"
+#include "io/colour.hpp"
+#include "io/json_doc_importer.hpp"
+#include "io/molecular_path_obj_exporter.hpp"
+#include "io/pdb_io.hpp"
+#include "io/results_json_stream_writer.hpp"
+
+using namespace gmx;
+
+
+/*
+ * Auxiliary function that checks that all given members are present in a 
+ * shard file.
+ */
+static void
+checkShardMembers(
+        const rapidjson::Value &json,
+        const std::vector<const char*> &members,
+        const std::string &fileName)
+{
+    for(auto member : members)
+    {
+        if( !json.IsObject() || !json.HasMember(member) )
+        {
+            throw std::runtime_error("ERROR: Shard file " + fileName + 
+                                     " has no member " + member + ".");
+        }
+    }
+}
+
+
+/*!
+ * Factory method creating a new merge module.
+ */
+ICommandLineOptionsModulePointer
+ChapMerge::create()
+{
+    return ICommandLineOptionsModulePointer(new ChapMerge());
+}
+
+
+/*!
+ * No special settings are required.
+ */
+void
+ChapMerge::init(CommandLineModuleSettings * /*settings*/)
+{
+
+}
+
+
+/*!
+ * Sets up the command line options.
+ */
+void
+ChapMerge::initOptions(
+        IOptionsContainer *options,
+        ICommandLineOptionsModuleSettings *settings)
+{
+    static const char *const desc[] = {
+        "[THISMODULE] combines shard files written by CHAP runs with",
+        "-out-shard into the JSON, PDB, and OBJ output of a single run over",
+        "the whole trajectory. Each shard typically results from a run over",
+        "one time window of the trajectory (set with -b and -e). Time",
+        "windows must not overlap and all shards must have been created",
+        "with identical output parameters, in particular",
+        "-out-profile-range.[PAR]",
+        "The structure written to the PDB file is read from the PDB file",
+        "written alongside the first shard, unless a different structure",
+        "file is given with -pdb."
+    };
+    settings -> setHelpText(desc);
+
+    options -> addOption(StringOption("f")
+                         .storeVector(&shardFileNames_)
+                         .multiValue()
+                         .required()
+                         .description("Shard files to merge."));
+
+    options -> addOption(StringOption("out-filename")
+                         .store(&outputBaseFileName_)
+                         .defaultValue("output")
+                         .description("File name for output files without "
+                                      "file extension."));
+
+    options -> addOption(StringOption("pdb")
+                         .store(&pdbFileName_)
+                         .storeIsSet(&pdbFileNameIsSet_)
+                         .description("Structure file to which time-averaged "
+                                      "pore-lining and pore-facing "
+                                      "attributes are assigned."));
+}
+
+
+/*!
+ * Checks that shard files were given.
+ */
+void
+ChapMerge::optionsFinished()
+{
+    if( shardFileNames_.empty() )
+    {
+        throw std::runtime_error("ERROR: No shard files given.");
+    }
+}
+
+
+/*!
+ * Converts the name of a file written next to a shard file into the form 
+ * stored in the shard file, i.e. strips the directory. Absolute paths are
+ * kept as they are.
+ */
+std::string
+ChapMerge::shardRelativePath(
+        const std::string &path)
+{
+    if( path.empty() || path.front() == '/' )
+    {
+        return path;
+    }
+    size_t pos = path.find_last_of('/');
+    if( pos == std::string::npos )
+    {
+        return path;
+    }
+    return path.substr(pos + 1);
+}
+
+
+/*!
+ * Resolves a file name stored in a shard file relative to the directory 
+ * containing the shard file. Absolute paths are returned unchanged.
+ */
+std::string
+ChapMerge::resolveShardPath(
+        const std::string &shardFileName, 
+        const std::string &path)
+{
+    if( path.empty() || path.front() == '/' )
+    {
+        return path;
+    }
+    size_t pos = shardFileName.find_last_of('/');
+    if( pos == std::string::npos )
+    {
+        return path;
+    }
+    return shardFileName.substr(0, pos + 1) + path;
+}
+
+
+/*!
+ * Reads all shard files, merges their aggregates in time order, and writes
+ * the output files.
+ */
+int
+ChapMerge::run()
+{
+    // READ SHARD FILES
+    // ------------------------------------------------------------------------
+
+    JsonDocImporter jdi;
+    std::vector<FrameAggregate> aggregates;
+    rapidjson::Document firstShard;
+    rapidjson::Document residues;
+    for(auto &fileName : shardFileNames_)
+    {
+        std::cout<<"Reading shard file "<<fileName<<std::endl;
+        rapidjson::Document shard = jdi(fileName);
+        checkShardMembers(
+                shard, 
+                {"settings", "residues", "pdbFile", "aggregate"}, 
+                fileName);
+        aggregates.push_back(FrameAggregate::fromJson(shard["aggregate"]));
+
+        // settings are taken from first shard and must agree for all others:
+        if( firstShard.IsNull() )
+        {
+            firstShard.CopyFrom(shard, firstShard.GetAllocator());
+            if( !pdbFileNameIsSet_ )
+            {
+                pdbFileName_ = resolveShardPath(
+                        fileName, 
+                        shard["pdbFile"].GetString());
+            }
+        }
+        else if( shard["settings"] != firstShard["settings"] )
+        {
+            throw std::runtime_error("ERROR: Output settings in shard file " + 
+                                     fileName + " differ from those in "
+                                     "shard file " + shardFileNames_.front() +
+                                     ".");
+        }
+
+        // residue information is only available for shards with frames:
+        if( aggregates.back().numFrames() == 0 )
+        {
+            continue;
+        }
+        if( residues.IsNull() )
+        {
+            residues.CopyFrom(shard["residues"], residues.GetAllocator());
+        }
+        else if( shard["residues"] != residues )
+        {
+            throw std::runtime_error("ERROR: Pore forming residues in shard "
+                                     "file " + fileName + " differ from "
+                                     "those in previous shard files.");
+        }
+    }
+    const rapidjson::Value &settings = firstShard["settings"];
+    checkShardMembers(
+            settings,
+            {"extrapDist", "gridSampleDist", "correctionThreshold", 
+             "objPrecision", "meshFormat", "tsFormat"},
+            shardFileNames_.front());
+
+
+    // MERGE AGGREGATES IN TIME ORDER
+    // ------------------------------------------------------------------------
+
+    // empty shards sort first and are ignored by merge:
+    std::sort(
+            aggregates.begin(), 
+            aggregates.end(), 
+            [](const FrameAggregate &a, const FrameAggregate &b)
+            {
+                if( a.numFrames() == 0 || b.numFrames() == 0 )
+                {
+                    return a.numFrames() < b.numFrames();
+                }
+                return a.timeStamps().front() < b.timeStamps().front();
+            });
+
+    FrameAggregate merged(
+            aggregates.front().supportPoints(), 
+            0.0, 
+            0.0);
+    real lastTimeStamp = -std::numeric_limits<real>::max();
+    for(auto &aggregate : aggregates)
+    {
+        if( aggregate.numFrames() == 0 )
+        {
+            continue;
+        }
+        if( aggregate.timeStamps().front() <= lastTimeStamp )
+        {
+            throw std::runtime_error("ERROR: Time windows of shards "
+                                     "overlap.");
+        }
+        lastTimeStamp = aggregate.timeStamps().back();
+
+        // first non-empty shard defines support and anchor points:
+        if( merged.numFrames() == 0 )
+        {
+            merged = aggregate;
+        }
+        else
+        {
+            merged.merge(aggregate);
+        }
+    }
+    if( merged.numFrames() == 0 )
+    {
+        throw std::runtime_error("ERROR: Shard files contain no frames.");
+    }
+    std::cout<<"Merged "<<merged.numFrames()<<" frames from "
+             <<aggregates.size()<<" shards."<<std::endl;
+
+    // residue information for pore forming residues:
+    ResidueInformationProvider resInfo;
+    for(auto &residue : residues.GetArray())
+    {
+        int id = residue["id"].GetInt();
+        std::string name = residue["name"].GetString();
+        resInfo.setName(id, name);
+        resInfo.setChain(id, residue["chain"].GetString());
+        resInfo.setHydrophobicity(name, residue["hydrophobicity"].GetDouble());
+    }
+
+
+    // CREATE PDB OUTPUT
+    // ------------------------------------------------------------------------
+
+    PdbStructure structure;
+    structure.fromFile(pdbFileName_);
+    structure.setPoreFacing(
+            merged.residuePoreLining(), 
+            merged.residuePoreFacing());
+    PdbIo::write(outputBaseFileName_ + ".pdb", structure);
+
+
+    // CREATE OUTPUT JSON
+    // ------------------------------------------------------------------------
+
+    ResultsJsonStreamWriter results;
+    results.open(
+            outputBaseFileName_ + ".json", 
+            static_cast<eTimeSeriesFormat>(settings["tsFormat"].GetInt()));
+    merged.writeResults(results, resInfo);
+    results.close();
+
+
+    // EXPORT PATHWAY TO OBJ FILE
+    // ------------------------------------------------------------------------
+
+    // pathway of first frame with averaged properties:
+    MolecularPath molPathAvg = merged.averagePath();
+
+    // load colour palettes from built-in JSON data:
+    auto palettes = ColourPaletteProvider::fromJsonDoc(
+            jdi.fromBuiltin("palettes/default.json"));
+
+    // export pathway to file:
+    MolecularPathObjExporter mpexp;
+    mpexp.setExtrapDist(settings["extrapDist"].GetDouble());
+    mpexp.setGridSampleDist(settings["gridSampleDist"].GetDouble());
+    mpexp.setCorrectionThreshold(settings["correctionThreshold"].GetDouble());
+    mpexp.setPrecision(settings["objPrecision"].GetInt());
+    mpexp.setMeshFormat(
+            static_cast<eMeshFormat>(settings["meshFormat"].GetInt()));
+    mpexp(
+        outputBaseFileName_, 
+        "time_averaged_molecular_path", 
+        molPathAvg,
+        palettes);
+
+    return 0;
+}
+
@@ -23,45 +23,43 @@
 
 
 #include <algorithm>
+#include <fstream>
+#include <future>
+#include <limits>
 #include <string>
+#include <thread>
 
+#include <gromacs/fileio/timecontrol.h>
 #include <gromacs/random/threefry.h>
 #include <gromacs/utility/fatalerror.h>
 
 #include "trajectory-analysis/chap_trajectory_analysis.hpp"
 
-#include "aggregation/boltzmann_energy_calculator.hpp"
-#include "aggregation/number_density_calculator.hpp"
-
 #include "config/config.hpp"
 #include "config/dependencies.hpp"
 #include "config/version.hpp"
 
-#include "geometry/cubic_spline_interp_1D.hpp"
 #include "geometry/cubic_spline_interp_3D.hpp"
-#include "geometry/linear_spline_interp_1D.hpp"
 #include "geometry/spline_curve_1D.hpp"
 #include "geometry/spline_curve_3D.hpp"
 
 #include "io/analysis_data_json_frame_exporter.hpp"
+#include "io/frame_stream_reader.hpp"
 #include "io/json_doc_importer.hpp"
 #include "io/molecular_path_obj_exporter.hpp"
-#include "io/results_json_exporter.hpp"
-#include "io/spline_curve_1D_json_converter.hpp"
+#include "io/results_json_stream_writer.hpp"
 #include "io/summary_statistics_json_converter.hpp"
 #include "io/summary_statistics_vector_json_converter.hpp"
+#include "io/xtc_reader.hpp"
 
-#include "statistics/amise_optimal_bandwidth_estimator.hpp"
-#include "statistics/histogram_density_estimator.hpp"
-#include "statistics/kernel_density_estimator.hpp"
-#include "statistics/summary_statistics.hpp"
-#include "statistics/weighted_kernel_density_estimator.hpp"
+#include "external/rapidjson/stringbuffer.h"
+#include "external/rapidjson/writer.h"
 
-#include "path-finding/inplane_optimised_probe_path_finder.hpp"
 #include "path-finding/optimised_direction_probe_path_finder.hpp"
-#include "path-finding/naive_cylindrical_path_finder.hpp"
 #include "path-finding/vdw_radius_provider.hpp"
 
+#include "trajectory-analysis/chap_merge.hpp"
+
 using namespace gmx;
 
 
@@ -69,7 +67,12 @@ using namespace gmx;
  * Constructor for the ChapTrajectoryAnalysis class.
  */
 ChapTrajectoryAnalysis::ChapTrajectoryAnalysis()
-    : pfProbeRadius_(0.0)
+    : readTrajectoryDirectly_(false)
+    , beginTime_(std::numeric_limits<real>::lowest())
+    , endTime_(std::numeric_limits<real>::max())
+    , endTimeIsSet_(false)
+    , deltaTime_(0.0)
+    , pfProbeRadius_(0.0)
     , pfMaxProbeSteps_(1e3)
     , pfInitProbePos_(3)
     , pfChanDirVec_(3)
@@ -78,6 +81,9 @@ ChapTrajectoryAnalysis::ChapTrajectoryAnalysis()
     , saInitTemp_(10.0)
     , saCoolingFactor_(0.99)
     , saStepLengthFactor_(0.01)
+    , numSweepSets_(0)
+    , convergedFrame_(-1)
+    , convergedTime_(0.0)
 {
     // register data containers:
     registerAnalysisDataset(&frameStreamData_, "frameStreamData");
@@ -165,6 +171,33 @@ ChapTrajectoryAnalysis::initOptions(
                                       "pathway endpoints for both JSON and "
                                       "OBJ output."));
 
+    options -> addOption(RealOption("out-profile-range")
+                         .storeVector(&outputProfileRange_)
+                         .storeIsSet(&outputProfileRangeIsSet_)
+                         .valueCount(2)
+                         .description("Lower and upper arc length of the "
+                                      "pathway section on which profiles are "
+                                      "sampled (before extrapolation with "
+                                      "-out-extrap-dist). The energy profile "
+                                      "is zero on average at these points. "
+                                      "If not set, the range spanned by all "
+                                      "pathways in the trajectory is used, "
+                                      "which requires an additional pass "
+                                      "over the stream file."));
+
+    options -> addOption(BooleanOption("out-shard")
+                         .store(&outputShard_)
+                         .defaultValue(false)
+                         .description("If true, CHAP writes mergeable "
+                                      "partial results to a shard file "
+                                      "instead of the JSON and OBJ output. "
+                                      "Shards from runs over different time "
+                                      "windows of a trajectory (set with -b "
+                                      "and -e) can be combined with 'chap "
+                                      "merge'. Requires -out-profile-range "
+                                      "to be set to the same value in all "
+                                      "runs."));
+
     options -> addOption(RealOption("out-grid-dist")
                          .store(&outputGridSampleDist_)
                          .defaultValue(0.15)
@@ -185,6 +218,38 @@ ChapTrajectoryAnalysis::initOptions(
                                       "Negative values may result in "
                                       "visualisation artifacts."));
 
+    options -> addOption(IntegerOption("out-obj-precision")
+                         .store(&outputObjPrecision_)
+                         .defaultValue(6)
+                         .description("Maximum number of decimal places of "
+                                      "vertex coordinates written to the OBJ "
+                                      "output."));
+
+    const char * const allowedMeshFormat[] = {"obj",
+                                              "ply",
+                                              "glb"};
+    outputMeshFormat_ = eMeshFormatObj;
+    options -> addOption(EnumOption<eMeshFormat>("out-mesh-format")
+                         .enumValue(allowedMeshFormat)
+                         .store(&outputMeshFormat_)
+                         .description("Format of the pathway surface output. "
+                                      "The binary ply and glb (glTF) formats "
+                                      "store each vertex once and attach all "
+                                      "scalar properties as per-vertex "
+                                      "attributes instead of writing an OBJ "
+                                      "and MTL file."));
+
+    options -> addOption(IntegerOption("out-mesh-stride")
+                         .store(&outputMeshStride_)
+                         .defaultValue(0)
+                         .description("If positive, the pore surface of "
+                                      "every n-th frame is written to a "
+                                      "binary glTF file with shared face "
+                                      "connectivity, which can be played "
+                                      "back as an animation. Properties are "
+                                      "the instantaneous radius and solvent "
+                                      "number density."));
+
     options -> addOption(BooleanOption("out-detailed")
                          .store(&outputDetailed_)
                          .defaultValue(false)
@@ -194,6 +259,70 @@ ChapTrajectoryAnalysis::initOptions(
                                       "probe positions and spline parameters. "
                                       "This is mostly useful for debugging."));
 
+    options -> addOption(StringOption("in-stream")
+                         .store(&inputStreamFileName_)
+                         .storeIsSet(&inputStreamFileNameIsSet_)
+                         .description("Per-frame stream file kept from a "
+                                      "previous run with -out-detailed. If "
+                                      "given, no path finding is done and "
+                                      "all output is regenerated from this "
+                                      "file with the current output "
+                                      "parameters. If any density "
+                                      "estimation parameter is set, the "
+                                      "solvent density is re-estimated from "
+                                      "the stored solvent positions."));
+
+    options -> addOption(StringOption("replicas")
+                         .storeVector(&replicaFileNames_)
+                         .multiValue()
+                         .description("Trajectories of further replicas of "
+                                      "the simulation given with -f, which "
+                                      "must share its topology. All "
+                                      "replicas are analysed in parallel "
+                                      "and results are written for each "
+                                      "replica as well as for the ensemble "
+                                      "of all replicas, including the "
+                                      "variance of the profiles between "
+                                      "replicas. Replicas in XTC format "
+                                      "are read selectively, only decoding "
+                                      "frames in the time range and atoms "
+                                      "used by the selections. The same "
+                                      "applies to an XTC trajectory given "
+                                      "with -f if all selections are "
+                                      "static and solvent is not mapped."));
+
+    options -> addOption(IntegerOption("read-ahead")
+                         .store(&readAhead_)
+                         .storeIsSet(&readAheadIsSet_)
+                         .defaultValue(4)
+                         .description("Number of frames of each "
+                                      "trajectory that are decoded on a "
+                                      "background thread ahead of their "
+                                      "analysis. Always used for "
+                                      "-replicas and for an XTC trajectory "
+                                      "given with -f if all selections are "
+                                      "static and solvent is not mapped. If "
+                                      "set explicitly, any "
+                                      "trajectory given with -f is read in "
+                                      "the same way instead of frame by "
+                                      "frame by the Gromacs runner."));
+
+    const char * const allowedTimeSeriesFormat[] = {"json",
+                                                    "npy"};
+    outputTsFormat_ = eTimeSeriesFormatJson;
+    options -> addOption(EnumOption<eTimeSeriesFormat>("out-ts-format")
+                         .enumValue(allowedTimeSeriesFormat)
+                         .store(&outputTsFormat_)
+                         .description("Format of scalar and profile time "
+                                      "series. If npy, each time series is "
+                                      "written to a separate NumPy file "
+                                      "which is referenced in the JSON "
+                                      "output and can be memory mapped. The "
+                                      "R and Python plotting scripts read "
+                                      "both formats, other tools reading "
+                                      "the JSON output may only support "
+                                      "json."));
+
 
     // PATH FINDING PARAMETERS
     //-------------------------------------------------------------------------
@@ -390,6 +519,7 @@ ChapTrajectoryAnalysis::initOptions(
     options -> addOption(EnumOption<eDensityEstimator>("de-method")
                          .enumValue(allowedDensityEstimationMethod)
                          .store(&deMethod_)
+                         .storeIsSet(&deMethodIsSet_)
                          .description("Method used for estimating the "
                                       "probability density of the solvent "
                                       "particles along the permeation "
@@ -397,6 +527,7 @@ ChapTrajectoryAnalysis::initOptions(
     
     options -> addOption(RealOption("de-res")
                          .store(&deResolution_)
+                         .storeIsSet(&deResolutionIsSet_)
                          .defaultValue(0.01)
                          .description("Spatial resolution of the density "
                                       "estimator. In case of a histogram, "
@@ -406,6 +537,7 @@ ChapTrajectoryAnalysis::initOptions(
 
     options -> addOption(RealOption("de-bandwidth")
                          .store(&deBandWidth_)
+                         .storeIsSet(&deBandWidthIsSet_)
                          .defaultValue(-1.0)
                          .description("Bandwidth for the kernel density "
                                       "estimator. Ignored for other "
@@ -416,6 +548,7 @@ ChapTrajectoryAnalysis::initOptions(
 
     options -> addOption(RealOption("de-bw-scale")
                          .store(&deBandWidthScale_)
+                         .storeIsSet(&deBandWidthScaleIsSet_)
                          .defaultValue(1.0)
                          .description("Scaling factor for the band width. "
                                       "Useful to set a bandwidth relative to "
@@ -423,6 +556,7 @@ ChapTrajectoryAnalysis::initOptions(
 
     options -> addOption(RealOption("de-eval-cutoff")
                          .store(&deEvalRangeCutoff_)
+                         .storeIsSet(&deEvalRangeCutoffIsSet_)
                          .defaultValue(5)
                          .description("Evaluation range cutoff for kernel "
                                       "density estimator in multiples of "
@@ -431,6 +565,16 @@ ChapTrajectoryAnalysis::initOptions(
                                       "smoothly to zero outside the data "
                                       "range."));
 
+    options -> addOption(BooleanOption("de-accumulate")
+                         .store(&deAccumulate_)
+                         .defaultValue(false)
+                         .description("Estimate the time-averaged solvent "
+                                      "density from a single histogram of "
+                                      "the solvent positions in all frames "
+                                      "rather than averaging the per-frame "
+                                      "densities. Requires -de-method "
+                                      "histogram."));
+
 
     // HYDROPHOBICITY PARAMETERS
     //-------------------------------------------------------------------------
@@ -471,6 +615,124 @@ ChapTrajectoryAnalysis::initOptions(
                          .store(&hpBandWidth_)
                          .defaultValue(0.35)
                          .description("Bandwidth for hydrophobicity kernel."));
+
+
+    // CONVERGENCE PARAMETERS
+    //-------------------------------------------------------------------------
+
+    options -> addOption(IntegerOption("conv-check-interval")
+                         .store(&convCheckInterval_)
+                         .defaultValue(0)
+                         .description("Number of frames between checks for "
+                                      "convergence of the time-averaged "
+                                      "radius and energy profiles. Once both "
+                                      "have converged, no further frames are "
+                                      "read from the trajectory. A value of "
+                                      "zero disables convergence checks."));
+
+    options -> addOption(RealOption("conv-tol-radius")
+                         .store(&convTolRadius_)
+                         .defaultValue(0.005)
+                         .description("Convergence tolerance for the mean "
+                                      "radius profile in nm. Both the change "
+                                      "of the mean between checks and its "
+                                      "correlation-corrected standard error "
+                                      "must be smaller than this at every "
+                                      "point along the pathway."));
+
+    options -> addOption(RealOption("conv-tol-energy")
+                         .store(&convTolEnergy_)
+                         .defaultValue(0.05)
+                         .description("Convergence tolerance for the mean "
+                                      "energy profile in kT. Ignored if no "
+                                      "solvent selection is given."));
+
+
+    // FRAME ANALYSIS PARAMETERS
+    //-------------------------------------------------------------------------
+
+    const char * const allowedSkipStages[] = {"hydrophobicity",
+                                              "solvent"};
+    options -> addOption(EnumOption<eFrameAnalysisSkip>("skip")
+                         .enumValue(allowedSkipStages)
+                         .storeVector(&skipStages_)
+                         .multiValue()
+                         .description("Per-frame analysis steps to skip. "
+                                      "Skipping hydrophobicity yields zero "
+                                      "hydrophobicity profiles, skipping "
+                                      "solvent omits solvent mapping and "
+                                      "density estimation as if no solvent "
+                                      "selection were given."));
+
+    options -> addOption(BooleanOption("concurrent-stages")
+                         .store(&concurrentStages_)
+                         .defaultValue(false)
+                         .description("If true, independent per-frame "
+                                      "analysis steps (e.g. pore residue and "
+                                      "solvent mapping) are run concurrently "
+                                      "within each frame."));
+
+
+    // PARAMETER SWEEP
+    //-------------------------------------------------------------------------
+
+    options -> addOption(EnumOption<eDensityEstimator>("sweep-de-method")
+                         .enumValue(allowedDensityEstimationMethod)
+                         .storeVector(&sweepDeMethod_)
+                         .multiValue()
+                         .description("Density estimation methods for "
+                                      "additional parameter sets. The "
+                                      "pathway, pore residues, and solvent "
+                                      "are mapped only once per frame and "
+                                      "density and hydrophobicity are "
+                                      "estimated and aggregated separately "
+                                      "for each set. All sweep lists are "
+                                      "combined element-wise and lists with "
+                                      "a single value apply to all sets."));
+
+    options -> addOption(RealOption("sweep-de-bandwidth")
+                         .storeVector(&sweepDeBandWidth_)
+                         .multiValue()
+                         .description("Density estimation bandwidths for "
+                                      "additional parameter sets. Falls back "
+                                      "to -de-bandwidth if not given."));
+
+    options -> addOption(RealOption("sweep-hydrophob-bandwidth")
+                         .storeVector(&sweepHpBandWidth_)
+                         .multiValue()
+                         .description("Hydrophobicity kernel bandwidths for "
+                                      "additional parameter sets. Falls back "
+                                      "to -hydrophob-bandwidth if not "
+                                      "given."));
+}
+
+
+/*
+ * Auxiliary function that compiles the selections in a collection against
+ * the given topology. Index groups are taken from the given NDX file or, if
+ * the file name is empty, generated from the topology.
+ */
+template<typename Topology>
+static void
+compileSelections(
+        SelectionCollection &selCol,
+        Topology *top,
+        const std::string &ndxFileName)
+{
+    // create index groups from topology:
+    gmx_ana_indexgrps_t *idxGroups;
+    gmx_ana_indexgrps_init(
+            &idxGroups, 
+            top, 
+            ndxFileName.empty() ? NULL : ndxFileName.c_str());
+
+    // compile the selections:
+    selCol.setTopology(top, 0);
+    selCol.setIndexGroups(idxGroups);
+    selCol.compile();
+
+    // free memory:
+    gmx_ana_indexgrps_free(idxGroups);
 }
 
 
@@ -497,8 +759,9 @@ ChapTrajectoryAnalysis::initAnalysis(
     #endif
 
 
-    // set path name of NDX file:
+    // set path name of NDX and trajectory file:
     obtainNdxFilePathInfo();
+    obtainTrajectoryFilePathInfo();
 
     // check validity of input parameters:
     checkParameters();
@@ -511,7 +774,7 @@ ChapTrajectoryAnalysis::initAnalysis(
     //-------------------------------------------------------------------------
 
     // prepare per frame data stream:
-    frameStreamData_.setDataSetCount(9);
+    frameStreamData_.setDataSetCount(9 + 5*numSweepSets_);
     std::vector<std::string> frameStreamDataSetNames = {
             "pathSummary",
             "molPathOrigPoints",
@@ -600,14 +863,31 @@ ChapTrajectoryAnalysis::initAnalysis(
     frameStreamColumnNames.push_back({"knots", 
                                       "ctrl"});
 
-    // add JSON exporter to frame stream data:
-    AnalysisDataJsonFrameExporterPointer jsonFrameExporter(new AnalysisDataJsonFrameExporter);
-    jsonFrameExporter -> setDataSetNames(frameStreamDataSetNames);
-    jsonFrameExporter -> setColumnNames(frameStreamColumnNames);
-    std::string frameStreamFileName = std::string("stream_") + outputJsonFileName_;
-    jsonFrameExporter -> setFileName(frameStreamFileName);
-    frameStreamData_.addModule(jsonFrameExporter);
-
+    // prepare containers for results of each parameter set in sweep:
+    for(size_t k = 0; k < numSweepSets_; k++)
+    {
+        int firstDataSet = 9 + 5*k;
+        std::string suffix = "_sweep" + std::to_string(k + 1);
+        frameStreamDataSetNames.push_back("pathSummary" + suffix);
+        frameStreamData_.setColumnCount(firstDataSet, 5);
+        frameStreamColumnNames.push_back({"solventRangeLo",
+                                          "solventRangeHi",
+                                          "argMinSolventDensity",
+                                          "minSolventDensity",
+                                          "bandWidth"});
+        frameStreamDataSetNames.push_back("residuePositions" + suffix);
+        frameStreamData_.setColumnCount(firstDataSet + 1, 1);
+        frameStreamColumnNames.push_back({"solventDensity"});
+        frameStreamDataSetNames.push_back("solventDensitySpline" + suffix);
+        frameStreamDataSetNames.push_back("plHydrophobicitySpline" + suffix);
+        frameStreamDataSetNames.push_back("pfHydrophobicitySpline" + suffix);
+        for(int i = 2; i < 5; i++)
+        {
+            frameStreamData_.setColumnCount(firstDataSet + i, 2);
+            frameStreamColumnNames.push_back({"knots", 
+                                              "ctrl"});
+        }
+    }
 
     // PREPARE SELECTIONS FOR PORE PARTICLE MAPPING
     //-------------------------------------------------------------------------
@@ -621,32 +901,13 @@ ChapTrajectoryAnalysis::initAnalysis(
     std::string poreMappingSelCalString = pfSelString_;
     std::string poreMappingSelCogString = pathwaySelSelText;
 
-    // create index groups from topology:
-    gmx_ana_indexgrps_t *poreIdxGroups;
- 
-    // has external index file been specified?
-    if( customNdxFileName_.size() != 0 )
-    {
-        gmx_ana_indexgrps_init(&poreIdxGroups, 
-                               topologyPointer.get(), 
-                               customNdxFileName_.c_str());  
-    }
-    else
-    {
-        gmx_ana_indexgrps_init(&poreIdxGroups, 
-                               topologyPointer.get(), 
-                               NULL); 
-    }
-
     // create selections as defined above:
     poreMappingSelCal_ = poreMappingSelCol_.parseFromString(poreMappingSelCalString)[0];
     poreMappingSelCog_ = poreMappingSelCol_.parseFromString(poreMappingSelCogString)[0];
-    poreMappingSelCol_.setTopology(topologyPointer.get(), 0);
-    poreMappingSelCol_.setIndexGroups(poreIdxGroups);
-    poreMappingSelCol_.compile();
-
-    // free memory:
-    gmx_ana_indexgrps_free(poreIdxGroups);
+    compileSelections(
+            poreMappingSelCol_, 
+            topologyPointer.get(), 
+            customNdxFileName_);
 
     // do we have one C-alpha for each pore-forming residue?
     if( poreMappingSelCal_.posCount() != poreMappingSelCog_.posCount() )
@@ -670,23 +931,6 @@ ChapTrajectoryAnalysis::initAnalysis(
         solvMappingSelCol_.setReferencePosType("res_cog");
         solvMappingSelCol_.setOutputPosType("res_cog");
 
-        // create index groups from topology:
-        gmx_ana_indexgrps_t *solvIdxGroups;
-
-        // has custom index file been provided?
-        if( customNdxFileName_.size() != 0 )
-        {
-            gmx_ana_indexgrps_init(&solvIdxGroups,
-                                   topologyPointer.get(),
-                                   customNdxFileName_.c_str());
-        }
-        else
-        {
-            gmx_ana_indexgrps_init(&solvIdxGroups,
-                                   topologyPointer.get(),
-                                   NULL);
-        }
-
         // selection text:
         std::string solvMappingSelCogString = solventSel_[0].selectionText();
 
@@ -694,42 +938,37 @@ ChapTrajectoryAnalysis::initAnalysis(
         solvMappingSelCog_ = solvMappingSelCol_.parseFromString(solvMappingSelCogString)[0];
 
         // compile the selections:
-        solvMappingSelCol_.setTopology(topologyPointer.get(), 0);
-        solvMappingSelCol_.setIndexGroups(solvIdxGroups);
-        solvMappingSelCol_.compile();
-
-        // free memory:
-        gmx_ana_indexgrps_free(solvIdxGroups);
+        compileSelections(
+                solvMappingSelCol_, 
+                topologyPointer.get(), 
+                customNdxFileName_);
     }
 
     
     // GET ATOM RADII FROM TOPOLOGY
     //-------------------------------------------------------------------------
 
-    // base path to location of van-der-Waals radius databases:
-    std::string radiusFilePath = chapInstallBase() +
-            std::string("/chap/share/data/vdwradii/");
-
-    // select appropriate database file:
+    // select appropriate built-in database:
+    std::string radiusDatabase = "vdwradii/";
     if( pfVdwRadiusDatabase_ == eVdwRadiusDatabaseHoleAmberuni )
     {
-        pfVdwRadiusJson_ = radiusFilePath + "hole_amberuni.json";
+        radiusDatabase += "hole_amberuni.json";
     }
     else if( pfVdwRadiusDatabase_ == eVdwRadiusDatabaseHoleBondi )
     {
-        pfVdwRadiusJson_ = radiusFilePath + "hole_bondi.json";
+        radiusDatabase += "hole_bondi.json";
     }
     else if( pfVdwRadiusDatabase_ == eVdwRadiusDatabaseHoleHardcore )
     {
-        pfVdwRadiusJson_ = radiusFilePath + "hole_hardcore.json";
+        radiusDatabase += "hole_hardcore.json";
     }
     else if( pfVdwRadiusDatabase_ == eVdwRadiusDatabaseHoleSimple )
     {
-        pfVdwRadiusJson_ = radiusFilePath + "hole_simple.json";
+        radiusDatabase += "hole_simple.json";
     }
     else if( pfVdwRadiusDatabase_ == eVdwRadiusDatabaseHoleXplor )
     {
-        pfVdwRadiusJson_ = radiusFilePath + "hole_xplor.json";
+        radiusDatabase += "hole_xplor.json";
     }
     else if( pfVdwRadiusDatabase_ == eVdwRadiusDatabaseUser )
     {
@@ -742,9 +981,17 @@ ChapTrajectoryAnalysis::initAnalysis(
         }
     }
 
-    // import vdW radii JSON: 
+    // import vdW radii JSON (user databases are read from file): 
     JsonDocImporter jdi;
-    rapidjson::Document radiiDoc = jdi(pfVdwRadiusJson_.c_str());
+    rapidjson::Document radiiDoc;
+    if( pfVdwRadiusDatabase_ == eVdwRadiusDatabaseUser )
+    {
+        radiiDoc = jdi(pfVdwRadiusJson_);
+    }
+    else
+    {
+        radiiDoc = jdi.fromBuiltin(radiusDatabase);
+    }
    
     // create radius provider and build lookup table:
     VdwRadiusProvider vrp;
@@ -777,38 +1024,35 @@ ChapTrajectoryAnalysis::initAnalysis(
     resInfo_.nameFromTopology(top);
     resInfo_.chainFromTopology(top);
 
-    // base path to location of hydrophobicity databases:
-    std::string hydrophobicityFilePath = chapInstallBase() + 
-            std::string("/chap/share/data/hydrophobicity/");
-    
-    // select appropriate database file:
+    // select appropriate built-in database:
+    std::string hydrophobicityDatabase = "hydrophobicity/";
     if( hydrophobicityDatabase_ == eHydrophobicityDatabaseHessa2005 )
     {
-        hydrophobicityJson_ = hydrophobicityFilePath + "hessa_2005.json";
+        hydrophobicityDatabase += "hessa_2005.json";
     }
     else if( hydrophobicityDatabase_ == eHydrophobicityDatabaseKyteDoolittle1982 )
     {
-        hydrophobicityJson_ = hydrophobicityFilePath + "kyte_doolittle_1982.json";
+        hydrophobicityDatabase += "kyte_doolittle_1982.json";
     }
     else if( hydrophobicityDatabase_ == eHydrophobicityDatabaseMonera1995 )
     {
-        hydrophobicityJson_ = hydrophobicityFilePath + "monera_1995.json";
+        hydrophobicityDatabase += "monera_1995.json";
     }
     else if( hydrophobicityDatabase_ == eHydrophobicityDatabaseMoon2011 )
     {
-        hydrophobicityJson_ = hydrophobicityFilePath + "moon_2011.json";
+        hydrophobicityDatabase += "moon_2011.json";
     }
     else if( hydrophobicityDatabase_ == eHydrophobicityDatabaseWimleyWhite1996 )
     {
-        hydrophobicityJson_ = hydrophobicityFilePath + "wimley_white_1996.json";
+        hydrophobicityDatabase += "wimley_white_1996.json";
     }
     else if( hydrophobicityDatabase_ == eHydrophobicityDatabaseZhu2016 )
     {
-        hydrophobicityJson_ = hydrophobicityFilePath + "zhu_2016.json";
+        hydrophobicityDatabase += "zhu_2016.json";
     }
     else if( hydrophobicityDatabase_ == eHydrophobicityDatabaseMemprotMd )
     {
-        hydrophobicityJson_ = hydrophobicityFilePath + "memprotmd.json";
+        hydrophobicityDatabase += "memprotmd.json";
     }
     else if( hydrophobicityDatabase_ == eHydrophobicityDatabaseUser )
     {
@@ -821,8 +1065,16 @@ ChapTrajectoryAnalysis::initAnalysis(
         }
     }
 
-    // import hydrophbicity JSON:
-    rapidjson::Document hydrophobicityDoc = jdi(hydrophobicityJson_.c_str());
+    // import hydrophbicity JSON (user databases are read from file):
+    rapidjson::Document hydrophobicityDoc;
+    if( hydrophobicityDatabase_ == eHydrophobicityDatabaseUser )
+    {
+        hydrophobicityDoc = jdi(hydrophobicityJson_);
+    }
+    else
+    {
+        hydrophobicityDoc = jdi.fromBuiltin(hydrophobicityDatabase);
+    }
    
     // generate hydrophobicity lookup table:
     resInfo_.hydrophobicityFromJson(hydrophobicityDoc);
@@ -833,6 +1085,188 @@ ChapTrajectoryAnalysis::initAnalysis(
         resInfo_.setDefaultHydrophobicity(hydrophobicityDefault_);
     }
 
+
+    // PREPARE TRAJECTORIES READ OUTSIDE THE RUNNER
+    //-------------------------------------------------------------------------
+
+    // keep time range of the main trajectory before it is changed:
+    // (the runner sets the Gromacs time control from -b, -e, and -dt)
+    beginTime_ = bTimeSet(TBEGIN) 
+            ? rTimeValue(TBEGIN) 
+            : std::numeric_limits<real>::lowest();
+    endTimeIsSet_ = bTimeSet(TEND);
+    endTime_ = endTimeIsSet_
+            ? rTimeValue(TEND) 
+            : std::numeric_limits<real>::max();
+    deltaTime_ = bTimeSet(TDELTA) ? rTimeValue(TDELTA) : 0.0;
+    bool replicaHasSolvent = !solventSel_.empty() && std::find(
+            skipStages_.begin(), 
+            skipStages_.end(), 
+            eFrameAnalysisSkipSolvent) == skipStages_.end();
+
+    // trajectories read directly share all setup derived from the topology, 
+    // but each has its own selections:
+    auto createTrajectoryAnalysis = [&](
+            const std::string &trajectoryFileName) 
+            -> std::unique_ptr<ReplicaTrajectoryAnalysis>
+    {
+        std::unique_ptr<ReplicaTrajectoryAnalysis> replica(
+                new ReplicaTrajectoryAnalysis(trajectoryFileName));
+        replica -> setReadAhead(readAhead_);
+
+        // pathway selections are evaluated by the replica itself:
+        FrameSelections &replicaSel = replica -> selections();
+        SelectionCollection &pathwaySelCol = replica -> pathwaySelections();
+        replicaSel.pathway_ = pathwaySelCol.parseFromString(
+                pathwaySelSelText)[0];
+        replicaSel.ipp_ = ippSelIsSet_ 
+                ? pathwaySelCol.parseFromString(ippSel_.selectionText())[0]
+                : replicaSel.pathway_;
+        compileSelections(
+                pathwaySelCol, 
+                topologyPointer.get(), 
+                customNdxFileName_);
+
+        // pore mapping selections:
+        SelectionCollection &poreSelCol = replica -> poreMappingSelections();
+        poreSelCol.setReferencePosType("res_cog");
+        poreSelCol.setOutputPosType("res_cog");
+        replicaSel.poreMappingCal_ = poreSelCol.parseFromString(
+                poreMappingSelCalString)[0];
+        replicaSel.poreMappingCog_ = poreSelCol.parseFromString(
+                poreMappingSelCogString)[0];
+        compileSelections(
+                poreSelCol, 
+                topologyPointer.get(), 
+                customNdxFileName_);
+
+        // solvent mapping selections:
+        if( !solventSel_.empty() )
+        {
+            SelectionCollection &solvSelCol = 
+                    replica -> solventMappingSelections();
+            solvSelCol.setReferencePosType("res_cog");
+            solvSelCol.setOutputPosType("res_cog");
+            replicaSel.solvMappingCog_ = solvSelCol.parseFromString(
+                    solventSel_[0].selectionText())[0];
+            compileSelections(
+                    solvSelCol, 
+                    topologyPointer.get(), 
+                    customNdxFileName_);
+        }
+
+        // only atoms needed by the selections are decoded from XTC files:
+        replica -> setMaxAtoms(replicaSel.numRequiredAtoms(replicaHasSolvent));
+        replica -> setTimeRange(beginTime_, endTime_, deltaTime_);
+
+        return replica;
+    };
+
+    // main trajectory is read directly if read-ahead is requested or if it 
+    // can be decoded partially, i.e. is an XTC file, all selections are 
+    // static, and solvent is not mapped:
+    // (not when re-aggregating, where frames are only passed through)
+    if( !inputStreamFileNameIsSet_ && 
+        !trajectoryFileName_.empty() &&
+        (readAheadIsSet_ || 
+         (XtcReader::isXtcFile(trajectoryFileName_) && !replicaHasSolvent)) )
+    {
+        mainTrajectory_ = createTrajectoryAnalysis(trajectoryFileName_);
+        if( !readAheadIsSet_ && 
+            mainTrajectory_ -> selections().numRequiredAtoms(false) == 0 )
+        {
+            mainTrajectory_.reset();
+        }
+    }
+    readTrajectoryDirectly_ = static_cast<bool>(mainTrajectory_);
+
+    // replica trajectories:
+    for(size_t k = 0; k < replicaFileNames_.size(); k++)
+    {
+        replicas_.push_back(createTrajectoryAnalysis(replicaFileNames_[k]));
+    }
+
+
+    // ASSEMBLE PER-FRAME ANALYSIS
+    //-------------------------------------------------------------------------
+
+    // selections of the trajectory processed by the Gromacs runner:
+    if( !readTrajectoryDirectly_ )
+    {
+        FrameSelections selections;
+        selections.pathway_ = pathwaySel_;
+        selections.ipp_ = ippSelIsSet_ ? ippSel_ : pathwaySel_;
+        selections.poreMappingSelCol_ = &poreMappingSelCol_;
+        selections.poreMappingCal_ = poreMappingSelCal_;
+        selections.poreMappingCog_ = poreMappingSelCog_;
+        selections.solvMappingSelCol_ = &solvMappingSelCol_;
+        selections.solvMappingCog_ = solvMappingSelCog_;
+        initFramePipeline(framePipeline_, selections, true);
+    }
+
+    // add JSON exporter to frame stream data of the runner:
+    // (not when re-aggregating, as the existing stream must not be 
+    // overwritten, or when the main trajectory writes its own stream)
+    std::string frameStreamFileName = "stream_" + outputJsonFileName_;
+    if( !inputStreamFileNameIsSet_ && !readTrajectoryDirectly_ )
+    {
+        AnalysisDataJsonFrameExporterPointer jsonFrameExporter(new AnalysisDataJsonFrameExporter);
+        jsonFrameExporter -> setDataSetNames(frameStreamDataSetNames);
+        jsonFrameExporter -> setColumnNames(frameStreamColumnNames);
+        jsonFrameExporter -> setFileName(frameStreamFileName);
+        frameStreamData_.addModule(jsonFrameExporter);
+    }
+
+    // main trajectory read directly stops once profiles have converged:
+    if( mainTrajectory_ )
+    {
+        initFramePipeline(
+                mainTrajectory_ -> pipeline(), 
+                mainTrajectory_ -> selections(), 
+                true);
+        mainTrajectory_ -> setFrameStream(
+                frameStreamData_,
+                frameStreamFileName,
+                frameStreamDataSetNames,
+                frameStreamColumnNames);
+        mainTrajectory_ -> setStopCondition(
+                [this](const FrameAnalysisContext &ctx)
+                { 
+                    return convergedFrame_ == ctx.frnr_; 
+                });
+    }
+
+    // replicas have their own frame streams:
+    for(size_t k = 0; k < replicas_.size(); k++)
+    {
+        initFramePipeline(
+                replicas_[k] -> pipeline(), 
+                replicas_[k] -> selections(), 
+                false);
+        replicas_[k] -> setFrameStream(
+                frameStreamData_,
+                "stream_" + outputBaseFileName_ + "_replica" + 
+                std::to_string(k + 2) + ".json",
+                frameStreamDataSetNames,
+                frameStreamColumnNames);
+    }
+
+    // analyse trajectories while the runner processes the main trajectory:
+    if( mainTrajectory_ )
+    {
+        ReplicaTrajectoryAnalysis *r = mainTrajectory_.get();
+        mainTrajectoryRun_ = std::async(
+                std::launch::async, 
+                [r](){ return r -> run(); });
+    }
+    for(auto &replica : replicas_)
+    {
+        ReplicaTrajectoryAnalysis *r = replica.get();
+        replicaRuns_.push_back(std::async(
+                std::launch::async, 
+                [r](){ return r -> run(); }));
+    }
+
     // free line for nice output:
     std::cout<<std::endl;
 }
@@ -846,7 +1280,13 @@ ChapTrajectoryAnalysis::initAfterFirstFrame(
         const TrajectoryAnalysisSettings &settings,
         const t_trxframe &fr)
 {
-
+    // runner only passes through first frame if trajectory is read directly:
+    // (the runner checks the end time in read_next_frame(), the end time 
+    // given by the user is restored in finishAnalysis())
+    if( readTrajectoryDirectly_ )
+    {
+        setTimeValue(TEND, fr.time);
+    }
 }
 
 
@@ -860,1084 +1300,649 @@ ChapTrajectoryAnalysis::analyzeFrame(
         t_pbc *pbc,
         TrajectoryAnalysisModuleData *pdata)
 {
-    // get thread-local selections:
-    const Selection &refSelection = pdata -> parallelSelection(pathwaySel_);
-
     // get data handles for this frame:
     AnalysisDataHandle dhFrameStream = pdata -> dataHandle(frameStreamData_);
 
     // get data for frame number frnr into data handle:
     dhFrameStream.startFrame(frnr, fr.time);
 
-
-    // UPDATE INITIAL PROBE POSITION FOR THIS FRAME
-    //-------------------------------------------------------------------------
-
-    // recalculate initial probe position based on reference group COG:
-    if( pfInitProbePosIsSet_ == false )
-    {  
-        // helper variable for conditional assignment of selection:
-        Selection tmpsel;
-  
-        // has a group for specifying initial probe position been set?
-        if( ippSelIsSet_ == true )
-        {
-            // use explicitly given selection:
-            tmpsel = ippSel_;
-        }
-        else 
-        {
-            // default to overall group of pore forming particles:
-            tmpsel = pathwaySel_;
-        }
-     
-        // load data into initial position selection:
-        const gmx::Selection &initPosSelection = pdata -> parallelSelection(tmpsel);
- 
-        // initialse total mass and COM vector:
-        real totalMass = 0.0;
-        gmx::RVec centreOfMass(0.0, 0.0, 0.0);
-        
-        // loop over all atoms: 
-        for(int i = 0; i < initPosSelection.atomCount(); i++)
-        {
-            // get i-th atom position:
-            gmx::SelectionPosition atom = initPosSelection.position(i);
-
-            // add to total mass:
-            totalMass += atom.mass();
-
-            // add to COM vector:
-            centreOfMass[XX] += atom.mass() * atom.x()[XX];
-            centreOfMass[YY] += atom.mass() * atom.x()[YY];
-            centreOfMass[ZZ] += atom.mass() * atom.x()[ZZ];
-        }
-
-        // scale COM vector by total MASS:
-        centreOfMass[XX] /= 1.0 * totalMass;
-        centreOfMass[YY] /= 1.0 * totalMass;
-        centreOfMass[ZZ] /= 1.0 * totalMass; 
-
-        // set initial probe position:
-        pfInitProbePos_[XX] = centreOfMass[XX];
-        pfInitProbePos_[YY] = centreOfMass[YY];
-        pfInitProbePos_[ZZ] = centreOfMass[ZZ];
+    // describe frame to analysis stages:
+    FrameAnalysisContext ctx;
+    ctx.frnr_ = frnr;
+    ctx.fr_ = &fr;
+    ctx.pbc_ = pbc;
+    ctx.pdata_ = pdata;
+    ctx.dataHandle_ = &dhFrameStream;
+
+    // run all stages on this frame:
+    // (frames are only passed through when re-aggregating an existing stream
+    // or when the main trajectory is read outside the runner)
+    if( !inputStreamFileNameIsSet_ && !readTrajectoryDirectly_ )
+    {
+        framePipeline_.run(ctx);
     }
 
-
-    // GET VDW RADII FOR SELECTION
-    //-------------------------------------------------------------------------
-
-    // create vector of van der Waals radii and allocate memory:
-    std::vector<real> selVdwRadii;
-    selVdwRadii.reserve(refSelection.atomCount());
-
-    // loop over all atoms in system and get vdW-radii:
-    for(int i=0; i<refSelection.atomCount(); i++)
+    // stop runner after this frame once profiles have converged:
+    // (the runner checks the end time in read_next_frame(), this is done 
+    // here on the main thread rather than in the convergence stage, which
+    // may run concurrently with other stages; a trajectory read directly 
+    // stops itself)
+    if( !readTrajectoryDirectly_ && convergedFrame_ == frnr )
     {
-        // get global index of i-th atom in selection:
-        gmx::SelectionPosition atom = refSelection.position(i);
-        int idx = atom.mappedId();
+        setTimeValue(TEND, fr.time);
+    }
 
-        // add radius to vector of radii:
-        selVdwRadii.push_back(vdwRadii_.at(idx));
-				}
+    // finish analysis of current frame:
+    dhFrameStream.finishFrame();
+}
 
 
-				// PORE FINDING AND RADIUS CALCULATION
-				// ------------------------------------------------------------------------
 
-    // vectors as RVec:
-    RVec initProbePos(pfInitProbePos_[0], pfInitProbePos_[1], pfInitProbePos_[2]);
-    RVec chanDirVec(pfChanDirVec_[0], pfChanDirVec_[1], pfChanDirVec_[2]); 
+/*
+ * Auxiliary function that calls f(i, t) for all i < n, where the indices are
+ * split into contiguous blocks, each of which is handled by a separate 
+ * thread t < numThreads.
+ */
+template<typename Function>
+static void
+parallelFor(size_t n, size_t numThreads, Function f)
+{
+    numThreads = std::max<size_t>(std::min(numThreads, n), 1);
+    size_t blockSize = (n + numThreads - 1) / numThreads;
 
-    // create path finding module:
-    std::unique_ptr<AbstractPathFinder> pfm;
-    if( pfMethod_ == ePathFindingMethodInplaneOptimised )
+    // launch all but first block asynchronously:
+    std::vector<std::future<void>> futures;
+    for(size_t t = 1; t < numThreads; t++)
     {
-        // create inplane-optimised path finder:
-        pfm.reset(new InplaneOptimisedProbePathFinder(pfPar_,
-                                                      initProbePos,
-                                                      chanDirVec,
-                                                      pbc,
-                                                      refSelection,
-                                                      selVdwRadii));        
+        futures.push_back(std::async(
+                std::launch::async,
+                [&f, t, n, blockSize]()
+                {
+                    for(size_t i = t*blockSize; 
+                        i < std::min(n, (t + 1)*blockSize); 
+                        i++)
+                    {
+                        f(i, t);
+                    }
+                }));
     }
-    else if( pfMethod_ == ePathFindingMethodNaiveCylindrical )
-    {        
-        // create the naive cylindrical path finder:
-        pfm.reset(new NaiveCylindricalPathFinder(pfPar_,
-                                                 initProbePos,
-                                                 chanDirVec));
-    }
-
-    // set parameters:
-    pfm -> setParameters(pfParams_);
-
 
-    // PATH FINDING
-    //-------------------------------------------------------------------------
-
-    // run path finding algorithm on current frame:
-    std::cout.flush();
-    clock_t tPathFinding = std::clock();
-    pfm -> findPath();
-    tPathFinding = (std::clock() - tPathFinding)/CLOCKS_PER_SEC;
-
-    // retrieve molecular path object:
-    std::cout.flush();
-    clock_t tMolPath = std::clock();
-    MolecularPath molPath = pfm -> getMolecularPath();
-    tMolPath = (std::clock() - tMolPath)/CLOCKS_PER_SEC;
-    
-    // which method do we use for path alignment?
-    if( pfPathAlignmentMethod_ == ePathAlignmentMethodNone )
+    // run first block on this thread and wait for the others:
+    for(size_t i = 0; i < std::min(n, blockSize); i++)
     {
-        // no need to do anything in this case
+        f(i, 0);
     }
-    else if( pfPathAlignmentMethod_ == ePathAlignmentMethodIpp )
+    for(auto &future : futures)
     {
-        // map initial probe position onto pathway:
-        std::vector<gmx::RVec> ipp;
-        ipp.push_back(initProbePos);
-        std::vector<gmx::RVec> mappedIpp = molPath.mapPositions(ipp);
-
-        // shift coordinates of molecular path appropriately:
-        molPath.shift(mappedIpp.front());
+        future.get();
     }
+}
 
-    // get original path points and radii:
-    std::vector<gmx::RVec> pathPoints = molPath.pathPoints();
-    std::vector<real> pathRadii = molPath.pathRadii();
 
-    // add original path points to frame stream dataset:
-    dhFrameStream.selectDataSet(1);
-    for(size_t i = 0; i < pathPoints.size(); i++)
+/*
+ * Auxiliary function that reads up to frames.size() frames from the stream 
+ * file and returns the number of frames read.
+ */
+static size_t
+readFrameBatch(FrameStreamReader &inFile, std::vector<FrameStreamData> &frames)
+{
+    size_t numFramesRead = 0;
+    while( numFramesRead < frames.size() && 
+           inFile.readFrame(frames[numFramesRead]) )
     {
-        dhFrameStream.setPoint(0, pathPoints.at(i)[XX]);
-        dhFrameStream.setPoint(1, pathPoints.at(i)[YY]);
-        dhFrameStream.setPoint(2, pathPoints.at(i)[ZZ]);
-        dhFrameStream.setPoint(3, pathRadii.at(i));
-        dhFrameStream.finishPointSet();
+        numFramesRead++;
     }
+    return numFramesRead;
+}
+
 
-    // add radius spline knots and control points to frame stream dataset:
-    dhFrameStream.selectDataSet(2);
-    std::vector<real> radiusKnots = molPath.poreRadiusUniqueKnots();    
-    std::vector<real> radiusCtrlPoints = molPath.poreRadiusCtrlPoints();
-    for(size_t i = 0; i < radiusKnots.size(); i++)
+/*
+ * Auxiliary function that re-estimates the solvent density in a frame read 
+ * from the stream file from the stored solvent positions, using the same 
+ * stage as the per-frame analysis. All quantities derived from the density 
+ * are updated accordingly.
+ */
+static void
+reestimateSolventDensity(FrameStreamData &frame, SolventDensityStage &stage)
+{
+    // set up context as after solvent mapping:
+    FrameAnalysisContext ctx;
+    ctx.molPath_.reset(new MolecularPath(
+            FrameAggregate::molecularPath(frame)));
+    for(size_t i = 0; i < frame.solventS_.size(); i++)
     {
-        dhFrameStream.setPoint(0, radiusKnots.at(i));
-        dhFrameStream.setPoint(1, radiusCtrlPoints.at(i));
-        dhFrameStream.finishPointSet();
+        ctx.solventMappedCoords_[i] = gmx::RVec(frame.solventS_[i], 0.0, 0.0);
+        ctx.solvInsideSample_[i] = frame.solventInSample_.at(i) != 0.0;
+        ctx.solvInsidePore_[i] = frame.solventInPore_.at(i) != 0.0;
     }
-    
-    // add centre line spline knots and control points to frame stream dataset:
-    dhFrameStream.selectDataSet(3);
-    std::vector<real> centreLineKnots = molPath.centreLineUniqueKnots();    
-    std::vector<gmx::RVec> centreLineCtrlPoints = molPath.centreLineCtrlPoints();
-    for(size_t i = 0; i < centreLineKnots.size(); i++)
+    ctx.numSolvInsideSample_ = frame.numSample_;
+
+    // estimate density:
+    SolventDensityProfile density;
+    stage.estimate(ctx, density);
+
+    // replace density spline:
+    frame.solventDensitySpline_.knots_ = density.density_.uniqueKnots();
+    frame.solventDensitySpline_.ctrl_ = density.density_.ctrlPoints();
+
+    // replace derived quantities:
+    frame.solventRangeLo_ = frame.solventDensitySpline_.knots_.front();
+    frame.solventRangeHi_ = frame.solventDensitySpline_.knots_.back();
+    frame.argMinSolventDensity_ = density.minimum_.first;
+    frame.minSolventDensity_ = density.minimum_.second;
+    frame.bandWidth_ = density.bandWidth_;
+    for(size_t i = 0; i < frame.resS_.size(); i++)
     {
-        dhFrameStream.setPoint(0, centreLineKnots.at(i));
-        dhFrameStream.setPoint(1, centreLineCtrlPoints.at(i)[XX]);
-        dhFrameStream.setPoint(2, centreLineCtrlPoints.at(i)[YY]);
-        dhFrameStream.setPoint(3, centreLineCtrlPoints.at(i)[ZZ]);
-        dhFrameStream.finishPointSet();
+        frame.resSolventDensity_[i] = density.density_.evaluate(
+                frame.resS_[i], 0);
     }
+}
 
 
-    // MAP PORE PARTICLES ONTO PATHWAY
-    //-------------------------------------------------------------------------
- 
-    // evaluate pore mapping selection for this frame:
-    t_trxframe frame = fr;
-    poreMappingSelCol_.evaluate(&frame, pbc);
-    const gmx::Selection poreMappingSelCal = pdata -> parallelSelection(poreMappingSelCal_);    
-    const gmx::Selection poreMappingSelCog = pdata -> parallelSelection(poreMappingSelCog_);    
-
-
-    // map pore residue COG onto pathway:
-    clock_t tMapResCog = std::clock();
-    std::map<int, gmx::RVec> poreCogMappedCoords = molPath.mapSelection(
-            poreMappingSelCog);
-    tMapResCog = (std::clock() - tMapResCog)/CLOCKS_PER_SEC;
-
-    // map pore residue C-alpha onto pathway:
-    clock_t tMapResCal = std::clock();
-    std::map<int, gmx::RVec> poreCalMappedCoords = molPath.mapSelection(
-            poreMappingSelCal);
-    tMapResCal = (std::clock() - tMapResCal)/CLOCKS_PER_SEC;
+/*
+ *
+ */
+void
+ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
+{
+    // free line for neater output:
+    std::cout<<std::endl;
 
-    
-    // check if particles are pore-lining:
-    clock_t tResPoreLining = std::clock();
-    std::map<int, bool> poreLining = molPath.checkIfInside(
-            poreCogMappedCoords, 
-            poreMappingMargin_);
-    int nPoreLining = 0;
-    for(auto jt = poreLining.begin(); jt != poreLining.end(); jt++)
-    {
-        if( jt -> second == true )
-        {
-            nPoreLining++;
-        }
+    // restore end time overwritten to stop the runner:
+    if( (convergedFrame_ >= 0 || readTrajectoryDirectly_) && endTimeIsSet_ )
+    {
+        setTimeValue(TEND, endTime_);
     }
-    tResPoreLining = (std::clock() - tResPoreLining)/CLOCKS_PER_SEC;
 
-    // check if residues are pore-facing:
-    // TODO: make this conditional on whether C-alphas are available
-    
-    clock_t tResPoreFacing = std::clock();
-    std::map<int, bool> poreFacing;
-    int nPoreFacing = 0;
-    for(auto it = poreCogMappedCoords.begin(); it != poreCogMappedCoords.end(); it++)
-    {
-        // is residue pore lining and has COG closer to centreline than CA?
-        if( it -> second[RR] < poreCalMappedCoords[it->first][RR] &&
-            poreLining[it -> first] == true &&
-            findPfResidues_ == true )
-        {
-            poreFacing[it->first] = true;
-            nPoreFacing++;
-        }
-        else
-        {
-            poreFacing[it->first] = false;            
-        }
+    // wait for analysis of main trajectory outside the runner to complete:
+    if( mainTrajectory_ )
+    {
+        numFrames = mainTrajectoryRun_.get();
+        std::cout<<"Analysed "<<numFrames<<" frames of trajectory "
+                 <<mainTrajectory_ -> trajectoryFileName()<<std::endl;
     }
-    tResPoreFacing = (std::clock() - tResPoreFacing)/CLOCKS_PER_SEC;
-    
 
-    // ESTIMATE HYDROPHOBICITY PROFILE
-    //-------------------------------------------------------------------------
-   
-    // get vectors of coordinates of pore-facing and -lining residues:
-    std::vector<real> plResidueCoordS;
-    std::vector<real> plResidueHydrophobicity;
-    std::vector<real> pfResidueCoordS;
-    std::vector<real> pfResidueHydrophobicity;
-    real minPoreResS = std::numeric_limits<real>::infinity();
-    real maxPoreResS = -std::numeric_limits<real>::infinity();
-    for(auto res : poreCogMappedCoords)
-    {
-        if( poreLining[res.first] )
-        {
-            plResidueCoordS.push_back(res.second[SS]);
-            plResidueHydrophobicity.push_back(
-                    resInfo_.hydrophobicity(res.first));
-        }
-        if( poreFacing[res.first] )
-        {
-            pfResidueCoordS.push_back(res.second[SS]);
-            pfResidueHydrophobicity.push_back(
-                    resInfo_.hydrophobicity(res.first));
-        }
-
-        // also track the largest and smallest residue positions:
-        if( res.second[SS] < minPoreResS )
-        {
-            minPoreResS = res.second[SS];
-        }
-        if( res.second[SS] > maxPoreResS )
-        {
-            maxPoreResS = res.second[SS];
-        }
+    // transfer file names from user input:
+    std::string inFileName = std::string("stream_") + outputJsonFileName_;
+    if( inputStreamFileNameIsSet_ )
+    {
+        inFileName = inputStreamFileName_;
     }
 
-    // add mock values at both ends to ensure profile goes to zero smoothly:
-    pfResidueCoordS.push_back(minPoreResS - hpBandWidth_/2.0);
-    pfResidueCoordS.push_back(maxPoreResS + hpBandWidth_/2.0);
-    pfResidueHydrophobicity.push_back(0.0);
-    pfResidueHydrophobicity.push_back(0.0);
-
-    plResidueCoordS.push_back(minPoreResS - hpBandWidth_/2.0);
-    plResidueCoordS.push_back(maxPoreResS + hpBandWidth_/2.0);
-    plResidueHydrophobicity.push_back(0.0);
-    plResidueHydrophobicity.push_back(0.0);
+    // wait for analysis of replica trajectories to complete:
+    std::vector<std::string> inFileNames = {inFileName};
+    std::vector<int> numReplicaFrames = {numFrames};
+    for(size_t k = 0; k < replicas_.size(); k++)
+    {
+        numReplicaFrames.push_back(replicaRuns_[k].get());
+        inFileNames.push_back(replicas_[k] -> frameStreamFileName());
+        std::cout<<"Analysed "<<numReplicaFrames.back()<<" frames of "
+                 <<"replica trajectory "
+                 <<replicas_[k] -> trajectoryFileName()<<std::endl;
+    }
 
-    // set up kernel smoother:
-    WeightedKernelDensityEstimator kernelSmoother;
-    kernelSmoother.setParameters(hydrophobKernelParams_);
+    // re-estimate solvent density if parameters were changed on re-analysis:
+    bool reestimateDensity = inputStreamFileNameIsSet_ && 
+            (deMethodIsSet_ || deResolutionIsSet_ || deBandWidthIsSet_ ||
+             deBandWidthScaleIsSet_ || deEvalRangeCutoffIsSet_);
 
-    // estimate hydrophobicity profiles due to pore-lining residues:
-    SplineCurve1D plHydrophobicity = kernelSmoother.estimate(
-            plResidueCoordS, 
-            plResidueHydrophobicity);
+    // aggregate results for primary parameters:
+    aggregateFrameStream(
+            inFileNames, 
+            numReplicaFrames, 
+            "", 
+            reestimateDensity);
 
-    // add spline curve parameters to data handle:   
-    dhFrameStream.selectDataSet(7);
-    for(size_t i = 0; i < plHydrophobicity.ctrlPoints().size(); i++)
+    // aggregate results for each parameter set of sweep:
+    for(size_t k = 0; k < numSweepSets_; k++)
     {
-        dhFrameStream.setPoint(
-                0, 
-                plHydrophobicity.uniqueKnots().at(i));
-        dhFrameStream.setPoint(
-                1, 
-                plHydrophobicity.ctrlPoints().at(i));
-        dhFrameStream.finishPointSet();
+        std::string suffix = "_sweep" + std::to_string(k + 1);
+        aggregateFrameStream(
+                inFileNames, 
+                numReplicaFrames, 
+                suffix, 
+                false);
     }
 
-    // estimate hydrophobicity profiles due to pore-facing residues:
-    SplineCurve1D pfHydrophobicity = kernelSmoother.estimate(
-            pfResidueCoordS, 
-            pfResidueHydrophobicity);
 
-    // add spline curve parameters to data handle:   
-    dhFrameStream.selectDataSet(8);
-    for(size_t i = 0; i < pfHydrophobicity.ctrlPoints().size(); i++)
+    // DELETE PER FRAME DATA
+    // ------------------------------------------------------------------------
+   
+    // detailed output requested? never remove stream being re-aggregated:
+    if( !outputDetailed_ && !inputStreamFileNameIsSet_ )
     {
-        dhFrameStream.setPoint(
-                0, 
-                pfHydrophobicity.uniqueKnots().at(i));
-        dhFrameStream.setPoint(
-                1, 
-                pfHydrophobicity.ctrlPoints().at(i));
-        dhFrameStream.finishPointSet();
+        // remove streaming JSON files:
+        for(auto &fileName : inFileNames)
+        {
+            std::remove(fileName.c_str());
+        }
     }
 
+    // export time-resolved pore surface:
+    if( meshSequence_.numFrames() > 0 )
+    {
+        meshSequence_.write(outputBaseFileName_ + "_sequence.glb");
+    }
+}
 
-    // MAP SOLVENT PARTICLES ONTO PATHWAY
-    //-------------------------------------------------------------------------
 
-    // create data containers:
-    std::map<int, gmx::RVec> solventMappedCoords; 
-    std::map<int, bool> solvInsideSample;
-    std::map<int, bool> solvInsidePore;
-    int numSolvInsideSample = 0;
-    int numSolvInsidePore = 0;
+/*!
+ * Reads the per-frame data from the stream files of all replicas and writes
+ * time-averaged results to a JSON file and the time-averaged pathway to an 
+ * OBJ file, both named after the output base file name and the 
+ * dataSetSuffix. The dataSetSuffix selects the results of a parameter sweep 
+ * (see FrameStreamReader::setDataSetSuffix()), the PDB file is only written 
+ * for the primary parameters (empty suffix). If reestimateDensity is true, 
+ * the solvent density is re-estimated from the solvent positions in the 
+ * stream file using the current parameters. With -de-accumulate, the mean
+ * density for the primary parameters is estimated from a histogram of the
+ * solvent positions in all frames. With -out-shard, the partial 
+ * aggregate is written to a shard file instead of the JSON and OBJ output.
+ *
+ * If more than one stream file is given, the results of each replica are 
+ * written to separate files with a replica suffix, while the un-suffixed 
+ * output contains the ensemble average over the frames of all replicas and 
+ * the between-replica statistics of the time-averaged profiles.
+ */
+void
+ChapTrajectoryAnalysis::aggregateFrameStream(
+        const std::vector<std::string> &inFileNames,
+        const std::vector<int> &numFrames,
+        const std::string &dataSetSuffix,
+        bool reestimateDensity)
+{
+    // DETERMINE RANGE OF PROFILE SUPPORT POINTS
+    // ------------------------------------------------------------------------
 
-    // only do this if solvent selection is valid:
-    if( !solventSel_.empty() )
+    // pathway range is either user specified or spanned by all frames:
+    real anchorPointLo = std::numeric_limits<real>::max();
+    real anchorPointHi = -std::numeric_limits<real>::max();
+    if( outputProfileRangeIsSet_ )
     {
-        // evaluate solvent mapping selections for this frame:
-        t_trxframe tmpFrame = fr;
-        solvMappingSelCol_.evaluate(&tmpFrame, pbc);
-
-        // TODO: make this a parameter:
-        real solvMappingMargin_ = 0.0;
-            
-        // get thread-local selection data:
-        const Selection solvMapSel = pdata -> parallelSelection(solvMappingSelCog_);
-
-        // map particles onto pathway:
-        clock_t tMapSol = std::clock();
-        solventMappedCoords = molPath.mapSelection(solvMapSel);
-        tMapSol = (std::clock() - tMapSol)/CLOCKS_PER_SEC;
-
-        // find particles inside path (i.e. pore plus bulk sampling regime):
-        clock_t tSolInsideSample = std::clock();
-        solvInsideSample = molPath.checkIfInside(
-                solventMappedCoords, 
-                solvMappingMargin_);
-        for(auto jt = solvInsideSample.begin(); jt != solvInsideSample.end(); jt++)
-        {            
-            if( jt -> second == true )
-            {
-                numSolvInsideSample++;
-            }
-        }
-        tSolInsideSample = (std::clock() - tSolInsideSample)/CLOCKS_PER_SEC;
-
-        // find particles inside pore:
-        clock_t tSolInsidePore = std::clock();
-        solvInsidePore = molPath.checkIfInside(
-                solventMappedCoords, 
-                solvMappingMargin_,
-                molPath.sLo(),
-                molPath.sHi());
-        for(auto jt = solvInsidePore.begin(); jt != solvInsidePore.end(); jt++)
-        {            
-            if( jt -> second == true )
+        anchorPointLo = outputProfileRange_.at(0);
+        anchorPointHi = outputProfileRange_.at(1);
+    }
+    else
+    {
+        // pathway endpoints do not depend on solvent positions:
+        size_t numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        std::vector<FrameStreamData> frames(16*numThreads);
+        size_t numFramesInBatch = 0;
+        for(auto &inFileName : inFileNames)
+        {
+            FrameStreamReader inFile;
+            inFile.setReadSolventPositions(false);
+            inFile.open(inFileName);
+            while( (numFramesInBatch = readFrameBatch(inFile, frames)) > 0 )
             {
-                numSolvInsidePore++;
+                for(size_t f = 0; f < numFramesInBatch; f++)
+                {
+                    anchorPointLo = std::min(
+                            anchorPointLo, 
+                            frames[f].arcLengthLo_);
+                    anchorPointHi = std::max(
+                            anchorPointHi, 
+                            frames[f].arcLengthHi_);
+                }
             }
+            inFile.close();
         }
-        tSolInsidePore = (std::clock() - tSolInsidePore)/CLOCKS_PER_SEC;
+    }
 
-        // now add mapped residue coordinates to data handle:
-        dhFrameStream.selectDataSet(5);
-        
-        // add mapped residues to data container:
-        for(auto it = solventMappedCoords.begin(); 
-            it != solventMappedCoords.end(); 
-            it++)
-        {
-             dhFrameStream.setPoint(0, solvMapSel.position(it -> first).mappedId()); // res.id
-             dhFrameStream.setPoint(1, it -> second[0]);     // s
-             dhFrameStream.setPoint(2, it -> second[1]);     // rho
-             dhFrameStream.setPoint(3, 0.0);                 // phi 
-             dhFrameStream.setPoint(4, solvInsidePore[it -> first]);        // inside pore
-             dhFrameStream.setPoint(5, solvInsideSample[it -> first]);      // inside sample
-             dhFrameStream.setPoint(6, solvMapSel.position(it -> first).x()[XX]);  // x
-             dhFrameStream.setPoint(7, solvMapSel.position(it -> first).x()[YY]);  // y
-             dhFrameStream.setPoint(8, solvMapSel.position(it -> first).x()[ZZ]);  // z
-             dhFrameStream.finishPointSet();
-        }
+    // build support points:
+    std::vector<real> supportPoints;
+    size_t numSupportPoints = outputNumPoints_;
+    real supportPointsLo = anchorPointLo - outputExtrapDist_;
+    real supportPointsHi = anchorPointHi + outputExtrapDist_;
+    real supportPointsStep = (supportPointsHi - supportPointsLo) / (numSupportPoints - 1);
+    for(size_t i = 0; i < numSupportPoints; i++)
+    {
+        supportPoints.push_back(supportPointsLo + i*supportPointsStep);
     }
 
-    
-    // ESTIMATE SOLVENT DENSITY
-    //-------------------------------------------------------------------------
 
-    // TODO this entire section can easily be made its own class
+    // READ PER-FRAME DATA AND AGGREGATE
+    // ------------------------------------------------------------------------
 
-    // build a vector of sample points inside the pathway:
-    std::vector<real> solventSampleCoordS;
-    solventSampleCoordS.reserve(solventMappedCoords.size());
-    for(auto isInsideSample : solvInsideSample)
+    // aggregate each replica separately:
+    std::vector<FrameAggregate> replicas;
+    for(size_t k = 0; k < inFileNames.size(); k++)
     {
-        // is this particle inside the pathway?
-        if( isInsideSample.second )
-        {
-            // add arc length coordinate to sample vector:
-            solventSampleCoordS.push_back(
-                    solventMappedCoords[isInsideSample.first][SS]);
-        }
+        replicas.push_back(readFrameStream(
+                inFileNames[k], 
+                dataSetSuffix, 
+                supportPoints, 
+                anchorPointLo, 
+                anchorPointHi, 
+                reestimateDensity, 
+                numFrames.at(k)));
     }
 
-    // sample points inside the pore only for bandwidth estimation:
-    std::vector<real> solventPoreCoordS;
-    solventPoreCoordS.reserve(solventMappedCoords.size());
-    for(auto isInsidePore : solvInsidePore)
+    // ensemble average is over frames of all replicas:
+    FrameAggregate aggregate = replicas.front();
+    for(size_t k = 1; k < replicas.size(); k++)
     {
-        if( isInsidePore.second )
-        {
-            solventPoreCoordS.push_back(
-                    solventMappedCoords[isInsidePore.first][SS]);
-        }
+        aggregate.merge(replicas[k]);
     }
 
-    // create density estimator:
-    std::unique_ptr<AbstractDensityEstimator> densityEstimator;
-    if( deMethod_ == eDensityEstimatorHistogram )
-    {
-        densityEstimator.reset(new HistogramDensityEstimator());
-    }
-    else if( deMethod_ == eDensityEstimatorKernel )
+    
+    // CREATE PDB OUTPUT
+    // ------------------------------------------------------------------------
+
+    // only needed once, as independent of density and hydrophobicity:
+    if( dataSetSuffix.empty() )
     {
-        if( deBandWidth_ <= 0.0 )
-        {
-            AmiseOptimalBandWidthEstimator bwe;
-            deParams_.setBandWidth( bwe.estimate(solventPoreCoordS) );
-        }
+        // assign residue pore facing and pore lining to occupency and bfac:
+        outputStructure_.setPoreFacing(
+                aggregate.residuePoreLining(), 
+                aggregate.residuePoreFacing());
 
-        densityEstimator.reset(new KernelDensityEstimator());
+        // write structure to PDB file:
+        PdbIo::write(outputPdbFileName_, outputStructure_);
     }
 
-    // set parameters for density estimation:
-    densityEstimator -> setParameters(deParams_);
-
-    // estimate density of solvent particles along arc length coordinate:
-    SplineCurve1D solventDensityCoordS = densityEstimator -> estimate(
-            solventSampleCoordS);
-
-    // add spline curve parameters to data handle:   
-    dhFrameStream.selectDataSet(6);
-    for(size_t i = 0; i < solventDensityCoordS.ctrlPoints().size(); i++)
+    // partial results are merged later:
+    if( outputShard_ )
     {
-        dhFrameStream.setPoint(
-                0, 
-                solventDensityCoordS.uniqueKnots().at(i));
-        dhFrameStream.setPoint(
-                1, 
-                solventDensityCoordS.ctrlPoints().at(i));
-        dhFrameStream.finishPointSet();
+        writeShard(
+                outputBaseFileName_ + dataSetSuffix + "_shard.json", 
+                aggregate);
+        return;
     }
 
-    // track range covered by solvent:
-    real solventRangeLo = solventDensityCoordS.uniqueKnots().front();
-    real solventRangeHi = solventDensityCoordS.uniqueKnots().back();
 
-    // obtain physical number density:
-    SplineCurve1D pathRadius = molPath.pathRadius();
-    NumberDensityCalculator ncc;
-    SplineCurve1D numberDensity = ncc(
-            solventDensityCoordS, 
-            pathRadius, 
-            numSolvInsideSample);
-  
-    // find minimum instantaneous solvent density in this frame:
-    std::pair<real, real> lim(molPath.sLo(), molPath.sHi());
-    std::pair<real, real> minSolventDensity = numberDensity.minimum(lim);
-
-
-    // ADD AGGREGATE DATA TO PARALLELISABLE CONTAINER
-    //-------------------------------------------------------------------------   
-
-    // add aggegate path data:
-    dhFrameStream.selectDataSet(0);
-
-    // only one point per frame:
-    dhFrameStream.setPoint(0, fr.time);
-    dhFrameStream.setPoint(1, molPath.minRadius().first);
-    dhFrameStream.setPoint(2, molPath.minRadius().second);
-    dhFrameStream.setPoint(3, molPath.length());
-    dhFrameStream.setPoint(4, molPath.volume());
-    dhFrameStream.setPoint(5, numSolvInsidePore); 
-    dhFrameStream.setPoint(6, numSolvInsideSample); 
-    dhFrameStream.setPoint(7, solventRangeLo); 
-    dhFrameStream.setPoint(8, solventRangeHi);
-    dhFrameStream.setPoint(9, minSolventDensity.first); 
-    dhFrameStream.setPoint(10, minSolventDensity.second);
-    dhFrameStream.setPoint(11, molPath.sLo()); 
-    dhFrameStream.setPoint(12, molPath.sHi());
-    dhFrameStream.setPoint(13, deParams_.bandWidth()*deParams_.bandWidthScale());
-    dhFrameStream.finishPointSet();
-
-
-    // ADD RESIDUE DATA TO CONTAINER
-    //-------------------------------------------------------------------------
+    // CREATE OUTPUT FILES
+    // ------------------------------------------------------------------------
 
-    // get pore radius and solvent density at each residue's position:
-    std::map<int, real> poreRadiusAtResidue;
-    std::map<int, real> solventDensityAtResidue;
-    for(auto res : poreCogMappedCoords)
+    // single trajectory:
+    if( replicas.size() == 1 )
     {
-        // get residue-local radius and density:
-        real rad = molPath.radius(res.second[SS]);
-        real den = solventDensityCoordS.evaluate(res.second[SS], 0);
-
-        // add radius and density to data handle:
-        poreRadiusAtResidue[res.first] = rad;
-        solventDensityAtResidue[res.first] = den;
+        writeAggregate(
+                outputBaseFileName_ + dataSetSuffix, 
+                aggregate, 
+                std::vector<FrameAggregate>(), 
+                std::vector<std::string>());
+        return;
     }
 
-    // add mapped residues to data container:
-    dhFrameStream.selectDataSet(4);
-    for(auto it = poreCogMappedCoords.begin(); it != poreCogMappedCoords.end(); it++)
+    // results for individual replicas:
+    std::vector<std::string> replicaFileNames;
+    for(size_t k = 0; k < replicas.size(); k++)
     {
-        dhFrameStream.setPoint( 0, poreMappingSelCog.position(it -> first).mappedId());
-        dhFrameStream.setPoint( 1, it -> second[SS]);            // s
-        dhFrameStream.setPoint( 2, std::sqrt(it -> second[RR])); // rho
-        dhFrameStream.setPoint( 3, it -> second[PP]);            // phi
-        dhFrameStream.setPoint( 4, poreLining[it -> first]);     // pore lining?
-        dhFrameStream.setPoint( 5, poreFacing[it -> first]);     // pore facing?
-        dhFrameStream.setPoint( 6, poreRadiusAtResidue[it -> first]);
-        dhFrameStream.setPoint( 7, solventDensityAtResidue[it -> first]);
-        dhFrameStream.setPoint( 8, poreMappingSelCog.position(it -> first).x()[XX]);
-        dhFrameStream.setPoint( 9, poreMappingSelCog.position(it -> first).x()[YY]);
-        dhFrameStream.setPoint(10, poreMappingSelCog.position(it -> first).x()[ZZ]);
-        dhFrameStream.finishPointSet();
+        std::string replicaBaseFileName = outputBaseFileName_ + "_replica" + 
+                std::to_string(k + 1) + dataSetSuffix;
+        writeAggregate(
+                replicaBaseFileName, 
+                replicas[k], 
+                std::vector<FrameAggregate>(), 
+                std::vector<std::string>());
+        replicaFileNames.push_back(replicaBaseFileName + ".json");
     }
 
-
-    // FINISH FRAME
-    //-------------------------------------------------------------------------
-
-    // finish analysis of current frame:
-    dhFrameStream.finishFrame();
+    // ensemble results:
+    writeAggregate(
+            outputBaseFileName_ + dataSetSuffix, 
+            aggregate, 
+            replicas, 
+            replicaFileNames);
 }
 
 
-
-/*
- *
+/*!
+ * Reads the per-frame data of a single stream file and aggregates it on the
+ * given support points. Frames are read in batches and their profiles are 
+ * sampled in parallel. The number of frames is used to report progress and,
+ * unless an existing stream is re-aggregated, to check that the stream file
+ * is complete.
  */
-void
-ChapTrajectoryAnalysis::finishAnalysis(int numFrames)
+FrameAggregate
+ChapTrajectoryAnalysis::readFrameStream(
+        const std::string &inFileName,
+        const std::string &dataSetSuffix,
+        const std::vector<real> &supportPoints,
+        real anchorPointLo,
+        real anchorPointHi,
+        bool reestimateDensity,
+        int numFrames)
 {
-    // free line for neater output:
-    std::cout<<std::endl;
+    FrameStreamReader inFile;
+    inFile.setDataSetSuffix(dataSetSuffix);
 
-    // transfer file names from user input:
-    std::string inFileName = std::string("stream_") + outputJsonFileName_;
-    std::string outFileName = outputJsonFileName_;
-    std::fstream inFile;
-    std::fstream outFile;
+    // frames are read in batches and preprocessed in parallel:
+    size_t numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<FrameStreamData> frames(16*numThreads);
+    size_t numFramesInBatch = 0;
 
-    // READ PER-FRAME DATA AND AGGREGATE ALL NON-PROFILE DATA
-    // ------------------------------------------------------------------------
-
-    // openen per-frame data set for reading:
-    inFile.open(inFileName, std::fstream::in);
-
-    // prepare summary statistics for aggregate properties:
-    SummaryStatistics argMinRadiusSummary;
-    SummaryStatistics minRadiusSummary;
-    SummaryStatistics lengthSummary;
-    SummaryStatistics volumeSummary;
-    SummaryStatistics numPathSummary;
-    SummaryStatistics numSampleSummary;
-    SummaryStatistics solventRangeLoSummary;
-    SummaryStatistics solventRangeHiSummary;
-    SummaryStatistics argMinSolventDensitySummary;
-    SummaryStatistics minSolventDensitySummary;
-    SummaryStatistics arcLengthLoSummary;
-    SummaryStatistics arcLengthHiSummary;
-    SummaryStatistics bandWidthSummary;
-
-    // containers for scalar time series:
-    std::vector<real> argMinRadiusTimeSeries;
-    std::vector<real> minRadiusTimeSeries;
-    std::vector<real> lengthTimeSeries;
-    std::vector<real> volumeTimeSeries;
-    std::vector<real> numPathwayTimeSeries;
-    std::vector<real> numSampleTimeSeries;
-    std::vector<real> argMinSolventDensityTimeSeries;
-    std::vector<real> minSolventDensityTimeSeries;
-    std::vector<real> bandWidthTimeSeries;
-
-    // number of residues in pore forming group:
-    size_t numPoreRes = 0;
-    std::vector<int> poreResIds;
-
-    // container for time stamps:
-    std::vector<real> timeStamps;
-
-    // read file line by line and calculate summary statistics:
-    int linesRead = 0;
-    std::string line;
-    while( std::getline(inFile, line) )
-    {
-        // read line into JSON document:
-        rapidjson::StringStream lineStream(line.c_str());
-        rapidjson::Document lineDoc;
-        lineDoc.ParseStream(lineStream);
-
-        // sanity checks:
-        if( !lineDoc.IsObject() )
-        {
-            // FIXME this is where the JSON error occurs
-            std::string error = "Line " + std::to_string(linesRead) + 
-            " read from" + inFileName + " is not valid JSON object.";
-            throw std::runtime_error(error);
-        }
-    
-        // calculate summary statistics of aggregate variables:
-        argMinRadiusSummary.update(
-                lineDoc["pathSummary"]["argMinRadius"][0].GetDouble());
-        minRadiusSummary.update(
-                lineDoc["pathSummary"]["minRadius"][0].GetDouble());
-        lengthSummary.update(
-                lineDoc["pathSummary"]["length"][0].GetDouble());
-        volumeSummary.update(
-                lineDoc["pathSummary"]["volume"][0].GetDouble());
-        numPathSummary.update(
-                lineDoc["pathSummary"]["numPath"][0].GetDouble());
-        numSampleSummary.update(
-                lineDoc["pathSummary"]["numSample"][0].GetDouble());
-        solventRangeLoSummary.update(
-                lineDoc["pathSummary"]["solventRangeLo"][0].GetDouble());
-        solventRangeHiSummary.update(
-                lineDoc["pathSummary"]["solventRangeHi"][0].GetDouble());
-        argMinSolventDensitySummary.update(
-                lineDoc["pathSummary"]["argMinSolventDensity"][0].GetDouble());
-        minSolventDensitySummary.update(
-                lineDoc["pathSummary"]["minSolventDensity"][0].GetDouble());
-        arcLengthLoSummary.update(
-                lineDoc["pathSummary"]["arcLengthLo"][0].GetDouble());
-        arcLengthHiSummary.update(
-                lineDoc["pathSummary"]["arcLengthHi"][0].GetDouble());
-        bandWidthSummary.update(
-                lineDoc["pathSummary"]["bandWidth"][0].GetDouble());
-        
-        // get time stamp of current frame:
-        real timeStamp = lineDoc["pathSummary"]["timeStamp"][0].GetDouble();
-        timeStamps.push_back(timeStamp);
-
-        // get scalar time series data:
-        argMinRadiusTimeSeries.push_back(lineDoc["pathSummary"]["argMinRadius"][0].GetDouble());
-        minRadiusTimeSeries.push_back(lineDoc["pathSummary"]["minRadius"][0].GetDouble());
-        lengthTimeSeries.push_back(lineDoc["pathSummary"]["length"][0].GetDouble());
-        volumeTimeSeries.push_back(lineDoc["pathSummary"]["volume"][0].GetDouble());
-        numPathwayTimeSeries.push_back(lineDoc["pathSummary"]["numPath"][0].GetDouble());
-        numSampleTimeSeries.push_back(lineDoc["pathSummary"]["numSample"][0].GetDouble());
-        argMinSolventDensityTimeSeries.push_back(lineDoc["pathSummary"]["argMinSolventDensity"][0].GetDouble());
-        minSolventDensityTimeSeries.push_back(lineDoc["pathSummary"]["minSolventDensity"][0].GetDouble());
-        bandWidthTimeSeries.push_back(lineDoc["pathSummary"]["bandWidth"][0].GetDouble());
-
-        // in first line, also read number of residues in pore forming group:
-        if( linesRead == 0 )
+    // one density estimator per thread if density is re-estimated:
+    std::vector<std::unique_ptr<SolventDensityStage>> densityStages;
+    if( reestimateDensity )
+    {
+        for(size_t t = 0; t < numThreads; t++)
         {
-            numPoreRes = lineDoc["residuePositions"]["resId"].Size();
-
-            for(size_t i = 0; i < numPoreRes; i++)
-            {
-                poreResIds.push_back(
-                        lineDoc["residuePositions"]["resId"][i].GetDouble());
-            }
+            densityStages.emplace_back(new SolventDensityStage(
+                    deMethod_, 
+                    deParams_, 
+                    deBandWidth_));
         }
-
-        // increment line counter:
-        linesRead++;
     }
+    // trajectory-wide histogram only for primary parameters:
+    bool accumulateDensity = deAccumulate_ && dataSetSuffix.empty();
+    inFile.setReadSolventPositions(reestimateDensity || accumulateDensity);
 
-    // close per frame data set:
-    inFile.close();
-    
-    // sanity check:
-    if( linesRead != numFrames )
-    {
-        throw std::runtime_error("Number of frames read does not equal number"
-        "of frames analyised.");
-    }
-
-
-    // READ PER-FRAME DATA AND AGGREGATE TIME-AVERAGED PORE PROFILE
-    // ------------------------------------------------------------------------
-
-    // define set of support points for profile evaluation:
-    std::vector<real> supportPoints;
-    size_t numSupportPoints = outputNumPoints_;
-    real supportPointsLo = arcLengthLoSummary.min() - outputExtrapDist_;
-    real supportPointsHi = arcLengthHiSummary.max() + outputExtrapDist_;
+    // openen per-frame data set for reading:
+    inFile.open(inFileName);
 
-    // build support points:
-    real supportPointsStep = (supportPointsHi - supportPointsLo) / (numSupportPoints - 1);
-    for(size_t i = 0; i < numSupportPoints; i++)
+    // read file batch by batch:
+    FrameAggregate aggregate(supportPoints, anchorPointLo, anchorPointHi);
+    if( accumulateDensity )
     {
-        supportPoints.push_back(supportPointsLo + i*supportPointsStep);
+        aggregate.setSolventHistogram(deResolution_);
     }
-
-    // define anchor points at which energy is set to zero:
-    real anchorPointLo = arcLengthLoSummary.min();
-    real anchorPointHi = arcLengthHiSummary.max();
-    SummaryStatistics anchorEnergyLo;
-    SummaryStatistics anchorEnergyHi;
-
-    // open JSON data file in read mode:
-    inFile.open(inFileName.c_str(), std::fstream::in);
-    
-    // prepare containers for profile summaries:
-    std::vector<SummaryStatistics> radiusSummary(supportPoints.size());
-    std::vector<SummaryStatistics> solventDensitySummary(supportPoints.size());
-    std::vector<SummaryStatistics> energySummary(supportPoints.size());
-    std::vector<SummaryStatistics> plHydrophobicitySummary(supportPoints.size());
-    std::vector<SummaryStatistics> pfHydrophobicitySummary(supportPoints.size());
-
-    // prepare summary statistics for residue properties:
-    std::vector<SummaryStatistics> residueArcSummary(numPoreRes);
-    std::vector<SummaryStatistics> residueRhoSummary(numPoreRes);
-    std::vector<SummaryStatistics> residuePhiSummary(numPoreRes);
-    std::vector<SummaryStatistics> residuePlSummary(numPoreRes);
-    std::vector<SummaryStatistics> residuePfSummary(numPoreRes);
-    std::vector<SummaryStatistics> residuePoreRadiusSummary(numPoreRes);
-    std::vector<SummaryStatistics> residueSolventDensitySummary(numPoreRes);
-    std::vector<SummaryStatistics> residueXSummary(numPoreRes);
-    std::vector<SummaryStatistics> residueYSummary(numPoreRes);
-    std::vector<SummaryStatistics> residueZSummary(numPoreRes);
-
-    // containers for profile valued time series: 
-    std::vector<std::vector<real>> radiusProfileTimeSeries;
-    std::vector<std::vector<real>> solventDensityTimeSeries;
-    std::vector<std::vector<real>> plHydrophobicityTimeSeries;
-    std::vector<std::vector<real>> pfHydrophobicityTimeSeries;
-
-    // read file line by line:
-    int linesProcessed = 0;
-    while( std::getline(inFile, line) )
+    std::vector<FrameProfileSample> samples(frames.size());
+    while( (numFramesInBatch = readFrameBatch(inFile, frames)) > 0 )
     {
         std::cout.precision(3);
         std::cout<<"\rForming time averages, "
-                 <<(double)linesProcessed/numFrames*100
+                 <<(double)aggregate.numFrames()/numFrames*100
                  <<"\% complete"
                  <<std::flush;
 
-        // read line into JSON document:
-        rapidjson::StringStream lineStream(line.c_str());
-        rapidjson::Document lineDoc;
-        lineDoc.ParseStream(lineStream);
-
-        // sanity checks:
-        if( !lineDoc.IsObject() )
+        // sample profiles of all frames in batch in parallel:
+        parallelFor(numFramesInBatch, numThreads, [&](size_t i, size_t t)
         {
-            std::string error = "Line " + std::to_string(linesProcessed) + 
-            " read from" + inFileName + " is not valid JSON object.";
-            throw std::runtime_error(error);
-        }
-
-        // copy first frame from here for OBJ output:
-        if( linesProcessed == 0 )
-        {
-            molPathAvg_.reset(new MolecularPath(lineDoc));
-        }
-
-
-        // create molecular path:
-        MolecularPath molPath(lineDoc);
+            if( reestimateDensity )
+            {
+                reestimateSolventDensity(frames[i], *densityStages[t]);
+            }
+            aggregate.sample(frames[i], samples[i]);
+        });
 
-        // sample radius at support points and add to summary statistics:
-        std::vector<real> radiusSample = molPath.sampleRadii(supportPoints); 
-        for(size_t i = 0; i < radiusSample.size(); i++)
+        // aggregate frames in order:
+        for(size_t f = 0; f < numFramesInBatch; f++)
         {
-            radiusSummary.at(i).update(radiusSample.at(i));
+            aggregate.update(frames[f], samples[f]);
         }
+    }
 
-        // add to time series:
-        radiusProfileTimeSeries.push_back(radiusSample);
-
-        
-        // sample points from hydrophobicity splines:
-        SplineCurve1D pfHydrophobicitySpline = SplineCurve1DJsonConverter::fromJson(
-                lineDoc["pfHydrophobicitySpline"], 1);
-        std::vector<real> pfHydrophobicitySample = 
-                pfHydrophobicitySpline.evaluateMultiple(supportPoints, 0);
-        SummaryStatistics::updateMultiple(
-                pfHydrophobicitySummary,
-                pfHydrophobicitySample);
-        pfHydrophobicityTimeSeries.push_back(pfHydrophobicitySample);
-
-        SplineCurve1D plHydrophobicitySpline = SplineCurve1DJsonConverter::fromJson(
-                lineDoc["plHydrophobicitySpline"], 1);
-        std::vector<real> plHydrophobicitySample = 
-                plHydrophobicitySpline.evaluateMultiple(supportPoints, 0);
-        SummaryStatistics::updateMultiple(
-                plHydrophobicitySummary,
-                plHydrophobicitySample);
-        plHydrophobicityTimeSeries.push_back(plHydrophobicitySample);
-
-
-        // sample points from solvent density spline:
-        SplineCurve1D solventDensitySpline = SplineCurve1DJsonConverter::fromJson(
-                lineDoc["solventDensitySpline"], 1);
-        std::vector<real> solventDensitySample = 
-                solventDensitySpline.evaluateMultiple(supportPoints, 0);
-
-        // get total number of particles in sample for this time step:
-        int totalNumber = lineDoc["pathSummary"]["numSample"][0].GetDouble();
-
-        // convert to number density and add to summary statistic:
-        // TODO this should be done in per-frame analysis:
-        NumberDensityCalculator ndc;
-        solventDensitySample = ndc(
-                solventDensitySample, 
-                radiusSample, 
-                totalNumber);
-        SummaryStatistics::updateMultiple(
-                solventDensitySummary,
-                solventDensitySample);
-        solventDensityTimeSeries.push_back(solventDensitySample);
- 
-        // convert to energy and add to summary statistic:
-        BoltzmannEnergyCalculator bec;
-        std::vector<real> energySample = bec.calculate(solventDensitySample);
-        SummaryStatistics::updateMultiple(
-                energySummary,
-                energySample);
-
-        // also evaluate density and radius at anchor points:
-        real solventDensityAnchorLo = solventDensitySpline.evaluate(
-                anchorPointLo, 0);
-        real solventDensityAnchorHi = solventDensitySpline.evaluate(
-                anchorPointHi, 0);
-        real poreRadiusAnchorLo = molPath.radius(anchorPointLo);
-        real poreRadiusAnchorHi = molPath.radius(anchorPointHi);
-
-        // calculate energy at anchor points by linear interpolation:
-        LinearSplineInterp1D interp;
-        auto energySpline = interp(supportPoints, energySample);
-        anchorEnergyLo.update( energySpline.evaluate(anchorPointLo, 0) );
-        anchorEnergyHi.update( energySpline.evaluate(anchorPointHi, 0) );
-
-
-        // loop over all pore forming residues:
-        for(size_t i = 0; i < numPoreRes; i++)
-        {
-            residueArcSummary.at(i).update(
-                    lineDoc["residuePositions"]["s"][i].GetDouble());
-            residueRhoSummary.at(i).update(
-                    lineDoc["residuePositions"]["rho"][i].GetDouble());
-            residuePhiSummary.at(i).update(
-                    lineDoc["residuePositions"]["phi"][i].GetDouble());
-            residuePlSummary.at(i).update(
-                    lineDoc["residuePositions"]["poreLining"][i].GetDouble());
-            residuePfSummary.at(i).update(
-                    lineDoc["residuePositions"]["poreFacing"][i].GetDouble());
-            residueXSummary.at(i).update(
-                    lineDoc["residuePositions"]["x"][i].GetDouble());
-            residueYSummary.at(i).update(
-                    lineDoc["residuePositions"]["y"][i].GetDouble());
-            residueZSummary.at(i).update(
-                    lineDoc["residuePositions"]["z"][i].GetDouble());
-
-            // residue-local number density requires additional post-processing:
-            real rad = lineDoc["residuePositions"]["poreRadius"][i].GetDouble();
-            real den = lineDoc["residuePositions"]["solventDensity"][i].GetDouble();
-            residuePoreRadiusSummary.at(i).update(rad);
-            residueSolventDensitySummary.at(i).update(den*totalNumber/(M_PI*rad*rad));
-        }
+    // close filestream object:
+    inFile.close();
 
-        // increment line counter:
-        linesProcessed++;
+    // sanity check:
+    // (when re-aggregating, all frames are taken from the stream file)
+    if( inputStreamFileNameIsSet_ )
+    {
+        numFrames = aggregate.numFrames();
+    }
+    else if( static_cast<int>(aggregate.numFrames()) != numFrames )
+    {
+        throw std::runtime_error("Number of frames read does not equal number"
+        "of frames analyised.");
     }
-  
-    // shift of energy profile so that energy at anchor points is zero:
-    real shift = -0.5*(anchorEnergyLo.mean() + anchorEnergyHi.mean());
-    std::for_each(
-            energySummary.begin(), 
-            energySummary.end(), 
-            [this, shift](SummaryStatistics &s){s.shift(shift);});
 
     // inform user about progress:
     std::cout.precision(3);
     std::cout<<"\rForming time averages, "
-             <<(double)linesProcessed/numFrames*100
+             <<(double)aggregate.numFrames()/numFrames*100
              <<"\% complete"
              <<std::endl;
 
-    // sanity check:
-    if( linesProcessed != numFrames )
-    {
-        std::string error = "Number of lines read from JSON file does not"
-        "equal number of frames processed!"; 
-        throw std::runtime_error(error);
-    }
-
-    // close filestream object:
-    inFile.close();
-
-    
-    // CREATE PDB OUTPUT
-    // ------------------------------------------------------------------------
-
-    // assign residue pore facing and pore lining to occupency and bfac:
-    outputStructure_.setPoreFacing(residuePlSummary, residuePfSummary);
-
-    // write structure to PDB file:
-    PdbIo::write(outputPdbFileName_, outputStructure_);
+    return aggregate;
+}
 
 
+/*!
+ * Writes the time-averaged results of an aggregate to a JSON file and its 
+ * pathway with averaged properties to an OBJ file, both named after 
+ * outBaseFileName. If replicas are given, the aggregate is taken to be 
+ * their ensemble and the between-replica statistics of all profiles are 
+ * added to the JSON file, which refers to the results of the individual 
+ * replicas by the given file names.
+ */
+void
+ChapTrajectoryAnalysis::writeAggregate(
+        const std::string &outBaseFileName,
+        const FrameAggregate &aggregate,
+        const std::vector<FrameAggregate> &replicas,
+        const std::vector<std::string> &replicaFileNames)
+{
     // CREATE OUTPUT JSON
     // ------------------------------------------------------------------------
 
-    // initialise a JSON results container:
-    ResultsJsonExporter results;
-
-    // add summary statistics for scalr variables describing the pathway:
-    results.addPathwaySummary("argMinRadius", argMinRadiusSummary);
-    results.addPathwaySummary("minRadius", minRadiusSummary);
-    results.addPathwaySummary("length", lengthSummary);
-    results.addPathwaySummary("volume", volumeSummary);
-    results.addPathwaySummary("numPathway", numPathSummary);
-    results.addPathwaySummary("numSample", numSampleSummary);
-    results.addPathwaySummary("argMinSolventDensity", argMinSolventDensitySummary);
-    results.addPathwaySummary("minSolventDensity", minSolventDensitySummary);
-    results.addPathwaySummary("bandWidth", bandWidthSummary);
-
-    // add time-averaged pathway profiles:
-    results.addSupportPoints(supportPoints);
-    results.addPathwayProfile("radius", radiusSummary);
-    results.addPathwayProfile("plHydrophobicity", plHydrophobicitySummary);
-    results.addPathwayProfile("pfHydrophobicity", pfHydrophobicitySummary);
-    results.addPathwayProfile("density", solventDensitySummary);
-    results.addPathwayProfile("energy", energySummary);
-    
-    // add scalar time series data to output:
-    results.addTimeStamps(timeStamps);
-    results.addPathwayScalarTimeSeries("argMinRadius", argMinRadiusTimeSeries);
-    results.addPathwayScalarTimeSeries("minRadius", minRadiusTimeSeries);
-    results.addPathwayScalarTimeSeries("length", lengthTimeSeries);
-    results.addPathwayScalarTimeSeries("volume", volumeTimeSeries);
-    results.addPathwayScalarTimeSeries("numPathway", numPathwayTimeSeries);
-    results.addPathwayScalarTimeSeries("numSample", numSampleTimeSeries);
-    results.addPathwayScalarTimeSeries("argMinSolventDensity", argMinSolventDensityTimeSeries);
-    results.addPathwayScalarTimeSeries("minSolventDensity", minSolventDensityTimeSeries);
-    results.addPathwayScalarTimeSeries("bandWidth", bandWidthTimeSeries);
-
-    // add vector-valued time series data to output:
-    results.addPathwayGridPoints(timeStamps, supportPoints);
-    results.addPathwayProfileTimeSeries("radius", radiusProfileTimeSeries);
-    results.addPathwayProfileTimeSeries("density", solventDensityTimeSeries);
-    results.addPathwayProfileTimeSeries("plHydrophobicity", plHydrophobicityTimeSeries);
-    results.addPathwayProfileTimeSeries("pfHydrophobicity", pfHydrophobicityTimeSeries);
-
-    // add per-residue data to output document:
-    results.addResidueInformation(poreResIds, resInfo_);
-    results.addResidueSummary("s", residueArcSummary);
-    results.addResidueSummary("rho", residueRhoSummary);
-    results.addResidueSummary("phi", residuePhiSummary);
-    results.addResidueSummary("poreLining", residuePlSummary);
-    results.addResidueSummary("poreFacing", residuePfSummary);
-    results.addResidueSummary("poreRadius", residuePoreRadiusSummary);
-    results.addResidueSummary("solventDensity", residueSolventDensitySummary);
-    results.addResidueSummary("x", residueXSummary);
-    results.addResidueSummary("y", residueYSummary);
-    results.addResidueSummary("z", residueZSummary);
-
-
-    // write results to JSON file:
-    results.write(outFileName);
+    // open results file, data is streamed to it as it is added:
+    ResultsJsonStreamWriter results;
+    results.open(outBaseFileName + ".json", outputTsFormat_);
+    aggregate.writeResults(results, resInfo_);
 
+    // add information on convergence of profiles:
+    // (not available when re-aggregating)
+    if( convCheckInterval_ > 0 && !inputStreamFileNameIsSet_ )
+    {
+        results.addConvergenceInformation(
+                convergedFrame_ >= 0,
+                convergedFrame_,
+                convergedTime_);
+    }
 
-    // DELETE PER FRAME DATA
-    // ------------------------------------------------------------------------
-   
-    // detailed output requested?
-    if( !outputDetailed_ )
+    // add variation of profiles between replicas:
+    if( !replicas.empty() )
     {
-        // remove streaming JSON file:
-        std::remove(inFileName.c_str());
+        results.addEnsembleInformation(replicaFileNames);
+        for(auto profile : {"radius", "plHydrophobicity", "pfHydrophobicity",
+                            "density", "energy"})
+        {
+            results.addEnsembleProfile(
+                    profile, 
+                    FrameAggregate::ensembleProfile(replicas, profile));
+        }
     }
 
+    // complete results file:
+    results.close();
+
+
     // EXPORT PATHWAY TO OBJ FILE
     // ------------------------------------------------------------------------
 
-    // retrieve averaged properties:
-    std::vector<real> avgRadius;
-    std::vector<real> avgSolventDensity;
-    std::vector<real> avgEnergy;
-    std::vector<real> avgPlHydrophobicity;
-    std::vector<real> avgPfHydrophobicity;
-    for(size_t i = 0; i < supportPoints.size(); i++)
-    {
-        avgRadius.push_back(radiusSummary.at(i).mean());
-        avgSolventDensity.push_back(solventDensitySummary.at(i).mean());
-        avgEnergy.push_back(energySummary.at(i).mean());
-        avgPlHydrophobicity.push_back(plHydrophobicitySummary.at(i).mean());
-        avgPfHydrophobicity.push_back(pfHydrophobicitySummary.at(i).mean());
-    }
-
-    // averaged properties as spline curves:
-    CubicSplineInterp1D interp;
-    auto avgRadiusSpl = interp(
-            supportPoints, 
-            avgRadius, 
-            eSplineInterpBoundaryHermite);
-    auto avgSolventDensitySpl = interp(
-            supportPoints, 
-            avgSolventDensity, 
-            eSplineInterpBoundaryHermite);
-    auto avgEnergySpl = interp(
-            supportPoints, 
-            avgEnergy, 
-            eSplineInterpBoundaryHermite);
-    auto avgPlHydrophobicitySpl = interp(
-            supportPoints, 
-            avgPlHydrophobicity, 
-            eSplineInterpBoundaryHermite);
-    auto avgPfHydrophobicitySpl = interp(
-            supportPoints, 
-            avgPfHydrophobicity, 
-            eSplineInterpBoundaryHermite);
-
-
-    // associate properties with pathway:
-    molPathAvg_ -> addScalarProperty("avg_radius", avgRadiusSpl, false);
-    molPathAvg_ -> addScalarProperty("avg_density", avgSolventDensitySpl, false);
-    // FIXME: NaN energy values can not be exported to OBJ!
-    molPathAvg_ -> addScalarProperty("avg_energy", avgEnergySpl, false);
-    molPathAvg_ -> addScalarProperty("avg_pl_hydrophobicity", avgPlHydrophobicitySpl, true);
-    molPathAvg_ -> addScalarProperty("avg_pf_hydrophobicity", avgPfHydrophobicitySpl, true);
-
-    // load colour palettes from JSON file:
-    std::string paletteFilePath = chapInstallBase() + 
-            std::string("/chap/share/data/palettes/");
-    std::string paletteFileName = paletteFilePath + "default.json";
-    auto palettes = ColourPaletteProvider::fromJsonFile(paletteFileName);
+    // pathway of first frame with averaged properties:
+    molPathAvg_.reset(new MolecularPath(aggregate.averagePath()));
+
+    // load colour palettes from built-in JSON data:
+    JsonDocImporter jdi;
+    auto palettes = ColourPaletteProvider::fromJsonDoc(
+            jdi.fromBuiltin("palettes/default.json"));
 
     // export pathway to file:
     MolecularPathObjExporter mpexp;
     mpexp.setExtrapDist(outputExtrapDist_);
     mpexp.setGridSampleDist(outputGridSampleDist_);
     mpexp.setCorrectionThreshold(outputCorrectionThreshold_);
+    mpexp.setPrecision(outputObjPrecision_);
+    mpexp.setMeshFormat(outputMeshFormat_);
     mpexp(
-        outputBaseFileName_, 
+        outBaseFileName, 
         "time_averaged_molecular_path", 
         *molPathAvg_,
         palettes);
 }
 
 
+/*!
+ * Writes a partial aggregate to a shard file together with the output 
+ * settings and residue information needed to create the final output from 
+ * merged shards without access to the topology (see ChapMerge).
+ */
+void
+ChapTrajectoryAnalysis::writeShard(
+        const std::string &fileName,
+        const FrameAggregate &aggregate) const
+{
+    rapidjson::Document doc;
+    doc.SetObject();
+    rapidjson::Document::AllocatorType &alloc = doc.GetAllocator();
+
+    // output settings:
+    rapidjson::Value settings(rapidjson::kObjectType);
+    settings.AddMember("extrapDist", outputExtrapDist_, alloc);
+    settings.AddMember("gridSampleDist", outputGridSampleDist_, alloc);
+    settings.AddMember("correctionThreshold", outputCorrectionThreshold_, alloc);
+    settings.AddMember("objPrecision", outputObjPrecision_, alloc);
+    settings.AddMember("meshFormat", static_cast<int>(outputMeshFormat_), alloc);
+    settings.AddMember("tsFormat", static_cast<int>(outputTsFormat_), alloc);
+    doc.AddMember("settings", settings, alloc);
+
+    // information on pore forming residues:
+    rapidjson::Value residues(rapidjson::kArrayType);
+    for(auto id : aggregate.poreResIds())
+    {
+        rapidjson::Value residue(rapidjson::kObjectType);
+        residue.AddMember("id", id, alloc);
+        residue.AddMember(
+                "name", 
+                rapidjson::Value(resInfo_.name(id).c_str(), alloc), 
+                alloc);
+        residue.AddMember(
+                "chain", 
+                rapidjson::Value(resInfo_.chain(id).c_str(), alloc), 
+                alloc);
+        residue.AddMember("hydrophobicity", resInfo_.hydrophobicity(id), alloc);
+        residues.PushBack(residue, alloc);
+    }
+    doc.AddMember("residues", residues, alloc);
+
+    // structure to which pore-lining attributes are assigned:
+    // (written next to the shard, so stored relative to it)
+    doc.AddMember(
+            "pdbFile", 
+            rapidjson::Value(
+                    ChapMerge::shardRelativePath(outputPdbFileName_).c_str(), 
+                    alloc), 
+            alloc);
+
+    // partial aggregate:
+    doc.AddMember("aggregate", aggregate.toJson(alloc), alloc);
+
+    // stringify document, energies may be infinite:
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<
+            rapidjson::StringBuffer,
+            rapidjson::UTF8<>,
+            rapidjson::UTF8<>,
+            rapidjson::CrtAllocator,
+            rapidjson::kWriteNanAndInfFlag> writer(buffer);
+    doc.Accept(writer);
+
+    // write to file:
+    std::ofstream file(fileName);
+    if( !file )
+    {
+        throw std::runtime_error("ERROR: Could not open file " + fileName + 
+                                 ".");
+    }
+    file.write(buffer.GetString(), buffer.GetSize());
+    file<<std::endl;
+}
+
+
 /*!
  *
  */
@@ -1948,6 +1953,171 @@ ChapTrajectoryAnalysis::writeOutput()
 }
 
 
+/*
+ * Auxiliary function returning the k-th value of a parameter sweep list. A 
+ * list with a single value applies to all parameter sets and an empty list 
+ * falls back to the given value.
+ */
+template<typename T>
+static T
+sweepValue(const std::vector<T> &values, size_t k, T fallback)
+{
+    if( values.empty() )
+    {
+        return fallback;
+    }
+    if( values.size() == 1 )
+    {
+        return values.front();
+    }
+    return values.at(k);
+}
+
+
+/*!
+ * Auxiliary function that assembles the stages of the per-frame analysis in
+ * the order in which their inputs become available. Stages that are optional
+ * are only added if they are requested, stages that the user asked to skip
+ * are added, but disabled, so that the frame stream keeps its structure.
+ * Stages with side effects beyond the frame stream (convergence monitoring 
+ * and the mesh sequence) are only added to the primary pipeline, which 
+ * analyses the main trajectory, whether it is processed by the Gromacs 
+ * runner or read directly.
+ */
+void
+ChapTrajectoryAnalysis::initFramePipeline(
+        FrameAnalysisPipeline &pipeline,
+        const FrameSelections &selections,
+        bool primary)
+{
+    // which optional stages are skipped?
+    bool skipHydrophobicity = std::find(
+            skipStages_.begin(), 
+            skipStages_.end(), 
+            eFrameAnalysisSkipHydrophobicity) != skipStages_.end();
+    bool skipSolvent = std::find(
+            skipStages_.begin(), 
+            skipStages_.end(), 
+            eFrameAnalysisSkipSolvent) != skipStages_.end();
+    bool hasSolvent = !solventSel_.empty() && !skipSolvent;
+
+    // path finding:
+    std::unique_ptr<PathFindingStage> pathFinding(new PathFindingStage(
+            selections.pathway_, 
+            selections.ipp_, 
+            vdwRadii_));
+    pathFinding -> setPathFindingMethod(pfMethod_, pfPar_, pfParams_);
+    pathFinding -> setChanDirVec(pfChanDirVec_);
+    pathFinding -> setPathAlignmentMethod(pfPathAlignmentMethod_);
+    if( pfInitProbePosIsSet_ )
+    {
+        pathFinding -> setInitProbePos(pfInitProbePos_);
+    }
+    pipeline.addStage(std::move(pathFinding));
+
+    // pore residues and hydrophobicity:
+    pipeline.addStage(
+            std::unique_ptr<AbstractFrameAnalysisStage>(
+                    new PoreResidueMappingStage(
+                            selections.poreMappingSelCol_,
+                            selections.poreMappingCal_,
+                            selections.poreMappingCog_,
+                            poreMappingMargin_,
+                            findPfResidues_)));
+    pipeline.addStage(
+            std::unique_ptr<AbstractFrameAnalysisStage>(
+                    new HydrophobicityProfileStage(
+                            resInfo_,
+                            hydrophobKernelParams_,
+                            hpBandWidth_)));
+
+    // solvent:
+    pipeline.addStage(
+            std::unique_ptr<AbstractFrameAnalysisStage>(
+                    new SolventMappingStage(
+                            selections.solvMappingSelCol_,
+                            selections.solvMappingCog_,
+                            !solventSel_.empty())));
+    pipeline.addStage(
+            std::unique_ptr<AbstractFrameAnalysisStage>(
+                    new SolventDensityStage(
+                            deMethod_,
+                            deParams_,
+                            deBandWidth_)));
+
+    // additional density estimation and hydrophobicity parameters:
+    if( numSweepSets_ > 0 )
+    {
+        std::unique_ptr<ParameterSweepStage> sweep(new ParameterSweepStage(
+                resInfo_, 
+                !skipHydrophobicity, 
+                !skipSolvent));
+        for(size_t k = 0; k < numSweepSets_; k++)
+        {
+            eDensityEstimator method = sweepValue(sweepDeMethod_, k, deMethod_);
+            real deBandWidth = sweepValue(sweepDeBandWidth_, k, deBandWidth_);
+            real hpBandWidth = sweepValue(sweepHpBandWidth_, k, hpBandWidth_);
+            sweep -> addParameterSet(
+                    method,
+                    densityEstimationParameters(method, deBandWidth),
+                    deBandWidth,
+                    hydrophobicityKernelParameters(hpBandWidth),
+                    hpBandWidth);
+        }
+        pipeline.addStage(std::move(sweep));
+    }
+
+    // convergence monitoring:
+    if( primary && convCheckInterval_ > 0 )
+    {
+        pipeline.addStage(
+                std::unique_ptr<AbstractFrameAnalysisStage>(
+                        new ConvergenceMonitoringStage(
+                                outputNumPoints_,
+                                outputExtrapDist_,
+                                convCheckInterval_,
+                                convTolRadius_,
+                                convTolEnergy_,
+                                hasSolvent,
+                                convergedFrame_,
+                                convergedTime_)));
+    }
+
+    // output:
+    pipeline.addStage(
+            std::unique_ptr<AbstractFrameAnalysisStage>(
+                    new PathSummaryStage()));
+    pipeline.addStage(
+            std::unique_ptr<AbstractFrameAnalysisStage>(
+                    new PoreResidueOutputStage()));
+    if( primary && outputMeshStride_ > 0 )
+    {
+        pipeline.addStage(
+                std::unique_ptr<AbstractFrameAnalysisStage>(
+                        new MeshSequenceStage(
+                                meshSequence_,
+                                outputMeshStride_,
+                                outputExtrapDist_,
+                                outputGridSampleDist_,
+                                outputCorrectionThreshold_)));
+    }
+
+    // disable skipped stages:
+    if( skipHydrophobicity )
+    {
+        pipeline.setStageEnabled("hydrophobicity", false);
+    }
+    if( skipSolvent )
+    {
+        pipeline.setStageEnabled("solvent", false);
+        pipeline.setStageEnabled("density", false);
+    }
+
+    // run independent stages concurrently?
+    pipeline.setConcurrent(concurrentStages_);
+}
+
+
 /*!
  * Auxiliary function to find the name of the NDX file (given with the -n flag)
  * directly from the command line call string, as there seems to be no
@@ -1978,6 +2148,33 @@ ChapTrajectoryAnalysis::obtainNdxFilePathInfo()
 }
 
 
+/*!
+ * Auxiliary function to find the name of the trajectory file (given with the 
+ * -f flag) from the command line call string in the same way as for the NDX
+ * file. The name is empty if no trajectory was given.
+ */
+void
+ChapTrajectoryAnalysis::obtainTrajectoryFilePathInfo()
+{
+    // name of trajectory file flag:
+    std::string flagName = " -f ";
+
+    // find name of trajectory file from command line:
+    std::string callString = chapCommandLine();
+    auto startPos = callString.find(flagName);
+    if( startPos == std::string::npos )
+    {
+        trajectoryFileName_ = "";
+    }
+    else
+    {
+        startPos += flagName.size();
+        auto substrLen = callString.find(" ", startPos) - startPos;
+        trajectoryFileName_ = callString.substr(startPos, substrLen);
+    }
+}
+
+
 /*! 
  * Auxiliary function for checking the validity of various input parameters. 
  * Bundled here to keep initAnalysis() uncluttered.
@@ -2010,6 +2207,73 @@ ChapTrajectoryAnalysis::checkParameters()
         throw std::runtime_error("Parameter -out-vis-teak must be in interval "
                                  "(-1, 1).");
     }
+    if( outputObjPrecision_ < 1 )
+    {
+        throw std::runtime_error("Parameter -out-obj-precision must be "
+                                 "strictly positive.");
+    }
+    if( outputMeshStride_ < 0 )
+    {
+        throw std::runtime_error("Parameter -out-mesh-stride may not be "
+                                 "negative.");
+    }
+    if( outputProfileRangeIsSet_ && 
+        outputProfileRange_.at(0) >= outputProfileRange_.at(1) )
+    {
+        throw std::runtime_error("Lower bound of -out-profile-range must be "
+                                 "smaller than upper bound.");
+    }
+    if( outputShard_ && !outputProfileRangeIsSet_ )
+    {
+        throw std::runtime_error("Parameter -out-shard requires "
+                                 "-out-profile-range to be set, so that all "
+                                 "shards sample profiles at the same "
+                                 "support points.");
+    }
+    if( outputShard_ && convCheckInterval_ > 0 )
+    {
+        throw std::runtime_error("Parameter -conv-check-interval can not be "
+                                 "used with -out-shard, as convergence can "
+                                 "only be assessed on the full "
+                                 "trajectory.");
+    }
+    if( !replicaFileNames_.empty() && outputShard_ )
+    {
+        throw std::runtime_error("Parameter -replicas can not be used with "
+                                 "-out-shard.");
+    }
+    if( !replicaFileNames_.empty() && convCheckInterval_ > 0 )
+    {
+        throw std::runtime_error("Parameter -conv-check-interval can not be "
+                                 "used with -replicas, as all replicas must "
+                                 "be analysed over their full length.");
+    }
+    if( readAhead_ < 1 )
+    {
+        throw std::runtime_error("Parameter -read-ahead must be strictly "
+                                 "positive.");
+    }
+    if( !replicaFileNames_.empty() && inputStreamFileNameIsSet_ )
+    {
+        throw std::runtime_error("Parameter -replicas can not be used with "
+                                 "-in-stream.");
+    }
+
+
+    // CONVERGENCE PARAMETERS
+    //-------------------------------------------------------------------------
+
+    // sanity checks:
+    if( convCheckInterval_ < 0 )
+    {
+        throw std::runtime_error("Parameter -conv-check-interval may not be "
+                                 "negative.");
+    }
+    if( convTolRadius_ <= 0.0 || convTolEnergy_ <= 0.0 )
+    {
+        throw std::runtime_error("Convergence tolerances must be strictly "
+                                 "positive.");
+    }
 
 
     // PATH FINDING PARAMETERS
@@ -2050,18 +2314,14 @@ ChapTrajectoryAnalysis::checkParameters()
     // DENSITY ESTIMATION PARAMETERS
     //-------------------------------------------------------------------------
 
-    // which estimator will be used?
-    if( deMethod_ == eDensityEstimatorHistogram )
-    {
-        deParams_.setBinWidth(deResolution_);
-    }
-    else if( deMethod_ == eDensityEstimatorKernel )
+    // set parameters for selected estimator:
+    deParams_ = densityEstimationParameters(deMethod_, deBandWidth_);
+
+    // trajectory-wide histogram needs a common bin width:
+    if( deAccumulate_ && deMethod_ != eDensityEstimatorHistogram )
     {
-        deParams_.setKernelFunction(eKernelFunctionGaussian);
-        deParams_.setBandWidth(deBandWidth_);
-        deParams_.setBandWidthScale(deBandWidthScale_);
-        deParams_.setEvalRangeCutoff(deEvalRangeCutoff_);
-        deParams_.setMaxEvalPointDist(deResolution_);
+        throw std::runtime_error("Parameter -de-accumulate requires "
+                                 "-de-method histogram.");
     }
 
     
@@ -2071,9 +2331,85 @@ ChapTrajectoryAnalysis::checkParameters()
     // parameters for the hydrophobicity kernel:
     hpResolution_ = deResolution_;
     hpEvalRangeCutoff_ = deEvalRangeCutoff_;
-    hydrophobKernelParams_.setKernelFunction(eKernelFunctionGaussian);
-    hydrophobKernelParams_.setBandWidth(hpBandWidth_);
-    hydrophobKernelParams_.setEvalRangeCutoff(hpEvalRangeCutoff_);
-    hydrophobKernelParams_.setMaxEvalPointDist(hpResolution_);
+    hydrophobKernelParams_ = hydrophobicityKernelParameters(hpBandWidth_);
+
+
+    // PARAMETER SWEEP
+    //-------------------------------------------------------------------------
+
+    // number of parameter sets is given by longest list:
+    numSweepSets_ = std::max(
+            sweepDeMethod_.size(), 
+            std::max(sweepDeBandWidth_.size(), sweepHpBandWidth_.size()));
+
+    // all other lists must be of the same length or contain a single value:
+    std::vector<size_t> sweepListSizes = {sweepDeMethod_.size(),
+                                          sweepDeBandWidth_.size(),
+                                          sweepHpBandWidth_.size()};
+    for(auto size : sweepListSizes)
+    {
+        if( size > 1 && size != numSweepSets_ )
+        {
+            throw std::runtime_error("ERROR: Parameters -sweep-de-method, "
+                                     "-sweep-de-bandwidth, and "
+                                     "-sweep-hydrophob-bandwidth must have "
+                                     "the same number of values or a single "
+                                     "value.");
+        }
+    }
+    for(auto bandWidth : sweepHpBandWidth_)
+    {
+        if( bandWidth <= 0.0 )
+        {
+            throw std::runtime_error("ERROR: Parameter "
+                                     "-sweep-hydrophob-bandwidth must be "
+                                     "strictly positive.");
+        }
+    }
+}
+
+
+/*!
+ * Auxiliary function that assembles the parameters of the density estimator
+ * of the given method. All parameters except the bandwidth are taken from 
+ * the de-* options.
+ */
+DensityEstimationParameters
+ChapTrajectoryAnalysis::densityEstimationParameters(
+        eDensityEstimator method,
+        real bandWidth) const
+{
+    // which estimator will be used?
+    DensityEstimationParameters params;
+    if( method == eDensityEstimatorHistogram )
+    {
+        params.setBinWidth(deResolution_);
+    }
+    else if( method == eDensityEstimatorKernel )
+    {
+        params.setKernelFunction(eKernelFunctionGaussian);
+        params.setBandWidth(bandWidth);
+        params.setBandWidthScale(deBandWidthScale_);
+        params.setEvalRangeCutoff(deEvalRangeCutoff_);
+        params.setMaxEvalPointDist(deResolution_);
+    }
+    return params;
+}
+
+
+/*!
+ * Auxiliary function that assembles the parameters of the kernel smoother
+ * used for hydrophobicity profiles with the given bandwidth.
+ */
+DensityEstimationParameters
+ChapTrajectoryAnalysis::hydrophobicityKernelParameters(
+        real bandWidth) const
+{
+    DensityEstimationParameters params;
+    params.setKernelFunction(eKernelFunctionGaussian);
+    params.setBandWidth(bandWidth);
+    params.setEvalRangeCutoff(hpEvalRangeCutoff_);
+    params.setMaxEvalPointDist(hpResolution_);
+    return params;
 }
 
@@ -0,0 +1,242 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+
+#include "trajectory-analysis/frame_analysis_pipeline.hpp"
+
+
+/*!
+ * Constructor. Creates an empty pipeline that runs stages serially.
+ */
+FrameAnalysisPipeline::FrameAnalysisPipeline()
+    : numLevels_(0)
+    , available_(0)
+    , producerLevel_(8*sizeof(unsigned int), -1)
+    , concurrent_(false)
+{
+
+}
+
+
+/*!
+ * Adds a stage to the end of the pipeline. Throws an exception if any of the
+ * stage's inputs is not produced by a previously added stage or if any of its
+ * outputs is already produced by another stage.
+ */
+void
+FrameAnalysisPipeline::addStage(
+        std::unique_ptr<AbstractFrameAnalysisStage> stage)
+{
+    // all inputs must be available:
+    if( (stage -> inputs() & ~available_) != 0 )
+    {
+        throw std::logic_error("ERROR: Frame analysis stage " + 
+                               stage -> name() + " requires data that is "
+                               "not produced by any previous stage.");
+    }
+
+    // each output may only be produced once:
+    if( (stage -> outputs() & available_) != 0 )
+    {
+        throw std::logic_error("ERROR: Frame analysis stage " + 
+                               stage -> name() + " produces data that is "
+                               "already produced by a previous stage.");
+    }
+
+    // stage runs on level after its latest input has been produced:
+    int level = 0;
+    for(size_t bit = 0; bit < producerLevel_.size(); bit++)
+    {
+        if( stage -> inputs() & (1u << bit) )
+        {
+            level = std::max(level, producerLevel_[bit] + 1);
+        }
+    }
+
+    // register outputs:
+    for(size_t bit = 0; bit < producerLevel_.size(); bit++)
+    {
+        if( stage -> outputs() & (1u << bit) )
+        {
+            producerLevel_[bit] = level;
+        }
+    }
+    available_ |= stage -> outputs();
+
+    // add stage to pipeline:
+    numLevels_ = std::max(numLevels_, level + 1);
+    levels_.push_back(level);
+    stages_.push_back(std::move(stage));
+}
+
+
+/*!
+ * Enables or disables the stage of the given name. Throws an exception if 
+ * there is no such stage.
+ */
+void
+FrameAnalysisPipeline::setStageEnabled(const std::string &name, bool enabled)
+{
+    for(auto &stage : stages_)
+    {
+        if( stage -> name() == name )
+        {
+            stage -> setEnabled(enabled);
+            return;
+        }
+    }
+
+    throw std::logic_error("ERROR: No frame analysis stage named " + name + 
+                           ".");
+}
+
+
+/*!
+ * Sets whether stages on the same level are run concurrently.
+ */
+void
+FrameAnalysisPipeline::setConcurrent(bool concurrent)
+{
+    concurrent_ = concurrent;
+}
+
+
+/*!
+ * Returns the number of stages in the pipeline.
+ */
+size_t
+FrameAnalysisPipeline::numStages() const
+{
+    return stages_.size();
+}
+
+
+/*!
+ * Returns the names of the stages on each level in the order in which levels
+ * are run.
+ */
+std::vector<std::vector<std::string>>
+FrameAnalysisPipeline::schedule() const
+{
+    std::vector<std::vector<std::string>> names(numLevels_);
+    for(size_t i = 0; i < stages_.size(); i++)
+    {
+        names[levels_[i]].push_back(stages_[i] -> name());
+    }
+
+    return names;
+}
+
+
+/*!
+ * Runs all stages on the frame described by the given context. Within each 
+ * level, the prepare() hooks are called serially first, then all stages are 
+ * evaluated (or skipped), possibly concurrently, and finally the write() 
+ * hooks are called serially in the order in which stages were added. 
+ * Exceptions thrown by any stage are passed on to the caller.
+ */
+void
+FrameAnalysisPipeline::run(FrameAnalysisContext &ctx)
+{
+    for(int level = 0; level < numLevels_; level++)
+    {
+        // collect stages on this level:
+        std::vector<AbstractFrameAnalysisStage*> levelStages;
+        for(size_t i = 0; i < stages_.size(); i++)
+        {
+            if( levels_[i] == level )
+            {
+                levelStages.push_back(stages_[i].get());
+            }
+        }
+
+        // serial preparation:
+        for(auto stage : levelStages)
+        {
+            if( stage -> isEnabled() )
+            {
+                stage -> prepare(ctx);
+            }
+        }
+
+        // evaluate stages:
+        if( concurrent_ && levelStages.size() > 1 )
+        {
+            // launch all but first stage asynchronously:
+            std::vector<std::future<void>> futures;
+            for(size_t i = 1; i < levelStages.size(); i++)
+            {
+                AbstractFrameAnalysisStage *stage = levelStages[i];
+                futures.push_back(std::async(
+                        std::launch::async,
+                        [this, stage, &ctx](){runStage(*stage, ctx);}));
+            }
+
+            // run first stage on this thread and wait for the others:
+            runStage(*levelStages.front(), ctx);
+            for(auto &future : futures)
+            {
+                future.get();
+            }
+        }
+        else
+        {
+            for(auto stage : levelStages)
+            {
+                runStage(*stage, ctx);
+            }
+        }
+
+        // serial output:
+        for(auto stage : levelStages)
+        {
+            stage -> write(ctx);
+        }
+    }
+}
+
+
+/*!
+ * Evaluates the given stage or calls its skip() hook if it is disabled.
+ */
+void
+FrameAnalysisPipeline::runStage(
+        AbstractFrameAnalysisStage &stage,
+        FrameAnalysisContext &ctx)
+{
+    if( stage.isEnabled() )
+    {
+        stage.evaluate(ctx);
+    }
+    else
+    {
+        stage.skip(ctx);
+    }
+}
+
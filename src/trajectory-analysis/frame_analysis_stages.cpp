@@ -0,0 +1,1248 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+#include "trajectory-analysis/frame_analysis_stages.hpp"
+
+#include "aggregation/boltzmann_energy_calculator.hpp"
+#include "aggregation/number_density_calculator.hpp"
+
+#include "io/molecular_path_obj_exporter.hpp"
+
+#include "path-finding/inplane_optimised_probe_path_finder.hpp"
+#include "path-finding/naive_cylindrical_path_finder.hpp"
+
+#include "statistics/amise_optimal_bandwidth_estimator.hpp"
+#include "statistics/histogram_density_estimator.hpp"
+#include "statistics/kernel_density_estimator.hpp"
+#include "statistics/weighted_kernel_density_estimator.hpp"
+
+
+/*
+ * Auxiliary function returning a linear spline that is constant over the 
+ * range covered by the centre line of the given pathway. Used as neutral 
+ * profile for skipped stages.
+ */
+static SplineCurve1D
+constantProfile(const MolecularPath &molPath, real value)
+{
+    std::vector<real> knots = molPath.centreLineUniqueKnots();
+    real lo = knots.front();
+    real hi = knots.back();
+    return SplineCurve1D(1, {lo, lo, hi, hi}, {value, value});
+}
+
+
+/*
+ * Auxiliary function for adding a linear spline curve's parameters to the 
+ * currently selected data set.
+ */
+static void
+writeSplineCurve(SplineCurve1D &spl, gmx::AnalysisDataHandle &dh)
+{
+    std::vector<real> knots = spl.uniqueKnots();
+    std::vector<real> ctrlPoints = spl.ctrlPoints();
+    for(size_t i = 0; i < ctrlPoints.size(); i++)
+    {
+        dh.setPoint(0, knots.at(i));
+        dh.setPoint(1, ctrlPoints.at(i));
+        dh.finishPointSet();
+    }
+}
+
+
+// PATH FINDING
+//-----------------------------------------------------------------------------
+
+/*!
+ * Constructor. The initial probe position is recalculated in every frame as 
+ * the centre of mass of ippSel, unless a fixed position is set with 
+ * setInitProbePos(). The vdwRadii map van der Waals radii to the mapped IDs
+ * of the atoms in pathwaySel.
+ */
+PathFindingStage::PathFindingStage(
+        const gmx::Selection &pathwaySel,
+        const gmx::Selection &ippSel,
+        const std::unordered_map<int, real> &vdwRadii)
+    : AbstractFrameAnalysisStage("path", 0, eFrameDataPath)
+    , pathwaySel_(pathwaySel)
+    , ippSel_(ippSel)
+    , method_(ePathFindingMethodInplaneOptimised)
+    , initProbePosIsSet_(false)
+    , initProbePos_(0.0, 0.0, 0.0)
+    , chanDirVec_(0.0, 0.0, 1.0)
+    , pathAlignmentMethod_(ePathAlignmentMethodNone)
+    , vdwRadii_(vdwRadii)
+{
+    // resolve radii in order of selection positions once for all frames:
+    updateSelectionVdwRadii(pathwaySel_);
+}
+
+
+/*!
+ * Sets the path finding method and its parameters.
+ */
+void
+PathFindingStage::setPathFindingMethod(
+        ePathFindingMethod method,
+        const std::map<std::string, real> &par,
+        const PathFindingParameters &params)
+{
+    method_ = method;
+    par_ = par;
+    params_ = params;
+}
+
+
+/*!
+ * Sets a fixed initial probe position to be used in all frames.
+ */
+void
+PathFindingStage::setInitProbePos(const std::vector<real> &initProbePos)
+{
+    initProbePos_ = gmx::RVec(initProbePos[XX], 
+                              initProbePos[YY], 
+                              initProbePos[ZZ]);
+    initProbePosIsSet_ = true;
+}
+
+
+/*!
+ * Sets the channel direction vector.
+ */
+void
+PathFindingStage::setChanDirVec(const std::vector<real> &chanDirVec)
+{
+    chanDirVec_ = gmx::RVec(chanDirVec[XX], chanDirVec[YY], chanDirVec[ZZ]);
+}
+
+
+/*!
+ * Sets the method used to align the pathway across frames.
+ */
+void
+PathFindingStage::setPathAlignmentMethod(ePathAlignmentMethod method)
+{
+    pathAlignmentMethod_ = method;
+}
+
+
+/*!
+ * Finds the permeation pathway and stores it in the context.
+ */
+void
+PathFindingStage::evaluate(FrameAnalysisContext &ctx)
+{
+    // get thread-local selection:
+    const gmx::Selection refSelection = ctx.selection(pathwaySel_);
+
+    // recalculate initial probe position based on reference group COM:
+    if( initProbePosIsSet_ == false )
+    {  
+        // load data into initial position selection:
+        const gmx::Selection initPosSelection = ctx.selection(ippSel_);
+ 
+        // initialse total mass and COM vector:
+        real totalMass = 0.0;
+        gmx::RVec centreOfMass(0.0, 0.0, 0.0);
+        
+        // loop over all atoms: 
+        for(int i = 0; i < initPosSelection.atomCount(); i++)
+        {
+            // get i-th atom position:
+            gmx::SelectionPosition atom = initPosSelection.position(i);
+
+            // add to total mass:
+            totalMass += atom.mass();
+
+            // add to COM vector:
+            centreOfMass[XX] += atom.mass() * atom.x()[XX];
+            centreOfMass[YY] += atom.mass() * atom.x()[YY];
+            centreOfMass[ZZ] += atom.mass() * atom.x()[ZZ];
+        }
+
+        // scale COM vector by total MASS:
+        centreOfMass[XX] /= 1.0 * totalMass;
+        centreOfMass[YY] /= 1.0 * totalMass;
+        centreOfMass[ZZ] /= 1.0 * totalMass; 
+
+        // set initial probe position:
+        initProbePos_ = centreOfMass;
+    }
+    ctx.initProbePos_ = initProbePos_;
+
+    // radii only need to be realigned if dynamic selection has changed:
+    if( refSelection.isDynamic() )
+    {
+        updateSelectionVdwRadii(refSelection);
+    }
+
+    // create path finding module:
+    std::unique_ptr<AbstractPathFinder> pfm;
+    if( method_ == ePathFindingMethodInplaneOptimised )
+    {
+        // create inplane-optimised path finder:
+        pfm.reset(new InplaneOptimisedProbePathFinder(par_,
+                                                      initProbePos_,
+                                                      chanDirVec_,
+                                                      ctx.pbc_,
+                                                      refSelection,
+                                                      selVdwRadii_));        
+    }
+    else if( method_ == ePathFindingMethodNaiveCylindrical )
+    {        
+        // create the naive cylindrical path finder:
+        pfm.reset(new NaiveCylindricalPathFinder(par_,
+                                                 initProbePos_,
+                                                 chanDirVec_));
+    }
+
+    // set parameters:
+    pfm -> setParameters(params_);
+
+    // run path finding algorithm on current frame:
+    pfm -> findPath();
+
+    // retrieve molecular path object:
+    ctx.molPath_.reset(new MolecularPath(pfm -> getMolecularPath()));
+    
+    // map initial probe position onto pathway:
+    // (this also builds the lookup table used in mapping particles, so that
+    // later stages can map particles concurrently)
+    std::vector<gmx::RVec> ipp(1, initProbePos_);
+    std::vector<gmx::RVec> mappedIpp = ctx.molPath_ -> mapPositions(ipp);
+
+    // shift coordinates of molecular path if requested:
+    if( pathAlignmentMethod_ == ePathAlignmentMethodIpp )
+    {
+        ctx.molPath_ -> shift(mappedIpp.front());
+        ctx.molPath_ -> mapPositions(ipp);
+    }
+}
+
+
+/*!
+ * Adds path points and spline parameters to data sets 1, 2, and 3.
+ */
+void
+PathFindingStage::write(FrameAnalysisContext &ctx)
+{
+    MolecularPath &molPath = *ctx.molPath_;
+    gmx::AnalysisDataHandle &dh = *ctx.dataHandle_;
+
+    // get original path points and radii:
+    std::vector<gmx::RVec> pathPoints = molPath.pathPoints();
+    std::vector<real> pathRadii = molPath.pathRadii();
+
+    // add original path points to frame stream dataset:
+    dh.selectDataSet(1);
+    for(size_t i = 0; i < pathPoints.size(); i++)
+    {
+        dh.setPoint(0, pathPoints.at(i)[XX]);
+        dh.setPoint(1, pathPoints.at(i)[YY]);
+        dh.setPoint(2, pathPoints.at(i)[ZZ]);
+        dh.setPoint(3, pathRadii.at(i));
+        dh.finishPointSet();
+    }
+
+    // add radius spline knots and control points to frame stream dataset:
+    dh.selectDataSet(2);
+    std::vector<real> radiusKnots = molPath.poreRadiusUniqueKnots();    
+    std::vector<real> radiusCtrlPoints = molPath.poreRadiusCtrlPoints();
+    for(size_t i = 0; i < radiusKnots.size(); i++)
+    {
+        dh.setPoint(0, radiusKnots.at(i));
+        dh.setPoint(1, radiusCtrlPoints.at(i));
+        dh.finishPointSet();
+    }
+    
+    // add centre line spline knots and control points to frame stream dataset:
+    dh.selectDataSet(3);
+    std::vector<real> centreLineKnots = molPath.centreLineUniqueKnots();    
+    std::vector<gmx::RVec> centreLineCtrlPoints = molPath.centreLineCtrlPoints();
+    for(size_t i = 0; i < centreLineKnots.size(); i++)
+    {
+        dh.setPoint(0, centreLineKnots.at(i));
+        dh.setPoint(1, centreLineCtrlPoints.at(i)[XX]);
+        dh.setPoint(2, centreLineCtrlPoints.at(i)[YY]);
+        dh.setPoint(3, centreLineCtrlPoints.at(i)[ZZ]);
+        dh.finishPointSet();
+    }
+}
+
+
+/*!
+ * Builds a contiguous array of van der Waals radii aligned with the positions
+ * in the given selection, so that the path finders can access radii by 
+ * position index. The array is shared with the path finders rather than 
+ * copied and is only rebuilt if the mapped IDs of the selected positions 
+ * differ from those it was last built for.
+ */
+void
+PathFindingStage::updateSelectionVdwRadii(const gmx::Selection &sel)
+{
+    // nothing to do if selection has not changed:
+    auto ids = sel.mappedIds();
+    if( selVdwRadii_ && 
+        ids.size() == selVdwRadiiIds_.size() &&
+        std::equal(ids.begin(), ids.end(), selVdwRadiiIds_.begin()) )
+    {
+        return;
+    }
+
+    // look up radius of each selected position:
+    std::vector<real> selVdwRadii;
+    selVdwRadii.reserve(ids.size());
+    for(auto id : ids)
+    {
+        selVdwRadii.push_back(vdwRadii_.at(id));
+    }
+
+    // replace shared radii:
+    selVdwRadiiIds_.assign(ids.begin(), ids.end());
+    selVdwRadii_ = std::make_shared<const std::vector<real>>(
+            std::move(selVdwRadii));
+}
+
+
+// PORE RESIDUE MAPPING
+//-----------------------------------------------------------------------------
+
+/*!
+ * Constructor. The selections calSel and cogSel must belong to the selection
+ * collection selCol, which is evaluated once per frame.
+ */
+PoreResidueMappingStage::PoreResidueMappingStage(
+        gmx::SelectionCollection *selCol,
+        const gmx::Selection &calSel,
+        const gmx::Selection &cogSel,
+        real margin,
+        bool findPfResidues)
+    : AbstractFrameAnalysisStage("residues", 
+                                 eFrameDataPath, 
+                                 eFrameDataPoreResidues)
+    , selCol_(selCol)
+    , calSel_(calSel)
+    , cogSel_(cogSel)
+    , margin_(margin)
+    , findPfResidues_(findPfResidues)
+{
+
+}
+
+
+/*!
+ * Evaluates the pore mapping selections for this frame.
+ */
+void
+PoreResidueMappingStage::prepare(FrameAnalysisContext &ctx)
+{
+    t_trxframe frame = *ctx.fr_;
+    selCol_ -> evaluate(&frame, ctx.pbc_);
+}
+
+
+/*!
+ * Maps residue centres of geometry and C-alpha atoms onto the pathway and
+ * decides which residues are pore-lining and pore-facing.
+ */
+void
+PoreResidueMappingStage::evaluate(FrameAnalysisContext &ctx)
+{
+    MolecularPath &molPath = *ctx.molPath_;
+
+    // get thread-local selections:
+    const gmx::Selection poreMappingSelCal = ctx.selection(calSel_);
+    ctx.poreMappingSelCog_ = ctx.selection(cogSel_);
+
+    // map pore residue COG and C-alpha onto pathway:
+    ctx.poreCogMappedCoords_ = molPath.mapSelection(ctx.poreMappingSelCog_);
+    ctx.poreCalMappedCoords_ = molPath.mapSelection(poreMappingSelCal);
+
+    // decide which residues are pore-lining and pore-facing:
+    classifyResidues(ctx, margin_, findPfResidues_);
+}
+
+
+/*!
+ * Decides which of the mapped residues in the given context are pore-lining
+ * and pore-facing. This only depends on the mapped coordinates, so that it 
+ * can also be used for residues that were not mapped from a selection.
+ */
+void
+PoreResidueMappingStage::classifyResidues(
+        FrameAnalysisContext &ctx,
+        real margin,
+        bool findPfResidues)
+{
+    MolecularPath &molPath = *ctx.molPath_;
+
+    // check if particles are pore-lining:
+    ctx.poreLining_ = molPath.checkIfInside(
+            ctx.poreCogMappedCoords_, 
+            margin);
+
+    // check if residues are pore-facing:
+    // TODO: make this conditional on whether C-alphas are available
+    ctx.poreFacing_.clear();
+    for(auto it = ctx.poreCogMappedCoords_.begin(); 
+        it != ctx.poreCogMappedCoords_.end(); 
+        it++)
+    {
+        // is residue pore lining and has COG closer to centreline than CA?
+        ctx.poreFacing_[it -> first] = 
+                it -> second[RR] < ctx.poreCalMappedCoords_[it -> first][RR] &&
+                ctx.poreLining_[it -> first] == true &&
+                findPfResidues == true;
+    }
+}
+
+
+// HYDROPHOBICITY PROFILE
+//-----------------------------------------------------------------------------
+
+/*!
+ * Constructor. The parameters are those of the kernel smoother and bandWidth
+ * is the width of the region over which the profile is smoothly taken to 
+ * zero at either end of the pore.
+ */
+HydrophobicityProfileStage::HydrophobicityProfileStage(
+        const ResidueInformationProvider &resInfo,
+        const DensityEstimationParameters &params,
+        real bandWidth)
+    : AbstractFrameAnalysisStage("hydrophobicity", 
+                                 eFrameDataPath | eFrameDataPoreResidues, 
+                                 eFrameDataHydrophobicity)
+    , resInfo_(resInfo)
+    , params_(params)
+    , bandWidth_(bandWidth)
+{
+
+}
+
+
+/*!
+ * Estimates hydrophobicity profiles from the pore-lining and pore-facing 
+ * residues.
+ */
+void
+HydrophobicityProfileStage::evaluate(FrameAnalysisContext &ctx)
+{
+    estimate(ctx, ctx.hydrophobicity_);
+}
+
+
+/*!
+ * Sets both hydrophobicity profiles to zero.
+ */
+void
+HydrophobicityProfileStage::skip(FrameAnalysisContext &ctx)
+{
+    zero(ctx, ctx.hydrophobicity_);
+}
+
+
+/*!
+ * Adds spline parameters of the hydrophobicity profiles to data sets 7 
+ * and 8.
+ */
+void
+HydrophobicityProfileStage::write(FrameAnalysisContext &ctx)
+{
+    ctx.dataHandle_ -> selectDataSet(7);
+    writeSplineCurve(ctx.hydrophobicity_.poreLining_, *ctx.dataHandle_);
+    ctx.dataHandle_ -> selectDataSet(8);
+    writeSplineCurve(ctx.hydrophobicity_.poreFacing_, *ctx.dataHandle_);
+}
+
+
+/*!
+ * Estimates hydrophobicity profiles from the pore residues in the given 
+ * context and stores them in profiles.
+ */
+void
+HydrophobicityProfileStage::estimate(
+        const FrameAnalysisContext &ctx,
+        HydrophobicityProfiles &profiles) const
+{
+    // get vectors of coordinates of pore-facing and -lining residues:
+    std::vector<real> plResidueCoordS;
+    std::vector<real> plResidueHydrophobicity;
+    std::vector<real> pfResidueCoordS;
+    std::vector<real> pfResidueHydrophobicity;
+    real minPoreResS = std::numeric_limits<real>::infinity();
+    real maxPoreResS = -std::numeric_limits<real>::infinity();
+    for(auto res : ctx.poreCogMappedCoords_)
+    {
+        if( ctx.poreLining_.at(res.first) )
+        {
+            plResidueCoordS.push_back(res.second[SS]);
+            plResidueHydrophobicity.push_back(
+                    resInfo_.hydrophobicity(res.first));
+        }
+        if( ctx.poreFacing_.at(res.first) )
+        {
+            pfResidueCoordS.push_back(res.second[SS]);
+            pfResidueHydrophobicity.push_back(
+                    resInfo_.hydrophobicity(res.first));
+        }
+
+        // also track the largest and smallest residue positions:
+        if( res.second[SS] < minPoreResS )
+        {
+            minPoreResS = res.second[SS];
+        }
+        if( res.second[SS] > maxPoreResS )
+        {
+            maxPoreResS = res.second[SS];
+        }
+    }
+
+    // add mock values at both ends to ensure profile goes to zero smoothly:
+    pfResidueCoordS.push_back(minPoreResS - bandWidth_/2.0);
+    pfResidueCoordS.push_back(maxPoreResS + bandWidth_/2.0);
+    pfResidueHydrophobicity.push_back(0.0);
+    pfResidueHydrophobicity.push_back(0.0);
+
+    plResidueCoordS.push_back(minPoreResS - bandWidth_/2.0);
+    plResidueCoordS.push_back(maxPoreResS + bandWidth_/2.0);
+    plResidueHydrophobicity.push_back(0.0);
+    plResidueHydrophobicity.push_back(0.0);
+
+    // set up kernel smoother:
+    WeightedKernelDensityEstimator kernelSmoother;
+    kernelSmoother.setParameters(params_);
+
+    // estimate hydrophobicity profiles:
+    profiles.poreLining_ = kernelSmoother.estimate(
+            plResidueCoordS, 
+            plResidueHydrophobicity);
+    profiles.poreFacing_ = kernelSmoother.estimate(
+            pfResidueCoordS, 
+            pfResidueHydrophobicity);
+}
+
+
+/*!
+ * Sets both profiles to zero along the pathway in the given context.
+ */
+void
+HydrophobicityProfileStage::zero(
+        const FrameAnalysisContext &ctx,
+        HydrophobicityProfiles &profiles) const
+{
+    profiles.poreLining_ = constantProfile(*ctx.molPath_, 0.0);
+    profiles.poreFacing_ = constantProfile(*ctx.molPath_, 0.0);
+}
+
+
+// SOLVENT MAPPING
+//-----------------------------------------------------------------------------
+
+/*!
+ * Constructor. The selection cogSel must belong to the selection collection
+ * selCol. If hasSolvent is false, neither is used.
+ */
+SolventMappingStage::SolventMappingStage(
+        gmx::SelectionCollection *selCol,
+        const gmx::Selection &cogSel,
+        bool hasSolvent)
+    : AbstractFrameAnalysisStage("solvent", eFrameDataPath, eFrameDataSolvent)
+    , selCol_(selCol)
+    , cogSel_(cogSel)
+    , hasSolvent_(hasSolvent)
+{
+
+}
+
+
+/*!
+ * Evaluates the solvent mapping selection for this frame.
+ */
+void
+SolventMappingStage::prepare(FrameAnalysisContext &ctx)
+{
+    if( hasSolvent_ )
+    {
+        t_trxframe frame = *ctx.fr_;
+        selCol_ -> evaluate(&frame, ctx.pbc_);
+    }
+}
+
+
+/*!
+ * Maps solvent particles onto the pathway and decides which of them lie 
+ * inside the sample region and inside the pore proper.
+ */
+void
+SolventMappingStage::evaluate(FrameAnalysisContext &ctx)
+{
+    // only do this if solvent selection is valid:
+    if( !hasSolvent_ )
+    {
+        return;
+    }
+
+    // get thread-local selection data:
+    frameSel_ = ctx.selection(cogSel_);
+
+    // map particles onto pathway:
+    ctx.solventMappedCoords_ = ctx.molPath_ -> mapSelection(frameSel_);
+
+    // decide which particles are inside sample region and pore:
+    classifySolvent(ctx);
+}
+
+
+/*!
+ * Decides which of the mapped solvent particles in the given context lie 
+ * inside the sample region and inside the pore proper. This only depends on
+ * the mapped coordinates, so that it can also be used for particles that 
+ * were not mapped from a selection.
+ */
+void
+SolventMappingStage::classifySolvent(FrameAnalysisContext &ctx)
+{
+    MolecularPath &molPath = *ctx.molPath_;
+
+    // TODO: make this a parameter:
+    real solvMappingMargin = 0.0;
+
+    // find particles inside path (i.e. pore plus bulk sampling regime):
+    ctx.solvInsideSample_ = molPath.checkIfInside(
+            ctx.solventMappedCoords_, 
+            solvMappingMargin);
+    ctx.numSolvInsideSample_ = std::count_if(
+            ctx.solvInsideSample_.begin(),
+            ctx.solvInsideSample_.end(),
+            [](const std::pair<const int, bool> &p){return p.second;});
+
+    // find particles inside pore:
+    ctx.solvInsidePore_ = molPath.checkIfInside(
+            ctx.solventMappedCoords_, 
+            solvMappingMargin,
+            molPath.sLo(),
+            molPath.sHi());
+    ctx.numSolvInsidePore_ = std::count_if(
+            ctx.solvInsidePore_.begin(),
+            ctx.solvInsidePore_.end(),
+            [](const std::pair<const int, bool> &p){return p.second;});
+}
+
+
+/*!
+ * Adds mapped solvent particles to data set 5.
+ */
+void
+SolventMappingStage::write(FrameAnalysisContext &ctx)
+{
+    if( !hasSolvent_ || !isEnabled() )
+    {
+        return;
+    }
+
+    gmx::AnalysisDataHandle &dh = *ctx.dataHandle_;
+    dh.selectDataSet(5);
+    for(auto it = ctx.solventMappedCoords_.begin(); 
+        it != ctx.solventMappedCoords_.end(); 
+        it++)
+    {
+        dh.setPoint(0, frameSel_.position(it -> first).mappedId()); // res.id
+        dh.setPoint(1, it -> second[0]);                            // s
+        dh.setPoint(2, it -> second[1]);                            // rho
+        dh.setPoint(3, 0.0);                                        // phi 
+        dh.setPoint(4, ctx.solvInsidePore_[it -> first]);   // inside pore
+        dh.setPoint(5, ctx.solvInsideSample_[it -> first]); // inside sample
+        dh.setPoint(6, frameSel_.position(it -> first).x()[XX]);    // x
+        dh.setPoint(7, frameSel_.position(it -> first).x()[YY]);    // y
+        dh.setPoint(8, frameSel_.position(it -> first).x()[ZZ]);    // z
+        dh.finishPointSet();
+    }
+}
+
+
+// SOLVENT DENSITY
+//-----------------------------------------------------------------------------
+
+/*!
+ * Constructor. For the kernel method, a bandWidth that is not positive means
+ * that the bandwidth is estimated in each frame.
+ */
+SolventDensityStage::SolventDensityStage(
+        eDensityEstimator method,
+        const DensityEstimationParameters &params,
+        real bandWidth)
+    : AbstractFrameAnalysisStage("density", 
+                                 eFrameDataPath | eFrameDataSolvent, 
+                                 eFrameDataSolventDensity)
+    , method_(method)
+    , params_(params)
+    , bandWidth_(bandWidth)
+{
+    // create density estimator:
+    if( method_ == eDensityEstimatorHistogram )
+    {
+        HistogramDensityEstimator *hde = new HistogramDensityEstimator();
+        hde -> setNumThreads(
+                std::max(std::thread::hardware_concurrency(), 1u));
+        densityEstimator_.reset(hde);
+    }
+    else if( method_ == eDensityEstimatorKernel )
+    {
+        densityEstimator_.reset(new KernelDensityEstimator());
+    }
+}
+
+
+/*!
+ * Estimates the solvent density along the arc length coordinate and the 
+ * corresponding number density.
+ */
+void
+SolventDensityStage::evaluate(FrameAnalysisContext &ctx)
+{
+    estimate(ctx, ctx.solventDensity_);
+}
+
+
+/*!
+ * Sets the solvent density to zero.
+ */
+void
+SolventDensityStage::skip(FrameAnalysisContext &ctx)
+{
+    zero(ctx, ctx.solventDensity_);
+}
+
+
+/*!
+ * Adds spline parameters of the solvent density to data set 6.
+ */
+void
+SolventDensityStage::write(FrameAnalysisContext &ctx)
+{
+    ctx.dataHandle_ -> selectDataSet(6);
+    writeSplineCurve(ctx.solventDensity_.density_, *ctx.dataHandle_);
+}
+
+
+/*!
+ * Estimates the solvent density from the solvent particles in the given 
+ * context and stores it and all derived quantities in density.
+ */
+void
+SolventDensityStage::estimate(
+        const FrameAnalysisContext &ctx,
+        SolventDensityProfile &density)
+{
+    MolecularPath &molPath = *ctx.molPath_;
+
+    // build a vector of sample points inside the pathway:
+    std::vector<real> solventSampleCoordS;
+    solventSampleCoordS.reserve(ctx.solventMappedCoords_.size());
+    for(auto isInsideSample : ctx.solvInsideSample_)
+    {
+        // is this particle inside the pathway?
+        if( isInsideSample.second )
+        {
+            // add arc length coordinate to sample vector:
+            solventSampleCoordS.push_back(
+                    ctx.solventMappedCoords_.at(isInsideSample.first)[SS]);
+        }
+    }
+
+    // sample points inside the pore only for bandwidth estimation:
+    if( method_ == eDensityEstimatorKernel && bandWidth_ <= 0.0 )
+    {
+        std::vector<real> solventPoreCoordS;
+        solventPoreCoordS.reserve(ctx.solventMappedCoords_.size());
+        for(auto isInsidePore : ctx.solvInsidePore_)
+        {
+            if( isInsidePore.second )
+            {
+                solventPoreCoordS.push_back(
+                        ctx.solventMappedCoords_.at(isInsidePore.first)[SS]);
+            }
+        }
+
+        AmiseOptimalBandWidthEstimator bwe;
+        params_.setBandWidth( bwe.estimate(solventPoreCoordS) );
+    }
+
+    // estimate density of solvent particles along arc length coordinate:
+    densityEstimator_ -> setParameters(params_);
+    density.density_ = densityEstimator_ -> estimate(solventSampleCoordS);
+    density.bandWidth_ = params_.bandWidth()*params_.bandWidthScale();
+
+    // obtain physical number density:
+    SplineCurve1D pathRadius = molPath.pathRadius();
+    NumberDensityCalculator ncc;
+    density.numberDensity_ = ncc(
+            density.density_, 
+            pathRadius, 
+            ctx.numSolvInsideSample_);
+  
+    // find minimum instantaneous solvent density in this frame:
+    std::pair<real, real> lim(molPath.sLo(), molPath.sHi());
+    density.minimum_ = density.numberDensity_.minimum(lim);
+}
+
+
+/*!
+ * Sets the density to zero along the pathway in the given context.
+ */
+void
+SolventDensityStage::zero(
+        const FrameAnalysisContext &ctx,
+        SolventDensityProfile &density) const
+{
+    density.density_ = constantProfile(*ctx.molPath_, 0.0);
+    density.numberDensity_ = constantProfile(*ctx.molPath_, 0.0);
+    density.minimum_ = std::make_pair(ctx.molPath_ -> sLo(), 0.0);
+    density.bandWidth_ = 0.0;
+}
+
+
+// PARAMETER SWEEP
+//-----------------------------------------------------------------------------
+
+/*!
+ * Constructor. If estimateHydrophobicity or estimateDensity is false, the 
+ * respective profiles are set to zero for all parameter sets, mirroring the 
+ * skipped primary stages.
+ */
+ParameterSweepStage::ParameterSweepStage(
+        const ResidueInformationProvider &resInfo,
+        bool estimateHydrophobicity,
+        bool estimateDensity)
+    : AbstractFrameAnalysisStage("sweep", 
+                                 eFrameDataPath | eFrameDataPoreResidues | 
+                                 eFrameDataSolvent, 
+                                 0)
+    , resInfo_(resInfo)
+    , estimateHydrophobicity_(estimateHydrophobicity)
+    , estimateDensity_(estimateDensity)
+{
+
+}
+
+
+/*!
+ * Adds a set of density estimation and hydrophobicity parameters. The 
+ * parameters have the same meaning as for SolventDensityStage and 
+ * HydrophobicityProfileStage.
+ */
+void
+ParameterSweepStage::addParameterSet(
+        eDensityEstimator deMethod,
+        const DensityEstimationParameters &deParams,
+        real deBandWidth,
+        const DensityEstimationParameters &hpParams,
+        real hpBandWidth)
+{
+    densityStages_.emplace_back(new SolventDensityStage(
+            deMethod, 
+            deParams, 
+            deBandWidth));
+    hydrophobicityStages_.emplace_back(new HydrophobicityProfileStage(
+            resInfo_, 
+            hpParams, 
+            hpBandWidth));
+    densities_.resize(densityStages_.size());
+    hydrophobicities_.resize(hydrophobicityStages_.size());
+    solventDensityAtResidue_.resize(densityStages_.size());
+}
+
+
+/*!
+ * Returns the number of parameter sets.
+ */
+size_t
+ParameterSweepStage::numParameterSets() const
+{
+    return densityStages_.size();
+}
+
+
+/*!
+ * Estimates solvent density and hydrophobicity profiles for each parameter 
+ * set and evaluates the density at each pore residue.
+ */
+void
+ParameterSweepStage::evaluate(FrameAnalysisContext &ctx)
+{
+    for(size_t k = 0; k < numParameterSets(); k++)
+    {
+        // solvent density:
+        if( estimateDensity_ )
+        {
+            densityStages_[k] -> estimate(ctx, densities_[k]);
+        }
+        else
+        {
+            densityStages_[k] -> zero(ctx, densities_[k]);
+        }
+
+        // hydrophobicity:
+        if( estimateHydrophobicity_ )
+        {
+            hydrophobicityStages_[k] -> estimate(ctx, hydrophobicities_[k]);
+        }
+        else
+        {
+            hydrophobicityStages_[k] -> zero(ctx, hydrophobicities_[k]);
+        }
+
+        // density at residue positions:
+        solventDensityAtResidue_[k].clear();
+        for(auto res : ctx.poreCogMappedCoords_)
+        {
+            solventDensityAtResidue_[k][res.first] = 
+                    densities_[k].density_.evaluate(res.second[SS], 0);
+        }
+    }
+}
+
+
+/*!
+ * Adds the results for each parameter set to its five data sets.
+ */
+void
+ParameterSweepStage::write(FrameAnalysisContext &ctx)
+{
+    gmx::AnalysisDataHandle &dh = *ctx.dataHandle_;
+    for(size_t k = 0; k < numParameterSets(); k++)
+    {
+        int firstDataSet = 9 + 5*k;
+
+        // parameter dependent part of path summary:
+        std::vector<real> solventKnots = densities_[k].density_.uniqueKnots();
+        dh.selectDataSet(firstDataSet);
+        dh.setPoint(0, solventKnots.front());
+        dh.setPoint(1, solventKnots.back());
+        dh.setPoint(2, densities_[k].minimum_.first);
+        dh.setPoint(3, densities_[k].minimum_.second);
+        dh.setPoint(4, densities_[k].bandWidth_);
+        dh.finishPointSet();
+
+        // solvent density at residue positions:
+        dh.selectDataSet(firstDataSet + 1);
+        for(auto res : solventDensityAtResidue_[k])
+        {
+            dh.setPoint(0, res.second);
+            dh.finishPointSet();
+        }
+
+        // profiles:
+        dh.selectDataSet(firstDataSet + 2);
+        writeSplineCurve(densities_[k].density_, dh);
+        dh.selectDataSet(firstDataSet + 3);
+        writeSplineCurve(hydrophobicities_[k].poreLining_, dh);
+        dh.selectDataSet(firstDataSet + 4);
+        writeSplineCurve(hydrophobicities_[k].poreFacing_, dh);
+    }
+}
+
+
+// CONVERGENCE MONITORING
+//-----------------------------------------------------------------------------
+
+/*!
+ * Constructor. The radius and energy profiles are sampled at numPoints
+ * points determined from the first frame's pathway and checked for 
+ * convergence every checkInterval frames. The energy profile is only 
+ * monitored if monitorEnergy is true.
+ */
+ConvergenceMonitoringStage::ConvergenceMonitoringStage(
+        int numPoints,
+        real extrapDist,
+        int checkInterval,
+        real tolRadius,
+        real tolEnergy,
+        bool monitorEnergy,
+        int &convergedFrame,
+        real &convergedTime)
+    : AbstractFrameAnalysisStage("convergence", 
+                                 eFrameDataPath | eFrameDataSolvent | 
+                                 eFrameDataSolventDensity, 
+                                 0)
+    , numPoints_(numPoints)
+    , extrapDist_(extrapDist)
+    , checkInterval_(checkInterval)
+    , tolRadius_(tolRadius)
+    , tolEnergy_(tolEnergy)
+    , monitorEnergy_(monitorEnergy)
+    , convergedFrame_(convergedFrame)
+    , convergedTime_(convergedTime)
+{
+
+}
+
+
+/*!
+ * Updates the running profiles and records the current frame as the 
+ * converged frame if they have converged. The stage does not stop reading 
+ * the trajectory itself, as it may run on a worker thread; this is left to 
+ * the caller, which checks the converged frame after the pipeline has run.
+ */
+void
+ConvergenceMonitoringStage::evaluate(FrameAnalysisContext &ctx)
+{
+    // only check if not yet converged:
+    if( convergedFrame_ >= 0 )
+    {
+        return;
+    }
+
+    // support points are fixed by the first frame:
+    if( supportPoints_.empty() )
+    {
+        supportPoints_ = ctx.molPath_ -> sampleArcLength(
+                numPoints_, 
+                extrapDist_);
+        radiusConvergence_ = ProfileConvergenceMonitor(
+                supportPoints_.size(), 
+                tolRadius_, 
+                checkInterval_);
+        energyConvergence_ = ProfileConvergenceMonitor(
+                supportPoints_.size(), 
+                tolEnergy_, 
+                checkInterval_);
+    }
+
+    // update running radius profile:
+    std::vector<real> convRadius = ctx.molPath_ -> sampleRadii(supportPoints_);
+    bool isConverged = radiusConvergence_.update(convRadius);
+
+    // update running energy profile (same procedure as final output):
+    if( monitorEnergy_ )
+    {
+        std::vector<real> convDensity = 
+                ctx.solventDensity_.density_.evaluateMultiple(
+                        supportPoints_, 0);
+        NumberDensityCalculator ndc;
+        convDensity = ndc(convDensity, convRadius, ctx.numSolvInsideSample_);
+        BoltzmannEnergyCalculator bec;
+        isConverged = energyConvergence_.update(bec.calculate(convDensity)) 
+                      && isConverged;
+    }
+
+    // record convergence, the caller stops reading the trajectory:
+    if( isConverged )
+    {
+        convergedFrame_ = ctx.frnr_;
+        convergedTime_ = ctx.fr_ -> time;
+
+        std::cout<<std::endl
+                 <<"Radius and energy profiles converged after frame "
+                 <<ctx.frnr_<<" (t = "<<ctx.fr_ -> time<<"), skipping "
+                 <<"remaining frames."<<std::endl;
+    }
+}
+
+
+// PATH SUMMARY
+//-----------------------------------------------------------------------------
+
+/*!
+ * Constructor.
+ */
+PathSummaryStage::PathSummaryStage()
+    : AbstractFrameAnalysisStage("summary", 
+                                 eFrameDataPath | eFrameDataSolvent | 
+                                 eFrameDataSolventDensity, 
+                                 0)
+    , minRadius_(0.0, 0.0)
+    , volume_(0.0)
+{
+
+}
+
+
+/*!
+ * Computes the minimum radius and volume of the pathway.
+ */
+void
+PathSummaryStage::evaluate(FrameAnalysisContext &ctx)
+{
+    minRadius_ = ctx.molPath_ -> minRadius();
+    volume_ = ctx.molPath_ -> volume();
+}
+
+
+/*!
+ * Adds aggregate path data to data set 0.
+ */
+void
+PathSummaryStage::write(FrameAnalysisContext &ctx)
+{
+    // track range covered by solvent:
+    std::vector<real> solventKnots = 
+            ctx.solventDensity_.density_.uniqueKnots();
+
+    // only one point per frame:
+    gmx::AnalysisDataHandle &dh = *ctx.dataHandle_;
+    dh.selectDataSet(0);
+    dh.setPoint(0, ctx.fr_ -> time);
+    dh.setPoint(1, minRadius_.first);
+    dh.setPoint(2, minRadius_.second);
+    dh.setPoint(3, ctx.molPath_ -> length());
+    dh.setPoint(4, volume_);
+    dh.setPoint(5, ctx.numSolvInsidePore_); 
+    dh.setPoint(6, ctx.numSolvInsideSample_); 
+    dh.setPoint(7, solventKnots.front()); 
+    dh.setPoint(8, solventKnots.back());
+    dh.setPoint(9, ctx.solventDensity_.minimum_.first); 
+    dh.setPoint(10, ctx.solventDensity_.minimum_.second);
+    dh.setPoint(11, ctx.molPath_ -> sLo()); 
+    dh.setPoint(12, ctx.molPath_ -> sHi());
+    dh.setPoint(13, ctx.solventDensity_.bandWidth_);
+    dh.finishPointSet();
+}
+
+
+// PORE RESIDUE OUTPUT
+//-----------------------------------------------------------------------------
+
+/*!
+ * Constructor.
+ */
+PoreResidueOutputStage::PoreResidueOutputStage()
+    : AbstractFrameAnalysisStage("residue-output", 
+                                 eFrameDataPath | eFrameDataPoreResidues | 
+                                 eFrameDataSolventDensity, 
+                                 0)
+{
+
+}
+
+
+/*!
+ * Evaluates pore radius and solvent density at each residue's position.
+ */
+void
+PoreResidueOutputStage::evaluate(FrameAnalysisContext &ctx)
+{
+    poreRadiusAtResidue_.clear();
+    solventDensityAtResidue_.clear();
+    for(auto res : ctx.poreCogMappedCoords_)
+    {
+        poreRadiusAtResidue_[res.first] = ctx.molPath_ -> radius(
+                res.second[SS]);
+        solventDensityAtResidue_[res.first] = 
+                ctx.solventDensity_.density_.evaluate(res.second[SS], 0);
+    }
+}
+
+
+/*!
+ * Adds mapped residues to data set 4.
+ */
+void
+PoreResidueOutputStage::write(FrameAnalysisContext &ctx)
+{
+    const gmx::Selection &sel = ctx.poreMappingSelCog_;
+    gmx::AnalysisDataHandle &dh = *ctx.dataHandle_;
+    dh.selectDataSet(4);
+    for(auto it = ctx.poreCogMappedCoords_.begin(); 
+        it != ctx.poreCogMappedCoords_.end(); 
+        it++)
+    {
+        dh.setPoint( 0, sel.position(it -> first).mappedId());
+        dh.setPoint( 1, it -> second[SS]);                   // s
+        dh.setPoint( 2, std::sqrt(it -> second[RR]));        // rho
+        dh.setPoint( 3, it -> second[PP]);                   // phi
+        dh.setPoint( 4, ctx.poreLining_[it -> first]);       // pore lining?
+        dh.setPoint( 5, ctx.poreFacing_[it -> first]);       // pore facing?
+        dh.setPoint( 6, poreRadiusAtResidue_[it -> first]);
+        dh.setPoint( 7, solventDensityAtResidue_[it -> first]);
+        dh.setPoint( 8, sel.position(it -> first).x()[XX]);
+        dh.setPoint( 9, sel.position(it -> first).x()[YY]);
+        dh.setPoint(10, sel.position(it -> first).x()[ZZ]);
+        dh.finishPointSet();
+    }
+}
+
+
+// MESH SEQUENCE
+//-----------------------------------------------------------------------------
+
+/*!
+ * Constructor. Frames whose number is a multiple of stride are added to the
+ * given mesh sequence.
+ */
+MeshSequenceStage::MeshSequenceStage(
+        GltfSequenceExporter &meshSequence,
+        int stride,
+        real extrapDist,
+        real gridSampleDist,
+        real correctionThreshold)
+    : AbstractFrameAnalysisStage("mesh", 
+                                 eFrameDataPath | eFrameDataSolventDensity, 
+                                 0)
+    , meshSequence_(meshSequence)
+    , stride_(stride)
+    , extrapDist_(extrapDist)
+    , gridSampleDist_(gridSampleDist)
+    , correctionThreshold_(correctionThreshold)
+{
+
+}
+
+
+/*!
+ * Generates the pore surface from the live pathway on a fixed grid and adds 
+ * it to the mesh sequence.
+ */
+void
+MeshSequenceStage::evaluate(FrameAnalysisContext &ctx)
+{
+    if( ctx.frnr_ % stride_ != 0 )
+    {
+        return;
+    }
+
+    // work on a copy, as other stages may read the pathway concurrently:
+    MolecularPath molPath(*ctx.molPath_);
+    molPath.addScalarProperty(
+            "density", 
+            ctx.solventDensity_.numberDensity_, 
+            false);
+
+    MolecularPathObjExporter mpexp;
+    mpexp.setExtrapDist(extrapDist_);
+    mpexp.setGridSampleDist(gridSampleDist_);
+    mpexp.setCorrectionThreshold(correctionThreshold_);
+    meshSequence_.addFrame(
+            mpexp.surfaceMesh("molecular_path", molPath), 
+            ctx.fr_ -> time);
+}
+
@@ -0,0 +1,299 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "trajectory-analysis/replica_trajectory_analysis.hpp"
+
+#include "io/analysis_data_json_frame_exporter.hpp"
+#include "io/async_trajectory_reader.hpp"
+#include "trajectory-analysis/frame_analysis_context.hpp"
+
+
+/*!
+ * Returns the number of leading atoms of the topology whose coordinates are 
+ * needed to evaluate the selections, i.e. one more than the largest atom 
+ * index in any of them. Solvent selections only count if includeSolvent is
+ * true, as they are not evaluated if solvent mapping is skipped. The 
+ * selections must have been compiled. Returns zero if all atoms are needed,
+ * which is the case as soon as any selection is dynamic, as the atoms it 
+ * depends on are not known before it is evaluated.
+ */
+int
+FrameSelections::numRequiredAtoms(
+        bool includeSolvent) const
+{
+    std::vector<const gmx::Selection*> selections = {
+            &pathway_, &ipp_, &poreMappingCal_, &poreMappingCog_};
+    if( includeSolvent )
+    {
+        selections.push_back(&solvMappingCog_);
+    }
+
+    int numAtoms = 0;
+    for(auto sel : selections)
+    {
+        if( sel -> isDynamic() )
+        {
+            return 0;
+        }
+        for(int idx : sel -> atomIndices())
+        {
+            numAtoms = std::max(numAtoms, idx + 1);
+        }
+    }
+
+    return numAtoms;
+}
+
+
+/*!
+ * Constructor. The replica is only set up for analysis once its selections
+ * have been compiled, its pipeline has been assembled, and its frame stream
+ * has been set.
+ */
+ReplicaTrajectoryAnalysis::ReplicaTrajectoryAnalysis(
+        const std::string &trajectoryFileName)
+    : trajectoryFileName_(trajectoryFileName)
+    , readAhead_(4)
+    , maxAtoms_(0)
+    , beginTime_(std::numeric_limits<real>::lowest())
+    , endTime_(std::numeric_limits<real>::max())
+    , deltaTime_(0.0)
+{
+    selections_.poreMappingSelCol_ = &poreMappingSelCol_;
+    selections_.solvMappingSelCol_ = &solvMappingSelCol_;
+}
+
+
+/*!
+ * Sets the number of frames that are decoded ahead of the analysis.
+ */
+void
+ReplicaTrajectoryAnalysis::setReadAhead(
+        size_t numFrames)
+{
+    readAhead_ = numFrames;
+}
+
+
+/*!
+ * Sets the number of atoms decoded from each frame of an XTC trajectory, 
+ * which must cover all atoms used by the selections (see 
+ * FrameSelections::numRequiredAtoms()).
+ */
+void
+ReplicaTrajectoryAnalysis::setMaxAtoms(
+        int numAtoms)
+{
+    maxAtoms_ = numAtoms;
+}
+
+
+/*!
+ * Sets the range of time stamps of the frames read from an XTC trajectory. 
+ * Frames of other formats are selected by the Gromacs time control.
+ */
+void
+ReplicaTrajectoryAnalysis::setTimeRange(
+        real begin,
+        real end,
+        real dt)
+{
+    beginTime_ = begin;
+    endTime_ = end;
+    deltaTime_ = dt;
+}
+
+
+/*!
+ * Sets a condition that is checked after each frame has been analysed. Once
+ * it returns true, no further frames are read. Used to stop reading once the
+ * time-averaged profiles have converged.
+ */
+void
+ReplicaTrajectoryAnalysis::setStopCondition(
+        std::function<bool(const FrameAnalysisContext&)> stop)
+{
+    stopCondition_ = stop;
+}
+
+
+/*!
+ * Returns the collection holding the pathway and initial probe position 
+ * selections, which is evaluated for each frame in run().
+ */
+gmx::SelectionCollection&
+ReplicaTrajectoryAnalysis::pathwaySelections()
+{
+    return pathwaySelCol_;
+}
+
+
+/*!
+ * Returns the collection for the pore residue mapping.
+ */
+gmx::SelectionCollection&
+ReplicaTrajectoryAnalysis::poreMappingSelections()
+{
+    return poreMappingSelCol_;
+}
+
+
+/*!
+ * Returns the collection for the solvent mapping.
+ */
+gmx::SelectionCollection&
+ReplicaTrajectoryAnalysis::solventMappingSelections()
+{
+    return solvMappingSelCol_;
+}
+
+
+/*!
+ * Returns the selections used by the pipeline of this replica. The 
+ * collection pointers are set, the selections themselves must be parsed 
+ * from the collections returned above.
+ */
+FrameSelections&
+ReplicaTrajectoryAnalysis::selections()
+{
+    return selections_;
+}
+
+
+/*!
+ * Returns the pipeline run on each frame of this replica.
+ */
+FrameAnalysisPipeline&
+ReplicaTrajectoryAnalysis::pipeline()
+{
+    return pipeline_;
+}
+
+
+/*!
+ * Sets up the frame stream of this replica with the same data sets and 
+ * columns as the given layout and writes it to the given file.
+ */
+void
+ReplicaTrajectoryAnalysis::setFrameStream(
+        const gmx::AbstractAnalysisData &layout,
+        const std::string &fileName,
+        const std::vector<std::string> &dataSetNames,
+        const std::vector<std::vector<std::string>> &columnNames)
+{
+    // copy layout of data sets:
+    frameStreamData_.setMultipoint(layout.isMultipoint());
+    frameStreamData_.setDataSetCount(layout.dataSetCount());
+    for(int i = 0; i < layout.dataSetCount(); i++)
+    {
+        frameStreamData_.setColumnCount(i, layout.columnCount(i));
+    }
+
+    // add JSON exporter:
+    AnalysisDataJsonFrameExporterPointer jsonFrameExporter(
+            new AnalysisDataJsonFrameExporter);
+    jsonFrameExporter -> setDataSetNames(dataSetNames);
+    jsonFrameExporter -> setColumnNames(columnNames);
+    jsonFrameExporter -> setFileName(fileName);
+    frameStreamData_.addModule(jsonFrameExporter);
+    frameStreamFileName_ = fileName;
+}
+
+
+/*!
+ * Reads all frames of the trajectory, evaluates the pathway selections, and
+ * runs the pipeline on each frame until the stop condition holds. Frames are
+ * decoded ahead of the analysis on a background thread. Returns the number 
+ * of frames analysed.
+ */
+int
+ReplicaTrajectoryAnalysis::run()
+{
+    // open trajectory:
+    AsyncTrajectoryReader reader(readAhead_);
+    reader.setMaxAtoms(maxAtoms_);
+    reader.setTimeRange(beginTime_, endTime_, deltaTime_);
+    reader.open(trajectoryFileName_);
+
+    // frames are analysed in order on this thread:
+    gmx::AnalysisDataHandle dhFrameStream = frameStreamData_.startData(
+            gmx::AnalysisDataParallelOptions());
+    int numFrames = 0;
+    while( const t_trxframe *fr = reader.nextFrame() )
+    {
+        t_trxframe frame = *fr;
+        pathwaySelCol_.evaluate(&frame, nullptr);
+        dhFrameStream.startFrame(numFrames, frame.time);
+
+        // describe frame to analysis stages:
+        // (no runner data, selections are used directly)
+        FrameAnalysisContext ctx;
+        ctx.frnr_ = numFrames;
+        ctx.fr_ = &frame;
+        ctx.dataHandle_ = &dhFrameStream;
+        pipeline_.run(ctx);
+
+        dhFrameStream.finishFrame();
+        numFrames++;
+
+        // skip remaining frames?
+        if( stopCondition_ && stopCondition_(ctx) )
+        {
+            break;
+        }
+    }
+
+    // finish data and clean up:
+    frameStreamData_.finishData(dhFrameStream);
+    pathwaySelCol_.evaluateFinal(numFrames);
+    reader.close();
+
+    return numFrames;
+}
+
+
+/*!
+ * Returns the name of the trajectory file of this replica.
+ */
+const std::string&
+ReplicaTrajectoryAnalysis::trajectoryFileName() const
+{
+    return trajectoryFileName_;
+}
+
+
+/*!
+ * Returns the name of the stream file to which per-frame data is written.
+ */
+const std::string&
+ReplicaTrajectoryAnalysis::frameStreamFileName() const
+{
+    return frameStreamFileName_;
+}
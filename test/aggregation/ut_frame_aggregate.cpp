@@ -0,0 +1,325 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "aggregation/frame_aggregate.hpp"
+
+
+/*!
+ * \brief Test fixture for FrameAggregate.
+ *
+ * Creates a short sequence of synthetic frames and profile samples. Frames 
+ * contain no pathway splines, so that profiles can not be sampled from them 
+ * and samples are hard-coded instead.
+ */
+class FrameAggregateTest : public ::testing::Test
+{
+    public:
+
+        // constructor for creating test data:
+        FrameAggregateTest()
+            : supportPoints_({-1.0, 0.0, 1.0})
+        {
+            size_t numFrames = 7;
+            for(size_t i = 0; i < numFrames; i++)
+            {
+                real x = static_cast<real>(i);
+
+                FrameStreamData frame;
+                frame.timeStamp_ = 10.0*x;
+                frame.argMinRadius_ = 0.1*x - 0.2;
+                frame.minRadius_ = 0.3 + 0.01*x*x;
+                frame.length_ = 4.0 - 0.1*x;
+                frame.volume_ = 12.0 + 0.5*x;
+                frame.numPath_ = 40 + i % 3;
+                frame.numSample_ = 80 + i % 2;
+                frame.arcLengthLo_ = -2.0 + 0.05*x;
+                frame.arcLengthHi_ = 2.0 - 0.03*x;
+                frame.bandWidth_ = 0.14;
+                frame.resId_ = {3, 8};
+                frame.resS_ = {-0.5 + 0.01*x, 0.7 - 0.02*x};
+                frame.resRho_ = {0.9, 1.1 + 0.1*x};
+                frame.resPhi_ = {0.2*x, -0.1*x};
+                frame.resPoreLining_ = {1.0, static_cast<real>(i % 2)};
+                frame.resPoreFacing_ = {static_cast<real>(i % 3 == 0), 0.0};
+                frame.resPoreRadius_ = {0.4 + 0.01*x, 0.5};
+                frame.resSolventDensity_ = {0.02*x, 0.1};
+                frame.resX_ = {1.0, 2.0 + x};
+                frame.resY_ = {-x, 0.5};
+                frame.resZ_ = {0.3*x, -0.3*x};
+                frames_.push_back(frame);
+
+                FrameProfileSample sample;
+                sample.radius_ = {0.5 + 0.1*x, 0.3, 0.6 - 0.05*x};
+                sample.plHydrophobicity_ = {0.1*x, -0.2, 0.3};
+                sample.pfHydrophobicity_ = {-0.1*x, 0.2, 0.1*x*x};
+                sample.solventDensity_ = {30.0 + x, 10.0 - x, 25.0};
+                sample.energy_ = {-1.0 - 0.1*x, 0.5*x, -0.7};
+                sample.energyAnchorLo_ = -1.0 - 0.05*x;
+                sample.energyAnchorHi_ = -0.7;
+                samples_.push_back(sample);
+            }
+        }
+
+    
+    protected:
+
+        // test data:
+        std::vector<real> supportPoints_;
+        std::vector<FrameStreamData> frames_;
+        std::vector<FrameProfileSample> samples_;
+
+        // creates aggregate of frames in [begin, end):
+        FrameAggregate aggregate(size_t begin, size_t end)
+        {
+            FrameAggregate agg(supportPoints_, -0.5, 0.5);
+            for(size_t i = begin; i < end; i++)
+            {
+                agg.update(frames_[i], samples_[i]);
+            }
+            return agg;
+        }
+};
+
+
+/*!
+ * Checks that merging aggregates of consecutive sections of the frame 
+ * sequence yields the same state as aggregating all frames at once. Time 
+ * series and extrema must agree exactly, moments up to rounding errors.
+ */
+TEST_F(FrameAggregateTest, FrameAggregateMergeTest)
+{
+    // relative tolerance threshold for floating point comparison:
+    real eps = 100*std::numeric_limits<real>::epsilon();
+
+    // aggregate in one pass and in three shards:
+    FrameAggregate full = aggregate(0, frames_.size());
+    FrameAggregate merged = aggregate(0, 3);
+    merged.merge(aggregate(3, 3));
+    merged.merge(aggregate(3, 5));
+    merged.merge(aggregate(5, frames_.size()));
+
+    // compare basic properties:
+    ASSERT_EQ(full.numFrames(), merged.numFrames());
+    ASSERT_EQ(full.timeStamps(), merged.timeStamps());
+    ASSERT_EQ(full.poreResIds(), merged.poreResIds());
+
+    // compare complete state via its JSON representation:
+    rapidjson::Document doc;
+    rapidjson::Value fullJson = full.toJson(doc.GetAllocator());
+    rapidjson::Value mergedJson = merged.toJson(doc.GetAllocator());
+    auto expectSummaryNear = [&](
+            const rapidjson::Value &a, 
+            const rapidjson::Value &b)
+    {
+        ASSERT_EQ(a["num"].GetInt(), b["num"].GetInt());
+        ASSERT_DOUBLE_EQ(a["min"].GetDouble(), b["min"].GetDouble());
+        ASSERT_DOUBLE_EQ(a["max"].GetDouble(), b["max"].GetDouble());
+        for(auto moment : {"mean", "sumSquaredMeanDiff"})
+        {
+            real value = a[moment].GetDouble();
+            ASSERT_NEAR(
+                    value, 
+                    b[moment].GetDouble(), 
+                    eps*std::max(std::fabs(value), real(1.0)));
+        }
+    };
+    for(auto &scalar : fullJson["scalars"].GetObject())
+    {
+        const rapidjson::Value &other = mergedJson["scalars"][scalar.name];
+        expectSummaryNear(scalar.value["summary"], other["summary"]);
+        ASSERT_TRUE(scalar.value["timeSeries"] == other["timeSeries"]);
+    }
+    for(auto &profile : fullJson["profiles"].GetObject())
+    {
+        const rapidjson::Value &other = mergedJson["profiles"][profile.name];
+        for(size_t i = 0; i < supportPoints_.size(); i++)
+        {
+            expectSummaryNear(profile.value["summary"][i], other["summary"][i]);
+        }
+        ASSERT_TRUE(profile.value["timeSeries"] == other["timeSeries"]);
+    }
+    expectSummaryNear(fullJson["anchorEnergyLo"], mergedJson["anchorEnergyLo"]);
+    expectSummaryNear(fullJson["anchorEnergyHi"], mergedJson["anchorEnergyHi"]);
+    for(auto &residue : fullJson["residues"].GetObject())
+    {
+        const rapidjson::Value &other = mergedJson["residues"][residue.name];
+        if( residue.name == "id" )
+        {
+            ASSERT_TRUE(residue.value == other);
+            continue;
+        }
+        for(size_t i = 0; i < residue.value.Size(); i++)
+        {
+            expectSummaryNear(residue.value[i], other[i]);
+        }
+    }
+}
+
+
+/*!
+ * Checks that an aggregate can be recreated exactly from its JSON 
+ * representation, including an aggregate without any frames.
+ */
+TEST_F(FrameAggregateTest, FrameAggregateJsonTest)
+{
+    rapidjson::Document doc;
+    for(size_t numFrames : {size_t(0), frames_.size()})
+    {
+        FrameAggregate agg = aggregate(0, numFrames);
+        rapidjson::Value json = agg.toJson(doc.GetAllocator());
+        FrameAggregate copy = FrameAggregate::fromJson(json);
+        ASSERT_EQ(agg.numFrames(), copy.numFrames());
+        ASSERT_TRUE(json == copy.toJson(doc.GetAllocator()));
+
+        // recreated aggregate can still be extended:
+        copy.merge(aggregate(numFrames, frames_.size()));
+        ASSERT_EQ(frames_.size(), copy.numFrames());
+    }
+}
+
+
+/*!
+ * Checks that the trajectory-wide solvent histogram only counts particles 
+ * inside the sample, is combined exactly when merging aggregates, and 
+ * survives the conversion to and from JSON. Aggregates with and without
+ * histogram can not be merged.
+ */
+TEST_F(FrameAggregateTest, FrameAggregateSolventHistogramTest)
+{
+    // add solvent positions to frames:
+    for(size_t i = 0; i < frames_.size(); i++)
+    {
+        real x = static_cast<real>(i);
+        frames_[i].solventS_ = {-0.73 + 0.1*x, 0.05*x, 0.41, 2.5};
+        frames_[i].solventInSample_ = {1.0, 1.0, 1.0, 0.0};
+    }
+    auto histogramAggregate = [&](size_t begin, size_t end)
+    {
+        FrameAggregate agg(supportPoints_, -0.5, 0.5);
+        agg.setSolventHistogram(0.1);
+        for(size_t i = begin; i < end; i++)
+        {
+            agg.update(frames_[i], samples_[i]);
+        }
+        return agg;
+    };
+
+    // aggregate in one pass and in two shards:
+    FrameAggregate full = histogramAggregate(0, frames_.size());
+    FrameAggregate merged = histogramAggregate(0, 4);
+    merged.merge(histogramAggregate(4, frames_.size()));
+
+    // histograms agree exactly and ignore particles outside sample:
+    rapidjson::Document doc;
+    rapidjson::Value fullJson = full.toJson(doc.GetAllocator());
+    rapidjson::Value mergedJson = merged.toJson(doc.GetAllocator());
+    ASSERT_TRUE(fullJson.HasMember("solventHistogram"));
+    ASSERT_TRUE(fullJson["solventHistogram"] == mergedJson["solventHistogram"]);
+    size_t numCounted = 0;
+    for(auto &count : fullJson["solventHistogram"]["counts"].GetArray())
+    {
+        numCounted += count.GetUint64();
+    }
+    ASSERT_EQ(3*frames_.size(), numCounted);
+
+    // histogram is recreated from JSON:
+    FrameAggregate copy = FrameAggregate::fromJson(fullJson);
+    ASSERT_TRUE(fullJson == copy.toJson(doc.GetAllocator()));
+
+    // histogram must be set up before adding frames:
+    ASSERT_THROW(full.setSolventHistogram(0.1), std::logic_error);
+
+    // can not merge with aggregate without histogram:
+    ASSERT_THROW(full.merge(aggregate(0, 3)), std::runtime_error);
+}
+
+
+/*!
+ * Checks that aggregates with different support points or pore residues can
+ * not be merged.
+ */
+TEST_F(FrameAggregateTest, FrameAggregateMergeMismatchTest)
+{
+    FrameAggregate agg = aggregate(0, 3);
+
+    FrameAggregate shifted(supportPoints_, -0.5, 0.6);
+    ASSERT_THROW(agg.merge(shifted), std::runtime_error);
+
+    FrameStreamData frame = frames_[3];
+    frame.resId_ = {3, 9};
+    FrameAggregate other(supportPoints_, -0.5, 0.5);
+    other.update(frame, samples_[3]);
+    ASSERT_THROW(agg.merge(other), std::runtime_error);
+}
+
+
+
+/*!
+ * Checks that the ensemble profile summarises the time-averaged profiles of
+ * each replica, with the energy profile of each replica shifted by its own 
+ * anchor energy.
+ */
+TEST_F(FrameAggregateTest, FrameAggregateEnsembleProfileTest)
+{
+    // floating point comparison threshold:
+    real eps = 100*std::numeric_limits<real>::epsilon();
+
+    // treat two sections of the frame sequence as independent replicas:
+    std::vector<FrameAggregate> replicas = {
+            aggregate(0, 3), 
+            aggregate(3, frames_.size())};
+
+    // radius is summarised over replica means:
+    std::vector<SummaryStatistics> radius = FrameAggregate::ensembleProfile(
+            replicas, 
+            "radius");
+    ASSERT_EQ(supportPoints_.size(), radius.size());
+    SummaryStatistics expected;
+    expected.update(0.6);
+    expected.update(0.95);
+    ASSERT_EQ(2, radius[0].num());
+    ASSERT_NEAR(expected.mean(), radius[0].mean(), eps);
+    ASSERT_NEAR(expected.var(), radius[0].var(), eps);
+    ASSERT_NEAR(0.0, radius[1].var(), eps);
+
+    // constant energy differs between replicas only due to anchor energy:
+    std::vector<SummaryStatistics> energy = FrameAggregate::ensembleProfile(
+            replicas, 
+            "energy");
+    ASSERT_NEAR(0.175, energy[2].min(), eps);
+    ASSERT_NEAR(0.2625, energy[2].max(), eps);
+
+    // unknown profile names are rejected:
+    ASSERT_THROW(
+            FrameAggregate::ensembleProfile(replicas, "foo"), 
+            std::logic_error);
+}
@@ -0,0 +1,138 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "io/async_file_writer.hpp"
+
+
+/*!
+ * \brief Test fixture for the AsyncFileWriter.
+ */
+class AsyncFileWriterTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Reads the entire content of a file into a string.
+         */
+        std::string readFile(const std::string &fileName)
+        {
+            std::ifstream file(fileName.c_str());
+            std::stringstream content;
+            content<<file.rdbuf();
+            return content.str();
+        }
+
+    protected:
+
+        std::string fileName_ = "async_file_writer_test.txt";
+};
+
+
+/*!
+ * Checks that all lines written to the buffer end up in the file in their
+ * original order, even if buffers are small and the queue holds only a 
+ * single buffer, so that the calling thread frequently has to wait for the
+ * writer thread.
+ */
+TEST_F(AsyncFileWriterTest, AsyncFileWriterContentTest)
+{
+    // try various buffer sizes and queue lengths:
+    std::vector<size_t> bufferSizes = {1, 100, 1 << 20};
+    std::vector<size_t> queueLengths = {1, 4};
+    for(auto bufferSize : bufferSizes)
+    {
+        for(auto queueLength : queueLengths)
+        {
+            AsyncFileWriter writer(bufferSize, queueLength);
+            writer.open(fileName_);
+            ASSERT_TRUE(writer.isOpen());
+
+            // write lines and keep a copy for comparison:
+            std::string reference;
+            for(int i = 0; i < 10000; i++)
+            {
+                std::string line = "line " + std::to_string(i) + "\n";
+                reference += line;
+                for(auto c : line)
+                {
+                    writer.buffer().Put(c);
+                }
+                writer.commit();
+            }
+
+            // file is complete only after closing:
+            writer.close();
+            ASSERT_FALSE(writer.isOpen());
+            ASSERT_EQ(reference, readFile(fileName_));
+        }
+    }
+
+    std::remove(fileName_.c_str());
+}
+
+
+/*!
+ * Checks that an existing file is overwritten, that the writer can be reused 
+ * after closing, and that opening a file in a non-existent directory throws.
+ */
+TEST_F(AsyncFileWriterTest, AsyncFileWriterReopenTest)
+{
+    AsyncFileWriter writer;
+
+    // write some content:
+    writer.open(fileName_);
+    writer.buffer().Put('a');
+    writer.close();
+    ASSERT_EQ("a", readFile(fileName_));
+
+    // reopening truncates file:
+    writer.open(fileName_);
+    writer.buffer().Put('b');
+    writer.flush();
+    writer.buffer().Put('c');
+    writer.close();
+    ASSERT_EQ("bc", readFile(fileName_));
+
+    // closing twice is harmless:
+    writer.close();
+
+    // invalid path:
+    ASSERT_THROW(writer.open("no/such/directory/file.txt"), 
+                 std::runtime_error);
+
+    // zero length queue is not permitted:
+    ASSERT_THROW(AsyncFileWriter(1, 0), std::logic_error);
+
+    std::remove(fileName_.c_str());
+}
+
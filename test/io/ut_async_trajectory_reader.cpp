@@ -0,0 +1,194 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gromacs/fileio/xtcio.h>
+
+#include "io/async_trajectory_reader.hpp"
+
+
+/*!
+ * \brief Test fixture for the AsyncTrajectoryReader.
+ *
+ * Writes a short XTC trajectory in which the coordinates of each frame encode
+ * the frame and atom index.
+ */
+class AsyncTrajectoryReaderTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Constructor writes the test trajectory.
+         */
+        AsyncTrajectoryReaderTest()
+        {
+            matrix box = {{5.0, 0.0, 0.0}, {0.0, 5.0, 0.0}, {0.0, 0.0, 5.0}};
+            std::vector<gmx::RVec> x(numAtoms_);
+            t_fileio *file = open_xtc(fileName_.c_str(), "w");
+            for(int f = 0; f < numFrames_; f++)
+            {
+                for(int i = 0; i < numAtoms_; i++)
+                {
+                    x[i] = gmx::RVec(0.5*f, 0.25*i, 1.0);
+                }
+                write_xtc(
+                        file, 
+                        numAtoms_, 
+                        f, 
+                        10.0*f, 
+                        box, 
+                        as_rvec_array(x.data()), 
+                        1000.0);
+            }
+            close_xtc(file);
+        }
+
+        /*!
+         * Destructor removes the test trajectory.
+         */
+        ~AsyncTrajectoryReaderTest()
+        {
+            std::remove(fileName_.c_str());
+        }
+
+    protected:
+
+        std::string fileName_ = "async_trajectory_reader_test.xtc";
+        int numAtoms_ = 7;
+        int numFrames_ = 25;
+};
+
+
+/*!
+ * Checks that all frames are returned in their original order with correct 
+ * time stamps and coordinates, even if only a single buffer is available, 
+ * so that the reader thread frequently has to wait for the calling thread.
+ */
+TEST_F(AsyncTrajectoryReaderTest, AsyncTrajectoryReaderContentTest)
+{
+    for(size_t numBuffers : {1, 2, 8})
+    {
+        AsyncTrajectoryReader reader(numBuffers);
+        reader.open(fileName_);
+
+        int numFramesRead = 0;
+        while( const t_trxframe *frame = reader.nextFrame() )
+        {
+            ASSERT_EQ(numAtoms_, frame -> natoms);
+            ASSERT_NEAR(10.0*numFramesRead, frame -> time, 1e-3);
+            for(int i = 0; i < numAtoms_; i++)
+            {
+                ASSERT_NEAR(0.5*numFramesRead, frame -> x[i][XX], 1e-3);
+                ASSERT_NEAR(0.25*i, frame -> x[i][YY], 1e-3);
+                ASSERT_NEAR(1.0, frame -> x[i][ZZ], 1e-3);
+            }
+            ASSERT_NEAR(5.0, frame -> box[ZZ][ZZ], 1e-3);
+            numFramesRead++;
+        }
+        ASSERT_EQ(numFrames_, numFramesRead);
+
+        // end of trajectory is sticky:
+        ASSERT_EQ(nullptr, reader.nextFrame());
+        reader.close();
+    }
+}
+
+
+/*!
+ * Checks that the reader can be reopened after closing, also if not all 
+ * frames have been read, and that reading from a closed reader or opening a
+ * non-existent file throws.
+ */
+TEST_F(AsyncTrajectoryReaderTest, AsyncTrajectoryReaderReopenTest)
+{
+    AsyncTrajectoryReader reader(2);
+
+    // stop reading early:
+    reader.open(fileName_);
+    ASSERT_NEAR(0.0, reader.nextFrame() -> time, 1e-3);
+    ASSERT_NEAR(10.0, reader.nextFrame() -> time, 1e-3);
+    reader.close();
+
+    // reopening starts from first frame:
+    reader.open(fileName_);
+    ASSERT_NEAR(0.0, reader.nextFrame() -> time, 1e-3);
+    reader.close();
+
+    // closing twice is harmless, but no frames can be read:
+    reader.close();
+    ASSERT_THROW(reader.nextFrame(), std::logic_error);
+
+    // invalid file:
+    ASSERT_ANY_THROW(reader.open("no/such/directory/traj.xtc"));
+
+    // zero buffers are not permitted:
+    ASSERT_THROW(AsyncTrajectoryReader(0), std::logic_error);
+}
+
+
+/*!
+ * Checks that only frames within the time range set for an XTC file are 
+ * returned, that the time step is counted from the first frame read, and 
+ * that coordinates of the atoms below the maximum number of atoms are 
+ * decoded correctly.
+ */
+TEST_F(AsyncTrajectoryReaderTest, AsyncTrajectoryReaderTimeRangeTest)
+{
+    AsyncTrajectoryReader reader(2);
+    reader.setMaxAtoms(3);
+    reader.setTimeRange(45.0, 200.0, 30.0);
+    reader.open(fileName_);
+
+    std::vector<real> times;
+    while( const t_trxframe *frame = reader.nextFrame() )
+    {
+        ASSERT_EQ(numAtoms_, frame -> natoms);
+        for(int i = 0; i < 3; i++)
+        {
+            ASSERT_NEAR(0.05*frame -> time, frame -> x[i][XX], 1e-3);
+            ASSERT_NEAR(0.25*i, frame -> x[i][YY], 1e-3);
+        }
+        times.push_back(frame -> time);
+    }
+    reader.close();
+
+    std::vector<real> expectedTimes = {50.0, 80.0, 110.0, 140.0, 170.0, 200.0};
+    ASSERT_EQ(expectedTimes.size(), times.size());
+    for(size_t i = 0; i < times.size(); i++)
+    {
+        ASSERT_NEAR(expectedTimes[i], times[i], 1e-3);
+    }
+
+    // no frames in time range:
+    reader.setTimeRange(1000.0, 2000.0, 0.0);
+    ASSERT_THROW(reader.open(fileName_), std::runtime_error);
+}
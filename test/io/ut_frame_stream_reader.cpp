@@ -0,0 +1,304 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "io/frame_stream_reader.hpp"
+
+
+/*!
+ * \brief Test fixture for the FrameStreamReader.
+ */
+class FrameStreamReaderTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Constructor creates a line of the stream file containing all data 
+         * sets that are written during the analysis.
+         */
+        FrameStreamReaderTest()
+        {
+            validLine_ = 
+                "{\"i\":3,\"t\":1.5,"
+                "\"pathSummary\":{\"timeStamp\":[1.5],\"argMinRadius\":[0.25],"
+                "\"minRadius\":[0.125],\"length\":[4.0],\"volume\":[2.0],"
+                "\"numPath\":[1.0],\"numSample\":[42.0],"
+                "\"solventRangeLo\":[-3.0],\"solventRangeHi\":[3.0],"
+                "\"argMinSolventDensity\":[0.5],"
+                "\"minSolventDensity\":[7.0],\"arcLengthLo\":[-2.0],"
+                "\"arcLengthHi\":[2.0],\"bandWidth\":[0.1]},"
+                "\"molPathOrigPoints\":{\"x\":[0.0,1.0],\"y\":[0.0,2.0],"
+                "\"z\":[-1.0,1.0],\"r\":[0.5,0.6]},"
+                "\"molPathRadiusSpline\":{\"knots\":[-2.0,0.0,2.0],"
+                "\"ctrl\":[0.5,0.4,0.6]},"
+                "\"molPathCentreLineSpline\":{\"knots\":[-2.0,2.0],"
+                "\"ctrlX\":[0.0,1.0],\"ctrlY\":[0.0,2.0],\"ctrlZ\":[-1.0,1.0]},"
+                "\"residuePositions\":{\"resId\":[10.0,11.0],\"s\":[0.1,0.2],"
+                "\"rho\":[1.0,1.1],\"phi\":[0.0,3.0],\"poreLining\":[1.0,0.0],"
+                "\"poreFacing\":[0.0,1.0],\"poreRadius\":[0.5,0.7],"
+                "\"solventDensity\":[0.01,0.02],\"x\":[1.0,2.0],"
+                "\"y\":[3.0,4.0],\"z\":[5.0,6.0]},"
+                "\"solventPositions\":{\"resId\":[1.0,2.0,3.0],"
+                "\"s\":[0.0,0.1,0.2],\"rho\":[0.0,0.0,0.0],"
+                "\"phi\":[0.0,0.0,0.0],\"inPore\":[1.0,1.0,0.0],"
+                "\"inSample\":[1.0,1.0,1.0],\"x\":[0.0,0.0,0.0],"
+                "\"y\":[0.0,0.0,0.0],\"z\":[0.0,0.0,0.0]},"
+                "\"solventDensitySpline\":{\"knots\":[-3.0,3.0],"
+                "\"ctrl\":[0.0,0.0]},"
+                "\"plHydrophobicitySpline\":{\"knots\":[-1.0,1.0],"
+                "\"ctrl\":[0.5,-0.5]},"
+                "\"pfHydrophobicitySpline\":{\"knots\":[-1.0,0.0,1.0],"
+                "\"ctrl\":[1.0,2.0,3.0]}}";
+        }
+
+        /*!
+         * Writes the given lines to the test file.
+         */
+        void writeFile(const std::vector<std::string> &lines)
+        {
+            std::ofstream file(fileName_.c_str());
+            for(auto &line : lines)
+            {
+                file<<line<<"\n";
+            }
+        }
+
+    protected:
+
+        std::string fileName_ = "frame_stream_reader_test.json";
+        std::string validLine_;
+};
+
+
+/*!
+ * Checks that all values of interest are extracted from a valid line, that
+ * reading the same data twice yields the same result, and that the end of the
+ * file is detected.
+ */
+TEST_F(FrameStreamReaderTest, FrameStreamReaderValidTest)
+{
+    writeFile({validLine_, validLine_});
+
+    FrameStreamReader reader;
+    FrameStreamData frame;
+    reader.open(fileName_);
+    for(int i = 0; i < 2; i++)
+    {
+        ASSERT_TRUE(reader.readFrame(frame));
+        ASSERT_EQ(i + 1, reader.numFramesRead());
+
+        // frame number and time stamp:
+        ASSERT_EQ(3, frame.frameIndex_);
+        ASSERT_FLOAT_EQ(1.5, frame.frameTime_);
+
+        // scalar path summary:
+        ASSERT_FLOAT_EQ(1.5, frame.timeStamp_);
+        ASSERT_FLOAT_EQ(0.25, frame.argMinRadius_);
+        ASSERT_FLOAT_EQ(0.125, frame.minRadius_);
+        ASSERT_FLOAT_EQ(4.0, frame.length_);
+        ASSERT_FLOAT_EQ(2.0, frame.volume_);
+        ASSERT_FLOAT_EQ(1.0, frame.numPath_);
+        ASSERT_FLOAT_EQ(42.0, frame.numSample_);
+        ASSERT_FLOAT_EQ(-3.0, frame.solventRangeLo_);
+        ASSERT_FLOAT_EQ(3.0, frame.solventRangeHi_);
+        ASSERT_FLOAT_EQ(0.5, frame.argMinSolventDensity_);
+        ASSERT_FLOAT_EQ(7.0, frame.minSolventDensity_);
+        ASSERT_FLOAT_EQ(-2.0, frame.arcLengthLo_);
+        ASSERT_FLOAT_EQ(2.0, frame.arcLengthHi_);
+        ASSERT_FLOAT_EQ(0.1, frame.bandWidth_);
+
+        // arrays are not appended to across frames:
+        ASSERT_EQ(2, frame.origPointsR_.size());
+        ASSERT_FLOAT_EQ(0.6, frame.origPointsR_[1]);
+        ASSERT_EQ(3, frame.radiusSpline_.knots_.size());
+        ASSERT_FLOAT_EQ(0.4, frame.radiusSpline_.ctrl_[1]);
+        ASSERT_EQ(2, frame.centreLineKnots_.size());
+        ASSERT_FLOAT_EQ(2.0, frame.centreLineCtrlY_[1]);
+        ASSERT_EQ(2, frame.resId_.size());
+        ASSERT_FLOAT_EQ(11.0, frame.resId_[1]);
+        ASSERT_FLOAT_EQ(0.02, frame.resSolventDensity_[1]);
+        ASSERT_FLOAT_EQ(6.0, frame.resZ_[1]);
+        ASSERT_EQ(2, frame.solventDensitySpline_.ctrl_.size());
+        ASSERT_FLOAT_EQ(-0.5, frame.plHydrophobicitySpline_.ctrl_[1]);
+        ASSERT_FLOAT_EQ(3.0, frame.pfHydrophobicitySpline_.ctrl_[2]);
+
+        // conversion to three-dimensional points:
+        std::vector<gmx::RVec> points = frame.origPoints();
+        ASSERT_EQ(2, points.size());
+        ASSERT_FLOAT_EQ(1.0, points[1][0]);
+        ASSERT_FLOAT_EQ(2.0, points[1][1]);
+        ASSERT_FLOAT_EQ(1.0, points[1][2]);
+        std::vector<gmx::RVec> ctrlPoints = frame.centreLineCtrlPoints();
+        ASSERT_EQ(2, ctrlPoints.size());
+        ASSERT_FLOAT_EQ(-1.0, ctrlPoints[0][2]);
+    }
+
+    // end of file:
+    ASSERT_FALSE(reader.readFrame(frame));
+    reader.close();
+
+    std::remove(fileName_.c_str());
+}
+
+
+/*!
+ * Checks that solvent positions are only read if requested and are then 
+ * required.
+ */
+TEST_F(FrameStreamReaderTest, FrameStreamReaderSolventPositionsTest)
+{
+    writeFile({validLine_});
+
+    // not read by default:
+    FrameStreamReader reader;
+    FrameStreamData frame;
+    reader.open(fileName_);
+    ASSERT_TRUE(reader.readFrame(frame));
+    ASSERT_EQ(0, frame.solventS_.size());
+    reader.close();
+
+    // read on request:
+    reader.setReadSolventPositions(true);
+    reader.open(fileName_);
+    ASSERT_TRUE(reader.readFrame(frame));
+    ASSERT_EQ(3, frame.solventS_.size());
+    ASSERT_FLOAT_EQ(0.2, frame.solventS_[2]);
+    ASSERT_FLOAT_EQ(0.0, frame.solventInPore_[2]);
+    ASSERT_FLOAT_EQ(1.0, frame.solventInSample_[2]);
+    ASSERT_EQ(2, frame.resId_.size());
+    reader.close();
+
+    // missing solvent positions are an error if requested:
+    std::string line = validLine_;
+    size_t pos = line.find("\"solventPositions\"");
+    line.replace(pos, std::string("\"solventPositions\"").size(), 
+                 "\"otherPositions\"");
+    writeFile({line});
+    reader.open(fileName_);
+    ASSERT_THROW(reader.readFrame(frame), std::runtime_error);
+    reader.close();
+
+    std::remove(fileName_.c_str());
+}
+
+
+/*!
+ * Checks that parameter dependent columns are read from the suffixed data
+ * sets of a parameter sweep, while all other columns are still read from the
+ * primary data sets.
+ */
+TEST_F(FrameStreamReaderTest, FrameStreamReaderDataSetSuffixTest)
+{
+    // append data sets of one parameter set to valid line:
+    std::string line = validLine_.substr(0, validLine_.size() - 1) +
+        ",\"pathSummary_sweep1\":{\"solventRangeLo\":[-4.0],"
+        "\"solventRangeHi\":[4.0],\"argMinSolventDensity\":[0.25],"
+        "\"minSolventDensity\":[3.0],\"bandWidth\":[0.2]},"
+        "\"residuePositions_sweep1\":{\"solventDensity\":[0.03,0.04]},"
+        "\"solventDensitySpline_sweep1\":{\"knots\":[-4.0,0.0,4.0],"
+        "\"ctrl\":[0.0,1.0,0.0]},"
+        "\"plHydrophobicitySpline_sweep1\":{\"knots\":[-1.0,1.0],"
+        "\"ctrl\":[0.0,0.0]},"
+        "\"pfHydrophobicitySpline_sweep1\":{\"knots\":[-1.0,1.0],"
+        "\"ctrl\":[0.0,0.0]}}";
+    writeFile({line});
+
+    // primary data sets by default:
+    FrameStreamReader reader;
+    FrameStreamData frame;
+    reader.open(fileName_);
+    ASSERT_TRUE(reader.readFrame(frame));
+    ASSERT_FLOAT_EQ(7.0, frame.minSolventDensity_);
+    ASSERT_FLOAT_EQ(0.02, frame.resSolventDensity_[1]);
+    ASSERT_EQ(2, frame.solventDensitySpline_.knots_.size());
+    reader.close();
+
+    // swept data sets on request:
+    reader.setDataSetSuffix("_sweep1");
+    reader.open(fileName_);
+    ASSERT_TRUE(reader.readFrame(frame));
+    ASSERT_FLOAT_EQ(-4.0, frame.solventRangeLo_);
+    ASSERT_FLOAT_EQ(4.0, frame.solventRangeHi_);
+    ASSERT_FLOAT_EQ(0.25, frame.argMinSolventDensity_);
+    ASSERT_FLOAT_EQ(3.0, frame.minSolventDensity_);
+    ASSERT_FLOAT_EQ(0.2, frame.bandWidth_);
+    ASSERT_FLOAT_EQ(0.04, frame.resSolventDensity_[1]);
+    ASSERT_EQ(3, frame.solventDensitySpline_.knots_.size());
+    ASSERT_FLOAT_EQ(0.0, frame.plHydrophobicitySpline_.ctrl_[0]);
+    ASSERT_EQ(2, frame.pfHydrophobicitySpline_.knots_.size());
+    reader.close();
+
+    // parameter independent columns still come from primary data sets:
+    ASSERT_FLOAT_EQ(0.125, frame.minRadius_);
+    ASSERT_FLOAT_EQ(42.0, frame.numSample_);
+    ASSERT_FLOAT_EQ(0.5, frame.resPoreRadius_[0]);
+    ASSERT_EQ(3, frame.radiusSpline_.knots_.size());
+
+    // a missing parameter set is an error:
+    reader.setDataSetSuffix("_sweep2");
+    reader.open(fileName_);
+    ASSERT_THROW(reader.readFrame(frame), std::runtime_error);
+    reader.close();
+
+    std::remove(fileName_.c_str());
+}
+
+
+/*!
+ * Checks that invalid JSON and lines lacking required data cause an 
+ * exception and that non-existent files can not be opened.
+ */
+TEST_F(FrameStreamReaderTest, FrameStreamReaderInvalidTest)
+{
+    FrameStreamReader reader;
+    FrameStreamData frame;
+
+    // truncated line:
+    writeFile({validLine_.substr(0, validLine_.size()/2)});
+    reader.open(fileName_);
+    ASSERT_THROW(reader.readFrame(frame), std::runtime_error);
+    reader.close();
+
+    // line without residue positions:
+    std::string line = validLine_;
+    size_t pos = line.find("\"residuePositions\"");
+    line.replace(pos, std::string("\"residuePositions\"").size(), 
+                 "\"otherPositions\"");
+    writeFile({line});
+    reader.open(fileName_);
+    ASSERT_THROW(reader.readFrame(frame), std::runtime_error);
+    reader.close();
+
+    // missing file:
+    std::remove(fileName_.c_str());
+    ASSERT_THROW(reader.open(fileName_), std::runtime_error);
+}
+
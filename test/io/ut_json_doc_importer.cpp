@@ -0,0 +1,116 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "config/builtin_data.hpp"
+#include "io/json_doc_importer.hpp"
+
+
+/*!
+ * \brief Test fixture for the JsonDocImporter.
+ */
+class JsonDocImporterTest : public ::testing::Test
+{
+
+};
+
+
+/*!
+ * Checks that a JSON file is read from disk and that missing, empty, and 
+ * invalid files are rejected.
+ */
+TEST_F(JsonDocImporterTest, JsonDocImporterFileTest)
+{
+    JsonDocImporter jdi;
+
+    // write small JSON file:
+    std::string fileName = "test_json_doc_importer.json";
+    std::ofstream file(fileName);
+    file<<"{\"name\": \"test\", \"values\": [1, 2, 3]}";
+    file.close();
+
+    // import file and check content:
+    rapidjson::Document doc = jdi(fileName);
+    ASSERT_TRUE(doc.IsObject());
+    ASSERT_STREQ("test", doc["name"].GetString());
+    ASSERT_EQ(3, doc["values"].Size());
+    ASSERT_EQ(2, doc["values"][1].GetInt());
+
+    // empty file is not a valid JSON object:
+    file.open(fileName, std::ofstream::trunc);
+    file.close();
+    ASSERT_THROW(jdi(fileName), std::invalid_argument);
+
+    // neither is a JSON array:
+    file.open(fileName, std::ofstream::trunc);
+    file<<"[1, 2, 3]";
+    file.close();
+    ASSERT_THROW(jdi(fileName), std::invalid_argument);
+    std::remove(fileName.c_str());
+
+    // missing file:
+    ASSERT_THROW(jdi("no_such_file.json"), std::runtime_error);
+}
+
+
+/*!
+ * Checks that all default databases are compiled into the binary and can be 
+ * parsed by name, while unknown names are rejected.
+ */
+TEST_F(JsonDocImporterTest, JsonDocImporterBuiltinTest)
+{
+    JsonDocImporter jdi;
+
+    // default databases are present:
+    ASSERT_NE(nullptr, builtinDataFile("vdwradii/hole_simple.json"));
+    ASSERT_NE(nullptr, builtinDataFile("hydrophobicity/hessa_2005.json"));
+    ASSERT_NE(nullptr, builtinDataFile("palettes/default.json"));
+
+    // each built-in file is a valid JSON object:
+    for(size_t i = 0; i < g_NUM_BUILTIN_DATA_FILES; i++)
+    {
+        rapidjson::Document doc = jdi.fromBuiltin(
+                g_BUILTIN_DATA_FILES[i].name_);
+        ASSERT_TRUE(doc.IsObject());
+    }
+
+    // palette database contains palette array:
+    rapidjson::Document doc = jdi.fromBuiltin("palettes/default.json");
+    ASSERT_TRUE(doc.HasMember("palettes"));
+    ASSERT_TRUE(doc["palettes"].IsArray());
+
+    // unknown names are rejected:
+    ASSERT_EQ(nullptr, builtinDataFile("vdwradii/no_such_file.json"));
+    ASSERT_THROW(jdi.fromBuiltin("vdwradii/no_such_file.json"), 
+                 std::runtime_error);
+}
+
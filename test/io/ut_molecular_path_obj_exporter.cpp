@@ -139,3 +139,83 @@ TEST_F(MolecularPathObjExporterTest, MolecularPathObjExporterAxisRotationTest)
     ASSERT_NEAR( vec[ZZ], rotZ[ZZ], 10*eps);
 }
 
+
+/*!
+ * Tests the triangulation and vertex normals of a RegularVertexGrid on a 
+ * straight cylinder along the z-axis, where normals away from the ends must 
+ * point radially outward.
+ */
+TEST_F(MolecularPathObjExporterTest, RegularVertexGridTest)
+{
+    // grid coordinates:
+    std::vector<real> s = {0.0, 1.0, 2.0};
+    std::vector<real> phi = {0.0, 0.5*M_PI, M_PI, 1.5*M_PI};
+    RegularVertexGrid grid(s, phi);
+
+    // vertices shared by two properties:
+    real radius = 2.0;
+    std::vector<gmx::RVec> vert;
+    std::vector<real> weightsA;
+    std::vector<real> weightsB;
+    for(size_t i = 0; i < s.size(); i++)
+    {
+        for(size_t j = 0; j < phi.size(); j++)
+        {
+            vert.push_back(gmx::RVec(
+                    radius*std::cos(phi[j]), 
+                    radius*std::sin(phi[j]), 
+                    s[i]));
+            weightsA.push_back(1.0);
+            weightsB.push_back(s[i]);
+        }
+    }
+
+    // grid is incomplete until vertices and a property have been set:
+    ASSERT_THROW(grid.faces("a"), std::logic_error);
+    ASSERT_THROW(grid.normalsFromFaces(), std::logic_error);
+    grid.setVertices(vert);
+    grid.setWeights("b", weightsB);
+    grid.setWeights("a", weightsA);
+
+    // inconsistent sizes and unknown properties are rejected:
+    ASSERT_THROW(grid.setVertices({gmx::RVec(0.0, 0.0, 0.0)}), 
+                 std::logic_error);
+    ASSERT_THROW(grid.setWeights("c", {0.0}), std::logic_error);
+    ASSERT_THROW(grid.weightedVertices("c"), std::logic_error);
+
+    // vertices are linearly indexed along phi first:
+    auto vertices = grid.vertices();
+    ASSERT_EQ(s.size()*phi.size(), vertices.size());
+    ASSERT_NEAR(radius, vertices[5][YY], std::numeric_limits<real>::epsilon());
+    ASSERT_NEAR(1.0, vertices[5][ZZ], std::numeric_limits<real>::epsilon());
+    auto weighted = grid.weightedVertices("b");
+    ASSERT_EQ(1.0, weighted[5].second);
+
+    // two triangles per grid cell, including wrap around:
+    auto indices = grid.triangleIndices();
+    ASSERT_EQ(6*(s.size() - 1)*phi.size(), indices.size());
+    for(auto idx : indices)
+    {
+        ASSERT_LT(idx, vertices.size());
+    }
+
+    // normals in interior ring point radially outward:
+    grid.normalsFromFaces();
+    auto normals = grid.normals();
+    ASSERT_EQ(vertices.size(), normals.size());
+    real eps = 10*std::numeric_limits<real>::epsilon();
+    for(size_t k = phi.size(); k < 2*phi.size(); k++)
+    {
+        gmx::RVec radial(vertices[k][XX], vertices[k][YY], 0.0);
+        unitv(radial, radial);
+        ASSERT_NEAR(1.0, iprod(normals[k], radial), eps);
+    }
+
+    // faces of second property are offset by size of first property grid:
+    auto faces = grid.faces("b");
+    ASSERT_EQ(indices.size()/3, faces.size());
+    ASSERT_EQ(indices[0] + 1, faces[0].vertexIdx_[0]);
+    faces = grid.faces("a");
+    ASSERT_EQ(indices.size()/3, faces.size());
+    ASSERT_EQ(indices[0] + 1 + vertices.size(), faces[0].vertexIdx_[0]);
+}
@@ -0,0 +1,112 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "io/npy_writer.hpp"
+
+
+/*!
+ * \brief Test fixture for the NpyWriter.
+ */
+class NpyWriterTest : public ::testing::Test
+{
+
+};
+
+
+/*!
+ * Checks that the header has the correct preamble, describes the array 
+ * shape, and is padded so that the data starts at a multiple of 64 bytes.
+ */
+TEST_F(NpyWriterTest, NpyWriterHeaderTest)
+{
+    // two dimensional array:
+    std::string head = NpyWriter::header({3, 5});
+    ASSERT_EQ(0, head.size() % 64);
+    ASSERT_EQ(std::string("\x93NUMPY\x01\x00", 8), head.substr(0, 8));
+    ASSERT_EQ(head.size() - 10, 
+              static_cast<unsigned char>(head[8]) + 
+              256*static_cast<unsigned char>(head[9]));
+    ASSERT_EQ('\n', head.back());
+    ASSERT_NE(std::string::npos, head.find("'shape': (3, 5), }"));
+    ASSERT_NE(std::string::npos, head.find("'fortran_order': False"));
+    ASSERT_NE(std::string::npos, head.find(NpyWriter::descr()));
+
+    // one dimensional array needs trailing comma in tuple:
+    head = NpyWriter::header({7});
+    ASSERT_EQ(0, head.size() % 64);
+    ASSERT_NE(std::string::npos, head.find("'shape': (7,), }"));
+
+    // type description matches real:
+    std::string descr = NpyWriter::descr();
+    ASSERT_EQ(std::to_string(sizeof(real)), descr.substr(2));
+    ASSERT_EQ('f', descr[1]);
+}
+
+
+/*!
+ * Checks that the data section of a written file contains the raw array 
+ * data and that inconsistent shapes are rejected.
+ */
+TEST_F(NpyWriterTest, NpyWriterWriteTest)
+{
+    std::vector<real> data = {0.0, 1.5, -2.0, 3.25, 4.0, 1e-3};
+    std::string fileName = "test_npy_writer.npy";
+    NpyWriter::write(fileName, data, {2, 3});
+
+    // read file content:
+    std::ifstream file(fileName, std::ifstream::binary);
+    std::stringstream content;
+    content<<file.rdbuf();
+    std::string str = content.str();
+
+    // check size and content of data section:
+    std::string head = NpyWriter::header({2, 3});
+    ASSERT_EQ(head.size() + data.size()*sizeof(real), str.size());
+    ASSERT_EQ(head, str.substr(0, head.size()));
+    std::vector<real> readData(data.size());
+    std::copy(
+            str.begin() + head.size(), 
+            str.end(), 
+            reinterpret_cast<char*>(readData.data()));
+    for(size_t i = 0; i < data.size(); i++)
+    {
+        ASSERT_EQ(data[i], readData[i]);
+    }
+    std::remove(fileName.c_str());
+
+    // shape must match number of elements:
+    ASSERT_THROW(NpyWriter::write(fileName, data, {4, 2}), std::logic_error);
+}
+
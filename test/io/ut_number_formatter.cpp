@@ -0,0 +1,104 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cmath>
+#include <limits>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "io/number_formatter.hpp"
+
+
+/*!
+ * \brief Test fixture for the NumberFormatter.
+ */
+class NumberFormatterTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Formats a real with the given number of decimal places.
+         */
+        std::string formatReal(real value, int decimalPlaces)
+        {
+            rapidjson::StringBuffer buffer;
+            NumberFormatter::appendReal(buffer, value, decimalPlaces);
+            return std::string(buffer.GetString(), buffer.GetSize());
+        }
+
+        /*!
+         * Formats an integer.
+         */
+        std::string formatInt(int value)
+        {
+            rapidjson::StringBuffer buffer;
+            NumberFormatter::appendInt(buffer, value);
+            return std::string(buffer.GetString(), buffer.GetSize());
+        }
+};
+
+
+/*!
+ * Checks formatting of floating point numbers, including truncation to the
+ * given number of decimal places and non-finite values.
+ */
+TEST_F(NumberFormatterTest, NumberFormatterRealTest)
+{
+    ASSERT_EQ("0.0", formatReal(0.0, 6));
+    ASSERT_EQ("1.0", formatReal(1.0, 6));
+    ASSERT_EQ("-2.5", formatReal(-2.5, 6));
+    ASSERT_EQ("0.1", formatReal(0.1, 6));
+    ASSERT_EQ("12.75", formatReal(12.75, 6));
+    ASSERT_EQ("3.14", formatReal(3.14159, 2));
+    ASSERT_EQ("0.0", formatReal(1e-9, 6));
+    ASSERT_EQ("nan", formatReal(std::nan(""), 6));
+    ASSERT_EQ("inf", formatReal(std::numeric_limits<real>::infinity(), 6));
+    ASSERT_EQ("-inf", formatReal(-std::numeric_limits<real>::infinity(), 6));
+
+    // formatted value must be close to original:
+    real value = 123.456789;
+    ASSERT_NEAR(value, std::stod(formatReal(value, 3)), 1e-3);
+
+    // must have at least one decimal place:
+    ASSERT_THROW(formatReal(1.0, 0), std::logic_error);
+}
+
+
+/*!
+ * Checks formatting of integers.
+ */
+TEST_F(NumberFormatterTest, NumberFormatterIntTest)
+{
+    ASSERT_EQ("0", formatInt(0));
+    ASSERT_EQ("42", formatInt(42));
+    ASSERT_EQ("-1234567", formatInt(-1234567));
+    ASSERT_EQ(std::to_string(std::numeric_limits<int>::max()), 
+              formatInt(std::numeric_limits<int>::max()));
+    ASSERT_EQ(std::to_string(std::numeric_limits<int>::min()), 
+              formatInt(std::numeric_limits<int>::min()));
+}
+
@@ -0,0 +1,311 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "external/rapidjson/document.h"
+
+#include "io/npy_writer.hpp"
+#include "io/results_json_exporter.hpp"
+#include "io/results_json_stream_writer.hpp"
+
+
+/*!
+ * \brief Test fixture for the ResultsJsonStreamWriter.
+ *
+ * Creates a set of statistics objects resembling those obtained in a 
+ * trajectory analysis, which can be added to both the in-memory 
+ * ResultsJsonExporter and the ResultsJsonStreamWriter.
+ */
+class ResultsJsonStreamWriterTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Constructor fills statistics with deterministic pseudo-data.
+         */
+        ResultsJsonStreamWriterTest()
+            : supportPoints_({-1.0, -0.5, 0.0, 0.5, 1.0})
+            , timeStamps_({0.0, 10.0, 20.0, 30.0})
+            , profile_(supportPoints_.size())
+            , quantiles_(supportPoints_.size(), {0.05, 0.5, 0.95})
+            , profileBlockAvg_(supportPoints_.size())
+            , profileAutocorr_(supportPoints_.size(), 
+                               AutocorrelationStatistics(2))
+            , autocorr_(2)
+            , resSummary_()
+        {
+            for(size_t t = 0; t < timeStamps_.size(); t++)
+            {
+                std::vector<real> row;
+                for(size_t s = 0; s < supportPoints_.size(); s++)
+                {
+                    row.push_back(0.1*t + 0.3*s*s + 0.01*std::sin(t*s));
+                }
+                profile_.update(row);
+                quantiles_.update(row);
+                BlockAverageStatistics::updateMultiple(profileBlockAvg_, row);
+                AutocorrelationStatistics::updateMultiple(
+                        profileAutocorr_, 
+                        row);
+                profileTimeSeries_.push_back(row);
+
+                summary_.update(row.front());
+                blockAvg_.update(row.front());
+                autocorr_.update(row.front());
+                scalarTimeSeries_.push_back(row.back());
+            }
+            ensembleProfile_.resize(supportPoints_.size());
+            for(size_t s = 0; s < supportPoints_.size(); s++)
+            {
+                ensembleProfile_[s].update(0.3*s*s);
+                ensembleProfile_[s].update(0.3*s*s + 0.1);
+            }
+        }
+
+        /*!
+         * Adds all test data to a results writer in output order.
+         */
+        template<typename T>
+        void addResults(T &results)
+        {
+            results.addPathwaySummary("minRadius", summary_);
+            results.addPathwaySummary(
+                    "length", 
+                    summary_, 
+                    blockAvg_, 
+                    autocorr_);
+            results.addSupportPoints(supportPoints_);
+            results.addPathwayProfile("radius", profile_, quantiles_);
+            results.addPathwayProfile("energy", profile_);
+            results.addPathwayProfileErrors(
+                    "radius", 
+                    profileBlockAvg_, 
+                    profileAutocorr_);
+            results.addTimeStamps(timeStamps_);
+            results.addPathwayScalarTimeSeries("length", scalarTimeSeries_);
+            results.addPathwayGridPoints(timeStamps_, supportPoints_);
+            results.addPathwayProfileTimeSeries("radius", profileTimeSeries_);
+            results.addResidueInformation(resId_, resInfo_);
+            results.addResidueSummary("rho", resSummary_);
+            results.addConvergenceInformation(true, 3, 30.0);
+            results.addEnsembleInformation({"replica1", "replica2"});
+            results.addEnsembleProfile("radius", ensembleProfile_);
+        }
+
+        /*!
+         * Returns the content of a file as a string.
+         */
+        std::string readFile(const std::string &fileName)
+        {
+            std::ifstream file(fileName);
+            std::stringstream content;
+            content<<file.rdbuf();
+            return content.str();
+        }
+
+    protected:
+
+        std::vector<real> supportPoints_;
+        std::vector<real> timeStamps_;
+        SummaryStatistics summary_;
+        BlockAverageStatistics blockAvg_;
+        ProfileSummaryStatistics profile_;
+        ProfileQuantileStatistics quantiles_;
+        std::vector<BlockAverageStatistics> profileBlockAvg_;
+        std::vector<AutocorrelationStatistics> profileAutocorr_;
+        AutocorrelationStatistics autocorr_;
+        std::vector<real> scalarTimeSeries_;
+        std::vector<std::vector<real>> profileTimeSeries_;
+        std::vector<SummaryStatistics> ensembleProfile_;
+        std::vector<int> resId_;
+        ResidueInformationProvider resInfo_;
+        std::vector<SummaryStatistics> resSummary_;
+};
+
+
+/*!
+ * Checks that the streamed output is byte-identical to the output of the 
+ * in-memory ResultsJsonExporter.
+ */
+TEST_F(ResultsJsonStreamWriterTest, ResultsJsonStreamWriterByteCompatibleTest)
+{
+    // write output with both implementations:
+    ResultsJsonExporter exporter;
+    addResults(exporter);
+    exporter.write("test_results_dom.json");
+
+    ResultsJsonStreamWriter writer;
+    writer.open("test_results_stream.json");
+    addResults(writer);
+    writer.close();
+
+    // compare file contents:
+    std::string expected = readFile("test_results_dom.json");
+    std::string actual = readFile("test_results_stream.json");
+    ASSERT_FALSE(expected.empty());
+    ASSERT_EQ(expected, actual);
+
+    std::remove("test_results_dom.json");
+    std::remove("test_results_stream.json");
+}
+
+
+/*!
+ * Checks that top level objects to which no data has been added are written
+ * as empty objects, as in the output of the ResultsJsonExporter.
+ */
+TEST_F(ResultsJsonStreamWriterTest, ResultsJsonStreamWriterEmptySectionsTest)
+{
+    // write output with both implementations:
+    ResultsJsonExporter exporter;
+    exporter.addTimeStamps(timeStamps_);
+    exporter.addPathwayScalarTimeSeries("length", scalarTimeSeries_);
+    exporter.write("test_results_dom.json");
+
+    ResultsJsonStreamWriter writer;
+    writer.open("test_results_stream.json");
+    writer.addTimeStamps(timeStamps_);
+    writer.addPathwayScalarTimeSeries("length", scalarTimeSeries_);
+    writer.close();
+
+    // compare file contents:
+    ASSERT_EQ(
+            readFile("test_results_dom.json"), 
+            readFile("test_results_stream.json"));
+
+    std::remove("test_results_dom.json");
+    std::remove("test_results_stream.json");
+}
+
+
+/*!
+ * Checks that in NPY format the time series are written to separate files
+ * which are referenced in the JSON output, while all other data is still 
+ * written to the JSON file.
+ */
+TEST_F(ResultsJsonStreamWriterTest, ResultsJsonStreamWriterNpyTest)
+{
+    ResultsJsonStreamWriter writer;
+    writer.open("test_results_npy.json", eTimeSeriesFormatNpy);
+    addResults(writer);
+    writer.close();
+
+    // parse output:
+    rapidjson::Document doc;
+    doc.Parse(readFile("test_results_npy.json").c_str());
+    ASSERT_FALSE(doc.HasParseError());
+    ASSERT_TRUE(doc["pathwayProfile"]["s"].IsArray());
+    ASSERT_TRUE(doc["convergence"]["converged"].GetBool());
+    ASSERT_EQ(2, doc["ensemble"]["numReplicas"].GetInt());
+    ASSERT_EQ(supportPoints_.size(), doc["ensemble"]["radiusVar"].Size());
+
+    // check references to array files:
+    const rapidjson::Value &scalarTs = doc["pathwayScalarTimeSeries"];
+    ASSERT_STREQ(
+            "test_results_npy_pathwayScalarTimeSeries_length.npy",
+            scalarTs["length"]["file"].GetString());
+    ASSERT_EQ(NpyWriter::descr(), scalarTs["length"]["dtype"].GetString());
+    ASSERT_EQ(1, scalarTs["length"]["shape"].Size());
+    ASSERT_EQ(timeStamps_.size(), scalarTs["length"]["shape"][0].GetUint64());
+
+    const rapidjson::Value &profileTs = doc["pathwayProfileTimeSeries"];
+    ASSERT_EQ(supportPoints_.size(), profileTs["s"]["shape"][0].GetUint64());
+    ASSERT_EQ(2, profileTs["radius"]["shape"].Size());
+    ASSERT_EQ(timeStamps_.size(), profileTs["radius"]["shape"][0].GetUint64());
+    ASSERT_EQ(
+            supportPoints_.size(), 
+            profileTs["radius"]["shape"][1].GetUint64());
+
+    // profile matrix is stored with one row per time step:
+    std::string radius = readFile(
+            "test_results_npy_pathwayProfileTimeSeries_radius.npy");
+    std::string head = NpyWriter::header(
+            {timeStamps_.size(), supportPoints_.size()});
+    ASSERT_EQ(
+            head.size() + 
+            timeStamps_.size()*supportPoints_.size()*sizeof(real),
+            radius.size());
+
+    // check presence of array files and remove them:
+    std::vector<std::string> arrays = {
+            "pathwayScalarTimeSeries_t", "pathwayScalarTimeSeries_length",
+            "pathwayProfileTimeSeries_t", "pathwayProfileTimeSeries_s",
+            "pathwayProfileTimeSeries_radius"};
+    for(auto name : arrays)
+    {
+        std::string fileName = "test_results_npy_" + name + ".npy";
+        ASSERT_FALSE(readFile(fileName).empty());
+        std::remove(fileName.c_str());
+    }
+    std::remove("test_results_npy.json");
+}
+
+
+/*!
+ * Checks that adding data out of order or adding values that can not be 
+ * represented in JSON results in an exception.
+ */
+TEST_F(ResultsJsonStreamWriterTest, ResultsJsonStreamWriterInvalidTest)
+{
+    ResultsJsonStreamWriter writer;
+
+    // can not add data before opening file:
+    ASSERT_THROW(
+            writer.addTimeStamps(timeStamps_), 
+            std::logic_error);
+
+    // can not return to a completed section:
+    writer.open("test_results_stream.json");
+    writer.addTimeStamps(timeStamps_);
+    ASSERT_THROW(
+            writer.addPathwaySummary("length", summary_), 
+            std::logic_error);
+
+    // time series must match time stamps:
+    scalarTimeSeries_.pop_back();
+    ASSERT_THROW(
+            writer.addPathwayScalarTimeSeries("length", scalarTimeSeries_), 
+            std::logic_error);
+
+    // NaN can not be written:
+    scalarTimeSeries_.push_back(std::numeric_limits<real>::quiet_NaN());
+    ASSERT_THROW(
+            writer.addPathwayScalarTimeSeries("length", scalarTimeSeries_), 
+            std::runtime_error);
+
+    std::remove("test_results_stream.json");
+}
+
@@ -0,0 +1,297 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "external/rapidjson/document.h"
+
+#include "io/gltf_io.hpp"
+#include "io/ply_io.hpp"
+#include "io/surface_mesh.hpp"
+
+
+/*!
+ * \brief Test fixture for the binary surface mesh exporters.
+ *
+ * Provides a tetrahedron with two scalar properties.
+ */
+class SurfaceMeshIoTest : public ::testing::Test
+{
+    public:
+
+        SurfaceMeshIoTest()
+            : mesh_("tetrahedron")
+        {
+            std::vector<gmx::RVec> pos = {
+                    gmx::RVec(0.0, 0.0, 0.0),
+                    gmx::RVec(1.0, 0.0, 0.0),
+                    gmx::RVec(0.0, 1.0, 0.0),
+                    gmx::RVec(0.0, 0.0, 1.0)};
+            std::vector<gmx::RVec> norm = {
+                    gmx::RVec(-1.0, -1.0, -1.0),
+                    gmx::RVec(1.0, 0.0, 0.0),
+                    gmx::RVec(0.0, 1.0, 0.0),
+                    gmx::RVec(0.0, 0.0, 1.0)};
+            mesh_.setVertices(pos, norm);
+            mesh_.setTriangles({0, 2, 1, 0, 1, 3, 0, 3, 2, 1, 2, 3});
+            mesh_.addProperty("radius", {0.5, 0.6, 0.7, 0.8});
+            mesh_.addProperty("avg_energy", {-1.0, 0.0, 1.0, 2.0});
+        }
+
+        // read entire file into string:
+        std::string readFile(const std::string &fileName)
+        {
+            std::ifstream file(fileName, std::ifstream::binary);
+            std::stringstream content;
+            content<<file.rdbuf();
+            return content.str();
+        }
+
+        // read little endian unsigned integer at given position:
+        uint32_t readUint32(const std::string &str, size_t pos)
+        {
+            uint32_t val = 0;
+            for(int i = 3; i >= 0; i--)
+            {
+                val = (val << 8) | static_cast<unsigned char>(str[pos + i]);
+            }
+            return val;
+        }
+
+        // read little endian float at given position:
+        float readFloat(const std::string &str, size_t pos)
+        {
+            uint32_t bits = readUint32(str, pos);
+            float val;
+            std::memcpy(&val, &bits, sizeof(val));
+            return val;
+        }
+
+    protected:
+
+        SurfaceMesh mesh_;
+};
+
+
+/*!
+ * Checks that inconsistent data is rejected by the mesh.
+ */
+TEST_F(SurfaceMeshIoTest, SurfaceMeshConsistencyTest)
+{
+    ASSERT_TRUE(mesh_.valid());
+    ASSERT_EQ(4, mesh_.numVertices());
+    ASSERT_EQ(4, mesh_.numTriangles());
+
+    // incomplete triangles and property of wrong size:
+    ASSERT_THROW(mesh_.setTriangles({0, 1}), std::logic_error);
+    ASSERT_THROW(mesh_.addProperty("p", {1.0, 2.0}), std::logic_error);
+
+    // scaling affects positions only:
+    mesh_.scale(10.0);
+    ASSERT_FLOAT_EQ(10.0, mesh_.positions_[1][XX]);
+    ASSERT_FLOAT_EQ(1.0, mesh_.normals_[1][XX]);
+}
+
+
+/*!
+ * Checks that the PLY header declares every property exactly once and that
+ * the binary body has the size implied by the shared-index layout.
+ */
+TEST_F(SurfaceMeshIoTest, PlyExporterTest)
+{
+    std::string fileName = "test_surface_mesh.ply";
+    PlyExporter plyExp;
+    plyExp.write(fileName, mesh_);
+    std::string str = readFile(fileName);
+    std::remove(fileName.c_str());
+
+    // check header:
+    std::string endHeader = "end_header\n";
+    size_t headSize = str.find(endHeader) + endHeader.size();
+    ASSERT_NE(std::string::npos, str.find(endHeader));
+    std::string head = str.substr(0, headSize);
+    ASSERT_EQ(0, head.find("ply\nformat binary_little_endian 1.0\n"));
+    ASSERT_NE(std::string::npos, head.find("element vertex 4\n"));
+    ASSERT_NE(std::string::npos, head.find("property float radius\n"));
+    ASSERT_NE(std::string::npos, head.find("property float avg_energy\n"));
+    ASSERT_NE(std::string::npos, head.find("element face 4\n"));
+
+    // each vertex has 3 coordinates, 3 normals, and 2 properties:
+    size_t vertexSize = 8*sizeof(float);
+    size_t faceSize = 1 + 3*sizeof(uint32_t);
+    ASSERT_EQ(headSize + 4*vertexSize + 4*faceSize, str.size());
+
+    // check content of second vertex and first face:
+    size_t pos = headSize + vertexSize;
+    ASSERT_FLOAT_EQ(1.0, readFloat(str, pos));
+    ASSERT_FLOAT_EQ(0.6, readFloat(str, pos + 6*sizeof(float)));
+    ASSERT_FLOAT_EQ(0.0, readFloat(str, pos + 7*sizeof(float)));
+    pos = headSize + 4*vertexSize;
+    ASSERT_EQ(3, static_cast<unsigned char>(str[pos]));
+    ASSERT_EQ(0, readUint32(str, pos + 1));
+    ASSERT_EQ(2, readUint32(str, pos + 5));
+    ASSERT_EQ(1, readUint32(str, pos + 9));
+}
+
+
+/*!
+ * Checks the GLB container structure and that the JSON chunk describes the 
+ * binary chunk consistently.
+ */
+TEST_F(SurfaceMeshIoTest, GltfExporterTest)
+{
+    std::string fileName = "test_surface_mesh.glb";
+    GltfExporter gltfExp;
+    gltfExp.write(fileName, mesh_);
+    std::string str = readFile(fileName);
+    std::remove(fileName.c_str());
+
+    // check header:
+    ASSERT_EQ("glTF", str.substr(0, 4));
+    ASSERT_EQ(2, readUint32(str, 4));
+    ASSERT_EQ(str.size(), readUint32(str, 8));
+
+    // check JSON chunk:
+    uint32_t jsonLength = readUint32(str, 12);
+    ASSERT_EQ(0, jsonLength % 4);
+    ASSERT_EQ("JSON", str.substr(16, 4));
+    rapidjson::Document doc;
+    doc.Parse(str.substr(20, jsonLength).c_str());
+    ASSERT_FALSE(doc.HasParseError());
+
+    // check binary chunk:
+    size_t binPos = 20 + jsonLength;
+    uint32_t binLength = readUint32(str, binPos);
+    ASSERT_EQ(0, binLength % 4);
+    ASSERT_EQ(std::string("BIN\0", 4), str.substr(binPos + 4, 4));
+    ASSERT_EQ(str.size(), binPos + 8 + binLength);
+    ASSERT_EQ(binLength, doc["buffers"][0]["byteLength"].GetUint());
+
+    // all attributes share one index accessor:
+    const auto &prim = doc["meshes"][0]["primitives"][0];
+    const auto &attr = prim["attributes"];
+    ASSERT_TRUE(attr.HasMember("POSITION"));
+    ASSERT_TRUE(attr.HasMember("NORMAL"));
+    ASSERT_TRUE(attr.HasMember("_RADIUS"));
+    ASSERT_TRUE(attr.HasMember("_AVG_ENERGY"));
+    const auto &indices = doc["accessors"][prim["indices"].GetUint()];
+    ASSERT_EQ(12, indices["count"].GetUint());
+    for(auto it = attr.MemberBegin(); it != attr.MemberEnd(); it++)
+    {
+        const auto &acc = doc["accessors"][it -> value.GetUint()];
+        ASSERT_EQ(4, acc["count"].GetUint());
+    }
+
+    // check property data via its buffer view:
+    const auto &acc = doc["accessors"][attr["_AVG_ENERGY"].GetUint()];
+    const auto &view = doc["bufferViews"][acc["bufferView"].GetUint()];
+    size_t pos = binPos + 8 + view["byteOffset"].GetUint();
+    ASSERT_EQ(4*sizeof(float), view["byteLength"].GetUint());
+    ASSERT_FLOAT_EQ(-1.0, readFloat(str, pos));
+    ASSERT_FLOAT_EQ(2.0, readFloat(str, pos + 3*sizeof(float)));
+
+    // empty meshes are rejected:
+    SurfaceMesh empty("empty");
+    ASSERT_THROW(gltfExp.write(fileName, empty), std::logic_error);
+}
+
+
+/*!
+ * Checks that a mesh sequence stores the connectivity once, references it 
+ * from every frame, and animates the visibility of the frames.
+ */
+TEST_F(SurfaceMeshIoTest, GltfSequenceExporterTest)
+{
+    // second frame is a scaled copy of the first:
+    SurfaceMesh scaled = mesh_;
+    scaled.scale(2.0);
+    GltfSequenceExporter seqExp;
+    seqExp.addFrame(mesh_, 0.0);
+    seqExp.addFrame(scaled, 10.0);
+    ASSERT_EQ(2, seqExp.numFrames());
+
+    // frames with different connectivity are rejected:
+    SurfaceMesh other = mesh_;
+    other.setTriangles({0, 1, 2});
+    ASSERT_THROW(seqExp.addFrame(other, 20.0), std::logic_error);
+
+    // write and read back:
+    std::string fileName = "test_surface_mesh_sequence.glb";
+    seqExp.write(fileName);
+    std::string str = readFile(fileName);
+    std::remove(fileName.c_str());
+    ASSERT_EQ(str.size(), readUint32(str, 8));
+    uint32_t jsonLength = readUint32(str, 12);
+    rapidjson::Document doc;
+    doc.Parse(str.substr(20, jsonLength).c_str());
+    ASSERT_FALSE(doc.HasParseError());
+    size_t binPos = 20 + jsonLength + 8;
+
+    // one node and mesh per frame with time stamp:
+    ASSERT_EQ(2, doc["nodes"].Size());
+    ASSERT_EQ(2, doc["meshes"].Size());
+    ASSERT_FLOAT_EQ(10.0, doc["nodes"][1]["extras"]["time"].GetDouble());
+    ASSERT_FALSE(doc["nodes"][0].HasMember("scale"));
+    ASSERT_TRUE(doc["nodes"][1].HasMember("scale"));
+
+    // all frames share the same index accessor:
+    const auto &primA = doc["meshes"][0]["primitives"][0];
+    const auto &primB = doc["meshes"][1]["primitives"][0];
+    ASSERT_EQ(primA["indices"].GetUint(), primB["indices"].GetUint());
+    size_t numIndexViews = 0;
+    for(auto it = doc["bufferViews"].Begin(); 
+        it != doc["bufferViews"].End(); 
+        it++)
+    {
+        if( it -> HasMember("target") && (*it)["target"].GetUint() == 34963 )
+        {
+            numIndexViews++;
+        }
+    }
+    ASSERT_EQ(1, numIndexViews);
+
+    // positions of second frame are scaled:
+    unsigned int posIdx = primB["attributes"]["POSITION"].GetUint();
+    const auto &acc = doc["accessors"][posIdx];
+    const auto &view = doc["bufferViews"][acc["bufferView"].GetUint()];
+    size_t pos = binPos + view["byteOffset"].GetUint();
+    ASSERT_FLOAT_EQ(2.0, readFloat(str, pos + 3*sizeof(float)));
+    ASSERT_FLOAT_EQ(2.0, acc["max"][0].GetDouble());
+
+    // one animation channel per frame:
+    ASSERT_EQ(1, doc["animations"].Size());
+    ASSERT_EQ(2, doc["animations"][0]["channels"].Size());
+    ASSERT_EQ(2, doc["animations"][0]["samplers"].Size());
+
+    // empty sequences are rejected:
+    GltfSequenceExporter emptyExp;
+    ASSERT_THROW(emptyExp.write(fileName), std::logic_error);
+}
@@ -0,0 +1,139 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "io/wavefront_mtl_io.hpp"
+#include "io/wavefront_obj_io.hpp"
+
+
+/*!
+ * \brief Test fixture for the Wavefront OBJ and MTL exporters.
+ */
+class WavefrontObjIoTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Returns the content of a file as a string.
+         */
+        std::string readFile(const std::string &fileName)
+        {
+            std::ifstream file(fileName);
+            std::stringstream content;
+            content<<file.rdbuf();
+            return content.str();
+        }
+};
+
+
+/*!
+ * Checks that an OBJ object with vertices, normals, groups, and materials is
+ * written in the expected format.
+ */
+TEST_F(WavefrontObjIoTest, WavefrontObjExporterWriteTest)
+{
+    // create a simple object consisting of two triangles:
+    WavefrontObjObject obj("test");
+    obj.setMaterialLibrary("test.mtl");
+    obj.addVertices(std::vector<std::pair<gmx::RVec, real>>{
+            {gmx::RVec(0.0, 0.0, 0.0), 1.0},
+            {gmx::RVec(1.5, 0.0, 0.0), 1.0},
+            {gmx::RVec(0.0, -2.25, 0.125), 0.5}});
+    obj.addVertexNormals({
+            gmx::RVec(0.0, 0.0, 1.0),
+            gmx::RVec(0.0, 0.0, 1.0),
+            gmx::RVec(1.0, 0.0, 0.0)});
+    WavefrontObjGroup group("surface");
+    group.addFace(WavefrontObjFace({1, 2, 3}, {1, 2, 3}, "red"));
+    group.addFace(WavefrontObjFace({3, 2, 1}, {3, 2, 1}, "red"));
+    group.addFace(WavefrontObjFace({1, 3, 2}, "blue"));
+    obj.addGroup(group);
+
+    // write to file:
+    WavefrontObjExporter exporter;
+    exporter.write("test_wavefront.obj", obj);
+
+    // check file content:
+    std::string expected = 
+        "# produced by CHAP\n"
+        "mtllib test.mtl\n"
+        "\n"
+        "o test\n"
+        "\n"
+        "v 0.0 0.0 0.0 1.0\n"
+        "v 1.5 0.0 0.0 1.0\n"
+        "v 0.0 -2.25 0.125 0.5\n"
+        "\n"
+        "vn 0.0 0.0 1.0\n"
+        "vn 0.0 0.0 1.0\n"
+        "vn 1.0 0.0 0.0\n"
+        "\n"
+        "g surface\n"
+        "usemtl red\n"
+        "f 1//1 2//2 3//3 \n"
+        "f 3//3 2//2 1//1 \n"
+        "usemtl blue\n"
+        "f 1 3 2 \n";
+    ASSERT_EQ(expected, readFile("test_wavefront.obj"));
+
+    // material state is reset between files:
+    exporter.write("test_wavefront.obj", obj);
+    ASSERT_EQ(expected, readFile("test_wavefront.obj"));
+    std::remove("test_wavefront.obj");
+}
+
+
+/*!
+ * Checks that materials are written in the expected format.
+ */
+TEST_F(WavefrontObjIoTest, WavefrontMtlExporterWriteTest)
+{
+    WavefrontMtlMaterial red("red");
+    red.setAmbientColour(gmx::RVec(1.0, 0.0, 0.0));
+    red.setDiffuseColour(gmx::RVec(0.75, 0.0, 0.0));
+    red.setSpecularColour(gmx::RVec(0.5, 0.25, 0.25));
+    WavefrontMtlObject mtl;
+    mtl.addMaterial(red);
+
+    WavefrontMtlExporter exporter;
+    exporter.write("test_wavefront.mtl", mtl);
+
+    std::string expected = 
+        "newmtl red\n"
+        "Ka 1.0 0.0 0.0\n"
+        "Kd 0.75 0.0 0.0\n"
+        "Ks 0.5 0.25 0.25\n";
+    ASSERT_EQ(expected, readFile("test_wavefront.mtl"));
+    std::remove("test_wavefront.mtl");
+}
+
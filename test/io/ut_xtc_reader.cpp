@@ -0,0 +1,214 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <gromacs/fileio/xtcio.h>
+
+#include "io/xtc_reader.hpp"
+
+
+/*!
+ * \brief Test fixture for the XtcReader.
+ *
+ * Writes a short XTC trajectory in which atoms form small clusters (so that
+ * the compression algorithm uses runs of small differences) and in which 
+ * the coordinates of each atom encode the frame and atom index.
+ */
+class XtcReaderTest : public ::testing::Test
+{
+    public:
+
+        /*!
+         * Constructor writes the test trajectory.
+         */
+        XtcReaderTest()
+        {
+            matrix box = {{5.0, 0.0, 0.0}, {0.0, 5.0, 0.0}, {0.0, 0.0, 5.0}};
+            std::vector<gmx::RVec> x(numAtoms_);
+            t_fileio *file = open_xtc(fileName_.c_str(), "w");
+            for(int f = 0; f < numFrames_; f++)
+            {
+                for(int i = 0; i < numAtoms_; i++)
+                {
+                    x[i] = position(f, i);
+                }
+                write_xtc(
+                        file, 
+                        numAtoms_, 
+                        10*f, 
+                        2.0*f, 
+                        box, 
+                        as_rvec_array(x.data()), 
+                        1000.0);
+            }
+            close_xtc(file);
+        }
+
+        /*!
+         * Destructor removes the test trajectory.
+         */
+        ~XtcReaderTest()
+        {
+            std::remove(fileName_.c_str());
+        }
+
+    protected:
+
+        std::string fileName_ = "xtc_reader_test.xtc";
+        int numAtoms_ = 500;
+        int numFrames_ = 20;
+
+        /*!
+         * Position of the given atom in the given frame.
+         */
+        gmx::RVec position(int frame, int atom) const
+        {
+            return gmx::RVec(
+                    0.1*frame + 0.4*(atom / 3), 
+                    0.05*(atom % 3), 
+                    0.002*atom);
+        }
+};
+
+
+/*!
+ * Checks that the frame index contains the time stamps of all frames and 
+ * that full decoding recovers all coordinates up to the XTC precision.
+ */
+TEST_F(XtcReaderTest, XtcReaderFullDecodingTest)
+{
+    XtcReader reader;
+    reader.open(fileName_);
+    ASSERT_EQ(numFrames_, reader.numFrames());
+    ASSERT_EQ(numAtoms_, reader.numAtoms());
+
+    std::vector<gmx::RVec> x(numAtoms_);
+    for(int f = 0; f < numFrames_; f++)
+    {
+        ASSERT_NEAR(2.0*f, reader.time(f), 1e-3);
+
+        std::int64_t step;
+        real time;
+        matrix box;
+        int numDecoded = reader.readFrame(
+                f, 0, step, time, box, as_rvec_array(x.data()));
+        ASSERT_EQ(numAtoms_, numDecoded);
+        ASSERT_EQ(10*f, step);
+        ASSERT_NEAR(2.0*f, time, 1e-3);
+        ASSERT_NEAR(5.0, box[YY][YY], 1e-3);
+        for(int i = 0; i < numAtoms_; i++)
+        {
+            for(int j = 0; j < 3; j++)
+            {
+                ASSERT_NEAR(position(f, i)[j], x[i][j], 1e-3);
+            }
+        }
+    }
+}
+
+
+/*!
+ * Checks that partial decoding writes correct coordinates for at least the
+ * requested number of atoms and leaves the remaining coordinates untouched,
+ * also when frames are accessed in arbitrary order.
+ */
+TEST_F(XtcReaderTest, XtcReaderPartialDecodingTest)
+{
+    XtcReader reader;
+    reader.open(fileName_);
+
+    const gmx::RVec untouched(-1.0, -1.0, -1.0);
+    for(int maxAtoms : {1, 2, 3, 50, 101, numAtoms_ - 1})
+    {
+        for(int f : {7, 0, 19, 7})
+        {
+            std::vector<gmx::RVec> x(numAtoms_, untouched);
+            std::int64_t step;
+            real time;
+            matrix box;
+            int numDecoded = reader.readFrame(
+                    f, maxAtoms, step, time, box, as_rvec_array(x.data()));
+            ASSERT_GE(numDecoded, maxAtoms);
+            ASSERT_LE(numDecoded, numAtoms_);
+            ASSERT_NEAR(2.0*f, time, 1e-3);
+            for(int i = 0; i < numDecoded; i++)
+            {
+                for(int j = 0; j < 3; j++)
+                {
+                    ASSERT_NEAR(position(f, i)[j], x[i][j], 1e-3);
+                }
+            }
+            for(int i = numDecoded; i < numAtoms_; i++)
+            {
+                ASSERT_EQ(untouched[XX], x[i][XX]);
+            }
+        }
+    }
+}
+
+
+/*!
+ * Checks that invalid files and frame indices are rejected and that the 
+ * file type is determined from the file name.
+ */
+TEST_F(XtcReaderTest, XtcReaderErrorTest)
+{
+    XtcReader reader;
+    ASSERT_THROW(reader.open("no/such/directory/traj.xtc"), std::runtime_error);
+
+    // a file that is not an XTC file:
+    std::string otherFileName = "xtc_reader_test.txt";
+    std::FILE *other = std::fopen(otherFileName.c_str(), "w");
+    std::fputs("this is not a trajectory, but it is long enough to hold "
+               "the header of an XTC frame", other);
+    std::fclose(other);
+    ASSERT_THROW(reader.open(otherFileName), std::runtime_error);
+    std::remove(otherFileName.c_str());
+
+    // frame index out of range:
+    reader.open(fileName_);
+    std::vector<gmx::RVec> x(numAtoms_);
+    std::int64_t step;
+    real time;
+    matrix box;
+    ASSERT_THROW(
+            reader.readFrame(
+                numFrames_, 0, step, time, box, as_rvec_array(x.data())), 
+            std::out_of_range);
+
+    // file type:
+    ASSERT_TRUE(XtcReader::isXtcFile("traj.xtc"));
+    ASSERT_TRUE(XtcReader::isXtcFile("dir.trr/traj.xtc"));
+    ASSERT_FALSE(XtcReader::isXtcFile("traj.trr"));
+    ASSERT_FALSE(XtcReader::isXtcFile("xtc"));
+}
@@ -248,8 +248,8 @@ TEST_F(InplaneOptimisedProbePathFinderTest, InplaneOptimisedProbePathFinderXDirT
                                                       poreVdwRadius,
                                                       poreCentre,
                                                       poreDir);    
-    std::vector<real> vdwRadii;
-    vdwRadii.insert(vdwRadii.begin(), particleCentres.size(), poreVdwRadius);
+    auto vdwRadii = std::make_shared<const std::vector<real>>(
+            particleCentres.size(), poreVdwRadius);
 
     // prepare an analysis neighborhood:
     gmx::AnalysisNeighborhood nbh;
@@ -324,3 +324,51 @@ TEST_F(VdwRadiusProviderTest, VdwRadiusProviderLookupTest)
     ASSERT_NEAR(5.5, rp.vdwRadiusForAtom("E2", "ARG", "H"), eps);
 }
 
+
+/*!
+ * Checks that repeated lookups are served consistently from the internal 
+ * caches and that the caches are invalidated when the default radius or the
+ * lookup table change.
+ */
+TEST_F(VdwRadiusProviderTest, VdwRadiusProviderCacheTest)
+{
+    // floating point comparison threshold:
+    real eps = std::numeric_limits<real>::epsilon();
+
+    // simple lookup table with wildcard atom name:
+    rapidjson::Document radii;
+    radii.Parse("{\"vdwradii\": ["
+                "{\"atomname\": \"C\", \"resname\": \"???\", \"vdwr\": 1.0},"
+                "{\"atomname\": \"O???\", \"resname\": \"???\", \"vdwr\": 2.0}"
+                "]}");
+
+    // create radius provider and build lookup table:
+    VdwRadiusProvider rp;
+    rp.lookupTableFromJson(radii);
+    rp.setDefaultVdwRadius(3.0);
+
+    // repeated lookups give the same results:
+    for(int i = 0; i < 3; i++)
+    {
+        ASSERT_NEAR(1.0, rp.vdwRadiusForAtom("CA", "ALA", "C"), eps);
+        ASSERT_NEAR(2.0, rp.vdwRadiusForAtom("O1", "ALA", "O"), eps);
+        ASSERT_NEAR(3.0, rp.vdwRadiusForAtom("N", "ALA", "N"), eps);
+    }
+
+    // same atom name with different element is a separate lookup:
+    ASSERT_NEAR(3.0, rp.vdwRadiusForAtom("CA", "ALA", "Ca"), eps);
+
+    // changing default radius affects previously looked up atoms:
+    rp.setDefaultVdwRadius(4.0);
+    ASSERT_NEAR(4.0, rp.vdwRadiusForAtom("N", "ALA", "N"), eps);
+
+    // new lookup table replaces cached radii:
+    radii.Parse("{\"vdwradii\": ["
+                "{\"atomname\": \"N\", \"resname\": \"ALA\", \"vdwr\": 5.0}"
+                "]}");
+    rp.lookupTableFromJson(radii);
+    ASSERT_NEAR(5.0, rp.vdwRadiusForAtom("N", "ALA", "N"), eps);
+    ASSERT_NEAR(4.0, rp.vdwRadiusForAtom("CA", "ALA", "C"), eps);
+    ASSERT_NEAR(4.0, rp.vdwRadiusForAtom("O1", "ALA", "O"), eps);
+}
+
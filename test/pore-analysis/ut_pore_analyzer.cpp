@@ -0,0 +1,261 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <cmath>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "pore-analysis/pore_analyzer.hpp"
+
+
+/*!
+ * \brief Test fixture for PoreAnalyzer.
+ *
+ * Creates a coordinate array containing a cylindrical mock pore along the
+ * \f$ z \f$-axis, residues lining and not lining this pore, and solvent 
+ * particles inside and outside of it. Atom indices of the different groups
+ * are stored alongside the coordinates.
+ */
+class PoreAnalyzerTest : public ::testing::Test
+{
+    public:
+
+        // constructor:
+        PoreAnalyzerTest()
+        {
+            // calculate angle required for overlapping vdW spheres:
+            real phi = std::acos(1.0 - std::pow(poreVdwRadius_, 2.0)/2.0/
+                                 std::pow(poreCentreRadius_, 2.0));
+            int nStepsAround = std::ceil(2.0*PI_/phi);
+
+            // step length and number of steps along the length of the pore:
+            real stepLengthAlong = poreVdwRadius_/2.0;
+            int nStepsAlong = std::ceil(poreLength_/stepLengthAlong) + 1;
+
+            // place pore particles on cylinder surface around origin:
+            for(int i = 0; i < nStepsAlong; i++)
+            {
+                for(int j = 0; j < nStepsAround; j++)
+                {
+                    addAtom(poreCentreRadius_*std::cos(phi*j),
+                            poreCentreRadius_*std::sin(phi*j),
+                            i*stepLengthAlong - poreLength_/2.0);
+                    pathwayAtoms_.push_back(coords_.size() - 1);
+                }
+            }
+
+            // residues pointing into the pore with C-alpha further out:
+            for(int i = 0; i < 4; i++)
+            {
+                real z = -0.5 + i*0.25;
+                real r = poreCentreRadius_ + 0.1;
+                residueAtoms_[i].push_back(addAtom(r, 0.0, z));
+                residueAtoms_[i].push_back(addAtom(r + 0.1, 0.0, z));
+                calphaAtoms_[i] = addAtom(r + 0.3, 0.0, z);
+            }
+
+            // residues far away from the pore:
+            for(int i = 4; i < 6; i++)
+            {
+                residueAtoms_[i].push_back(addAtom(3.0, 3.0, 0.0));
+                calphaAtoms_[i] = addAtom(2.9, 2.9, 0.0);
+            }
+
+            // solvent particles inside the pore:
+            for(int i = 0; i < 5; i++)
+            {
+                solventAtoms_[i].push_back(addAtom(0.0, 0.0, -0.4 + i*0.2));
+            }
+
+            // solvent particles far away from the pore:
+            for(int i = 5; i < 8; i++)
+            {
+                solventAtoms_[i].push_back(addAtom(-3.0, 3.0, i*0.1));
+            }
+        };
+
+        // coordinates and atom indices:
+        std::vector<gmx::RVec> coords_;
+        std::vector<int> pathwayAtoms_;
+        std::map<int, std::vector<int>> residueAtoms_;
+        std::map<int, int> calphaAtoms_;
+        std::map<int, std::vector<int>> solventAtoms_;
+
+        // pore geometry:
+        const real poreLength_ = 2.0;
+        const real poreCentreRadius_ = 0.25;
+        const real poreVdwRadius_ = 0.2;
+
+        // mathematical constants:
+        const real PI_ = std::acos(-1.0);
+
+        // analyser set up for the mock system:
+        void setUpAnalyzer(PoreAnalyzer &analyzer)
+        {
+            analyzer.setPathwayAtoms(
+                    pathwayAtoms_,
+                    std::vector<real>(pathwayAtoms_.size(), poreVdwRadius_));
+            analyzer.setPoreResidues(residueAtoms_, calphaAtoms_);
+            analyzer.setSolventParticles(solventAtoms_);
+            analyzer.setInitProbePos(gmx::RVec(0.02, -0.01, 0.05));
+        };
+
+        // raw coordinate array:
+        const rvec* x() const
+        {
+            return as_rvec_array(coords_.data());
+        };
+
+    private:
+
+        // add atom and return its index:
+        int addAtom(real x, real y, real z)
+        {
+            coords_.push_back(gmx::RVec(x, y, z));
+            return coords_.size() - 1;
+        };
+};
+
+
+/*!
+ * Checks that the pathway through the mock pore is found from a raw 
+ * coordinate array and that residues and solvent particles are mapped onto
+ * it and classified correctly.
+ */
+TEST_F(PoreAnalyzerTest, PoreAnalyzerCylindricalPoreTest)
+{
+    PoreAnalyzer analyzer;
+    setUpAnalyzer(analyzer);
+    PoreAnalysisResult res = analyzer.analyse(x(), coords_.size());
+
+    // pathway should be at least as long as the pore and not be closed:
+    ASSERT_TRUE(res.molPath_ != nullptr);
+    ASSERT_LE(poreLength_, res.molPath_ -> length());
+    ASSERT_LT(0.0, res.molPath_ -> minRadius().second);
+
+    // all residues are mapped:
+    ASSERT_EQ(residueAtoms_.size(), res.poreCogMappedCoords_.size());
+    ASSERT_EQ(residueAtoms_.size(), res.poreCalMappedCoords_.size());
+
+    // residues next to the pore are pore-lining and -facing:
+    for(int i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(res.poreLining_.at(i));
+        ASSERT_TRUE(res.poreFacing_.at(i));
+    }
+
+    // residues away from the pore are neither:
+    for(int i = 4; i < 6; i++)
+    {
+        ASSERT_FALSE(res.poreLining_.at(i));
+        ASSERT_FALSE(res.poreFacing_.at(i));
+    }
+
+    // only solvent particles along the centre line are inside the pore:
+    ASSERT_EQ(solventAtoms_.size(), res.solventMappedCoords_.size());
+    ASSERT_EQ(5, res.numSolvInsidePore_);
+    ASSERT_EQ(5, res.numSolvInsideSample_);
+    for(int i = 0; i < 5; i++)
+    {
+        ASSERT_TRUE(res.solvInsidePore_.at(i));
+        ASSERT_NEAR(0.0, res.solventMappedCoords_.at(i)[RR], 0.05);
+    }
+    for(int i = 5; i < 8; i++)
+    {
+        ASSERT_FALSE(res.solvInsidePore_.at(i));
+        ASSERT_FALSE(res.solvInsideSample_.at(i));
+    }
+}
+
+
+/*!
+ * Checks that repeated analysis of the same coordinates yields the same 
+ * pathway and that requested profiles are estimated along it.
+ */
+TEST_F(PoreAnalyzerTest, PoreAnalyzerProfileTest)
+{
+    PoreAnalyzer analyzer;
+    setUpAnalyzer(analyzer);
+
+    // all residues have the same hydrophobicity:
+    ResidueInformationProvider resInfo;
+    resInfo.setHydrophobicity("ALA", 1.0);
+    for(auto r : residueAtoms_)
+    {
+        resInfo.setName(r.first, "ALA");
+    }
+    DensityEstimationParameters hpParams;
+    hpParams.setKernelFunction(eKernelFunctionGaussian);
+    hpParams.setBandWidth(0.35);
+    hpParams.setEvalRangeCutoff(5.0);
+    hpParams.setMaxEvalPointDist(0.1);
+    analyzer.setHydrophobicity(resInfo, hpParams, 0.35);
+
+    // histogram of solvent density:
+    DensityEstimationParameters deParams;
+    deParams.setBinWidth(0.1);
+    analyzer.setDensityEstimation(eDensityEstimatorHistogram, deParams, 0.0);
+
+    // analyse coordinates twice:
+    PoreAnalysisResult resA = analyzer.analyse(x(), coords_.size());
+    PoreAnalysisResult resB = analyzer.analyse(x(), coords_.size());
+
+    // pathways are identical:
+    ASSERT_EQ(resA.molPath_ -> length(), resB.molPath_ -> length());
+    ASSERT_EQ(resA.molPath_ -> minRadius().second, 
+              resB.molPath_ -> minRadius().second);
+
+    // profiles are estimated:
+    real sMid = resA.poreCogMappedCoords_.at(1)[SS];
+    ASSERT_LT(0.0, resA.hydrophobicity_.poreLining_.evaluate(sMid, 0));
+    ASSERT_LT(0.0, resA.hydrophobicity_.poreFacing_.evaluate(sMid, 0));
+    ASSERT_LT(0.0, resA.solventDensity_.numberDensity_.evaluate(
+            resA.solventMappedCoords_.at(2)[SS], 0));
+}
+
+
+/*!
+ * Checks that inconsistent input is rejected.
+ */
+TEST_F(PoreAnalyzerTest, PoreAnalyzerErrorTest)
+{
+    PoreAnalyzer analyzer;
+
+    // no pathway atoms:
+    ASSERT_THROW(analyzer.analyse(x(), coords_.size()), std::logic_error);
+
+    // number of radii does not match number of atoms:
+    ASSERT_THROW(
+            analyzer.setPathwayAtoms(pathwayAtoms_, std::vector<real>(1, 0.2)),
+            std::logic_error);
+
+    // atom index outside coordinate array:
+    setUpAnalyzer(analyzer);
+    ASSERT_THROW(
+            analyzer.analyse(x(), pathwayAtoms_.size()),
+            std::logic_error);
+}
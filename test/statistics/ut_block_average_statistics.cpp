@@ -0,0 +1,162 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "statistics/autocorrelation_statistics.hpp"
+#include "statistics/block_average_statistics.hpp"
+#include "statistics/summary_statistics.hpp"
+
+
+/*!
+ * \brief Test fixture for BlockAverageStatistics and 
+ * AutocorrelationStatistics.
+ *
+ * Generates a reproducible sample of independent normal variates and an 
+ * autoregressive AR(1) process with known statistical inefficiency
+ * \f$ g = (1 + \phi)/(1 - \phi) \f$.
+ */
+class BlockAverageStatisticsTest : public ::testing::Test
+{
+    public:
+
+        // constructor for creating test data:
+        BlockAverageStatisticsTest()
+            : phi_(0.8)
+        {
+            std::mt19937 rng(15011985);
+            std::normal_distribution<real> dist(0.0, 1.0);
+            size_t n = 1 << 16;
+            independentData_.resize(n);
+            correlatedData_.resize(n);
+            real x = 0.0;
+            for(size_t i = 0; i < n; i++)
+            {
+                independentData_[i] = 10.0 + dist(rng);
+                x = phi_*x + dist(rng);
+                correlatedData_[i] = 10.0 + x;
+            }
+        }
+
+    
+    protected:
+
+        // AR(1) coefficient:
+        real phi_;
+
+        // test data:
+        std::vector<real> independentData_;
+        std::vector<real> correlatedData_;
+};
+
+
+/*!
+ * Checks that the mean and number of samples agree with SummaryStatistics, 
+ * that the number of levels grows logarithmically and that the standard error
+ * of independent data agrees with the naive estimate.
+ */
+TEST_F(BlockAverageStatisticsTest, BlockAverageStatisticsIndependentTest)
+{
+    // create block averaging and summary statistics objects:
+    BlockAverageStatistics bas;
+    SummaryStatistics sumStat;
+    for(auto x : independentData_)
+    {
+        bas.update(x);
+        sumStat.update(x);
+    }
+    bas.update(std::numeric_limits<real>::infinity());
+
+    // basic properties:
+    ASSERT_EQ(sumStat.num(), bas.num());
+    ASSERT_NEAR(sumStat.mean(), bas.mean(), 1e-4);
+    ASSERT_EQ(17, bas.numLevels());
+    ASSERT_EQ(1024, bas.blockSize(10));
+
+    // standard error of independent data should be close to naive estimate:
+    real naiveSe = sumStat.sd()/std::sqrt(sumStat.num());
+    ASSERT_NEAR(naiveSe, bas.blockStandardError(0), 1e-6);
+    ASSERT_NEAR(1.0, bas.statisticalInefficiency(), 0.5);
+    ASSERT_GE(bas.standardError(), naiveSe);
+}
+
+
+/*!
+ * Checks that both block averaging and autocorrelation analysis recover the
+ * statistical inefficiency of an AR(1) process.
+ */
+TEST_F(BlockAverageStatisticsTest, BlockAverageStatisticsCorrelatedTest)
+{
+    // expected statistical inefficiency:
+    real g = (1.0 + phi_)/(1.0 - phi_);
+
+    // accumulate statistics:
+    BlockAverageStatistics bas;
+    AutocorrelationStatistics acs(100);
+    for(auto x : correlatedData_)
+    {
+        bas.update(x);
+        acs.update(x);
+    }
+
+    // both estimators should agree on mean:
+    ASSERT_NEAR(bas.mean(), acs.mean(), 1e-4);
+
+    // autocorrelation at lag one should be close to AR coefficient:
+    ASSERT_NEAR(phi_, acs.autocorrelation(1), 0.02);
+
+    // statistical inefficiencies should be close to theoretical value:
+    ASSERT_NEAR(g, acs.statisticalInefficiency(), 0.15*g);
+    ASSERT_NEAR(g, bas.statisticalInefficiency(), 0.4*g);
+
+    // standard errors of both methods should be consistent:
+    ASSERT_NEAR(acs.standardError(), bas.standardError(), 
+                0.3*acs.standardError());
+}
+
+
+/*!
+ * Checks that autocorrelation analysis of independent data yields a 
+ * statistical inefficiency close to one.
+ */
+TEST_F(BlockAverageStatisticsTest, AutocorrelationStatisticsIndependentTest)
+{
+    // accumulate statistics:
+    AutocorrelationStatistics acs(50);
+    for(auto x : independentData_)
+    {
+        acs.update(x);
+    }
+
+    // assert correctness:
+    ASSERT_EQ(independentData_.size(), acs.num());
+    ASSERT_NEAR(0.0, acs.autocorrelation(1), 0.02);
+    ASSERT_NEAR(1.0, acs.statisticalInefficiency(), 0.1);
+    ASSERT_EQ(0.0, acs.autocorrelation(51));
+}
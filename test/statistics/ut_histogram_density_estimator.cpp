@@ -23,6 +23,7 @@
 
 
 #include <algorithm>
+#include <numeric>
 #include <random>
 
 #include <gtest/gtest.h>
@@ -272,10 +273,11 @@ TEST_F(HistogramDensityEstimatorTest, HistogramDensityEstimatorEstimateTest)
         }
  
         // evaluate density below data range:
+        // (breaks are multiples of bin width, so margin exceeds a full bin)
         for(int i = 0; i < numEval; i++)
         {
             // eval point below data range: 
-            real eval = -i*bw + dataMin - 0.5*bw;
+            real eval = -i*bw + dataMin - 1.5*bw;
             
             // evaluate density:
             real density = densitySpline.evaluate(
@@ -290,11 +292,11 @@ TEST_F(HistogramDensityEstimatorTest, HistogramDensityEstimatorEstimateTest)
         std::vector<real> evalPoints;
         std::vector<real> evalDensities;
         real dataRange = dataMax - dataMin;
-        real evalStep = (dataRange + 2.0*bw ) /(numEval);
+        real evalStep = (dataRange + 4.0*bw ) /(numEval);
         for(int i = 0; i < numEval; i++)
         {
             // calculate evaluation point:
-            real eval = dataMin - bw + i*evalStep;
+            real eval = dataMin - 2.0*bw + i*evalStep;
             evalPoints.push_back(eval);
 
             // evaluate density at this point:
@@ -321,3 +323,220 @@ TEST_F(HistogramDensityEstimatorTest, HistogramDensityEstimatorEstimateTest)
    }
 }
 
+
+
+/*!
+ * Checks that binning the sample with several threads yields exactly the
+ * same density as serial binning, and that the input does not need to be 
+ * sorted.
+ */
+TEST_F(HistogramDensityEstimatorTest, HistogramDensityEstimatorParallelTest)
+{
+    // create histogram estimator and set bin width:
+    HistogramDensityEstimator hde;
+    hde.setBinWidth(0.1);
+
+    // make sure even the small test sample is split over threads:
+    hde.minSamplesPerThread_ = 100;
+
+    // serial reference on sorted data:
+    std::vector<real> sortedData = testData_;
+    std::sort(sortedData.begin(), sortedData.end());
+    std::vector<real> breaks = hde.createBreaks(sortedData);
+    std::vector<real> serialDensity = hde.calculateDensity(
+            sortedData, 
+            breaks);
+
+    // try various numbers of threads on unsorted data:
+    std::vector<size_t> numThreads = {1, 2, 3, 7, 16};
+    for(auto nt : numThreads)
+    {
+        hde.setNumThreads(nt);
+        std::vector<real> density = hde.calculateDensity(testData_, breaks);
+
+        ASSERT_EQ(serialDensity.size(), density.size());
+        for(size_t i = 0; i < density.size(); i++)
+        {
+            ASSERT_EQ(serialDensity[i], density[i]);
+        }
+    }
+
+    // zero threads are not permitted:
+    ASSERT_THROW(hde.setNumThreads(0), std::logic_error);
+}
+
+
+/*!
+ * Checks that break points and midpoints are reused between calls to 
+ * estimate() if the data range does not change and recomputed if it does or
+ * if the bin width is changed.
+ */
+TEST_F(HistogramDensityEstimatorTest, HistogramDensityEstimatorBreaksReuseTest)
+{
+    // create histogram estimator and set bin width:
+    HistogramDensityEstimator hde;
+    hde.setBinWidth(0.1);
+
+    // first estimate creates breaks for this range:
+    hde.estimate(testData_);
+    std::vector<real> breaks = hde.breaks_;
+    ASSERT_EQ(hde.createBreaks(testData_), breaks);
+    const real *breaksData = hde.breaks_.data();
+
+    // permuted data has same range, so breaks are reused:
+    std::reverse(testData_.begin(), testData_.end());
+    hde.estimate(testData_);
+    ASSERT_EQ(breaksData, hde.breaks_.data());
+    ASSERT_EQ(breaks, hde.breaks_);
+
+    // extending the range requires new breaks:
+    testData_.push_back(100.0);
+    hde.estimate(testData_);
+    ASSERT_EQ(hde.createBreaks(testData_), hde.breaks_);
+    ASSERT_GT(hde.breaks_.back(), 100.0);
+
+    // changing bin width discards cached breaks:
+    hde.setBinWidth(0.5);
+    ASSERT_TRUE(hde.breaks_.empty());
+    ASSERT_TRUE(hde.midpoints_.empty());
+}
+
+
+/*!
+ * Checks that the trajectory-wide histogram built by accumulating several 
+ * subsets of the data contains the same counts as one built from all data at
+ * once, that the endpoint bins remain empty, and that the resulting density 
+ * integrates to one.
+ */
+TEST_F(HistogramDensityEstimatorTest, HistogramDensityEstimatorAccumulateTest)
+{
+    // floating point comparison tolerance:
+    real eps = std::numeric_limits<real>::epsilon();
+
+    // bin width:
+    real bw = 0.1;
+
+    // accumulate all data at once:
+    HistogramDensityEstimator hdeAll;
+    hdeAll.setBinWidth(bw);
+    hdeAll.accumulate(testData_);
+    ASSERT_EQ(testData_.size(), hdeAll.numAccumulatedSamples());
+
+    // accumulate data in frames of increasing spread:
+    std::vector<real> sortedData = testData_;
+    std::sort(sortedData.begin(), sortedData.end());
+    size_t mid = sortedData.size()/2;
+    HistogramDensityEstimator hdeFrames;
+    hdeFrames.setBinWidth(bw);
+    hdeFrames.accumulate(std::vector<real>());
+    ASSERT_EQ(0, hdeFrames.numAccumulatedSamples());
+    for(size_t w = 1; w <= mid; w *= 2)
+    {
+        std::vector<real> frame(sortedData.begin() + mid - w, 
+                                sortedData.begin() + mid + w);
+        hdeFrames.accumulate(frame);
+        hdeAll.accumulate(frame);
+    }
+    hdeFrames.accumulate(testData_);
+
+    // breaks must be equidistant and cover the data:
+    std::vector<real> breaks = hdeFrames.accumulatedBreaks();
+    ASSERT_LT(breaks.front(), sortedData.front());
+    ASSERT_GT(breaks.back(), sortedData.back());
+    for(size_t i = 0; i < breaks.size() - 1; i++)
+    {
+        ASSERT_NEAR(bw, breaks.at(i+1) - breaks.at(i), 100*eps);
+    }
+
+    // counts must be identical:
+    std::vector<size_t> countsAll = hdeAll.accumulatedCounts();
+    std::vector<size_t> countsFrames = hdeFrames.accumulatedCounts();
+    ASSERT_EQ(hdeAll.accumulatedBreaks(), breaks);
+    ASSERT_EQ(countsAll, countsFrames);
+    ASSERT_EQ(hdeAll.numAccumulatedSamples(), 
+              hdeFrames.numAccumulatedSamples());
+    ASSERT_EQ(0, countsFrames.front());
+    ASSERT_EQ(0, countsFrames.back());
+
+    // density must integrate to one:
+    SplineCurve1D density = hdeFrames.accumulatedDensity();
+    int numEval = 10000;
+    real evalStep = (breaks.back() - breaks.front() + 2.0*bw)/numEval;
+    real integral = 0.0;
+    for(int i = 0; i < numEval; i++)
+    {
+        real d = density.evaluate(breaks.front() + i*evalStep, 0);
+        ASSERT_LE(0.0, d);
+        integral += d;
+    }
+    integral *= evalStep;
+    ASSERT_NEAR(1.0, integral, std::sqrt(eps));
+
+    // merging histograms of two halves yields histogram of all data:
+    HistogramDensityEstimator hdeLo;
+    HistogramDensityEstimator hdeHi;
+    HistogramDensityEstimator hdeSum;
+    hdeLo.setBinWidth(bw);
+    hdeHi.setBinWidth(bw);
+    hdeSum.setBinWidth(bw);
+    hdeLo.accumulate(std::vector<real>(sortedData.begin(), 
+                                       sortedData.begin() + mid));
+    hdeHi.accumulate(std::vector<real>(sortedData.begin() + mid, 
+                                       sortedData.end()));
+    hdeSum.accumulate(testData_);
+    hdeLo.mergeAccumulated(hdeHi);
+    ASSERT_EQ(hdeSum.accumulatedBreaks(), hdeLo.accumulatedBreaks());
+    ASSERT_EQ(hdeSum.accumulatedCounts(), hdeLo.accumulatedCounts());
+    ASSERT_EQ(testData_.size(), hdeLo.numAccumulatedSamples());
+
+    // histograms with different bin widths can not be merged:
+    hdeHi.setBinWidth(2.0*bw);
+    ASSERT_THROW(hdeLo.mergeAccumulated(hdeHi), std::logic_error);
+
+    // reset discards all counts:
+    hdeFrames.resetAccumulated();
+    ASSERT_EQ(0, hdeFrames.numAccumulatedSamples());
+}
+
+
+/*!
+ * Checks that break points start at a multiple of the bin width, so that 
+ * samples with different values but ranges starting and ending in the same 
+ * bins share the same breaks, and that the endpoint bins remain empty for 
+ * both samples.
+ */
+TEST_F(HistogramDensityEstimatorTest, HistogramDensityEstimatorBreaksSnapTest)
+{
+    // create histogram estimator and set bin width:
+    real bw = 0.1;
+    HistogramDensityEstimator hde;
+    hde.setBinWidth(bw);
+
+    // two samples with different values spanning the same bins:
+    std::vector<real> sampleA = {1.23, 1.51, 1.87, 2.34};
+    std::vector<real> sampleB = {1.21, 1.42, 1.99, 2.31, 1.27};
+
+    // lowest break is a multiple of bin width:
+    hde.estimate(sampleA);
+    std::vector<real> breaks = hde.breaks_;
+    const real *breaksData = hde.breaks_.data();
+    ASSERT_NEAR(1.0, breaks.front(), 1e-5);
+    ASSERT_EQ(hde.createBreaks(sampleB), breaks);
+
+    // second sample reuses breaks:
+    hde.estimate(sampleB);
+    ASSERT_EQ(breaksData, hde.breaks_.data());
+    ASSERT_EQ(breaks, hde.breaks_);
+
+    // endpoint bins are empty for both samples:
+    for(auto sample : {sampleA, sampleB})
+    {
+        std::vector<real> density = hde.calculateDensity(sample, hde.breaks_);
+        ASSERT_EQ(0.0, density.front());
+        ASSERT_EQ(0.0, density.back());
+        ASSERT_NEAR(
+                1.0, 
+                std::accumulate(density.begin(), density.end(), 0.0), 
+                1e-5);
+    }
+}
@@ -0,0 +1,170 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "statistics/p2_quantile_estimator.hpp"
+#include "statistics/profile_quantile_statistics.hpp"
+
+
+/*!
+ * \brief Test fixture for P2QuantileEstimator.
+ *
+ * Draws a reproducible sample from a standard normal distribution.
+ */
+class P2QuantileEstimatorTest : public ::testing::Test
+{
+    public:
+
+        // constructor for creating test data:
+        P2QuantileEstimatorTest()
+        {
+            std::mt19937 rng(15011985);
+            std::normal_distribution<real> dist(0.0, 1.0);
+            testData_.resize(10000);
+            for(auto &x : testData_)
+            {
+                x = dist(rng);
+            }
+        }
+
+    
+    protected:
+
+        // test data:
+        std::vector<real> testData_;
+
+        // exact sample quantile by linear interpolation of order statistics:
+        real exactQuantile(std::vector<real> data, real p)
+        {
+            std::sort(data.begin(), data.end());
+            real h = p*(data.size() - 1);
+            size_t lo = std::floor(h);
+            size_t hi = std::min(lo + 1, data.size() - 1);
+            return data[lo] + (h - lo)*(data[hi] - data[lo]);
+        }
+};
+
+
+/*!
+ * Checks that the exact sample quantile is returned for fewer than five 
+ * samples and that infinite values are ignored.
+ */
+TEST_F(P2QuantileEstimatorTest, P2QuantileEstimatorSmallSampleTest)
+{
+    // tolerance threshold for floating point comparison:
+    real eps = std::numeric_limits<real>::epsilon();
+
+    // small data set:
+    std::vector<real> data = {0.3, 1.5, -0.9, std::sqrt(2.0)};
+
+    // check several quantiles:
+    for(real p : {0.0, 0.05, 0.5, 0.95, 1.0})
+    {
+        P2QuantileEstimator est(p);
+        for(auto x : data)
+        {
+            est.update(x);
+        }
+        est.update(std::numeric_limits<real>::infinity());
+
+        ASSERT_EQ(data.size(), est.num());
+        ASSERT_NEAR(exactQuantile(data, p), est.quantile(), 2*eps);
+    }
+}
+
+
+/*!
+ * Checks that the P2 estimate of median and 5 and 95 percent quantiles of a
+ * large normally distributed sample are close to the exact sample quantiles.
+ */
+TEST_F(P2QuantileEstimatorTest, P2QuantileEstimatorNormalTest)
+{
+    // tolerance in units of the standard deviation:
+    real tol = 0.05;
+
+    // check several quantiles:
+    for(real p : {0.05, 0.5, 0.95})
+    {
+        P2QuantileEstimator est(p);
+        for(auto x : testData_)
+        {
+            est.update(x);
+        }
+
+        ASSERT_NEAR(exactQuantile(testData_, p), est.quantile(), tol);
+    }
+}
+
+
+/*!
+ * Checks that ProfileQuantileStatistics agrees with individual estimators at
+ * each support point.
+ */
+TEST_F(P2QuantileEstimatorTest, ProfileQuantileStatisticsTest)
+{
+    // tolerance threshold for floating point comparison:
+    real eps = std::numeric_limits<real>::epsilon();
+
+    // build profiles of three points from test data:
+    size_t numPoints = 3;
+    std::vector<real> probs = {0.05, 0.5, 0.95};
+    ProfileQuantileStatistics profile(numPoints, probs);
+    std::vector<P2QuantileEstimator> reference;
+    for(auto p : probs)
+    {
+        reference.insert(reference.end(), numPoints, P2QuantileEstimator(p));
+    }
+    for(size_t i = 0; i + numPoints <= testData_.size(); i += numPoints)
+    {
+        std::vector<real> sample(
+                testData_.begin() + i, 
+                testData_.begin() + i + numPoints);
+        profile.update(sample);
+        for(size_t j = 0; j < probs.size(); j++)
+        {
+            for(size_t k = 0; k < numPoints; k++)
+            {
+                reference[j*numPoints + k].update(sample[k]);
+            }
+        }
+    }
+
+    // assert correctness:
+    for(size_t j = 0; j < probs.size(); j++)
+    {
+        std::vector<real> q = profile.quantile(j);
+        ASSERT_EQ(numPoints, q.size());
+        for(size_t k = 0; k < numPoints; k++)
+        {
+            ASSERT_NEAR(reference[j*numPoints + k].quantile(), q[k], eps);
+        }
+    }
+}
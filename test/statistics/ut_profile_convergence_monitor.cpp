@@ -0,0 +1,129 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "statistics/profile_convergence_monitor.hpp"
+
+
+/*!
+ * \brief Test fixture for ProfileConvergenceMonitor.
+ */
+class ProfileConvergenceMonitorTest : public ::testing::Test
+{
+    public:
+
+        // constructor initialises random number generator:
+        ProfileConvergenceMonitorTest()
+            : rng_(15011985)
+            , dist_(0.0, 0.1)
+            , numPoints_(10)
+        {
+
+        }
+
+    
+    protected:
+
+        // random number generation:
+        std::mt19937 rng_;
+        std::normal_distribution<real> dist_;
+
+        // number of support points:
+        size_t numPoints_;
+
+        // generates a noisy profile around a constant mean:
+        std::vector<real> noisyProfile(real offset)
+        {
+            std::vector<real> profile(numPoints_);
+            for(auto &p : profile)
+            {
+                p = 1.0 + offset + dist_(rng_);
+            }
+            return profile;
+        }
+};
+
+
+/*!
+ * Checks that a stationary noisy profile is eventually declared converged, 
+ * but not before the standard error has dropped below the tolerance.
+ */
+TEST_F(ProfileConvergenceMonitorTest, StationaryProfileTest)
+{
+    // tolerance and check interval:
+    real tol = 0.01;
+    int interval = 50;
+    ProfileConvergenceMonitor monitor(numPoints_, tol, interval);
+
+    // add profiles until convergence:
+    int maxNum = 100000;
+    while( !monitor.update(noisyProfile(0.0)) && monitor.num() < maxNum )
+    {
+
+    }
+
+    // assert convergence:
+    ASSERT_TRUE(monitor.converged());
+    ASSERT_LT(monitor.num(), maxNum);
+    ASSERT_EQ(0, monitor.num() % interval);
+    ASSERT_LT(monitor.maxMeanChange(), tol);
+    ASSERT_LT(monitor.maxStandardError(), tol);
+
+    // standard error requires at least (sd/tol)^2 samples:
+    ASSERT_GE(monitor.num(), 100);
+
+    // further updates do not change state:
+    ASSERT_TRUE(monitor.update(noisyProfile(0.0)));
+}
+
+
+/*!
+ * Checks that a drifting profile is never declared converged and that capped
+ * infinities are ignored.
+ */
+TEST_F(ProfileConvergenceMonitorTest, DriftingProfileTest)
+{
+    // tolerance and check interval:
+    real tol = 0.01;
+    int interval = 50;
+    ProfileConvergenceMonitor monitor(numPoints_, tol, interval);
+
+    // add strongly drifting profiles:
+    for(int i = 0; i < 5000; i++)
+    {
+        std::vector<real> profile = noisyProfile(0.001*i);
+        profile.front() = std::numeric_limits<real>::max();
+        monitor.update(profile);
+    }
+
+    // assert no convergence:
+    ASSERT_FALSE(monitor.converged());
+    ASSERT_GE(monitor.maxMeanChange(), tol);
+    ASSERT_LT(monitor.maxMeanChange(), 1.0);
+}
@@ -0,0 +1,195 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "statistics/profile_summary_statistics.hpp"
+#include "statistics/summary_statistics.hpp"
+
+
+/*!
+ * \brief Test fixture for ProfileSummaryStatistics.
+ *
+ * Initialises a small hard-coded set of profiles used in all tests. The last
+ * support point contains an infinite value to check that these are skipped.
+ */
+class ProfileSummaryStatisticsTest : public ::testing::Test
+{
+    public:
+
+        // constructor for creating test data:
+        ProfileSummaryStatisticsTest()
+        {
+            real inf = std::numeric_limits<real>::infinity();
+            testData_ = {{0.3, 1.5, -0.9},
+                         {1.5, -2.0, 0.1},
+                         {-0.9, 0.7, inf},
+                         {std::sqrt(2.0), 3.3, 2.5},
+                         {-5.1, 0.0, -1.2}};
+        }
+
+    
+    protected:
+
+        // test data:
+        std::vector<std::vector<real>> testData_;
+};
+
+
+/*!
+ * Checks that the profile statistics agree with those obtained from a vector
+ * of SummaryStatistics updated point by point.
+ */
+TEST_F(ProfileSummaryStatisticsTest, ProfileSummaryStatisticsUpdateTest)
+{
+    // tolerance threshold for floating point comparison:
+    real eps = 10*std::numeric_limits<real>::epsilon();
+
+    // accumulate data in both representations:
+    size_t numPoints = testData_.front().size();
+    ProfileSummaryStatistics profile(numPoints);
+    std::vector<SummaryStatistics> reference(numPoints);
+    for(auto &p : testData_)
+    {
+        profile.update(p);
+        SummaryStatistics::updateMultiple(reference, p);
+    }
+
+    // assert correctness:
+    ASSERT_EQ(numPoints, profile.size());
+    for(size_t i = 0; i < numPoints; i++)
+    {
+        ASSERT_EQ(reference[i].num(), profile.num(i));
+        ASSERT_NEAR(reference[i].min(), profile.min(i), eps);
+        ASSERT_NEAR(reference[i].max(), profile.max(i), eps);
+        ASSERT_NEAR(reference[i].mean(), profile.mean(i), eps);
+        ASSERT_NEAR(reference[i].var(), profile.var(i), eps);
+        ASSERT_NEAR(reference[i].sd(), profile.sd(i), eps);
+    }
+
+    // infinite value should have been skipped:
+    ASSERT_EQ(testData_.size() - 1, profile.num(2));
+}
+
+
+/*!
+ * Checks that merging two profiles accumulated over disjoint subsets of the
+ * test data yields the same result as accumulating all data in one profile.
+ */
+TEST_F(ProfileSummaryStatisticsTest, ProfileSummaryStatisticsMergeTest)
+{
+    // tolerance threshold for floating point comparison:
+    real eps = 10*std::numeric_limits<real>::epsilon();
+
+    // accumulate all data and two disjoint parts:
+    size_t numPoints = testData_.front().size();
+    ProfileSummaryStatistics full(numPoints);
+    ProfileSummaryStatistics partA(numPoints);
+    ProfileSummaryStatistics partB(numPoints);
+    for(size_t i = 0; i < testData_.size(); i++)
+    {
+        full.update(testData_[i]);
+        if( i % 2 == 0 )
+        {
+            partA.update(testData_[i]);
+        }
+        else
+        {
+            partB.update(testData_[i]);
+        }
+    }
+
+    // merge partial profiles:
+    partA.merge(partB);
+
+    // assert correctness:
+    for(size_t i = 0; i < numPoints; i++)
+    {
+        ASSERT_EQ(full.num(i), partA.num(i));
+        ASSERT_NEAR(full.min(i), partA.min(i), eps);
+        ASSERT_NEAR(full.max(i), partA.max(i), eps);
+        ASSERT_NEAR(full.mean(i), partA.mean(i), eps);
+        ASSERT_NEAR(full.var(i), partA.var(i), eps);
+    }
+
+    // profiles of different size can not be merged:
+    ProfileSummaryStatistics other(numPoints + 1);
+    ASSERT_THROW(partA.merge(other), std::logic_error);
+}
+
+
+/*!
+ * Checks that a profile reconstructed from the summary statistics at its 
+ * support points has the same state as the original, including support 
+ * points without any samples.
+ */
+TEST_F(ProfileSummaryStatisticsTest, ProfileSummaryStatisticsFromStatsTest)
+{
+    // accumulate first part of data:
+    size_t numPoints = testData_.front().size();
+    ProfileSummaryStatistics original(numPoints);
+    original.update(testData_[0]);
+    original.update(testData_[1]);
+
+    // reconstruct from individual support points:
+    std::vector<SummaryStatistics> stats;
+    for(size_t i = 0; i < numPoints; i++)
+    {
+        stats.push_back(original.at(i));
+    }
+    ProfileSummaryStatistics copy(stats);
+
+    // update both with remaining data:
+    for(size_t i = 2; i < testData_.size(); i++)
+    {
+        original.update(testData_[i]);
+        copy.update(testData_[i]);
+    }
+
+    // assert identical state:
+    ASSERT_EQ(numPoints, copy.size());
+    for(size_t i = 0; i < numPoints; i++)
+    {
+        ASSERT_EQ(original.num(i), copy.num(i));
+        ASSERT_EQ(original.min(i), copy.min(i));
+        ASSERT_EQ(original.max(i), copy.max(i));
+        ASSERT_EQ(original.mean(i), copy.mean(i));
+        ASSERT_EQ(original.var(i), copy.var(i));
+    }
+
+    // empty support points can be merged into after reconstruction:
+    std::vector<SummaryStatistics> emptyStats(numPoints);
+    ProfileSummaryStatistics empty(emptyStats);
+    empty.merge(original);
+    for(size_t i = 0; i < numPoints; i++)
+    {
+        ASSERT_EQ(original.min(i), empty.min(i));
+        ASSERT_EQ(original.max(i), empty.max(i));
+        ASSERT_FLOAT_EQ(original.mean(i), empty.mean(i));
+    }
+}
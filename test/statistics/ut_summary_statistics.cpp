@@ -147,3 +147,58 @@ TEST_F(SummaryStatisticsTest, SummaryStatisticsVarSdTest)
     ASSERT_NEAR(sd, testDataSummary.sd(), eps);
 }
 
+
+
+/*!
+ * Checks that merging the summary statistics of two disjoint parts of the 
+ * test data set yields the same result as updating a single object with the
+ * entire data set. Also checks that merging with an empty object has no 
+ * effect.
+ */
+TEST_F(SummaryStatisticsTest, SummaryStatisticsMergeTest)
+{
+    // tolerance threshold for floating point comparison:
+    real eps = 10*std::numeric_limits<real>::epsilon();
+
+    // summary statistics of entire data set:
+    SummaryStatistics fullSummary;
+    for(size_t i = 0; i < testData_.size(); i++)
+    {
+        fullSummary.update(testData_.at(i));
+    }
+
+    // summary statistics of two parts of the data set:
+    SummaryStatistics partSummaryA;
+    SummaryStatistics partSummaryB;
+    for(size_t i = 0; i < testData_.size(); i++)
+    {
+        if( i < 2 )
+        {
+            partSummaryA.update(testData_.at(i));
+        }
+        else
+        {
+            partSummaryB.update(testData_.at(i));
+        }
+    }
+
+    // merge partial statistics:
+    partSummaryA.merge(partSummaryB);
+
+    // assert correctness:
+    ASSERT_EQ(fullSummary.num(), partSummaryA.num());
+    ASSERT_NEAR(fullSummary.min(), partSummaryA.min(), eps);
+    ASSERT_NEAR(fullSummary.max(), partSummaryA.max(), eps);
+    ASSERT_NEAR(fullSummary.mean(), partSummaryA.mean(), eps);
+    ASSERT_NEAR(fullSummary.var(), partSummaryA.var(), eps);
+    ASSERT_NEAR(fullSummary.sd(), partSummaryA.sd(), eps);
+
+    // merging with empty object in either direction should change nothing:
+    SummaryStatistics emptySummary;
+    partSummaryA.merge(emptySummary);
+    emptySummary.merge(fullSummary);
+    ASSERT_EQ(fullSummary.num(), partSummaryA.num());
+    ASSERT_EQ(fullSummary.num(), emptySummary.num());
+    ASSERT_NEAR(fullSummary.mean(), emptySummary.mean(), eps);
+    ASSERT_NEAR(fullSummary.var(), emptySummary.var(), eps);
+}
@@ -0,0 +1,73 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "trajectory-analysis/chap_merge.hpp"
+
+
+/*!
+ * Checks that the PDB file written next to a shard is found again when the 
+ * shard is merged, independent of the directory given in -out-filename and 
+ * of the working directory of chap merge.
+ */
+TEST(ChapMergeTest, ChapMergeShardPathTest)
+{
+    // output base file name with directory as given to -out-filename:
+    std::string shardFileName = "results/run1_shard.json";
+    std::string pdbFileName = "results/run1.pdb";
+
+    // only file name is stored in shard:
+    std::string stored = ChapMerge::shardRelativePath(pdbFileName);
+    ASSERT_EQ("run1.pdb", stored);
+
+    // resolved relative to shard file directory:
+    ASSERT_EQ(
+            pdbFileName, 
+            ChapMerge::resolveShardPath(shardFileName, stored));
+    ASSERT_EQ(
+            "../project/results/run1.pdb", 
+            ChapMerge::resolveShardPath(
+                    "../project/results/run1_shard.json", 
+                    stored));
+
+    // shards in the working directory:
+    ASSERT_EQ("run1.pdb", ChapMerge::shardRelativePath("run1.pdb"));
+    ASSERT_EQ(
+            "run1.pdb", 
+            ChapMerge::resolveShardPath("run1_shard.json", "run1.pdb"));
+
+    // absolute paths are used as they are:
+    ASSERT_EQ(
+            "/data/run1.pdb", 
+            ChapMerge::shardRelativePath("/data/run1.pdb"));
+    ASSERT_EQ(
+            "/data/run1.pdb", 
+            ChapMerge::resolveShardPath("results/run1_shard.json", 
+                                        "/data/run1.pdb"));
+}
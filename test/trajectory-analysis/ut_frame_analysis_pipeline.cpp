@@ -0,0 +1,250 @@
+// CHAP - The Channel Annotation Package
+// 
+// Copyright (c) 2016 - 2018 Gianni Klesse, Shanlin Rao, Mark S. P. Sansom, and 
+// Stephen J. Tucker
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "trajectory-analysis/frame_analysis_pipeline.hpp"
+
+
+/*!
+ * \brief Stage that only records which of its hooks were called.
+ */
+class RecordingStage : public AbstractFrameAnalysisStage
+{
+    public:
+
+        // constructor:
+        RecordingStage(
+                std::string name, 
+                unsigned int inputs, 
+                unsigned int outputs,
+                std::vector<std::string> &log,
+                std::mutex &logMutex)
+            : AbstractFrameAnalysisStage(name, inputs, outputs)
+            , log_(log)
+            , logMutex_(logMutex)
+        {
+
+        }
+
+        // stage hooks:
+        void prepare(FrameAnalysisContext &/*ctx*/)
+        {
+            record("prepare");
+        }
+        void evaluate(FrameAnalysisContext &/*ctx*/)
+        {
+            record("evaluate");
+        }
+        void skip(FrameAnalysisContext &/*ctx*/)
+        {
+            record("skip");
+        }
+        void write(FrameAnalysisContext &/*ctx*/)
+        {
+            record("write");
+        }
+
+    private:
+
+        std::vector<std::string> &log_;
+        std::mutex &logMutex_;
+
+        // adds hook call to log:
+        void record(const std::string &hook)
+        {
+            std::lock_guard<std::mutex> lock(logMutex_);
+            log_.push_back(name() + ":" + hook);
+        }
+};
+
+
+/*!
+ * \brief Test fixture for FrameAnalysisPipeline.
+ */
+class FrameAnalysisPipelineTest : public ::testing::Test
+{
+    protected:
+
+        std::vector<std::string> log_;
+        std::mutex logMutex_;
+        FrameAnalysisContext ctx_;
+
+        // creates a new recording stage:
+        std::unique_ptr<AbstractFrameAnalysisStage> stage(
+                std::string name,
+                unsigned int inputs,
+                unsigned int outputs)
+        {
+            return std::unique_ptr<AbstractFrameAnalysisStage>(
+                    new RecordingStage(name, inputs, outputs, log_, 
+                                       logMutex_));
+        }
+
+        // adds the stage layout used in CHAP to the given pipeline:
+        void addChapLayout(FrameAnalysisPipeline &pipeline)
+        {
+            pipeline.addStage(stage("path", 0, eFrameDataPath));
+            pipeline.addStage(stage("residues", 
+                                    eFrameDataPath, 
+                                    eFrameDataPoreResidues));
+            pipeline.addStage(stage("hydrophobicity", 
+                                    eFrameDataPoreResidues, 
+                                    eFrameDataHydrophobicity));
+            pipeline.addStage(stage("solvent", 
+                                    eFrameDataPath, 
+                                    eFrameDataSolvent));
+            pipeline.addStage(stage("density", 
+                                    eFrameDataSolvent, 
+                                    eFrameDataSolventDensity));
+            pipeline.addStage(stage("summary", 
+                                    eFrameDataPath | eFrameDataSolventDensity, 
+                                    0));
+        }
+};
+
+
+/*!
+ * Checks that stages are assigned to levels according to their inputs.
+ */
+TEST_F(FrameAnalysisPipelineTest, FrameAnalysisPipelineScheduleTest)
+{
+    FrameAnalysisPipeline pipeline;
+    addChapLayout(pipeline);
+    ASSERT_EQ(6, pipeline.numStages());
+
+    std::vector<std::vector<std::string>> schedule = pipeline.schedule();
+    ASSERT_EQ(4, schedule.size());
+    ASSERT_EQ(std::vector<std::string>({"path"}), schedule[0]);
+    ASSERT_EQ(std::vector<std::string>({"residues", "solvent"}), schedule[1]);
+    ASSERT_EQ(std::vector<std::string>({"hydrophobicity", "density"}), 
+              schedule[2]);
+    ASSERT_EQ(std::vector<std::string>({"summary"}), schedule[3]);
+}
+
+
+/*!
+ * Checks that inconsistent stage declarations are rejected.
+ */
+TEST_F(FrameAnalysisPipelineTest, FrameAnalysisPipelineInvalidStageTest)
+{
+    FrameAnalysisPipeline pipeline;
+
+    // input not produced by any previous stage:
+    ASSERT_THROW(pipeline.addStage(stage("residues", 
+                                         eFrameDataPath, 
+                                         eFrameDataPoreResidues)),
+                 std::logic_error);
+
+    // output produced twice:
+    pipeline.addStage(stage("path", 0, eFrameDataPath));
+    ASSERT_THROW(pipeline.addStage(stage("other-path", 0, eFrameDataPath)),
+                 std::logic_error);
+
+    // unknown stage name:
+    ASSERT_THROW(pipeline.setStageEnabled("solvent", false), 
+                 std::logic_error);
+}
+
+
+/*!
+ * Checks that hooks are called in the documented order and that disabled 
+ * stages are skipped rather than evaluated.
+ */
+TEST_F(FrameAnalysisPipelineTest, FrameAnalysisPipelineSkipTest)
+{
+    FrameAnalysisPipeline pipeline;
+    pipeline.addStage(stage("path", 0, eFrameDataPath));
+    pipeline.addStage(stage("residues", 
+                            eFrameDataPath, 
+                            eFrameDataPoreResidues));
+    pipeline.addStage(stage("solvent", eFrameDataPath, eFrameDataSolvent));
+    pipeline.setStageEnabled("solvent", false);
+
+    pipeline.run(ctx_);
+
+    std::vector<std::string> expected = {"path:prepare",
+                                         "path:evaluate",
+                                         "path:write",
+                                         "residues:prepare",
+                                         "residues:evaluate",
+                                         "solvent:skip",
+                                         "residues:write",
+                                         "solvent:write"};
+    ASSERT_EQ(expected, log_);
+}
+
+
+/*!
+ * Checks that concurrent execution calls the same hooks as serial execution 
+ * and keeps prepare and write hooks in order.
+ */
+TEST_F(FrameAnalysisPipelineTest, FrameAnalysisPipelineConcurrentTest)
+{
+    // serial reference:
+    FrameAnalysisPipeline serial;
+    addChapLayout(serial);
+    serial.run(ctx_);
+    std::vector<std::string> serialLog = log_;
+
+    // concurrent run over several frames:
+    FrameAnalysisPipeline concurrent;
+    addChapLayout(concurrent);
+    concurrent.setConcurrent(true);
+    int numFrames = 10;
+    for(int i = 0; i < numFrames; i++)
+    {
+        log_.clear();
+        concurrent.run(ctx_);
+
+        // same number of hook calls:
+        ASSERT_EQ(serialLog.size(), log_.size());
+
+        // serial hooks are in same position as in serial run:
+        for(size_t j = 0; j < log_.size(); j++)
+        {
+            if( serialLog[j].find(":evaluate") == std::string::npos )
+            {
+                ASSERT_EQ(serialLog[j], log_[j]);
+            }
+        }
+
+        // evaluation of independent stages may happen in any order:
+        std::vector<std::string> sortedLog = log_;
+        std::vector<std::string> sortedSerialLog = serialLog;
+        std::sort(sortedLog.begin(), sortedLog.end());
+        std::sort(sortedSerialLog.begin(), sortedSerialLog.end());
+        ASSERT_EQ(sortedSerialLog, sortedLog);
+    }
+}
+